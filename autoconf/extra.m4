@@ -883,6 +883,16 @@ AC_DEFUN([CS_ENABLE_LOCK_DEBUG], [
 ])
 
 
+AC_DEFUN([CS_ENABLE_LOCK_PROFILE], [
+	AC_ARG_ENABLE(lock_profile, 
+		[AC_HELP_STRING([--enable-lock-profile], [enable lock contention profiling ('sccp show locks')])], 
+		[ac_cv_lock_profile=$enableval], 
+		[ac_cv_lock_profile=no]
+	)
+	AS_IF([test "_${ac_cv_lock_profile}" == "_yes"], [AC_DEFINE(CS_LOCK_PROFILE, 1, [lock contention profiling enabled])])
+	AC_MSG_RESULT([--enable-lock-profile: ${ac_cv_lock_profile}])
+])
+
 AC_DEFUN([CS_ENABLE_STRIP], [
 	AC_ARG_ENABLE(strip, 
 		[AC_HELP_STRING([--enable-strip], [strip the symbols from the binary during installation])], 
@@ -1189,6 +1199,7 @@ AC_DEFUN([CS_PARSE_WITH_AND_ENABLE], [
 	CS_ENABLE_REFCOUNT_DEBUG
 	CS_ENABLE_ASTOBJ_REFCOUNT
 	CS_ENABLE_LOCK_DEBUG
+	CS_ENABLE_LOCK_PROFILE
 	CS_ENABLE_STRIP
 	CS_DISABLE_PICKUP
 	CS_DISABLE_PARK
@@ -0,0 +1,1058 @@
+/*!
+ * \file	sccp_loadtest.c
+ * \brief	SCCP Phone Simulator / Load Generator
+ * \note	This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *		See the LICENSE file at the top of the source tree.
+ *
+ * Simulates a large number of skinny phones over TCP, to measure the behaviour of chan-sccp under load on a single box.
+ * Every phone goes through the token/register sequence, requests its button/softkey templates, line/speeddial/blf
+ * states and sends keepalives. Phones are paired up (even phone calls the next odd one), the caller goes offhook,
+ * dials using enbloc, the callee answers after a short delay and the caller hangs up after the hold time.
+ *
+ * Reported: registration rate and latency, call setup (offhook->connected) and ring (dial->ringin) latency
+ * percentiles, keepalive round trip, blf notifications and the cpu time consumed by the server process.
+ *
+ * Use '-g' to generate the matching sccp.conf / extensions.conf snippets.
+ */
+
+#include <sys/epoll.h>
+#include <sys/time.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sccp_loadtest.h"
+
+static struct {
+	const char *host;
+	const char *port;
+	uint32_t phones;
+	uint32_t macbase;
+	uint32_t extbase;
+	uint32_t threads;
+	uint32_t rate;											/*!< new registrations per second, 0 = all at once */
+	uint32_t duration;										/*!< seconds */
+	uint32_t callinterval;										/*!< ms between calls per caller, 0 = no calls */
+	uint32_t holdtime;										/*!< ms */
+	uint32_t answerdelay;										/*!< ms */
+	uint32_t keepalive;										/*!< ms, 0 = use value from RegisterAck */
+	uint32_t blf;											/*!< number of blf speeddials per phone (genconf) */
+	boolean_t token;
+	pid_t serverpid;
+	int verbose;
+} conf = {
+	.host = "127.0.0.1",
+	.port = "2000",
+	.phones = 100,
+	.macbase = 0x1000,
+	.extbase = 1000,
+	.threads = 4,
+	.rate = 100,
+	.duration = 60,
+	.callinterval = 5000,
+	.holdtime = 2000,
+	.answerdelay = 200,
+	.keepalive = 0,
+	.blf = 1,
+	.token = FALSE,
+	.serverpid = 0,
+	.verbose = 0,
+};
+
+static struct {
+	volatile int connects;
+	volatile int connectFailures;
+	volatile int disconnects;
+	volatile int registered;
+	volatile int rejected;
+	volatile int tokenAcks;
+	volatile int tokenRejects;
+	volatile int keepalives;
+	volatile int callsStarted;
+	volatile int callsConnected;
+	volatile int callsFailed;
+	volatile int callsCompleted;
+	volatile int blfUpdates;
+	volatile int messagesIn;
+	volatile int messagesOut;
+} stats;
+
+static sim_phone_t *phones = NULL;
+static sim_worker_t *workers = NULL;
+static struct addrinfo *serveraddr = NULL;
+static volatile int sim_stop = 0;
+static uint64_t sim_start = 0;
+static volatile uint64_t sim_lastRegistration = 0;
+
+#define SIM_INCR(_x) __sync_fetch_and_add(&stats._x, 1)
+
+static uint64_t sim_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sim_samples_add(sim_samples_t *s, uint64_t usec)
+{
+	if (s->count == s->size) {
+		size_t newsize = s->size ? s->size * 2 : 1024;
+		uint32_t *samples = realloc(s->samples, newsize * sizeof(uint32_t));
+		if (!samples) {
+			return;
+		}
+		s->samples = samples;
+		s->size = newsize;
+	}
+	s->samples[s->count++] = usec > UINT32_MAX ? UINT32_MAX : (uint32_t)usec;
+}
+
+static int sim_samples_cmp(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+/* ================================================================================================================ SEND */
+static sccp_msg_t *sim_build(sccp_msg_t *msg, sccp_mid_t mid, size_t len)
+{
+	memset(msg, 0, SCCP_PACKET_HEADER + len);
+	msg->header.length = htolel(len + 4);
+	msg->header.lel_protocolVer = htolel(SIM_PROTOCOL_VERSION);					/* same rule as the server: version >= 10 goes into the header */
+	msg->header.lel_messageId = htolel(mid);
+	return msg;
+}
+#define SIM_REQ(_msg, _type) sim_build(&(_msg), _type, sizeof((_msg).data._type))
+
+/* arm / disarm EPOLLOUT, only while there is queued data (or a connect in progress) */
+static void sim_wantWrite(sim_phone_t *p, boolean_t wantWrite)
+{
+	struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP | (wantWrite ? EPOLLOUT : 0), .data.ptr = p };
+
+	if (p->fd >= 0 && p->wantWrite != wantWrite) {
+		epoll_ctl(p->epfd, EPOLL_CTL_MOD, p->fd, &ev);
+		p->wantWrite = wantWrite;
+	}
+}
+
+/*
+ * write as much of the send queue as the socket takes, never blocks. On a write error the socket is shut down, the worker
+ * then sees EPOLLHUP and disconnects the phone from its own context.
+ */
+static int sim_flush(sim_phone_t *p)
+{
+	size_t sent = 0;
+
+	if (p->fd < 0) {
+		return -1;
+	}
+	while (sent < p->txlen) {
+		ssize_t res = send(p->fd, p->txbuf + sent, p->txlen - sent, MSG_NOSIGNAL);
+		if (res < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			shutdown(p->fd, SHUT_RDWR);
+			p->txlen = 0;
+			return -1;
+		}
+		sent += res;
+	}
+	memmove(p->txbuf, p->txbuf + sent, p->txlen - sent);
+	p->txlen -= sent;
+	sim_wantWrite(p, p->txlen > 0);
+	return 0;
+}
+
+static int sim_send(sim_phone_t *p, sccp_msg_t *msg)
+{
+	size_t len = letohl(msg->header.length) + 8;
+
+	if (p->fd < 0 || p->state == SIM_PHONE_CONNECTING) {
+		return -1;
+	}
+	if (p->txlen + len > sizeof(p->txbuf)) {
+		fprintf(stderr, "%s: send queue full, server is not reading, disconnecting\n", p->name);
+		shutdown(p->fd, SHUT_RDWR);
+		p->txlen = 0;
+		return -1;
+	}
+	memcpy(p->txbuf + p->txlen, msg, len);
+	p->txlen += len;
+	SIM_INCR(messagesOut);
+	return (p->wantWrite) ? 0 : sim_flush(p);						/* when EPOLLOUT is armed, the worker flushes */
+}
+
+static void sim_sendSimple(sim_phone_t *p, sccp_mid_t mid)
+{
+	sccp_msg_t msg;
+	sim_build(&msg, mid, 4);
+	sim_send(p, &msg);
+}
+
+static void sim_sendRegister(sim_phone_t *p)
+{
+	sccp_msg_t msg;
+	SIM_REQ(msg, RegisterMessage);
+	snprintf(msg.data.RegisterMessage.sId.deviceName, StationMaxDeviceNameSize, "%s", p->name);
+	msg.data.RegisterMessage.sId.lel_instance = htolel(1);
+	msg.data.RegisterMessage.stationIpAddr = htonl(INADDR_LOOPBACK);
+	msg.data.RegisterMessage.lel_deviceType = htolel(SIM_DEVICETYPE);
+	msg.data.RegisterMessage.lel_maxStreams = htolel(5);
+	msg.data.RegisterMessage.protocolFeatures.protocolVersion = SIM_PROTOCOL_VERSION;
+	msg.data.RegisterMessage.protocolFeatures.phoneFeatures[2] = SKINNY_PHONE_FEATURES2_DYNAMIC_MESSAGES;
+	msg.data.RegisterMessage.lel_maxConferences = htolel(1);
+	memcpy(msg.data.RegisterMessage.macAddress, p->name + 3, sizeof(msg.data.RegisterMessage.macAddress));
+	msg.data.RegisterMessage.lel_maxNumberOfLines = htolel(8);
+	snprintf(msg.data.RegisterMessage.loadInfo, sizeof(msg.data.RegisterMessage.loadInfo), "sccp_loadtest");
+	sim_send(p, &msg);
+	p->state = SIM_PHONE_REGISTERING;
+}
+
+static void sim_sendTokenRequest(sim_phone_t *p)
+{
+	sccp_msg_t msg;
+	SIM_REQ(msg, RegisterTokenRequest);
+	snprintf(msg.data.RegisterTokenRequest.sId.deviceName, StationMaxDeviceNameSize, "%s", p->name);
+	msg.data.RegisterTokenRequest.sId.lel_instance = htolel(1);
+	msg.data.RegisterTokenRequest.lel_stationIpAddr = htonl(INADDR_LOOPBACK);
+	msg.data.RegisterTokenRequest.lel_deviceType = htolel(SIM_DEVICETYPE);
+	sim_send(p, &msg);
+	p->state = SIM_PHONE_TOKEN;
+}
+
+static void sim_sendCapabilities(sim_phone_t *p)
+{
+	sccp_msg_t msg;
+	SIM_REQ(msg, CapabilitiesResMessage);
+	msg.data.CapabilitiesResMessage.lel_count = htolel(2);
+	msg.data.CapabilitiesResMessage.caps[0].lel_payloadCapability = htolel(SKINNY_CODEC_G711_ULAW_64K);
+	msg.data.CapabilitiesResMessage.caps[0].lel_maxFramesPerPacket = htolel(40);
+	msg.data.CapabilitiesResMessage.caps[1].lel_payloadCapability = htolel(SKINNY_CODEC_G711_ALAW_64K);
+	msg.data.CapabilitiesResMessage.caps[1].lel_maxFramesPerPacket = htolel(40);
+	sim_send(p, &msg);
+}
+
+static void sim_sendButtonRequests(sim_phone_t *p)
+{
+	sccp_msg_t msg;
+	uint8_t i = 0;
+
+	sim_sendSimple(p, SoftKeyTemplateReqMessage);
+	sim_sendSimple(p, SoftKeySetReqMessage);
+	for (i = 0; i < p->numLines; i++) {
+		SIM_REQ(msg, LineStatReqMessage);
+		msg.data.LineStatReqMessage.lel_lineNumber = htolel(p->lineInstances[i]);
+		sim_send(p, &msg);
+	}
+	for (i = 0; i < p->numSpeeddials; i++) {
+		SIM_REQ(msg, SpeedDialStatReqMessage);
+		msg.data.SpeedDialStatReqMessage.lel_speedDialNumber = htolel(p->speeddialInstances[i]);
+		sim_send(p, &msg);
+	}
+	for (i = 0; i < p->numBLF; i++) {
+		SIM_REQ(msg, FeatureStatReqMessage);
+		msg.data.FeatureStatReqMessage.lel_featureIndex = htolel(p->blfInstances[i]);
+		sim_send(p, &msg);
+	}
+	SIM_REQ(msg, RegisterAvailableLinesMessage);
+	msg.data.RegisterAvailableLinesMessage.maxAvailLines = htolel(p->numLines);
+	sim_send(p, &msg);
+	sim_sendSimple(p, TimeDateReqMessage);
+}
+
+static void sim_sendOffHook(sim_phone_t *p, uint32_t callReference)
+{
+	sccp_msg_t msg;
+	SIM_REQ(msg, OffHookMessage);
+	msg.data.OffHookMessage.lel_lineInstance = htolel(p->numLines ? p->lineInstances[0] : 1);
+	msg.data.OffHookMessage.lel_callReference = htolel(callReference);
+	sim_send(p, &msg);
+}
+
+static void sim_sendOnHook(sim_phone_t *p)
+{
+	sccp_msg_t msg;
+	SIM_REQ(msg, OnHookMessage);
+	msg.data.OnHookMessage.lel_buttonIndex = htolel(p->numLines ? p->lineInstances[0] : 1);
+	msg.data.OnHookMessage.lel_callReference = htolel(p->callReference);
+	sim_send(p, &msg);
+	p->callstate = SIM_CALL_HANGUP;
+}
+
+static void sim_sendEnbloc(sim_phone_t *p)
+{
+	sccp_msg_t msg;
+	SIM_REQ(msg, EnblocCallMessage);
+	snprintf(msg.data.EnblocCallMessage.v17.calledParty, StationMaxDirnumSize, "%u", conf.extbase + p->idx + 1);
+	msg.data.EnblocCallMessage.v17.lel_lineInstance = htolel(p->numLines ? p->lineInstances[0] : 1);
+	sim_send(p, &msg);
+}
+
+static void sim_sendOpenReceiveChannelAck(sim_phone_t *p, constMessagePtr msg_in)
+{
+	sccp_msg_t msg;
+	uint32_t addr = htonl(INADDR_LOOPBACK);
+	SIM_REQ(msg, OpenReceiveChannelAck);
+	msg.data.OpenReceiveChannelAck.v17.lel_mediastatus = htolel(SKINNY_MEDIASTATUS_Ok);
+	msg.data.OpenReceiveChannelAck.v17.lel_ipv46 = 0;
+	memcpy(msg.data.OpenReceiveChannelAck.v17.bel_ipAddr, &addr, sizeof(addr));
+	msg.data.OpenReceiveChannelAck.v17.lel_portNumber = htolel(20000 + (p->idx * 2) % 40000);
+	msg.data.OpenReceiveChannelAck.v17.lel_passThruPartyId = msg_in->data.OpenReceiveChannel.v17.lel_passThruPartyId;
+	msg.data.OpenReceiveChannelAck.v17.lel_callReference = msg_in->data.OpenReceiveChannel.v17.lel_callReference;
+	sim_send(p, &msg);
+}
+
+static void sim_sendStartMediaTransmissionAck(sim_phone_t *p, constMessagePtr msg_in)
+{
+	sccp_msg_t msg;
+	uint32_t addr = htonl(INADDR_LOOPBACK);
+	SIM_REQ(msg, StartMediaTransmissionAck);
+	msg.data.StartMediaTransmissionAck.v17.lel_callReference = msg_in->data.StartMediaTransmission.v17.lel_callReference;
+	msg.data.StartMediaTransmissionAck.v17.lel_passThruPartyId = msg_in->data.StartMediaTransmission.v17.lel_passThruPartyId;
+	msg.data.StartMediaTransmissionAck.v17.lel_callReference1 = msg_in->data.StartMediaTransmission.v17.lel_callReference;
+	memcpy(msg.data.StartMediaTransmissionAck.v17.bel_ipAddr, &addr, sizeof(addr));
+	msg.data.StartMediaTransmissionAck.v17.lel_portNumber = htolel(20000 + (p->idx * 2) % 40000);
+	msg.data.StartMediaTransmissionAck.v17.lel_mediastatus = htolel(SKINNY_MEDIASTATUS_Ok);
+	sim_send(p, &msg);
+}
+
+/* ========================================================================================================= CONNECTION */
+static void sim_phone_disconnect(sim_worker_t *w, sim_phone_t *p, uint64_t now)
+{
+	if (p->fd >= 0) {
+		epoll_ctl(w->epfd, EPOLL_CTL_DEL, p->fd, NULL);
+		close(p->fd);
+		p->fd = -1;
+		SIM_INCR(disconnects);
+	}
+	if (p->state == SIM_PHONE_REGISTERED) {
+		__sync_fetch_and_sub(&stats.registered, 1);
+	}
+	p->state = SIM_PHONE_IDLE;
+	p->callstate = SIM_CALL_NONE;
+	p->rxlen = 0;
+	p->txlen = 0;
+	p->wantWrite = FALSE;
+	p->templateRequested = FALSE;
+	p->numLines = p->numSpeeddials = p->numBLF = 0;
+	p->connect_at = now + SIM_RECONNECT_DELAY * 1000;
+}
+
+static void sim_phone_connectFailed(sim_worker_t *w, sim_phone_t *p, uint64_t now, int error)
+{
+	if (conf.verbose) {
+		fprintf(stderr, "%s: connect failed: %s\n", p->name, strerror(error));
+	}
+	SIM_INCR(connectFailures);
+	if (p->fd >= 0) {
+		epoll_ctl(w->epfd, EPOLL_CTL_DEL, p->fd, NULL);
+		close(p->fd);
+		p->fd = -1;
+	}
+	p->state = SIM_PHONE_IDLE;
+	p->wantWrite = FALSE;
+	p->connect_at = now + SIM_RECONNECT_DELAY * 1000;
+}
+
+static void sim_phone_connected(sim_phone_t *p, uint64_t now)
+{
+	int on = 1;
+
+	setsockopt(p->fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	SIM_INCR(connects);
+	p->state = SIM_PHONE_IDLE;
+	p->connected_at = now;
+	if (conf.token) {
+		sim_sendTokenRequest(p);
+	} else {
+		sim_sendRegister(p);
+	}
+}
+
+/* the connect is non-blocking: completion is reported by EPOLLOUT, see sim_phone_connectDone */
+static void sim_phone_connect(sim_worker_t *w, sim_phone_t *p, uint64_t now)
+{
+	struct epoll_event ev = { .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP, .data.ptr = p };
+
+	if ((p->fd = socket(serveraddr->ai_family, SOCK_STREAM, IPPROTO_TCP)) < 0) {
+		sim_phone_connectFailed(w, p, now, errno);
+		return;
+	}
+	fcntl(p->fd, F_SETFL, fcntl(p->fd, F_GETFL) | O_NONBLOCK);
+	p->epfd = w->epfd;
+	p->rxlen = p->txlen = 0;
+	p->connected_at = now;
+	if (connect(p->fd, serveraddr->ai_addr, serveraddr->ai_addrlen) < 0 && errno != EINPROGRESS) {
+		sim_phone_connectFailed(w, p, now, errno);
+		return;
+	}
+	p->state = SIM_PHONE_CONNECTING;
+	p->wantWrite = TRUE;
+	epoll_ctl(w->epfd, EPOLL_CTL_ADD, p->fd, &ev);
+}
+
+static void sim_phone_connectDone(sim_worker_t *w, sim_phone_t *p, uint64_t now)
+{
+	int error = 0;
+	socklen_t len = sizeof(error);
+
+	if (getsockopt(p->fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0) {
+		error = errno;
+	}
+	if (error) {
+		sim_phone_connectFailed(w, p, now, error);
+		return;
+	}
+	sim_phone_connected(p, now);
+	sim_flush(p);											/* disarms EPOLLOUT once the register went out */
+}
+
+/* ============================================================================================================ RECEIVE */
+static void sim_handle_buttonTemplate(sim_phone_t *p, constMessagePtr msg)
+{
+	uint32_t offset = letohl(msg->data.ButtonTemplateMessage.lel_buttonOffset);
+	uint32_t count = letohl(msg->data.ButtonTemplateMessage.lel_buttonCount);
+	uint32_t total = letohl(msg->data.ButtonTemplateMessage.lel_totalButtonCount);
+	uint32_t i = 0;
+
+	if (offset == 0) {
+		/* start of a (new) template, e.g. resent after a live config update: do not append to the previous one */
+		p->numLines = p->numSpeeddials = p->numBLF = 0;
+		p->templateRequested = FALSE;
+	}
+	for (i = 0; i < count && i < StationMaxButtonTemplateSize; i++) {
+		const StationButtonDefinition *def = &msg->data.ButtonTemplateMessage.definition[i];
+		switch (def->buttonDefinition) {
+			case SKINNY_BUTTONTYPE_LINE:
+				if (p->numLines < SIM_MAX_BUTTONS) {
+					p->lineInstances[p->numLines++] = def->instanceNumber;
+				}
+				break;
+			case SKINNY_BUTTONTYPE_SPEEDDIAL:
+				if (p->numSpeeddials < SIM_MAX_BUTTONS) {
+					p->speeddialInstances[p->numSpeeddials++] = def->instanceNumber;
+				}
+				break;
+			case SKINNY_BUTTONTYPE_BLFSPEEDDIAL:
+				if (p->numBLF < SIM_MAX_BUTTONS) {
+					p->blfInstances[p->numBLF++] = def->instanceNumber;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	if (offset + count >= total && !p->templateRequested) {
+		p->templateRequested = TRUE;
+		sim_sendButtonRequests(p);
+	}
+}
+
+static void sim_handle_callState(sim_worker_t *w, sim_phone_t *p, constMessagePtr msg, uint64_t now)
+{
+	skinny_callstate_t callstate = letohl(msg->data.CallStateMessage.lel_callState);
+	uint32_t callReference = letohl(msg->data.CallStateMessage.lel_callReference);
+
+	switch (callstate) {
+		case SKINNY_CALLSTATE_OFFHOOK:
+			if (p->callstate == SIM_CALL_OFFHOOK) {
+				p->callReference = callReference;
+				p->callstate = SIM_CALL_DIALED;
+				__atomic_store_n(&p->dialed_at, now, __ATOMIC_RELEASE);
+				sim_sendEnbloc(p);
+			}
+			break;
+		case SKINNY_CALLSTATE_RINGIN:
+			if (p->callstate == SIM_CALL_NONE) {
+				uint64_t dialed_at = p->idx > 0 ? __atomic_load_n(&phones[p->idx - 1].dialed_at, __ATOMIC_ACQUIRE) : 0;
+				if (dialed_at && dialed_at <= now) {
+					sim_samples_add(&w->ring, now - dialed_at);
+				}
+				p->callReference = callReference;
+				p->callstate = SIM_CALL_RINGIN;
+				p->answer_at = now + conf.answerdelay * 1000;
+			}
+			break;
+		case SKINNY_CALLSTATE_CONNECTED:
+			if (p->callstate == SIM_CALL_DIALED && callReference == p->callReference) {
+				sim_samples_add(&w->callsetup, now - p->call_at);
+				SIM_INCR(callsConnected);
+				p->callstate = SIM_CALL_CONNECTED;
+				p->hangup_at = now + conf.holdtime * 1000;
+			} else if (p->callstate == SIM_CALL_ANSWERED) {
+				p->callstate = SIM_CALL_CONNECTED;
+			}
+			break;
+		case SKINNY_CALLSTATE_ONHOOK:
+			if (p->callstate != SIM_CALL_NONE && (!callReference || callReference == p->callReference)) {
+				boolean_t isCaller = (p->idx % 2 == 0);
+				if (isCaller) {
+					if (p->callstate == SIM_CALL_HANGUP) {
+						SIM_INCR(callsCompleted);
+					} else {
+						SIM_INCR(callsFailed);
+					}
+					p->call_at = now + conf.callinterval * 1000;
+				}
+				p->callstate = SIM_CALL_NONE;
+				p->callReference = 0;
+				p->dialed_at = 0;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static void sim_handle_message(sim_worker_t *w, sim_phone_t *p, constMessagePtr msg, uint64_t now)
+{
+	sccp_mid_t mid = letohl(msg->header.lel_messageId);
+
+	SIM_INCR(messagesIn);
+	switch (mid) {
+		case RegisterTokenAck:
+			SIM_INCR(tokenAcks);
+			sim_sendRegister(p);
+			break;
+		case RegisterTokenReject:
+			SIM_INCR(tokenRejects);
+			sim_phone_disconnect(w, p, now);
+			p->connect_at = now + (uint64_t)letohl(msg->data.RegisterTokenReject.lel_tokenRejWaitTime) * 1000000;
+			break;
+		case RegisterAckMessage:
+			p->keepAliveInterval = conf.keepalive ? conf.keepalive : letohl(msg->data.RegisterAckMessage.lel_keepAliveInterval) * 1000;
+			if (!p->keepAliveInterval) {
+				p->keepAliveInterval = SCCP_MIN_KEEPALIVE * 1000;
+			}
+			sim_sendSimple(p, ButtonTemplateReqMessage);
+			break;
+		case RegisterRejectMessage:
+			SIM_INCR(rejected);
+			if (conf.verbose) {
+				fprintf(stderr, "%s: registration rejected: %s\n", p->name, msg->data.RegisterRejectMessage.text);
+			}
+			sim_phone_disconnect(w, p, now);
+			break;
+		case CapabilitiesReqMessage:
+			sim_sendCapabilities(p);
+			break;
+		case ButtonTemplateMessage:
+			sim_handle_buttonTemplate(p, msg);
+			break;
+		case DefineTimeDate:
+			if (p->state == SIM_PHONE_REGISTERING) {
+				p->state = SIM_PHONE_REGISTERED;
+				SIM_INCR(registered);
+				sim_samples_add(&w->registration, now - p->connected_at);
+				sim_lastRegistration = now;
+				p->keepalive_at = now + p->keepAliveInterval * 1000;
+				p->call_at = now + (conf.callinterval ? (uint64_t)(rand() % conf.callinterval) * 1000 : 0);
+			}
+			break;
+		case KeepAliveAckMessage:
+			if (p->keepalive_sent) {
+				sim_samples_add(&w->keepalive, now - p->keepalive_sent);
+				p->keepalive_sent = 0;
+			}
+			break;
+		case CallStateMessage:
+			sim_handle_callState(w, p, msg, now);
+			break;
+		case OpenReceiveChannel:
+			sim_sendOpenReceiveChannelAck(p, msg);
+			break;
+		case StartMediaTransmission:
+			sim_sendStartMediaTransmissionAck(p, msg);
+			break;
+		case FeatureStatDynamicMessage:
+			if (letohl(msg->data.FeatureStatDynamicMessage.lel_buttonType) == SKINNY_BUTTONTYPE_BLFSPEEDDIAL) {
+				SIM_INCR(blfUpdates);
+			}
+			break;
+		case Reset:
+			sim_phone_disconnect(w, p, now);
+			break;
+		default:
+			break;
+	}
+}
+
+static void sim_phone_read(sim_worker_t *w, sim_phone_t *p, uint64_t now)
+{
+	ssize_t res = 0;
+
+	while (p->fd >= 0) {
+		res = recv(p->fd, p->rxbuf + p->rxlen, sizeof(p->rxbuf) - p->rxlen, 0);
+		if (res == 0 || (res < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+			if (conf.verbose) {
+				fprintf(stderr, "%s: connection closed by server\n", p->name);
+			}
+			sim_phone_disconnect(w, p, now);
+			return;
+		}
+		if (res < 0) {
+			return;
+		}
+		p->rxlen += res;
+		while (p->fd >= 0 && p->rxlen >= SCCP_PACKET_HEADER) {
+			const sccp_header_t *header = (const sccp_header_t *)p->rxbuf;
+			size_t len = letohl(header->length) + 8;
+			if (len < SCCP_PACKET_HEADER || len > SCCP_MAX_PACKET) {
+				fprintf(stderr, "%s: invalid packet length %zu, disconnecting\n", p->name, len);
+				sim_phone_disconnect(w, p, now);
+				return;
+			}
+			if (p->rxlen < len) {
+				break;
+			}
+			sccp_msg_t msg;
+			memset(&msg, 0, sizeof(msg));
+			memcpy(&msg, p->rxbuf, len);
+			memmove(p->rxbuf, p->rxbuf + len, p->rxlen - len);
+			p->rxlen -= len;
+			sim_handle_message(w, p, &msg, now);
+		}
+	}
+}
+
+/* ============================================================================================================= TIMERS */
+static void sim_phone_timers(sim_worker_t *w, sim_phone_t *p, uint64_t now)
+{
+	boolean_t isCaller = (p->idx % 2 == 0) && (p->idx + 1 < conf.phones);
+
+	switch (p->state) {
+		case SIM_PHONE_IDLE:
+			if (p->fd < 0 && now >= p->connect_at) {
+				sim_phone_connect(w, p, now);
+			}
+			return;
+		case SIM_PHONE_CONNECTING:
+			if (now - p->connected_at > SIM_REGISTER_TIMEOUT * 1000) {
+				sim_phone_connectFailed(w, p, now, ETIMEDOUT);
+			}
+			return;
+		case SIM_PHONE_TOKEN:
+		case SIM_PHONE_REGISTERING:
+			if (now - p->connected_at > SIM_REGISTER_TIMEOUT * 1000) {
+				fprintf(stderr, "%s: registration timed out\n", p->name);
+				sim_phone_disconnect(w, p, now);
+			}
+			return;
+		case SIM_PHONE_REGISTERED:
+			break;
+	}
+
+	if (now >= p->keepalive_at) {
+		sim_sendSimple(p, KeepAliveMessage);
+		SIM_INCR(keepalives);
+		p->keepalive_sent = now;
+		p->keepalive_at = now + p->keepAliveInterval * 1000;
+	}
+	if (!conf.callinterval) {
+		return;
+	}
+	switch (p->callstate) {
+		case SIM_CALL_NONE:
+			if (isCaller && now >= p->call_at) {
+				SIM_INCR(callsStarted);
+				p->call_at = now;
+				p->callstate = SIM_CALL_OFFHOOK;
+				sim_sendOffHook(p, 0);
+			}
+			break;
+		case SIM_CALL_OFFHOOK:
+		case SIM_CALL_DIALED:
+			if (now - p->call_at > SIM_CALLSETUP_TIMEOUT * 1000) {
+				if (conf.verbose) {
+					fprintf(stderr, "%s: call setup timed out\n", p->name);
+				}
+				SIM_INCR(callsFailed);
+				sim_sendOnHook(p);
+				p->callstate = SIM_CALL_NONE;
+				p->callReference = 0;
+				p->call_at = now + conf.callinterval * 1000;
+			}
+			break;
+		case SIM_CALL_RINGIN:
+			if (now >= p->answer_at) {
+				p->callstate = SIM_CALL_ANSWERED;
+				sim_sendOffHook(p, p->callReference);
+			}
+			break;
+		case SIM_CALL_CONNECTED:
+			if (isCaller && now >= p->hangup_at) {
+				sim_sendOnHook(p);
+			}
+			break;
+		case SIM_CALL_ANSWERED:
+		case SIM_CALL_HANGUP:
+			break;
+	}
+}
+
+static void *sim_worker_thread(void *data)
+{
+	sim_worker_t *w = data;
+	struct epoll_event events[SIM_MAX_EVENTS];
+	uint64_t nextTick = 0;
+	uint32_t i = 0;
+
+	while (!sim_stop) {
+		int n = epoll_wait(w->epfd, events, SIM_MAX_EVENTS, SIM_TICK);
+		uint64_t now = sim_now();
+		int e = 0;
+		for (e = 0; e < n; e++) {
+			sim_phone_t *p = (sim_phone_t *)events[e].data.ptr;
+			if (p->state == SIM_PHONE_CONNECTING) {
+				if (events[e].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) {
+					sim_phone_connectDone(w, p, now);
+				}
+				continue;
+			}
+			if (events[e].events & EPOLLOUT) {
+				sim_flush(p);
+			}
+			if (events[e].events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) {
+				sim_phone_read(w, p, now);
+			}
+		}
+		if (now >= nextTick) {
+			nextTick = now + SIM_TICK * 1000;
+			for (i = w->id; i < conf.phones; i += conf.threads) {
+				sim_phone_timers(w, &phones[i], now);
+			}
+		}
+	}
+
+	/* hang up and unregister cleanly, so the next run does not start with stale sessions */
+	for (i = w->id; i < conf.phones; i += conf.threads) {
+		sim_phone_t *p = &phones[i];
+		if (p->fd >= 0) {
+			if (p->callstate != SIM_CALL_NONE && p->callstate != SIM_CALL_RINGIN) {
+				sim_sendOnHook(p);
+			}
+			sim_sendSimple(p, UnregisterMessage);
+			sim_flush(p);
+			close(p->fd);
+			p->fd = -1;
+		}
+	}
+	return NULL;
+}
+
+/* ========================================================================================================== REPORTING */
+static pid_t sim_findServerPid(void)
+{
+	DIR *dir = opendir("/proc");
+	struct dirent *entry = NULL;
+	pid_t pid = 0;
+
+	if (!dir) {
+		return 0;
+	}
+	while (!pid && (entry = readdir(dir))) {
+		char path[300];
+		char comm[64] = "";
+		FILE *f = NULL;
+		if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+			continue;
+		}
+		snprintf(path, sizeof(path), "/proc/%s/comm", entry->d_name);
+		if ((f = fopen(path, "r"))) {
+			if (fgets(comm, sizeof(comm), f) && !strncmp(comm, "asterisk", 8)) {
+				pid = (pid_t)strtol(entry->d_name, NULL, 10);
+			}
+			fclose(f);
+		}
+	}
+	closedir(dir);
+	return pid;
+}
+
+/* returns utime + stime of the server process in clock ticks, or -1 */
+static long long sim_serverCpuTicks(void)
+{
+	char path[64];
+	char buf[1024];
+	FILE *f = NULL;
+	long long utime = 0;
+	long long stime = 0;
+	char *p = NULL;
+
+	if (!conf.serverpid) {
+		return -1;
+	}
+	snprintf(path, sizeof(path), "/proc/%d/stat", (int)conf.serverpid);
+	if (!(f = fopen(path, "r"))) {
+		return -1;
+	}
+	if (!fgets(buf, sizeof(buf), f)) {
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+	/* skip "pid (comm)", comm might contain spaces; utime and stime are fields 14 and 15 */
+	if (!(p = strrchr(buf, ')')) || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lld %lld", &utime, &stime) != 2) {
+		return -1;
+	}
+	return utime + stime;
+}
+
+static void sim_merge(sim_samples_t *dst, sim_samples_t *src)
+{
+	size_t i = 0;
+	for (i = 0; i < src->count; i++) {
+		sim_samples_add(dst, src->samples[i]);
+	}
+}
+
+static void sim_printLatency(const char *name, sim_samples_t *s)
+{
+	if (!s->count) {
+		printf("  %-22s %8s\n", name, "-");
+		return;
+	}
+	qsort(s->samples, s->count, sizeof(uint32_t), sim_samples_cmp);
+	printf("  %-22s %8zu %10.2f %10.2f %10.2f %10.2f %10.2f\n", name, s->count,
+	       s->samples[s->count * 50 / 100] / 1000.0, s->samples[s->count * 90 / 100] / 1000.0,
+	       s->samples[s->count * 99 / 100] / 1000.0, s->samples[(s->count * 999) / 1000] / 1000.0,
+	       s->samples[s->count - 1] / 1000.0);
+}
+
+static void sim_report(uint64_t elapsed, long long cpuTicks)
+{
+	sim_samples_t registration = {0}, callsetup = {0}, ring = {0}, keepalive = {0};
+	uint32_t i = 0;
+	double seconds = elapsed / 1000000.0;
+
+	for (i = 0; i < conf.threads; i++) {
+		sim_merge(&registration, &workers[i].registration);
+		sim_merge(&callsetup, &workers[i].callsetup);
+		sim_merge(&ring, &workers[i].ring);
+		sim_merge(&keepalive, &workers[i].keepalive);
+	}
+
+	printf("\n=== sccp_loadtest results (%u phones, %u threads, %.1f sec) ===\n", conf.phones, conf.threads, seconds);
+	printf("Connections      : %d connects, %d failed, %d disconnects\n", stats.connects, stats.connectFailures, stats.disconnects);
+	printf("Registrations    : %zu completed, %d rejected, %d still registered", registration.count, stats.rejected, stats.registered);
+	if (sim_lastRegistration > sim_start && registration.count) {
+		printf(", %.1f reg/sec", registration.count / ((sim_lastRegistration - sim_start) / 1000000.0));
+	}
+	printf("\n");
+	if (conf.token) {
+		printf("Tokens           : %d acknowledged, %d rejected\n", stats.tokenAcks, stats.tokenRejects);
+	}
+	printf("Calls            : %d started, %d connected, %d completed, %d failed, %.1f calls/sec\n", stats.callsStarted, stats.callsConnected, stats.callsCompleted, stats.callsFailed, stats.callsConnected / seconds);
+	printf("BLF updates      : %d\n", stats.blfUpdates);
+	printf("Messages         : %d sent (%.0f/sec), %d received (%.0f/sec), %d keepalives\n", stats.messagesOut, stats.messagesOut / seconds, stats.messagesIn, stats.messagesIn / seconds, stats.keepalives);
+	if (cpuTicks >= 0) {
+		double cpu = (double)cpuTicks / sysconf(_SC_CLK_TCK);
+		printf("Server CPU       : pid %d, %.2f sec cpu, %.1f%% of one core\n", (int)conf.serverpid, cpu, cpu * 100.0 / seconds);
+	} else {
+		printf("Server CPU       : unavailable (use -P <pid>)\n");
+	}
+	printf("\nLatency (ms)           %8s %10s %10s %10s %10s %10s\n", "count", "p50", "p90", "p99", "p99.9", "max");
+	sim_printLatency("registration", &registration);
+	sim_printLatency("call setup", &callsetup);
+	sim_printLatency("ring (dial->ringin)", &ring);
+	sim_printLatency("keepalive rtt", &keepalive);
+	printf("\n");
+
+	free(registration.samples);
+	free(callsetup.samples);
+	free(ring.samples);
+	free(keepalive.samples);
+}
+
+/* ========================================================================================================== GENCONFIG */
+static void sim_generateConfig(void)
+{
+	uint32_t i = 0;
+	uint32_t b = 0;
+
+	printf(";\n; sccp.conf snippet generated by sccp_loadtest (%u phones)\n;\n", conf.phones);
+	for (i = 0; i < conf.phones; i++) {
+		printf("[SEP%012X]\n", conf.macbase + i);
+		printf("type = device\n");
+		printf("devicetype = 7970\n");
+		printf("description = loadtest %u\n", i);
+		printf("button = line, %u\n", conf.extbase + i);
+		for (b = 1; b <= conf.blf && b < conf.phones; b++) {
+			uint32_t target = conf.extbase + (i + b) % conf.phones;
+			printf("button = speeddial,BLF %u, %u, %u@sccp-loadtest\n", target, target, target);
+		}
+		printf("\n[%u]\n", conf.extbase + i);
+		printf("type = line\n");
+		printf("id = %u\n", conf.extbase + i);
+		printf("label = %u\n", conf.extbase + i);
+		printf("cid_num = %u\n", conf.extbase + i);
+		printf("cid_name = Loadtest %u\n", i);
+		printf("context = sccp-loadtest\n");
+		printf("incominglimit = 2\n\n");
+	}
+	printf(";\n; extensions.conf snippet\n;\n[sccp-loadtest]\n");
+	for (i = 0; i < conf.phones; i++) {
+		printf("exten => %u,hint,SCCP/%u\n", conf.extbase + i, conf.extbase + i);
+	}
+	printf("exten => _X.,1,Dial(SCCP/${EXTEN},30)\n");
+	printf(" same => n,Hangup()\n");
+}
+
+/* =============================================================================================================== MAIN */
+static void sim_usage(const char *prog)
+{
+	printf("Usage: %s [options]\n", prog);
+	printf("  -s <host>      server address (default: %s)\n", conf.host);
+	printf("  -p <port>      server port (default: %s)\n", conf.port);
+	printf("  -n <phones>    number of simulated phones (default: %u)\n", conf.phones);
+	printf("  -m <hex>       first mac address, phones are named SEP<mac+n> (default: %X)\n", conf.macbase);
+	printf("  -e <exten>     first extension, phone n owns line <exten+n> (default: %u)\n", conf.extbase);
+	printf("  -t <threads>   worker threads (default: %u)\n", conf.threads);
+	printf("  -r <rate>      new registrations per second, 0 = all at once (default: %u)\n", conf.rate);
+	printf("  -d <seconds>   test duration (default: %u)\n", conf.duration);
+	printf("  -c <ms>        interval between calls per caller, 0 = no calls (default: %u)\n", conf.callinterval);
+	printf("  -H <ms>        call hold time (default: %u)\n", conf.holdtime);
+	printf("  -a <ms>        answer delay (default: %u)\n", conf.answerdelay);
+	printf("  -k <ms>        keepalive interval, 0 = as requested by server (default: %u)\n", conf.keepalive);
+	printf("  -b <count>     blf speeddials per phone, used by -g (default: %u)\n", conf.blf);
+	printf("  -T             start with a token request\n");
+	printf("  -P <pid>       server pid for cpu accounting (default: first 'asterisk' process)\n");
+	printf("  -g             print matching sccp.conf / extensions.conf snippets and exit\n");
+	printf("  -v             verbose\n");
+}
+
+static void sim_signal(int sig)
+{
+	sim_stop = 1;
+}
+
+int main(int argc, char *argv[])
+{
+	struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+	boolean_t genconf = FALSE;
+	uint64_t now = 0;
+	uint64_t end = 0;
+	long long cpuStart = -1;
+	long long cpuEnd = -1;
+	uint32_t i = 0;
+	int opt = 0;
+	int res = 0;
+
+	while ((opt = getopt(argc, argv, "s:p:n:m:e:t:r:d:c:H:a:k:b:TP:gvh")) != -1) {
+		switch (opt) {
+			case 's': conf.host = optarg; break;
+			case 'p': conf.port = optarg; break;
+			case 'n': conf.phones = strtoul(optarg, NULL, 10); break;
+			case 'm': conf.macbase = strtoul(optarg, NULL, 16); break;
+			case 'e': conf.extbase = strtoul(optarg, NULL, 10); break;
+			case 't': conf.threads = strtoul(optarg, NULL, 10); break;
+			case 'r': conf.rate = strtoul(optarg, NULL, 10); break;
+			case 'd': conf.duration = strtoul(optarg, NULL, 10); break;
+			case 'c': conf.callinterval = strtoul(optarg, NULL, 10); break;
+			case 'H': conf.holdtime = strtoul(optarg, NULL, 10); break;
+			case 'a': conf.answerdelay = strtoul(optarg, NULL, 10); break;
+			case 'k': conf.keepalive = strtoul(optarg, NULL, 10); break;
+			case 'b': conf.blf = strtoul(optarg, NULL, 10); break;
+			case 'T': conf.token = TRUE; break;
+			case 'P': conf.serverpid = (pid_t)strtol(optarg, NULL, 10); break;
+			case 'g': genconf = TRUE; break;
+			case 'v': conf.verbose++; break;
+			case 'h':
+			default:
+				sim_usage(argv[0]);
+				return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (!conf.phones || !conf.threads) {
+		sim_usage(argv[0]);
+		return 1;
+	}
+	if (genconf) {
+		sim_generateConfig();
+		return 0;
+	}
+	if ((res = getaddrinfo(conf.host, conf.port, &hints, &serveraddr)) != 0) {
+		fprintf(stderr, "Could not resolve %s:%s: %s\n", conf.host, conf.port, gai_strerror(res));
+		return 1;
+	}
+	if (conf.threads > conf.phones) {
+		conf.threads = conf.phones;
+	}
+	if (!conf.serverpid) {
+		conf.serverpid = sim_findServerPid();
+	}
+	if (!(phones = calloc(conf.phones, sizeof(sim_phone_t))) || !(workers = calloc(conf.threads, sizeof(sim_worker_t)))) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+	signal(SIGINT, sim_signal);
+	signal(SIGTERM, sim_signal);
+	signal(SIGPIPE, SIG_IGN);
+	srand((unsigned int)time(NULL));
+
+	sim_start = now = sim_now();
+	for (i = 0; i < conf.phones; i++) {
+		sim_phone_t *p = &phones[i];
+		p->fd = -1;
+		p->idx = i;
+		snprintf(p->name, sizeof(p->name), "SEP%012X", conf.macbase + i);
+		p->connect_at = now + (conf.rate ? (uint64_t)i * 1000000 / conf.rate : 0);
+	}
+	printf("Starting %u phones against %s:%s using %u threads, %u registrations/sec, duration %u sec\n", conf.phones, conf.host, conf.port, conf.threads, conf.rate, conf.duration);
+	cpuStart = sim_serverCpuTicks();
+	for (i = 0; i < conf.threads; i++) {
+		workers[i].id = i;
+		if ((workers[i].epfd = epoll_create1(0)) < 0 || pthread_create(&workers[i].thread, NULL, sim_worker_thread, &workers[i])) {
+			fprintf(stderr, "Could not start worker %u: %s\n", i, strerror(errno));
+			sim_stop = 1;
+			conf.threads = i;
+			break;
+		}
+	}
+
+	end = now + (uint64_t)conf.duration * 1000000;
+	while (!sim_stop && (now = sim_now()) < end) {
+		sleep(1);
+		if (conf.verbose || isatty(STDOUT_FILENO)) {
+			printf("\r[%4llu s] registered: %6d, calls connected: %6d, failed: %4d, blf: %7d, msgs in/out: %8d/%8d ",
+			       (unsigned long long)((now - sim_start) / 1000000), stats.registered, stats.callsConnected, stats.callsFailed,
+			       stats.blfUpdates, stats.messagesIn, stats.messagesOut);
+			fflush(stdout);
+		}
+	}
+	cpuEnd = sim_serverCpuTicks();
+	now = sim_now();
+	sim_stop = 1;
+	for (i = 0; i < conf.threads; i++) {
+		pthread_join(workers[i].thread, NULL);
+		close(workers[i].epfd);
+	}
+
+	sim_report(now - sim_start, (cpuStart >= 0 && cpuEnd >= 0) ? cpuEnd - cpuStart : -1);
+
+	for (i = 0; i < conf.threads; i++) {
+		free(workers[i].registration.samples);
+		free(workers[i].callsetup.samples);
+		free(workers[i].ring.samples);
+		free(workers[i].keepalive.samples);
+	}
+	free(workers);
+	free(phones);
+	freeaddrinfo(serveraddr);
+	return 0;
+}
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
@@ -0,0 +1,105 @@
+/*!
+ * \file	sccp_loadtest.h
+ * \brief	SCCP Phone Simulator / Load Generator Header
+ * \note	This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *		See the LICENSE file at the top of the source tree.
+ *
+ * Pulls in the message definitions from sccp_protocol.h without dragging in the asterisk headers, so the simulator
+ * always speaks exactly the same wire format as the channel driver it is testing.
+ */
+#pragma once
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "define.h"
+#include "forward_declarations.h"
+#include "sccp_dllists.h"
+#include "sccp_enum.h"
+#include "sccp_protocol.h"
+
+/* define.h redirects snprintf to pbx_log in maintainer mode, we are not running inside asterisk */
+#ifdef __snprintf
+#undef snprintf
+#endif
+
+#define SIM_PROTOCOL_VERSION		17							/*!< All message layouts below use the v17 variants */
+#define SIM_DEVICETYPE			SKINNY_DEVICETYPE_CISCO7970
+#define SIM_MAX_BUTTONS			StationMaxButtonTemplateSize
+#define SIM_RECONNECT_DELAY		5000							/*!< ms */
+#define SIM_REGISTER_TIMEOUT		30000							/*!< ms */
+#define SIM_CALLSETUP_TIMEOUT		10000							/*!< ms */
+#define SIM_TICK			10							/*!< ms between timer scans */
+#define SIM_MAX_EVENTS			256
+#define SIM_TXBUF_SIZE			(SCCP_MAX_PACKET * 4)					/*!< unsent data queued per phone, disconnect when exceeded */
+
+typedef enum {
+	SIM_PHONE_IDLE,
+	SIM_PHONE_CONNECTING,										/*!< non-blocking connect in progress, waiting for EPOLLOUT */
+	SIM_PHONE_TOKEN,
+	SIM_PHONE_REGISTERING,
+	SIM_PHONE_REGISTERED,
+} sim_phonestate_t;
+
+typedef enum {
+	SIM_CALL_NONE,
+	SIM_CALL_OFFHOOK,										/*!< caller: offhook sent, waiting for callreference */
+	SIM_CALL_DIALED,										/*!< caller: number sent, waiting for connected */
+	SIM_CALL_RINGIN,										/*!< callee: ringing, answer pending */
+	SIM_CALL_ANSWERED,										/*!< callee: offhook sent */
+	SIM_CALL_CONNECTED,
+	SIM_CALL_HANGUP,										/*!< onhook sent, waiting for onhook callstate */
+} sim_callstate_t;
+
+typedef struct {
+	uint32_t *samples;
+	size_t count;
+	size_t size;
+} sim_samples_t;
+
+typedef struct sim_phone {
+	int fd;
+	int epfd;											/*!< epoll instance of the owning worker */
+	uint32_t idx;
+	char name[StationMaxDeviceNameSize];
+	sim_phonestate_t state;
+	sim_callstate_t callstate;
+	uint32_t callReference;
+	uint32_t keepAliveInterval;									/*!< ms */
+	uint64_t connect_at;										/*!< usec timestamps (CLOCK_MONOTONIC) */
+	uint64_t connected_at;										/*!< connect started, reset when the connection is established */
+	uint64_t keepalive_at;
+	uint64_t keepalive_sent;
+	uint64_t call_at;
+	uint64_t dialed_at;										/*!< read by the callee's worker to measure ring latency */
+	uint64_t answer_at;
+	uint64_t hangup_at;
+	uint8_t lineInstances[SIM_MAX_BUTTONS];
+	uint8_t speeddialInstances[SIM_MAX_BUTTONS];
+	uint8_t blfInstances[SIM_MAX_BUTTONS];
+	uint8_t numLines;
+	uint8_t numSpeeddials;
+	uint8_t numBLF;
+	boolean_t templateRequested;
+	boolean_t wantWrite;										/*!< EPOLLOUT armed */
+	size_t rxlen;
+	uint8_t rxbuf[SCCP_MAX_PACKET * 2];
+	size_t txlen;
+	uint8_t txbuf[SIM_TXBUF_SIZE];
+} sim_phone_t;
+
+typedef struct sim_worker {
+	pthread_t thread;
+	int id;
+	int epfd;
+	sim_samples_t registration;
+	sim_samples_t callsetup;
+	sim_samples_t ring;
+	sim_samples_t keepalive;
+} sim_worker_t;
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
@@ -17,6 +17,8 @@
 #include "config.h"
 #include "common.h"
 #include "chan_sccp.h"
+#include "sccp_capture.h"
+#include "sccp_callstats.h"
 #include "sccp_channel.h"
 #include "sccp_config.h"
 #include "sccp_device.h"
@@ -126,6 +128,8 @@ boolean_t sccp_prePBXLoad(void)
 #endif
 	sccp_hint_module_start();
 	sccp_manager_module_start();
+	sccp_capture_module_start();
+	sccp_callstats_module_start();
 #ifdef CS_SCCP_CONFERENCE
 	sccp_conference_module_start();
 #endif
@@ -307,6 +311,8 @@ int sccp_preUnload(void)
 
 	/* stop services */
 	sccp_session_terminateAll();
+	sccp_callstats_module_stop();
+	sccp_capture_module_stop();
 	sccp_manager_module_stop();
 #ifdef CS_DEVSTATE_FEATURE	
 	sccp_devstate_module_stop();
@@ -317,6 +323,8 @@ int sccp_preUnload(void)
 	sccp_softkey_clear();
 	sccp_threadpool_destroy(GLOB(general_threadpool));
 	sccp_refcount_destroy();
+	GLOB(trace) = 0;
+	sccp_trace_module_stop();
 
 	/* free resources */
 	if (GLOB(config_file_name)) {
@@ -59,6 +59,7 @@
 #include "sccp_event.h"
 #include "sccp_feature.h"
 #include "pbx_impl/pbx_impl.h"
+#include "sccp_lockprofile.h"
 #include "sccp_callinfo.h"
 
 // kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
@@ -54,6 +54,7 @@ typedef struct sccp_feature_configuration sccp_featureConfiguration_t;
 typedef struct sccp_selectedchannel sccp_selectedchannel_t;                                                   //!< SCCP Selected Channel Structure
 typedef struct sccp_ast_channel_name sccp_ast_channel_name_t;                                                 //!< SCCP Asterisk Channel Name Structure
 typedef struct sccp_buttonconfig sccp_buttonconfig_t;                                                         //!< SCCP Button Config Structure
+typedef struct sccp_buttonindex sccp_buttonindex_t;                                                           //!< SCCP Button Instance Lookup Tables
 typedef struct sccp_hotline sccp_hotline_t;                                                                   //!< SCCP Hotline Structure
 typedef struct sccp_callinfo sccp_callinfo_t;                                                                 //!< SCCP Call Information Structure
 typedef struct sccp_call_statistics sccp_call_statistics_t;                                                   //!< SCCP Call Statistic Structure
@@ -140,6 +140,11 @@
 
 #define pbx_bridge_destroy(_x, _y) ast_bridge_destroy((_x))
 #define pbx_bridge_features_cleanup ast_bridge_features_cleanup
+#if ASTERISK_VERSION_GROUP >= 112
+#define pbx_bridge_features_new ast_bridge_features_new
+#define pbx_bridge_features_destroy ast_bridge_features_destroy
+#define pbx_bridge_leave_hook ast_bridge_leave_hook
+#endif
 #define pbx_bridge_change_state ast_bridge_change_state
 #define pbx_bridge_lock ast_bridge_lock
 #define pbx_bridge_unlock ast_bridge_unlock
@@ -280,6 +285,15 @@ typedef struct pbx_event_sub pbx_event_subscription_t;
 #define pbx_rwlock_tryrdlock(_x) {ast_debug(5, "[%d] %s:%d (%s) RWLOCK_TRYRDLOCK: " #_x ": %p\n", (unsigned int) pthread_self(), __FILE__, __LINE__, __PRETTY_FUNCTION__, (_x)); ast_rwlock_tryrdlock((ast_rwlock_t *)(_x));}
 #define pbx_rwlock_trywrlock(_x) {ast_debug(5, "[%d] %s:%d (%s) RWLOCK_TRYWRLOCK: " #_x ": %p\n", (unsigned int) pthread_self(), __FILE__, __LINE__, __PRETTY_FUNCTION__, (_x)); ast_rwlock_trywrlock((ast_rwlock_t *)(_x));}
 #define pbx_rwlock_unlock(_x) {ast_rwlock_unlock((ast_rwlock_t *)(_x)); ast_debug(5, "[%d] %s:%d (%s) RWLOCK_UNLOCK: " #_x ": %p\n", (unsigned int) pthread_self(), __FILE__, __LINE__, __PRETTY_FUNCTION__, (_x));}
+#elif CS_LOCK_PROFILE
+#define pbx_mutex_lock(_x) ({sccp_lockprofile_lock(SCCP_LOCKPROFILE_MUTEX, (void *)(_x), __FILE__, __LINE__, __PRETTY_FUNCTION__, #_x);})
+#define pbx_mutex_trylock(_x) ({sccp_lockprofile_trylock(SCCP_LOCKPROFILE_MUTEX, (void *)(_x), __FILE__, __LINE__, __PRETTY_FUNCTION__, #_x);})
+#define pbx_mutex_unlock(_x) ({sccp_lockprofile_unlock(SCCP_LOCKPROFILE_MUTEX, (void *)(_x));})
+#define pbx_rwlock_rdlock(_x) ({sccp_lockprofile_lock(SCCP_LOCKPROFILE_RDLOCK, (void *)(_x), __FILE__, __LINE__, __PRETTY_FUNCTION__, #_x);})
+#define pbx_rwlock_wrlock(_x) ({sccp_lockprofile_lock(SCCP_LOCKPROFILE_WRLOCK, (void *)(_x), __FILE__, __LINE__, __PRETTY_FUNCTION__, #_x);})
+#define pbx_rwlock_tryrdlock(_x) ({sccp_lockprofile_trylock(SCCP_LOCKPROFILE_RDLOCK, (void *)(_x), __FILE__, __LINE__, __PRETTY_FUNCTION__, #_x);})
+#define pbx_rwlock_trywrlock(_x) ({sccp_lockprofile_trylock(SCCP_LOCKPROFILE_WRLOCK, (void *)(_x), __FILE__, __LINE__, __PRETTY_FUNCTION__, #_x);})
+#define pbx_rwlock_unlock(_x) ({sccp_lockprofile_unlock(SCCP_LOCKPROFILE_RDLOCK, (void *)(_x));})
 #else
 #define pbx_mutex_lock(_x) ({ast_mutex_lock((ast_mutex_t *)(_x));})
 #define pbx_mutex_trylock(_x) ({ast_mutex_trylock((ast_mutex_t *)(_x));})
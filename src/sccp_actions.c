@@ -31,6 +31,8 @@ SCCP_FILE_VERSION(__FILE__, "");
 #include "sccp_labels.h"
 #include "sccp_devstate.h"
 #include "sccp_featureParkingLot.h"
+#include "sccp_atomic.h"
+#include "sccp_callstats.h"
 
 /*!
  * \remarks
@@ -211,6 +213,168 @@ static const struct messageMap_cb spcpMessagesCbMap[SPCP_MESSAGE_HIGH_BOUNDARY +
 	//[UnknownVGMessage - SPCP_MESSAGE_OFFSET] = {NULL, FALSE},
 };
 
+/*!
+ * \brief Per Message-Id Statistics
+ *
+ * Counters and log2(usec) latency histograms, collected when message_stats=yes. Inbound entries measure the time spent
+ * in the message handler, outbound entries the time between entering sccp_session_send2 and the write completing
+ * (including the wait for the session write_lock). Updates are done using atomics, readers may see slightly skewed values.
+ */
+#define SCCP_MESSAGESTAT_BUCKETS 20										/* 1usec .. 2^19usec (~0.5sec) and above */
+#define SCCP_MESSAGESTAT_ENTRIES (SCCP_MESSAGE_HIGH_BOUNDARY + 1 + SPCP_MESSAGE_HIGH_BOUNDARY + 1 - SPCP_MESSAGE_OFFSET)
+
+typedef struct {
+	volatile CAS32_TYPE count;
+	volatile CAS32_TYPE usec_max;
+	volatile size_t usec_total;
+	volatile CAS32_TYPE buckets[SCCP_MESSAGESTAT_BUCKETS];
+} sccp_messagestat_t;
+
+static struct {
+	sccp_messagestat_t in;
+	sccp_messagestat_t out;
+} messagestats[SCCP_MESSAGESTAT_ENTRIES];
+
+AST_MUTEX_DEFINE_STATIC(messagestats_lock);
+
+static inline int messagestat_mid2idx(const sccp_mid_t mid)
+{
+	if (mid <= SCCP_MESSAGE_HIGH_BOUNDARY) {
+		return mid;
+	}
+	if (mid >= SPCP_MESSAGE_LOW_BOUNDARY && mid <= SPCP_MESSAGE_HIGH_BOUNDARY) {
+		return SCCP_MESSAGE_HIGH_BOUNDARY + 1 + (mid - SPCP_MESSAGE_OFFSET);
+	}
+	return -1;
+}
+
+static inline sccp_mid_t messagestat_idx2mid(const int idx)
+{
+	if (idx <= SCCP_MESSAGE_HIGH_BOUNDARY) {
+		return idx;
+	}
+	return idx - (SCCP_MESSAGE_HIGH_BOUNDARY + 1) + SPCP_MESSAGE_OFFSET;
+}
+
+static void messagestat_record(sccp_messagestat_t * const stat, const struct timeval *start)
+{
+	struct timeval delta = ast_tvsub(pbx_tvnow(), *start);
+	uint64_t usec = (uint64_t)delta.tv_sec * 1000000 + delta.tv_usec;
+	int usec32 = usec > INT32_MAX ? INT32_MAX : (int)usec;
+	uint8_t bucket = 0;
+
+	while ((usec >> (bucket + 1)) && bucket < SCCP_MESSAGESTAT_BUCKETS - 1) {
+		bucket++;
+	}
+	ATOMIC_INCR(&stat->count, 1, &messagestats_lock);
+	ATOMIC_INCR(&stat->buckets[bucket], 1, &messagestats_lock);
+	ATOMIC_INCR(&stat->usec_total, usec, &messagestats_lock);
+
+	int curmax = 0;
+	do {
+		curmax = stat->usec_max;
+		if (usec32 <= curmax) {
+			break;
+		}
+	} while (CAS32(&stat->usec_max, curmax, usec32, &messagestats_lock) != curmax);
+}
+
+/*!
+ * \brief Record the time it took to send a message (called by sccp_session_send2)
+ * \param mid Message Id
+ * \param start Time at which the send was requested
+ */
+void sccp_messagestat_recordOutbound(sccp_mid_t mid, const struct timeval *start)
+{
+	int idx = messagestat_mid2idx(mid);
+	if (idx >= 0) {
+		messagestat_record(&messagestats[idx].out, start);
+	}
+}
+
+/* upper bound of the histogram bucket containing the requested percentile */
+static int messagestat_percentile(const sccp_messagestat_t * const stat, const int percent)
+{
+	int threshold = (int)(((int64_t)stat->count * percent + 99) / 100);
+	int cumulative = 0;
+	uint8_t bucket = 0;
+
+	if (!stat->count) {
+		return 0;
+	}
+	for (bucket = 0; bucket < SCCP_MESSAGESTAT_BUCKETS - 1; bucket++) {
+		cumulative += stat->buckets[bucket];
+		if (cumulative >= threshold) {
+			return 1 << (bucket + 1);
+		}
+	}
+	return stat->usec_max;
+}
+
+static inline int messagestat_average(const sccp_messagestat_t * const stat)
+{
+	return stat->count ? (int)(stat->usec_total / stat->count) : 0;
+}
+
+/*!
+ * \brief Show Per Message-Id Statistics
+ * \param fd Fd as int
+ * \param totals Total number of lines as int
+ * \param s AMI Session
+ * \param m Message
+ * \param argc Argc as int
+ * \param argv[] Argv[] as char
+ * \return Result as int
+ *
+ * \called_from_asterisk
+ */
+int sccp_show_message_stats(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[])
+{
+	int local_line_total = 0;
+	int idx = 0;
+
+	if (argc == 5 && sccp_strcaseequals(argv[4], "reset")) {
+		memset(messagestats, 0, sizeof(messagestats));
+		CLI_AMI_OUTPUT(fd, s, "Message statistics have been reset\n");
+		if (s) {
+			totals->lines = local_line_total;
+		}
+		return RESULT_SUCCESS;
+	}
+	if (!s && !GLOB(message_stats)) {
+		CLI_AMI_OUTPUT(fd, s, "Note: message_stats is disabled in sccp.conf, counters are not being updated\n");
+	}
+
+#define CLI_AMI_TABLE_NAME MessageStats
+#define CLI_AMI_TABLE_PER_ENTRY_NAME Message
+#define CLI_AMI_TABLE_ITERATOR for (idx = 0; idx < SCCP_MESSAGESTAT_ENTRIES; idx++)
+#define CLI_AMI_TABLE_BEFORE_ITERATION											\
+		if (messagestats[idx].in.count || messagestats[idx].out.count) {					\
+			sccp_mid_t mid = messagestat_idx2mid(idx);							\
+			const char *name = msginfo2str(mid);
+#define CLI_AMI_TABLE_AFTER_ITERATION 											\
+		}
+#define CLI_AMI_TABLE_FIELDS 												\
+		CLI_AMI_TABLE_FIELD(Id,			"-6.6",		X,	6,	mid)				\
+		CLI_AMI_TABLE_FIELD(Message,		"-40.40",	s,	40,	name ? name : "unknown")	\
+		CLI_AMI_TABLE_FIELD(In,			"8",		d,	8,	messagestats[idx].in.count)	\
+		CLI_AMI_TABLE_FIELD(InAvg,		"8",		d,	8,	messagestat_average(&messagestats[idx].in))	\
+		CLI_AMI_TABLE_FIELD(InP50,		"8",		d,	8,	messagestat_percentile(&messagestats[idx].in, 50))	\
+		CLI_AMI_TABLE_FIELD(InP99,		"8",		d,	8,	messagestat_percentile(&messagestats[idx].in, 99))	\
+		CLI_AMI_TABLE_FIELD(InMax,		"8",		d,	8,	messagestats[idx].in.usec_max)	\
+		CLI_AMI_TABLE_FIELD(Out,		"8",		d,	8,	messagestats[idx].out.count)	\
+		CLI_AMI_TABLE_FIELD(OutAvg,		"8",		d,	8,	messagestat_average(&messagestats[idx].out))	\
+		CLI_AMI_TABLE_FIELD(OutP99,		"8",		d,	8,	messagestat_percentile(&messagestats[idx].out, 99))	\
+		CLI_AMI_TABLE_FIELD(OutMax,		"8",		d,	8,	messagestats[idx].out.usec_max)
+#include "sccp_cli_table.h"
+
+	if (s) {
+		totals->lines = local_line_total;
+		totals->tables = 1;
+	}
+	return RESULT_SUCCESS;
+}
+
 /*!
  * \brief       Controller function to handle Received Messages
  * \param       msg Message as sccp_msg_t
@@ -252,7 +416,13 @@ int sccp_handle_message(constMessagePtr msg, constSessionPtr s)
 		return -3;
 	}
 	if (messageMap_cb->messageHandler_cb) {
-		messageMap_cb->messageHandler_cb(s, device, msg);
+		if (GLOB(message_stats)) {
+			struct timeval start = pbx_tvnow();
+			messageMap_cb->messageHandler_cb(s, device, msg);
+			messagestat_record(&messagestats[messagestat_mid2idx(mid)].in, &start);
+		} else {
+			messageMap_cb->messageHandler_cb(s, device, msg);
+		}
 	}
 
 	if (device && sccp_device_getRegistrationState(device) == SKINNY_DEVICE_RS_PROGRESS && mid == device->protocol->registrationFinishedMessageId) {
@@ -1503,6 +1673,9 @@ void sccp_handle_button_template_req(constSessionPtr s, devicePtr d, constMessag
 	}
 	/* done */
 
+	/* all instances are assigned now, build the button lookup tables */
+	sccp_dev_build_buttonindex(d);
+
 	sccp_dev_send(d, msg_out);
 }
 
@@ -2082,9 +2255,11 @@ static void handle_stimulus_groupcallpickup(constDevicePtr d, constLinePtr l, co
  *
  * \warning
  *   - device->buttonconfig is not always locked
+ * \note the button index reference keeps the feature buttonconfig alive until the end of the function
  */
 static void handle_feature_action(constDevicePtr d, const int instance, const boolean_t toggleState)
 {
+	sccp_buttonindex_t *idx = NULL;
 	sccp_buttonconfig_t *config = NULL;
 	sccp_cfwd_t status = SCCP_CFWD_NONE; /* state of cfwd */
 
@@ -2094,18 +2269,10 @@ static void handle_feature_action(constDevicePtr d, const int instance, const bo
 
 	sccp_log((DEBUGCAT_FEATURE_BUTTON + DEBUGCAT_FEATURE)) (VERBOSE_PREFIX_3 "%s: instance: %d, toggle: %s\n", d->id, instance, (toggleState) ? "yes" : "no");
 
-	SCCP_LIST_TRAVERSE(&d->buttonconfig, config, list) {
-		if (config->instance == instance && config->type == FEATURE) {
-			// sccp_log((DEBUGCAT_FEATURE_BUTTON + DEBUGCAT_FEATURE)) (VERBOSE_PREFIX_3 "%s: toggle status from %d\n", d->id, config->button.feature.status);
-			// config->button.feature.status = (config->button.feature.status == 0) ? 1 : 0;
-			// sccp_log((DEBUGCAT_FEATURE_BUTTON + DEBUGCAT_FEATURE)) (VERBOSE_PREFIX_3 " to %d\n", config->button.feature.status);
-			break;
-		}
-
-	}
-
-	if (!config || !config->type || config->type != FEATURE) {
+	idx = sccp_buttonindex_retain(d);
+	if (!(config = sccp_dev_feature_find_byindex(idx, instance))) {
 		pbx_log(LOG_WARNING, "%s: Couldn find feature with ID = %d \n", d->id, instance);
+		sccp_buttonindex_release(idx);
 		return;
 	}
 
@@ -2220,6 +2387,7 @@ static void handle_feature_action(constDevicePtr d, const int instance, const bo
 			if (TRUE == toggleState) {
 				enum ast_device_state newDeviceState = sccp_devstate_getNextDeviceState(d, config);
 				pbx_devstate_changed(newDeviceState, "Custom:%s", config->button.feature.options);
+				sccp_buttonindex_release(idx);
 				return;
 			}
 			break;
@@ -2266,6 +2434,7 @@ static void handle_feature_action(constDevicePtr d, const int instance, const bo
 		//sccp_log((DEBUGCAT_FEATURE_BUTTON + DEBUGCAT_FEATURE)) (VERBOSE_PREFIX_3 "%s: Got Feature Status Request.  Index = %d Status: %d\n", d->id, instance, config->button.feature.status);
 		sccp_feat_changed(d, NULL, config->button.feature.id);
 	}
+	sccp_buttonindex_release(idx);
 }
 
 /*!
@@ -3762,129 +3931,59 @@ void handle_version(constSessionPtr s, devicePtr d, constMessagePtr msg_in)
  */
 void handle_ConnectionStatistics(constSessionPtr s, devicePtr device, constMessagePtr msg_in)
 {
-#define CALC_AVG(_newval, _mean, _numval) ( ( ((_mean) * (_numval) ) + (_newval) ) / ((_numval) + 1))
-
-	size_t buffersize = 2048;
-	struct ast_str *output_buf = pbx_str_alloca(buffersize);
-	char QualityStats[600] = "";
+	sccp_callstats_sample_t sample = { 0 };
 	uint32_t QualityStatsSize = 0;
-
-	AUTO_RELEASE(sccp_device_t, d , sccp_device_retain(device));
-
-	if (d) {
-		// update last_call_statistics
-		sccp_call_statistics_t *call_stats = d->call_statistics;
-
-		if (letohl(msg_in->header.lel_protocolVer < 20)) {
-			call_stats[SCCP_CALLSTATISTIC_LAST].num = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_CallIdentifier);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_sent = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_SentPackets);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_received = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_RecvdPackets);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_lost = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_LostPkts);
-			call_stats[SCCP_CALLSTATISTIC_LAST].jitter = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_Jitter);
-			call_stats[SCCP_CALLSTATISTIC_LAST].latency = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_latency);
-			QualityStatsSize = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_QualityStatsSize) + 1;
-			QualityStatsSize = QualityStatsSize < sizeof(QualityStats) ? QualityStatsSize : sizeof(QualityStats);
-			if (QualityStatsSize) {
-				sccp_copy_string(QualityStats, msg_in->data.ConnectionStatisticsRes.v3.QualityStats, QualityStatsSize);
-			}
-		} else if (letohl(msg_in->header.lel_protocolVer < 22)) {
-			call_stats[SCCP_CALLSTATISTIC_LAST].num = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_CallIdentifier);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_sent = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_SentPackets);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_received = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_RecvdPackets);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_lost = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_LostPkts);
-			call_stats[SCCP_CALLSTATISTIC_LAST].jitter = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_Jitter);
-			call_stats[SCCP_CALLSTATISTIC_LAST].latency = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_latency);
-			QualityStatsSize = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_QualityStatsSize) + 1;
-			QualityStatsSize = QualityStatsSize < sizeof(QualityStats) ? QualityStatsSize : sizeof(QualityStats);
-			if (QualityStatsSize) {
-				sccp_copy_string(QualityStats, msg_in->data.ConnectionStatisticsRes.v20.QualityStats, QualityStatsSize);
-			}
-		} else {											// odd
-			// ConnectionStatisticsRes_V22 has irregular packing (single byte packing), need to access unaligned data (using get_unaligned_uint32 for sparc62 / buserror machines
+	const char *QualityStats = NULL;
+
+	// only copy the raw values, parsing, averaging and reporting is done by the callstats aggregator
+	sample.protocolVer = letohl(msg_in->header.lel_protocolVer);
+	if (sample.protocolVer < 20) {
+		sccp_copy_string(sample.directoryNumber, msg_in->data.ConnectionStatisticsRes.v3.DirectoryNumber, sizeof(sample.directoryNumber));
+		sample.callid = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_CallIdentifier);
+		sample.packets_sent = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_SentPackets);
+		sample.packets_received = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_RecvdPackets);
+		sample.packets_lost = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_LostPkts);
+		sample.jitter = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_Jitter);
+		sample.latency = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_latency);
+		QualityStatsSize = letohl(msg_in->data.ConnectionStatisticsRes.v3.lel_QualityStatsSize) + 1;
+		QualityStats = msg_in->data.ConnectionStatisticsRes.v3.QualityStats;
+	} else if (sample.protocolVer < 22) {
+		sccp_copy_string(sample.directoryNumber, msg_in->data.ConnectionStatisticsRes.v20.DirectoryNumber, sizeof(sample.directoryNumber));
+		sample.callid = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_CallIdentifier);
+		sample.packets_sent = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_SentPackets);
+		sample.packets_received = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_RecvdPackets);
+		sample.packets_lost = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_LostPkts);
+		sample.jitter = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_Jitter);
+		sample.latency = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_latency);
+		QualityStatsSize = letohl(msg_in->data.ConnectionStatisticsRes.v20.lel_QualityStatsSize) + 1;
+		QualityStats = msg_in->data.ConnectionStatisticsRes.v20.QualityStats;
+	} else {											// odd
+		sccp_copy_string(sample.directoryNumber, msg_in->data.ConnectionStatisticsRes.v22.DirectoryNumber, sizeof(sample.directoryNumber));
+		// ConnectionStatisticsRes_V22 has irregular packing (single byte packing), need to access unaligned data (using get_unaligned_uint32 for sparc62 / buserror machines
 #if defined(HAVE_UNALIGNED_BUSERROR)
-			call_stats[SCCP_CALLSTATISTIC_LAST].num = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_CallIdentifier));
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_sent = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_SentPackets));
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_received = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_RecvdPackets));
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_lost = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_LostPkts));
-			call_stats[SCCP_CALLSTATISTIC_LAST].jitter = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_Jitter));
-			call_stats[SCCP_CALLSTATISTIC_LAST].latency = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_latency));
-			QualityStatsSize = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_QualityStatsSize));
+		sample.callid = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_CallIdentifier));
+		sample.packets_sent = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_SentPackets));
+		sample.packets_received = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_RecvdPackets));
+		sample.packets_lost = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_LostPkts));
+		sample.jitter = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_Jitter));
+		sample.latency = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_latency));
+		QualityStatsSize = letohl(get_unaligned_uint32((const void *) &msg_in->data.ConnectionStatisticsRes.v22.lel_QualityStatsSize));
 #else
-			call_stats[SCCP_CALLSTATISTIC_LAST].num = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_CallIdentifier);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_sent = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_SentPackets);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_received = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_RecvdPackets);
-			call_stats[SCCP_CALLSTATISTIC_LAST].packets_lost = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_LostPkts);
-			call_stats[SCCP_CALLSTATISTIC_LAST].jitter = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_Jitter);
-			call_stats[SCCP_CALLSTATISTIC_LAST].latency = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_latency);
-			QualityStatsSize = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_QualityStatsSize) + 1;
+		sample.callid = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_CallIdentifier);
+		sample.packets_sent = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_SentPackets);
+		sample.packets_received = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_RecvdPackets);
+		sample.packets_lost = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_LostPkts);
+		sample.jitter = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_Jitter);
+		sample.latency = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_latency);
+		QualityStatsSize = letohl(msg_in->data.ConnectionStatisticsRes.v22.lel_QualityStatsSize) + 1;
 #endif
-			QualityStatsSize = QualityStatsSize < sizeof(QualityStats) ? QualityStatsSize : sizeof(QualityStats);
-			if (QualityStatsSize) {
-				sccp_copy_string(QualityStats, msg_in->data.ConnectionStatisticsRes.v22.QualityStats, QualityStatsSize);
-			}
-		}
-		pbx_str_append(&output_buf, buffersize, "%s: Call Statistics:\n", d->id);
-		pbx_str_append(&output_buf, buffersize, "       [\n");
-
-		pbx_str_append(&output_buf, buffersize, "         Last Call        : CallID: %d Packets sent: %d rcvd: %d lost: %d jitter: %d latency: %d\n", call_stats[SCCP_CALLSTATISTIC_LAST].num, call_stats[SCCP_CALLSTATISTIC_LAST].packets_sent, call_stats[SCCP_CALLSTATISTIC_LAST].packets_received, call_stats[SCCP_CALLSTATISTIC_LAST].packets_lost, call_stats[SCCP_CALLSTATISTIC_LAST].jitter, call_stats[SCCP_CALLSTATISTIC_LAST].latency);
-		sccp_log(DEBUGCAT_CORE) (VERBOSE_PREFIX_3 "QualityStats: %s\n", QualityStats);
-		if (!sccp_strlen_zero(QualityStats)) {
-			if (letohl(msg_in->header.lel_protocolVer < 20)) {
-				sscanf(QualityStats, "MLQK=%f;MLQKav=%f;MLQKmn=%f;MLQKmx=%f;MLQKvr=%f;CCR=%f;ICR=%f;ICRmx=%f;CS=%d;SCS=%d",
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].opinion_score_listening_quality, &call_stats[SCCP_CALLSTATISTIC_LAST].avg_opinion_score_listening_quality,
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].mean_opinion_score_listening_quality, &call_stats[SCCP_CALLSTATISTIC_LAST].max_opinion_score_listening_quality,
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].variance_opinion_score_listening_quality, &call_stats[SCCP_CALLSTATISTIC_LAST].cumulative_concealement_ratio, &call_stats[SCCP_CALLSTATISTIC_LAST].interval_concealement_ratio, &call_stats[SCCP_CALLSTATISTIC_LAST].max_concealement_ratio, &call_stats[SCCP_CALLSTATISTIC_LAST].concealed_seconds, &call_stats[SCCP_CALLSTATISTIC_LAST].severely_concealed_seconds);
-			} else if (letohl(msg_in->header.lel_protocolVer < 22)) {
-				int Log = 0;
-
-				sscanf(QualityStats, "Log %d: mos %f, avgMos %f, maxMos %f, minMos %f, CS %d, SCS %d, CCR %f, ICR %f, maxCR %f",
-				       &Log,
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].opinion_score_listening_quality, &call_stats[SCCP_CALLSTATISTIC_LAST].avg_opinion_score_listening_quality,
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].max_opinion_score_listening_quality, &call_stats[SCCP_CALLSTATISTIC_LAST].mean_opinion_score_listening_quality,
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].concealed_seconds, &call_stats[SCCP_CALLSTATISTIC_LAST].severely_concealed_seconds, &call_stats[SCCP_CALLSTATISTIC_LAST].cumulative_concealement_ratio, &call_stats[SCCP_CALLSTATISTIC_LAST].interval_concealement_ratio, &call_stats[SCCP_CALLSTATISTIC_LAST].max_concealement_ratio);
-			} else {
-				sscanf(QualityStats, "MLQK=%f;MLQKav=%f;MLQKmn=%f;MLQKmx=%f;ICR=%f;CCR=%f;ICRmx=%f;CS=%d;SCS=%d;MLQKvr=%f",
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].opinion_score_listening_quality, &call_stats[SCCP_CALLSTATISTIC_LAST].avg_opinion_score_listening_quality,
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].mean_opinion_score_listening_quality, &call_stats[SCCP_CALLSTATISTIC_LAST].max_opinion_score_listening_quality,
-				       &call_stats[SCCP_CALLSTATISTIC_LAST].interval_concealement_ratio, &call_stats[SCCP_CALLSTATISTIC_LAST].cumulative_concealement_ratio, &call_stats[SCCP_CALLSTATISTIC_LAST].max_concealement_ratio, &call_stats[SCCP_CALLSTATISTIC_LAST].concealed_seconds, &call_stats[SCCP_CALLSTATISTIC_LAST].severely_concealed_seconds, &call_stats[SCCP_CALLSTATISTIC_LAST].variance_opinion_score_listening_quality);
-			}
-		}
-		pbx_str_append(&output_buf, buffersize, "         Last Quality     : MLQK=%.4f;MLQKav=%.4f;MLQKmn=%.4f;MLQKmx=%.4f;MLQKvr=%.2f|ICR=%.4f;CCR=%.4f;ICRmx=%.4f|CS=%d;SCS=%d\n",
-			       call_stats[SCCP_CALLSTATISTIC_LAST].opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_LAST].avg_opinion_score_listening_quality,
-			       call_stats[SCCP_CALLSTATISTIC_LAST].mean_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_LAST].max_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_LAST].variance_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_LAST].interval_concealement_ratio, call_stats[SCCP_CALLSTATISTIC_LAST].cumulative_concealement_ratio, call_stats[SCCP_CALLSTATISTIC_LAST].max_concealement_ratio,
-			       (int) call_stats[SCCP_CALLSTATISTIC_LAST].concealed_seconds, (int) call_stats[SCCP_CALLSTATISTIC_LAST].severely_concealed_seconds);
-
-		// update avg_call_statistics
-		call_stats[SCCP_CALLSTATISTIC_AVG].packets_sent = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].packets_sent, call_stats[SCCP_CALLSTATISTIC_AVG].packets_sent, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].packets_received = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].packets_received, call_stats[SCCP_CALLSTATISTIC_AVG].packets_received, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].packets_lost = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].packets_lost, call_stats[SCCP_CALLSTATISTIC_AVG].packets_lost, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].jitter = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].jitter, call_stats[SCCP_CALLSTATISTIC_AVG].jitter, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].latency = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].latency, call_stats[SCCP_CALLSTATISTIC_AVG].latency, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].opinion_score_listening_quality = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].avg_opinion_score_listening_quality = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].avg_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].avg_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].mean_opinion_score_listening_quality = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].mean_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].mean_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		if (call_stats[SCCP_CALLSTATISTIC_AVG].max_opinion_score_listening_quality < call_stats[SCCP_CALLSTATISTIC_LAST].max_opinion_score_listening_quality) {
-			call_stats[SCCP_CALLSTATISTIC_AVG].max_opinion_score_listening_quality = call_stats[SCCP_CALLSTATISTIC_LAST].max_opinion_score_listening_quality;
-		}
-		call_stats[SCCP_CALLSTATISTIC_AVG].interval_concealement_ratio = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].interval_concealement_ratio, call_stats[SCCP_CALLSTATISTIC_AVG].interval_concealement_ratio, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].cumulative_concealement_ratio = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].cumulative_concealement_ratio, call_stats[SCCP_CALLSTATISTIC_AVG].cumulative_concealement_ratio, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		if (call_stats[SCCP_CALLSTATISTIC_AVG].max_concealement_ratio < call_stats[SCCP_CALLSTATISTIC_LAST].max_concealement_ratio) {
-			call_stats[SCCP_CALLSTATISTIC_AVG].max_concealement_ratio = call_stats[SCCP_CALLSTATISTIC_LAST].max_concealement_ratio;
-		}
-		call_stats[SCCP_CALLSTATISTIC_AVG].concealed_seconds = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].concealed_seconds, call_stats[SCCP_CALLSTATISTIC_AVG].concealed_seconds, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].severely_concealed_seconds = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].severely_concealed_seconds, call_stats[SCCP_CALLSTATISTIC_AVG].severely_concealed_seconds, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-		call_stats[SCCP_CALLSTATISTIC_AVG].variance_opinion_score_listening_quality = CALC_AVG(call_stats[SCCP_CALLSTATISTIC_LAST].variance_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].variance_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].num);
-
-		call_stats[SCCP_CALLSTATISTIC_AVG].num++;
-		pbx_str_append(&output_buf, buffersize, "         Mean Statistics  : #Calls: %d Packets sent: %d rcvd: %d lost: %d jitter: %d latency: %d\n", call_stats[SCCP_CALLSTATISTIC_AVG].num, call_stats[SCCP_CALLSTATISTIC_AVG].packets_sent, call_stats[SCCP_CALLSTATISTIC_AVG].packets_received, call_stats[SCCP_CALLSTATISTIC_AVG].packets_lost, call_stats[SCCP_CALLSTATISTIC_AVG].jitter, call_stats[SCCP_CALLSTATISTIC_AVG].latency);
-
-		pbx_str_append(&output_buf, buffersize, "         Mean Quality     : MLQK=%.4f;MLQKav=%.4f;MLQKmn=%.4f;MLQKmx=%.4f;MLQKvr=%.2f|ICR=%.4f;CCR=%.4f;ICRmx=%.4f|CS=%d;SCS=%d\n",
-			       call_stats[SCCP_CALLSTATISTIC_AVG].opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].avg_opinion_score_listening_quality,
-			       call_stats[SCCP_CALLSTATISTIC_AVG].mean_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].max_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].variance_opinion_score_listening_quality, call_stats[SCCP_CALLSTATISTIC_AVG].interval_concealement_ratio, call_stats[SCCP_CALLSTATISTIC_AVG].cumulative_concealement_ratio, call_stats[SCCP_CALLSTATISTIC_AVG].max_concealement_ratio,
-			       (int) call_stats[SCCP_CALLSTATISTIC_AVG].concealed_seconds, (int) call_stats[SCCP_CALLSTATISTIC_AVG].severely_concealed_seconds);
-		pbx_str_append(&output_buf, buffersize, "       ]\n");
-		sccp_log((DEBUGCAT_CORE)) (VERBOSE_PREFIX_3 "%s", pbx_str_buffer(output_buf));
+		QualityStats = msg_in->data.ConnectionStatisticsRes.v22.QualityStats;
 	}
+	QualityStatsSize = QualityStatsSize < sizeof(sample.qualityStats) ? QualityStatsSize : sizeof(sample.qualityStats);
+	if (QualityStatsSize) {
+		sccp_copy_string(sample.qualityStats, QualityStats, QualityStatsSize);
+	}
+	sccp_callstats_submit(device, &sample);
 }
 
 /*!
@@ -4098,10 +4197,14 @@ void handle_feature_stat_req(constSessionPtr s, devicePtr d, constMessagePtr msg
 	}
 #endif
 
-	SCCP_LIST_TRAVERSE(&d->buttonconfig, config, list) {
-		if (config->instance == featureIndex && config->type == FEATURE) {
-			sccp_feat_changed(d, NULL, config->button.feature.id);
-		}
+	sccp_buttonindex_t *idx = sccp_buttonindex_retain(d);
+	sccp_feature_type_t featureId = SCCP_FEATURE_UNKNOWN;
+	if ((config = sccp_dev_feature_find_byindex(idx, featureIndex))) {
+		featureId = config->button.feature.id;							/* config is only valid while idx is retained */
+	}
+	sccp_buttonindex_release(idx);
+	if (featureId != SCCP_FEATURE_UNKNOWN) {
+		sccp_feat_changed(d, NULL, featureId);
 	}
 }
 
@@ -4114,13 +4217,13 @@ void handle_feature_stat_req(constSessionPtr s, devicePtr d, constMessagePtr msg
 void handle_services_stat_req(constSessionPtr s, devicePtr d, constMessagePtr msg_in)
 {
 	sccp_msg_t * msg_out = NULL;
-	sccp_buttonconfig_t * config = NULL;
+	sccp_service_t service;
 
 	int urlIndex = letohl(msg_in->data.ServiceURLStatReqMessage.lel_serviceURLIndex);
 
 	sccp_log((DEBUGCAT_CORE)) (VERBOSE_PREFIX_3 "%s: Got ServiceURL Status Request.  Index = %d\n", d->id, urlIndex);
 
-	if ((config = sccp_dev_serviceURL_find_byindex(d, urlIndex))) {
+	if (sccp_dev_serviceURL_find_byindex(d, urlIndex, &service)) {
 		/* \todo move ServiceURLStatMessage impl to sccp_protocol.c */
 		if (d->inuseprotocolversion < 7) {
 			REQ(msg_out, ServiceURLStatMessage);
@@ -4128,12 +4231,12 @@ void handle_services_stat_req(constSessionPtr s, devicePtr d, constMessagePtr ms
 				return;
 			}
 			msg_out->data.ServiceURLStatMessage.lel_serviceURLIndex = htolel(urlIndex);
-			sccp_copy_string(msg_out->data.ServiceURLStatMessage.URL, config->button.service.url, sccp_strlen(config->button.service.url) + 1);
-			//sccp_copy_string(msg_out->data.ServiceURLStatMessage.label, config->label, sccp_strlen(config->label) + 1);
-			d->copyStr2Locale(d, msg_out->data.ServiceURLStatMessage.label, config->label, sccp_strlen(config->label) + 1);
+			sccp_copy_string(msg_out->data.ServiceURLStatMessage.URL, service.url, sccp_strlen(service.url) + 1);
+			//sccp_copy_string(msg_out->data.ServiceURLStatMessage.label, service.label, sccp_strlen(service.label) + 1);
+			d->copyStr2Locale(d, msg_out->data.ServiceURLStatMessage.label, service.label, sccp_strlen(service.label) + 1);
 		} else {
-			int URL_len = sccp_strlen(config->button.service.url);
-			int label_len = sccp_strlen(config->label);
+			int URL_len = sccp_strlen(service.url);
+			int label_len = sccp_strlen(service.label);
 			int dummy_len = URL_len + label_len;
 
 			int hdr_len = sizeof(msg_in->data.ServiceURLStatDynamicMessage) - 1;
@@ -4149,10 +4252,10 @@ void handle_services_stat_req(constSessionPtr s, devicePtr d, constMessagePtr ms
 
 				memset(&buffer[0], 0, dummy_len + 2);
 				if (URL_len) {
-					memcpy(&buffer[0], config->button.service.url, URL_len);
+					memcpy(&buffer[0], service.url, URL_len);
 				}
 				if (label_len) {
-					memcpy(&buffer[URL_len + 1], config->label, label_len);
+					memcpy(&buffer[URL_len + 1], service.label, label_len);
 				}
 				memcpy(&msg_out->data.ServiceURLStatDynamicMessage.dummy, &buffer[0], dummy_len + 2);
 			}
@@ -4163,6 +4266,67 @@ void handle_services_stat_req(constSessionPtr s, devicePtr d, constMessagePtr ms
 	}
 }
 
+/*!
+ * \brief Re-send the (changed) softkeyset definition to a registered device
+ * \param s SCCP Session
+ * \param d SCCP Device
+ * \param none SCCP Message (unused)
+ * \note used by sccp_device_apply_liveupdate after reload
+ */
+void sccp_handle_soft_key_set_req(constSessionPtr s, devicePtr d, constMessagePtr none)
+{
+	sccp_msg_t msg_in = { {0,} };
+	handle_soft_key_set_req(s, d, &msg_in);
+}
+
+/*!
+ * \brief Re-send the line, speeddial, service and feature button status to a registered device, as if the device had requested them
+ * \param s SCCP Session
+ * \param d SCCP Device
+ * \param linesOnly only refresh the line buttons
+ * \note used by sccp_device_apply_liveupdate to push changed labels after reload, without resetting the device
+ */
+void sccp_handle_buttonstat_refresh(constSessionPtr s, devicePtr d, boolean_t linesOnly)
+{
+	sccp_buttonconfig_t * config = NULL;
+	sccp_msg_t msg_in = { {0,} };
+
+	SCCP_LIST_LOCK(&d->buttonconfig);
+	SCCP_LIST_TRAVERSE(&d->buttonconfig, config, list) {
+		if (!config->instance || (linesOnly && config->type != LINE)) {
+			continue;
+		}
+		memset(&msg_in.data, 0, sizeof(msg_in.data));
+		switch (config->type) {
+			case LINE:
+				msg_in.data.LineStatReqMessage.lel_lineNumber = htolel(config->instance);
+				handle_line_number(s, d, &msg_in);
+				break;
+			case SPEEDDIAL:
+				if (config->button.speeddial.hint) {
+					msg_in.data.LineStatReqMessage.lel_lineNumber = htolel(config->instance);
+					handle_line_number(s, d, &msg_in);
+				} else {
+					msg_in.data.SpeedDialStatReqMessage.lel_speedDialNumber = htolel(config->instance);
+					handle_speed_dial_stat_req(s, d, &msg_in);
+				}
+				break;
+			case SERVICE:
+				msg_in.data.ServiceURLStatReqMessage.lel_serviceURLIndex = htolel(config->instance);
+				handle_services_stat_req(s, d, &msg_in);
+				break;
+			case FEATURE:
+				msg_in.data.FeatureStatReqMessage.lel_featureIndex = htolel(config->instance);
+				handle_feature_stat_req(s, d, &msg_in);
+				break;
+			default:
+				break;
+		}
+	}
+	SCCP_LIST_UNLOCK(&d->buttonconfig);
+	sccp_log((DEBUGCAT_ACTION | DEBUGCAT_BUTTONTEMPLATE)) (VERBOSE_PREFIX_3 "%s: Refreshed %s button status\n", DEV_ID_LOG(d), linesOnly ? "line" : "all");
+}
+
 #if defined(CS_SCCP_VIDEO) && defined(DEBUG) && DEBUG == 1
 static void handle_updatecapabilities_dissect_customPictureFormat(constDevicePtr d, uint32_t customPictureFormatCount, const customPictureFormat_t customPictureFormat[MAX_CUSTOM_PICTURES]) {
 	uint8_t video_customPictureFormat = 0;
@@ -4844,4 +5008,59 @@ void handle_miscellaneousCommandMessage(constSessionPtr s, devicePtr d, constMes
 		}
 	}
 }
+#if CS_TEST_FRAMEWORK
+#include <asterisk/test.h>
+AST_TEST_DEFINE(sccp_messagestat_tests)
+{
+	sccp_messagestat_t stat;
+	struct timeval start;
+	int iter = 0;
+
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "messagestats";
+			info->category = "/channels/chan_sccp/actions/";
+			info->summary = "chan-sccp-b message statistics test";
+			info->description = "chan-sccp-b per message-id index mapping and latency histogram tests";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+
+	pbx_test_status_update(test, "Message Id to index mapping...\n");
+	pbx_test_validate(test, messagestat_mid2idx(KeepAliveMessage) == KeepAliveMessage);
+	pbx_test_validate(test, messagestat_idx2mid(messagestat_mid2idx(RegisterMessage)) == RegisterMessage);
+	pbx_test_validate(test, messagestat_idx2mid(messagestat_mid2idx(SPCPRegisterTokenRequest)) == SPCPRegisterTokenRequest);
+	pbx_test_validate(test, messagestat_mid2idx(SPCP_MESSAGE_HIGH_BOUNDARY) == SCCP_MESSAGESTAT_ENTRIES - 1);
+	pbx_test_validate(test, messagestat_mid2idx(SCCP_MESSAGE_HIGH_BOUNDARY + 1) == -1);
+
+	pbx_test_status_update(test, "Histogram...\n");
+	memset(&stat, 0, sizeof(stat));
+	pbx_test_validate(test, messagestat_percentile(&stat, 99) == 0);
+	pbx_test_validate(test, messagestat_average(&stat) == 0);
+	for (iter = 0; iter < 99; iter++) {
+		start = pbx_tvnow();
+		messagestat_record(&stat, &start);
+	}
+	start = ast_tvsub(pbx_tvnow(), ast_tv(1, 0));
+	messagestat_record(&stat, &start);
+	pbx_test_validate(test, stat.count == 100);
+	pbx_test_validate(test, stat.usec_max >= 1000000);
+	pbx_test_validate(test, stat.buckets[SCCP_MESSAGESTAT_BUCKETS - 1] == 1);
+	pbx_test_validate(test, messagestat_percentile(&stat, 50) < messagestat_percentile(&stat, 100));
+	pbx_test_validate(test, messagestat_percentile(&stat, 100) == stat.usec_max);
+
+	return AST_TEST_PASS;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_messagestat_tests);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_messagestat_tests);
+}
+#endif
 // kate: indent-width 4; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets on;
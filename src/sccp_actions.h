@@ -10,9 +10,13 @@
  * 
  */
 #pragma once
+#include "sccp_cli.h"
+
 __BEGIN_C_EXTERN__
 
 SCCP_API int SCCP_CALL sccp_handle_message(constMessagePtr msg, constSessionPtr s);
+SCCP_API void SCCP_CALL sccp_messagestat_recordOutbound(sccp_mid_t mid, const struct timeval *start);
+SCCP_API int SCCP_CALL sccp_show_message_stats(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[]);
 
 /* externally used handlers */
 SCCP_API void SCCP_CALL sccp_handle_backspace(constDevicePtr d, const uint8_t lineInstance, const uint32_t callid)	__NONNULL(1);
@@ -21,5 +25,7 @@ SCCP_API void SCCP_CALL sccp_handle_AvailableLines(constSessionPtr s, devicePtr
 SCCP_API void SCCP_CALL sccp_handle_soft_key_template_req(constSessionPtr s, devicePtr d, constMessagePtr none)		__NONNULL(1,2);
 SCCP_API void SCCP_CALL sccp_handle_time_date_req(constSessionPtr s, devicePtr d, constMessagePtr none)			__NONNULL(1,2);
 SCCP_API void SCCP_CALL sccp_handle_button_template_req(constSessionPtr s, devicePtr d, constMessagePtr none)		__NONNULL(1,2);
+SCCP_API void SCCP_CALL sccp_handle_soft_key_set_req(constSessionPtr s, devicePtr d, constMessagePtr none)		__NONNULL(1,2);
+SCCP_API void SCCP_CALL sccp_handle_buttonstat_refresh(constSessionPtr s, devicePtr d, boolean_t linesOnly)		__NONNULL(1,2);
 __END_C_EXTERN__
 // kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
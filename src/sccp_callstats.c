@@ -0,0 +1,656 @@
+/*!
+ * \file        sccp_callstats.c
+ * \brief       SCCP Call Quality Statistics
+ * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *              See the LICENSE file at the top of the source tree.
+ *
+ * handle_ConnectionStatistics only copies the raw values out of the message and submits them here. Samples are queued and
+ * drained by a single job on the general threadpool, so the session thread never parses the QualityStats string, updates
+ * averages or formats reports. The drain job parses the QualityStats (format depends on the protocol version), updates
+ * the device call_statistics (last/avg) and adds the call to the global, per-device and per-line histograms.
+ *
+ * The human readable per call report is only built when core debugging is enabled. "sccp show stats calls" formats the
+ * histograms on request.
+ */
+
+#include "config.h"
+#include "common.h"
+#include "sccp_callstats.h"
+
+SCCP_FILE_VERSION(__FILE__, "");
+
+#include "sccp_device.h"
+#include "sccp_threadpool.h"
+#include "sccp_utils.h"
+
+#define SCCP_CALLSTATS_HASHSIZE 256										/* power of 2 */
+#define SCCP_CALLSTATS_MAXQUEUED 10000										/* samples queued before new ones are dropped */
+#define SCCP_CALLSTATS_NAMESIZE (StationMaxDirnumSize > StationMaxDeviceNameSize ? StationMaxDirnumSize : StationMaxDeviceNameSize)
+
+typedef enum {
+	SCCP_CALLSTATS_GLOBAL,
+	SCCP_CALLSTATS_DEVICE,
+	SCCP_CALLSTATS_LINE,
+} sccp_callstats_type_t;
+
+/* histogram bucket boundaries, the last bucket holds everything above the last boundary */
+static const float callstats_mos_bounds[SCCP_CALLSTATS_BUCKETS - 1] = { 2.5, 3.0, 3.5, 4.0 };				/* MOS (MLQKav) */
+static const uint32_t callstats_jitter_bounds[SCCP_CALLSTATS_BUCKETS - 1] = { 10, 20, 50, 100 };			/* ms */
+static const float callstats_loss_bounds[SCCP_CALLSTATS_BUCKETS - 1] = { 0.0, 1.0, 3.0, 5.0 };				/* percent, first bucket = no loss */
+
+typedef struct sccp_callstats_agg {
+	uint32_t calls;
+	uint32_t mosCalls;											/*!< calls reporting a MOS score */
+	double mosTotal;
+	uint64_t jitterTotal;
+	uint32_t jitterMax;
+	uint64_t packetsReceived;
+	uint64_t packetsLost;
+	uint32_t mos[SCCP_CALLSTATS_BUCKETS];
+	uint32_t jitter[SCCP_CALLSTATS_BUCKETS];
+	uint32_t loss[SCCP_CALLSTATS_BUCKETS];
+} sccp_callstats_agg_t;
+
+typedef struct sccp_callstats_entry sccp_callstats_entry_t;
+struct sccp_callstats_entry {
+	sccp_callstats_entry_t *next;
+	sccp_callstats_type_t type;
+	char name[SCCP_CALLSTATS_NAMESIZE];
+	sccp_callstats_agg_t agg;
+};
+
+typedef struct sccp_callstats_job sccp_callstats_job_t;
+struct sccp_callstats_job {
+	SCCP_LIST_ENTRY(sccp_callstats_job_t) list;
+	sccp_device_t *device;
+	sccp_callstats_sample_t sample;
+};
+
+typedef struct sccp_callstats_table {
+	sccp_callstats_agg_t global;
+	sccp_callstats_entry_t *table[SCCP_CALLSTATS_HASHSIZE];
+	uint32_t entries;
+} sccp_callstats_table_t;
+
+static struct {
+	SCCP_LIST_HEAD(, sccp_callstats_job_t) queue;
+	boolean_t running;
+	boolean_t draining;											/*!< a drain job is scheduled / running */
+	uint32_t dropped;											/*!< protected by the queue lock, like running and draining */
+
+	pbx_mutex_t lock;											/*!< protects the aggregates below */
+	sccp_callstats_table_t aggregates;
+} callstats;
+
+/* ============================================================================================================ BUCKETS */
+static inline int callstats_bucket_float(const float *bounds, float value)
+{
+	int bucket = 0;
+	while (bucket < SCCP_CALLSTATS_BUCKETS - 1 && value > bounds[bucket]) {
+		bucket++;
+	}
+	return bucket;
+}
+
+static inline int callstats_bucket_mos(float value)
+{
+	int bucket = 0;
+	while (bucket < SCCP_CALLSTATS_BUCKETS - 1 && value >= callstats_mos_bounds[bucket]) {
+		bucket++;
+	}
+	return bucket;
+}
+
+static inline int callstats_bucket_jitter(uint32_t value)
+{
+	int bucket = 0;
+	while (bucket < SCCP_CALLSTATS_BUCKETS - 1 && value >= callstats_jitter_bounds[bucket]) {
+		bucket++;
+	}
+	return bucket;
+}
+
+static void callstats_agg_add(sccp_callstats_agg_t *agg, const sccp_call_statistics_t *last)
+{
+	uint64_t total = (uint64_t)last->packets_received + last->packets_lost;
+	float loss = total ? (float)last->packets_lost * 100 / total : 0;
+
+	agg->calls++;
+	if (last->avg_opinion_score_listening_quality > 0) {
+		agg->mosCalls++;
+		agg->mosTotal += last->avg_opinion_score_listening_quality;
+		agg->mos[callstats_bucket_mos(last->avg_opinion_score_listening_quality)]++;
+	}
+	agg->jitterTotal += last->jitter;
+	if (last->jitter > agg->jitterMax) {
+		agg->jitterMax = last->jitter;
+	}
+	agg->jitter[callstats_bucket_jitter(last->jitter)]++;
+	agg->packetsReceived += last->packets_received;
+	agg->packetsLost += last->packets_lost;
+	agg->loss[callstats_bucket_float(callstats_loss_bounds, loss)]++;
+}
+
+/* ============================================================================================================== TABLE */
+static inline uint32_t callstats_hash(sccp_callstats_type_t type, const char *name)
+{
+	uint32_t hash = 5381 + type;
+	while (*name) {
+		hash = ((hash << 5) + hash) + (unsigned char)*name++;
+	}
+	return hash & (SCCP_CALLSTATS_HASHSIZE - 1);
+}
+
+/* needs callstats.lock when used on callstats.aggregates */
+static sccp_callstats_agg_t *callstats_find(sccp_callstats_table_t *tbl, sccp_callstats_type_t type, const char *name)
+{
+	uint32_t hash = callstats_hash(type, name);
+	sccp_callstats_entry_t *entry = NULL;
+
+	for (entry = tbl->table[hash]; entry; entry = entry->next) {
+		if (entry->type == type && sccp_strequals(entry->name, name)) {
+			return &entry->agg;
+		}
+	}
+	if (!(entry = (sccp_callstats_entry_t *)sccp_calloc(1, sizeof(sccp_callstats_entry_t)))) {
+		return NULL;
+	}
+	entry->type = type;
+	sccp_copy_string(entry->name, name, sizeof(entry->name));
+	entry->next = tbl->table[hash];
+	tbl->table[hash] = entry;
+	tbl->entries++;
+	return &entry->agg;
+}
+
+/* needs callstats.lock when used on callstats.aggregates */
+static void callstats_reset(sccp_callstats_table_t *tbl)
+{
+	sccp_callstats_entry_t *entry = NULL;
+	int idx = 0;
+
+	for (idx = 0; idx < SCCP_CALLSTATS_HASHSIZE; idx++) {
+		while ((entry = tbl->table[idx])) {
+			tbl->table[idx] = entry->next;
+			sccp_free(entry);
+		}
+	}
+	memset(&tbl->global, 0, sizeof(tbl->global));
+	tbl->entries = 0;
+}
+
+/* needs callstats.lock when used on callstats.aggregates */
+static void callstats_aggregate(sccp_callstats_table_t *tbl, const char *deviceId, const char *directoryNumber, const sccp_call_statistics_t *last)
+{
+	sccp_callstats_agg_t *agg = NULL;
+
+	callstats_agg_add(&tbl->global, last);
+	if (deviceId && (agg = callstats_find(tbl, SCCP_CALLSTATS_DEVICE, deviceId))) {
+		callstats_agg_add(agg, last);
+	}
+	if (!sccp_strlen_zero(directoryNumber) && (agg = callstats_find(tbl, SCCP_CALLSTATS_LINE, directoryNumber))) {
+		callstats_agg_add(agg, last);
+	}
+}
+
+/* ============================================================================================================ PROCESS */
+static void callstats_parse(const sccp_callstats_sample_t *sample, sccp_call_statistics_t *last)
+{
+	memset(last, 0, sizeof(sccp_call_statistics_t));
+	last->num = sample->callid;
+	last->packets_sent = sample->packets_sent;
+	last->packets_received = sample->packets_received;
+	last->packets_lost = sample->packets_lost;
+	last->jitter = sample->jitter;
+	last->latency = sample->latency;
+
+	if (sccp_strlen_zero(sample->qualityStats)) {
+		return;
+	}
+	if (sample->protocolVer < 20) {
+		sscanf(sample->qualityStats, "MLQK=%f;MLQKav=%f;MLQKmn=%f;MLQKmx=%f;MLQKvr=%f;CCR=%f;ICR=%f;ICRmx=%f;CS=%d;SCS=%d",
+		       &last->opinion_score_listening_quality, &last->avg_opinion_score_listening_quality,
+		       &last->mean_opinion_score_listening_quality, &last->max_opinion_score_listening_quality,
+		       &last->variance_opinion_score_listening_quality, &last->cumulative_concealement_ratio, &last->interval_concealement_ratio, &last->max_concealement_ratio, &last->concealed_seconds, &last->severely_concealed_seconds);
+	} else if (sample->protocolVer < 22) {
+		int Log = 0;
+
+		sscanf(sample->qualityStats, "Log %d: mos %f, avgMos %f, maxMos %f, minMos %f, CS %d, SCS %d, CCR %f, ICR %f, maxCR %f",
+		       &Log,
+		       &last->opinion_score_listening_quality, &last->avg_opinion_score_listening_quality,
+		       &last->max_opinion_score_listening_quality, &last->mean_opinion_score_listening_quality,
+		       &last->concealed_seconds, &last->severely_concealed_seconds, &last->cumulative_concealement_ratio, &last->interval_concealement_ratio, &last->max_concealement_ratio);
+	} else {
+		sscanf(sample->qualityStats, "MLQK=%f;MLQKav=%f;MLQKmn=%f;MLQKmx=%f;ICR=%f;CCR=%f;ICRmx=%f;CS=%d;SCS=%d;MLQKvr=%f",
+		       &last->opinion_score_listening_quality, &last->avg_opinion_score_listening_quality,
+		       &last->mean_opinion_score_listening_quality, &last->max_opinion_score_listening_quality,
+		       &last->interval_concealement_ratio, &last->cumulative_concealement_ratio, &last->max_concealement_ratio, &last->concealed_seconds, &last->severely_concealed_seconds, &last->variance_opinion_score_listening_quality);
+	}
+}
+
+static void callstats_update_device(sccp_device_t *d, const sccp_call_statistics_t *last)
+{
+#define CALC_AVG(_newval, _mean, _numval) ( ( ((_mean) * (_numval) ) + (_newval) ) / ((_numval) + 1))
+	sccp_call_statistics_t *avg = &d->call_statistics[SCCP_CALLSTATISTIC_AVG];
+
+	d->call_statistics[SCCP_CALLSTATISTIC_LAST] = *last;
+
+	avg->packets_sent = CALC_AVG(last->packets_sent, avg->packets_sent, avg->num);
+	avg->packets_received = CALC_AVG(last->packets_received, avg->packets_received, avg->num);
+	avg->packets_lost = CALC_AVG(last->packets_lost, avg->packets_lost, avg->num);
+	avg->jitter = CALC_AVG(last->jitter, avg->jitter, avg->num);
+	avg->latency = CALC_AVG(last->latency, avg->latency, avg->num);
+	avg->opinion_score_listening_quality = CALC_AVG(last->opinion_score_listening_quality, avg->opinion_score_listening_quality, avg->num);
+	avg->avg_opinion_score_listening_quality = CALC_AVG(last->avg_opinion_score_listening_quality, avg->avg_opinion_score_listening_quality, avg->num);
+	avg->mean_opinion_score_listening_quality = CALC_AVG(last->mean_opinion_score_listening_quality, avg->mean_opinion_score_listening_quality, avg->num);
+	if (avg->max_opinion_score_listening_quality < last->max_opinion_score_listening_quality) {
+		avg->max_opinion_score_listening_quality = last->max_opinion_score_listening_quality;
+	}
+	avg->interval_concealement_ratio = CALC_AVG(last->interval_concealement_ratio, avg->interval_concealement_ratio, avg->num);
+	avg->cumulative_concealement_ratio = CALC_AVG(last->cumulative_concealement_ratio, avg->cumulative_concealement_ratio, avg->num);
+	if (avg->max_concealement_ratio < last->max_concealement_ratio) {
+		avg->max_concealement_ratio = last->max_concealement_ratio;
+	}
+	avg->concealed_seconds = CALC_AVG(last->concealed_seconds, avg->concealed_seconds, avg->num);
+	avg->severely_concealed_seconds = CALC_AVG(last->severely_concealed_seconds, avg->severely_concealed_seconds, avg->num);
+	avg->variance_opinion_score_listening_quality = CALC_AVG(last->variance_opinion_score_listening_quality, avg->variance_opinion_score_listening_quality, avg->num);
+	avg->num++;
+#undef CALC_AVG
+}
+
+static void callstats_log_report(constDevicePtr d, const sccp_callstats_sample_t *sample)
+{
+	const sccp_call_statistics_t *last = &d->call_statistics[SCCP_CALLSTATISTIC_LAST];
+	const sccp_call_statistics_t *avg = &d->call_statistics[SCCP_CALLSTATISTIC_AVG];
+	size_t buffersize = 2048;
+	struct ast_str *output_buf = pbx_str_alloca(buffersize);
+
+	pbx_str_append(&output_buf, buffersize, "%s: Call Statistics:\n", d->id);
+	pbx_str_append(&output_buf, buffersize, "       [\n");
+	pbx_str_append(&output_buf, buffersize, "         Last Call        : CallID: %d Packets sent: %d rcvd: %d lost: %d jitter: %d latency: %d\n", last->num, last->packets_sent, last->packets_received, last->packets_lost, last->jitter, last->latency);
+	pbx_str_append(&output_buf, buffersize, "         QualityStats     : %s\n", sample->qualityStats);
+	pbx_str_append(&output_buf, buffersize, "         Last Quality     : MLQK=%.4f;MLQKav=%.4f;MLQKmn=%.4f;MLQKmx=%.4f;MLQKvr=%.2f|ICR=%.4f;CCR=%.4f;ICRmx=%.4f|CS=%d;SCS=%d\n",
+		       last->opinion_score_listening_quality, last->avg_opinion_score_listening_quality,
+		       last->mean_opinion_score_listening_quality, last->max_opinion_score_listening_quality, last->variance_opinion_score_listening_quality, last->interval_concealement_ratio, last->cumulative_concealement_ratio, last->max_concealement_ratio,
+		       (int) last->concealed_seconds, (int) last->severely_concealed_seconds);
+	pbx_str_append(&output_buf, buffersize, "         Mean Statistics  : #Calls: %d Packets sent: %d rcvd: %d lost: %d jitter: %d latency: %d\n", avg->num, avg->packets_sent, avg->packets_received, avg->packets_lost, avg->jitter, avg->latency);
+	pbx_str_append(&output_buf, buffersize, "         Mean Quality     : MLQK=%.4f;MLQKav=%.4f;MLQKmn=%.4f;MLQKmx=%.4f;MLQKvr=%.2f|ICR=%.4f;CCR=%.4f;ICRmx=%.4f|CS=%d;SCS=%d\n",
+		       avg->opinion_score_listening_quality, avg->avg_opinion_score_listening_quality,
+		       avg->mean_opinion_score_listening_quality, avg->max_opinion_score_listening_quality, avg->variance_opinion_score_listening_quality, avg->interval_concealement_ratio, avg->cumulative_concealement_ratio, avg->max_concealement_ratio,
+		       (int) avg->concealed_seconds, (int) avg->severely_concealed_seconds);
+	pbx_str_append(&output_buf, buffersize, "       ]\n");
+	sccp_log((DEBUGCAT_CORE)) (VERBOSE_PREFIX_3 "%s", pbx_str_buffer(output_buf));
+}
+
+/*!
+ * \brief Process one sample: parse it, update the device call_statistics and the aggregates
+ * \param d Device (may be NULL)
+ * \param sample Raw sample
+ */
+static void callstats_process(sccp_device_t *d, const sccp_callstats_sample_t *sample)
+{
+	sccp_call_statistics_t last;
+
+	callstats_parse(sample, &last);
+	if (d) {
+		callstats_update_device(d, &last);
+		if ((GLOB(debug) & DEBUGCAT_CORE) != 0) {							// only format the report when debugging
+			callstats_log_report(d, sample);
+		}
+	}
+
+	pbx_mutex_lock(&callstats.lock);
+	callstats_aggregate(&callstats.aggregates, d ? d->id : NULL, sample->directoryNumber, &last);
+	pbx_mutex_unlock(&callstats.lock);
+}
+
+/*!
+ * \brief Drain job running on the general threadpool, only one is scheduled at a time
+ */
+static void *callstats_drain(void *data)
+{
+	sccp_callstats_job_t *job = NULL;
+
+	while (1) {
+		SCCP_LIST_LOCK(&callstats.queue);
+		if (!callstats.running || !(job = SCCP_LIST_REMOVE_HEAD(&callstats.queue, list))) {
+			callstats.draining = FALSE;
+			SCCP_LIST_UNLOCK(&callstats.queue);
+			break;
+		}
+		SCCP_LIST_UNLOCK(&callstats.queue);
+
+		callstats_process(job->device, &job->sample);
+		if (job->device) {
+			sccp_device_release(&job->device);							/* explicit release */
+		}
+		sccp_free(job);
+	}
+	return NULL;
+}
+
+/* ============================================================================================================ MODULE */
+void sccp_callstats_module_start(void)
+{
+	memset(&callstats, 0, sizeof(callstats));
+	SCCP_LIST_HEAD_INIT(&callstats.queue);
+	pbx_mutex_init(&callstats.lock);
+	callstats.running = TRUE;
+}
+
+void sccp_callstats_module_stop(void)
+{
+	sccp_callstats_job_t *job = NULL;
+	boolean_t draining = FALSE;
+	int loopcount = 0;
+
+	SCCP_LIST_LOCK(&callstats.queue);
+	callstats.running = FALSE;
+	draining = callstats.draining;
+	SCCP_LIST_UNLOCK(&callstats.queue);
+	while (draining) {											/* a scheduled / running drain job still uses the queue and the lock, wait until it is done */
+		if (++loopcount % 100 == 0) {
+			pbx_log(LOG_NOTICE, "SCCP: (callstats) waiting for the drain job to finish (%dms)\n", loopcount * 10);
+		}
+		usleep(10000);
+		SCCP_LIST_LOCK(&callstats.queue);
+		draining = callstats.draining;
+		SCCP_LIST_UNLOCK(&callstats.queue);
+	}
+
+	SCCP_LIST_LOCK(&callstats.queue);
+	while ((job = SCCP_LIST_REMOVE_HEAD(&callstats.queue, list))) {
+		if (job->device) {
+			sccp_device_release(&job->device);							/* explicit release */
+		}
+		sccp_free(job);
+	}
+	SCCP_LIST_UNLOCK(&callstats.queue);
+	SCCP_LIST_HEAD_DESTROY(&callstats.queue);
+
+	pbx_mutex_lock(&callstats.lock);
+	callstats_reset(&callstats.aggregates);
+	pbx_mutex_unlock(&callstats.lock);
+	pbx_mutex_destroy(&callstats.lock);
+}
+
+/*!
+ * \brief Queue a ConnectionStatistics sample for background processing (called from the session thread)
+ * \param device SCCP Device
+ * \param sample Raw values copied out of the ConnectionStatisticsRes
+ */
+void sccp_callstats_submit(constDevicePtr device, const sccp_callstats_sample_t *sample)
+{
+	sccp_callstats_job_t *job = (sccp_callstats_job_t *)sccp_malloc(sizeof(sccp_callstats_job_t));
+	boolean_t schedule = FALSE;
+
+	if (job) {
+		memset(&job->list, 0, sizeof(job->list));
+		job->device = NULL;
+		memcpy(&job->sample, sample, sizeof(sccp_callstats_sample_t));
+	}
+
+	/* running, the queue size and dropped are only changed under the queue lock (see sccp_callstats_module_stop) */
+	SCCP_LIST_LOCK(&callstats.queue);
+	if (!callstats.running || !job || SCCP_LIST_GETSIZE(&callstats.queue) >= SCCP_CALLSTATS_MAXQUEUED) {
+		if (callstats.running) {
+			callstats.dropped++;
+		}
+		SCCP_LIST_UNLOCK(&callstats.queue);
+		if (job) {
+			sccp_free(job);
+		}
+		return;
+	}
+	job->device = sccp_device_retain(device);
+	SCCP_LIST_INSERT_TAIL(&callstats.queue, job, list);
+	if (!callstats.draining) {
+		callstats.draining = schedule = TRUE;
+	}
+	SCCP_LIST_UNLOCK(&callstats.queue);
+
+	if (schedule && (!GLOB(general_threadpool) || !sccp_threadpool_add_work(GLOB(general_threadpool), callstats_drain, NULL))) {
+		callstats_drain(NULL);										/* no threadpool, process inline */
+	}
+}
+
+/* ================================================================================================================ CLI */
+typedef struct sccp_callstats_row {
+	sccp_callstats_type_t type;
+	char name[SCCP_CALLSTATS_NAMESIZE];
+	sccp_callstats_agg_t agg;
+} sccp_callstats_row_t;
+
+static int callstats_row_compare(const void *a, const void *b)
+{
+	const sccp_callstats_row_t *rowA = (const sccp_callstats_row_t *)a;
+	const sccp_callstats_row_t *rowB = (const sccp_callstats_row_t *)b;
+
+	if (rowA->type != rowB->type) {
+		return rowA->type - rowB->type;
+	}
+	return strcmp(rowA->name, rowB->name);
+}
+
+static void callstats_format_histogram(char *buf, size_t size, const uint32_t *buckets)
+{
+	snprintf(buf, size, "%u/%u/%u/%u/%u", buckets[0], buckets[1], buckets[2], buckets[3], buckets[4]);
+}
+
+static const char *callstats_type2str(sccp_callstats_type_t type)
+{
+	switch (type) {
+		case SCCP_CALLSTATS_GLOBAL:
+			return "global";
+		case SCCP_CALLSTATS_DEVICE:
+			return "device";
+		case SCCP_CALLSTATS_LINE:
+			return "line";
+	}
+	return "";
+}
+
+/*!
+ * \brief Show Call Quality Statistics
+ * \param fd Fd as int
+ * \param totals Total number of lines as int
+ * \param s AMI Session
+ * \param m Message
+ * \param argc Argc as int
+ * \param argv[] Argv[] as char
+ * \return Result as int
+ *
+ * \called_from_asterisk
+ */
+int sccp_show_call_stats(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[])
+{
+	int local_line_total = 0;
+	sccp_callstats_row_t *rows = NULL;
+	sccp_callstats_entry_t *entry = NULL;
+	boolean_t showDevices = TRUE;
+	boolean_t showLines = TRUE;
+	uint32_t queued = 0;
+	uint32_t dropped = 0;
+	int nrows = 0;
+	int idx = 0;
+
+	if (argc == 5) {
+		if (sccp_strcaseequals(argv[4], "reset")) {
+			pbx_mutex_lock(&callstats.lock);
+			callstats_reset(&callstats.aggregates);
+			pbx_mutex_unlock(&callstats.lock);
+			SCCP_LIST_LOCK(&callstats.queue);
+			callstats.dropped = 0;
+			SCCP_LIST_UNLOCK(&callstats.queue);
+			CLI_AMI_OUTPUT(fd, s, "Call statistics have been reset\n");
+			if (s) {
+				totals->lines = local_line_total;
+			}
+			return RESULT_SUCCESS;
+		} else if (sccp_strcaseequals(argv[4], "devices")) {
+			showLines = FALSE;
+		} else if (sccp_strcaseequals(argv[4], "lines")) {
+			showDevices = FALSE;
+		} else if (!sccp_strcaseequals(argv[4], "all")) {
+			return RESULT_SHOWUSAGE;
+		}
+	}
+
+	/* take a snapshot, so formatting happens without holding the lock */
+	pbx_mutex_lock(&callstats.lock);
+	if ((rows = (sccp_callstats_row_t *)sccp_calloc(callstats.aggregates.entries + 1, sizeof(sccp_callstats_row_t)))) {
+		rows[nrows].type = SCCP_CALLSTATS_GLOBAL;
+		sccp_copy_string(rows[nrows].name, "*", sizeof(rows[nrows].name));
+		rows[nrows++].agg = callstats.aggregates.global;
+		for (idx = 0; idx < SCCP_CALLSTATS_HASHSIZE; idx++) {
+			for (entry = callstats.aggregates.table[idx]; entry; entry = entry->next) {
+				if ((entry->type == SCCP_CALLSTATS_DEVICE && showDevices) || (entry->type == SCCP_CALLSTATS_LINE && showLines)) {
+					rows[nrows].type = entry->type;
+					sccp_copy_string(rows[nrows].name, entry->name, sizeof(rows[nrows].name));
+					rows[nrows++].agg = entry->agg;
+				}
+			}
+		}
+	}
+	pbx_mutex_unlock(&callstats.lock);
+	if (!rows) {
+		return RESULT_FAILURE;
+	}
+	SCCP_LIST_LOCK(&callstats.queue);
+	queued = SCCP_LIST_GETSIZE(&callstats.queue);
+	dropped = callstats.dropped;
+	SCCP_LIST_UNLOCK(&callstats.queue);
+	qsort(rows + 1, nrows - 1, sizeof(sccp_callstats_row_t), callstats_row_compare);
+	if (!s) {
+		CLI_AMI_OUTPUT(fd, s, "Histogram buckets: MOS <2.5/<3.0/<3.5/<4.0/>=4.0, Jitter(ms) <10/<20/<50/<100/>=100, Loss(%%) 0/<=1/<=3/<=5/>5. Queued: %u, Dropped: %u\n", queued, dropped);
+	}
+
+#define CLI_AMI_TABLE_NAME CallStats
+#define CLI_AMI_TABLE_PER_ENTRY_NAME CallStat
+#define CLI_AMI_TABLE_ITERATOR for (idx = 0; idx < nrows; idx++)
+#define CLI_AMI_TABLE_BEFORE_ITERATION											\
+		sccp_callstats_row_t *row = &rows[idx];									\
+		uint64_t packets = row->agg.packetsReceived + row->agg.packetsLost;					\
+		char mosHistogram[40];											\
+		char jitterHistogram[40];										\
+		char lossHistogram[40];											\
+		callstats_format_histogram(mosHistogram, sizeof(mosHistogram), row->agg.mos);				\
+		callstats_format_histogram(jitterHistogram, sizeof(jitterHistogram), row->agg.jitter);			\
+		callstats_format_histogram(lossHistogram, sizeof(lossHistogram), row->agg.loss);
+#define CLI_AMI_TABLE_FIELDS 												\
+		CLI_AMI_TABLE_FIELD(Type,		"-6.6",		s,	6,	callstats_type2str(row->type))	\
+		CLI_AMI_TABLE_FIELD(Name,		"-24.24",	s,	24,	row->name)			\
+		CLI_AMI_TABLE_FIELD(Calls,		"7",		d,	7,	row->agg.calls)			\
+		CLI_AMI_TABLE_FIELD(MosAvg,		"6.2",		f,	6,	row->agg.mosCalls ? row->agg.mosTotal / row->agg.mosCalls : 0.0)	\
+		CLI_AMI_TABLE_FIELD(MosHistogram,	"-24.24",	s,	24,	mosHistogram)			\
+		CLI_AMI_TABLE_FIELD(JitAvg,		"6",		d,	6,	row->agg.calls ? (int)(row->agg.jitterTotal / row->agg.calls) : 0)	\
+		CLI_AMI_TABLE_FIELD(JitMax,		"6",		d,	6,	row->agg.jitterMax)		\
+		CLI_AMI_TABLE_FIELD(JitterHistogram,	"-24.24",	s,	24,	jitterHistogram)		\
+		CLI_AMI_TABLE_FIELD(Loss,		"6.2",		f,	6,	packets ? (double)row->agg.packetsLost * 100 / packets : 0.0)	\
+		CLI_AMI_TABLE_FIELD(LossHistogram,	"-24.24",	s,	24,	lossHistogram)
+#include "sccp_cli_table.h"
+
+	sccp_free(rows);
+	if (s) {
+		totals->lines = local_line_total;
+		totals->tables = 1;
+	}
+	return RESULT_SUCCESS;
+}
+
+#if CS_TEST_FRAMEWORK
+#	include <asterisk/test.h>
+AST_TEST_DEFINE(sccp_callstats_aggregate)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "aggregate";
+			info->category = "/channels/chan_sccp/callstats/";
+			info->summary = "chan-sccp-b call quality statistics";
+			info->description = "Parses the QualityStats formats of the different protocol versions and checks the resulting histograms";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	sccp_callstats_sample_t sample;
+	sccp_call_statistics_t last;
+	sccp_callstats_table_t tbl;										/* local aggregates, the live ones are left alone */
+	sccp_callstats_agg_t *agg = NULL;
+	boolean_t globalOk = FALSE;
+	boolean_t line1Ok = FALSE;
+	boolean_t line2Ok = FALSE;
+	uint32_t entries = 0;
+
+	pbx_test_status_update(test, "Check bucket boundaries\n");
+	pbx_test_validate(test, callstats_bucket_mos(2.49) == 0);
+	pbx_test_validate(test, callstats_bucket_mos(3.0) == 2);
+	pbx_test_validate(test, callstats_bucket_mos(4.5) == 4);
+	pbx_test_validate(test, callstats_bucket_jitter(9) == 0);
+	pbx_test_validate(test, callstats_bucket_jitter(100) == 4);
+	pbx_test_validate(test, callstats_bucket_float(callstats_loss_bounds, 0.0) == 0);
+	pbx_test_validate(test, callstats_bucket_float(callstats_loss_bounds, 0.5) == 1);
+	pbx_test_validate(test, callstats_bucket_float(callstats_loss_bounds, 7.0) == 4);
+
+	memset(&tbl, 0, sizeof(tbl));
+
+	pbx_test_status_update(test, "Process one sample per QualityStats format\n");
+	memset(&sample, 0, sizeof(sample));
+	sample.protocolVer = 17;
+	sample.packets_received = 1000;
+	sample.jitter = 5;
+	sccp_copy_string(sample.directoryNumber, "98011", sizeof(sample.directoryNumber));
+	sccp_copy_string(sample.qualityStats, "MLQK=4.1000;MLQKav=3.9000;MLQKmn=3.5000;MLQKmx=4.2000;MLQKvr=0.95;CCR=0.0010;ICR=0.0000;ICRmx=0.0100;CS=1;SCS=0", sizeof(sample.qualityStats));
+	callstats_parse(&sample, &last);
+	callstats_aggregate(&tbl, NULL, sample.directoryNumber, &last);
+
+	sample.protocolVer = 20;
+	sample.packets_received = 980;
+	sample.packets_lost = 20;
+	sample.jitter = 30;
+	sccp_copy_string(sample.qualityStats, "Log 476: mos 4.2000, avgMos 4.3000, maxMos 4.5000, minMos 4.0000, CS 0, SCS 0, CCR 0.0000, ICR 0.0000, maxCR 0.0000", sizeof(sample.qualityStats));
+	callstats_parse(&sample, &last);
+	callstats_aggregate(&tbl, NULL, sample.directoryNumber, &last);
+
+	sample.protocolVer = 22;
+	sample.packets_received = 900;
+	sample.packets_lost = 100;
+	sample.jitter = 150;
+	sccp_copy_string(sample.directoryNumber, "98012", sizeof(sample.directoryNumber));
+	sccp_copy_string(sample.qualityStats, "MLQK=2.0000;MLQKav=2.2000;MLQKmn=2.0000;MLQKmx=3.0000;ICR=0.1000;CCR=0.0500;ICRmx=0.2000;CS=10;SCS=3;MLQKvr=0.95", sizeof(sample.qualityStats));
+	callstats_parse(&sample, &last);
+	callstats_aggregate(&tbl, NULL, sample.directoryNumber, &last);
+
+	/* collect the results first and validate afterwards: pbx_test_validate returns on failure, which must not leak the table */
+	globalOk = tbl.global.calls == 3 && tbl.global.mosCalls == 3
+		&& tbl.global.mos[0] == 1 && tbl.global.mos[3] == 1 && tbl.global.mos[4] == 1
+		&& tbl.global.jitter[0] == 1 && tbl.global.jitter[2] == 1 && tbl.global.jitter[4] == 1
+		&& tbl.global.jitterMax == 150
+		&& tbl.global.loss[0] == 1 && tbl.global.loss[2] == 1 && tbl.global.loss[4] == 1
+		&& tbl.global.packetsLost == 120;
+	entries = tbl.entries;
+	agg = callstats_find(&tbl, SCCP_CALLSTATS_LINE, "98011");
+	line1Ok = agg && agg->calls == 2;
+	agg = callstats_find(&tbl, SCCP_CALLSTATS_LINE, "98012");
+	line2Ok = agg && agg->calls == 1 && agg->mos[0] == 1;
+	callstats_reset(&tbl);
+
+	pbx_test_validate(test, globalOk);
+	pbx_test_validate(test, entries == 2);
+	pbx_test_validate(test, line1Ok);
+	pbx_test_validate(test, line2Ok);
+
+	return AST_TEST_PASS;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_callstats_aggregate);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_callstats_aggregate);
+}
+#endif
+
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
@@ -0,0 +1,38 @@
+/*!
+ * \file        sccp_callstats.h
+ * \brief       SCCP Call Quality Statistics Header
+ * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *              See the LICENSE file at the top of the source tree.
+ *
+ * The ConnectionStatisticsRes a phone sends at the end of each call is only copied on the session thread and handed to a
+ * background aggregator, which parses the QualityStats string, updates the device call_statistics and keeps per-device,
+ * per-line (directory number) and global histograms of MOS, jitter and packet loss ("sccp show stats calls").
+ */
+#pragma once
+#include "sccp_cli.h"
+
+#define SCCP_CALLSTATS_BUCKETS 5
+#define SCCP_CALLSTATS_QUALITYSTATS_SIZE 600
+
+__BEGIN_C_EXTERN__
+/*!
+ * \brief Raw ConnectionStatisticsRes values, as received from the phone
+ */
+typedef struct sccp_callstats_sample {
+	uint32_t protocolVer;
+	uint32_t callid;
+	uint32_t packets_sent;
+	uint32_t packets_received;
+	uint32_t packets_lost;
+	uint32_t jitter;
+	uint32_t latency;
+	char directoryNumber[StationMaxDirnumSize];
+	char qualityStats[SCCP_CALLSTATS_QUALITYSTATS_SIZE];
+} sccp_callstats_sample_t;
+
+SCCP_API void SCCP_CALL sccp_callstats_module_start(void);
+SCCP_API void SCCP_CALL sccp_callstats_module_stop(void);
+SCCP_API void SCCP_CALL sccp_callstats_submit(constDevicePtr device, const sccp_callstats_sample_t * sample);
+SCCP_API int SCCP_CALL sccp_show_call_stats(int fd, sccp_cli_totals_t * totals, struct mansession * s, const struct message * m, int argc, char * argv[]);
+__END_C_EXTERN__
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
@@ -0,0 +1,608 @@
+/*!
+ * \file        sccp_capture.c
+ * \brief       SCCP Traffic Capture and Replay
+ * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *              See the LICENSE file at the top of the source tree.
+ *
+ * Writes the raw skinny packets exchanged with a device to a compact binary file (see sccp_capture.h for the format).
+ * Capturing is toggled per device id ("sccp capture start|stop <deviceId>"), so a capture keeps running when the device
+ * re-registers or its sccp_device_t is recreated by a reload. The session only looks up the device id while at least one
+ * capture is running, so there is no cost otherwise. Inbound packets are recorded before they are dispatched, a register
+ * request on a session without a device is recorded for the device it names.
+ *
+ * "sccp capture replay <filename>" opens a new connection to our own listener and feeds the inbound packets of one
+ * captured session back into it, either with the recorded timing, accelerated/slowed down by a speed factor or as fast as
+ * possible, so that a production issue can be reproduced and profiled offline.
+ */
+
+#include "config.h"
+#include "common.h"
+#include "sccp_capture.h"
+
+SCCP_FILE_VERSION(__FILE__, "");
+
+#include "sccp_device.h"
+#include "sccp_netsock.h"
+#include "sccp_session.h"
+#include "sccp_utils.h"
+#include <asterisk/cli.h>
+#include <asterisk/paths.h>				// ast_config_AST_LOG_DIR
+#include <netinet/in.h>
+
+#define SCCP_CAPTURE_REPLAY_DRAIN_TIME 1000									/* ms to keep reading server responses after the last packet */
+
+typedef struct sccp_capture sccp_capture_t;
+struct sccp_capture {
+	SCCP_LIST_ENTRY(sccp_capture_t) list;
+	char deviceId[StationMaxDeviceNameSize];
+	char filename[SCCP_PATH_MAX];
+	FILE * file;
+	pbx_mutex_t lock;											/*!< serializes writes from the session thread and senders */
+	uint32_t records;
+	size_t bytes;
+};
+
+static SCCP_RWLIST_HEAD(, sccp_capture_t) captures;
+static uint32_t capturesRunning;										/*!< changed under the captures lock, read without it as a shortcut */
+
+typedef struct sccp_capture_replay {
+	char filename[SCCP_PATH_MAX];
+	double speed;												/*!< 1.0 = recorded speed, 0 = as fast as possible */
+	uint32_t sessionId;											/*!< 0 = first session found in the file */
+	struct sockaddr_storage server;
+} sccp_capture_replay_t;
+
+/* ============================================================================================================== FILE */
+static FILE * capture_openWriter(const char * filename)
+{
+	sccp_capture_fileheader_t header;
+	FILE * file = fopen(filename, "w");
+
+	if (!file) {
+		return NULL;
+	}
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SCCP_CAPTURE_MAGIC, sizeof(SCCP_CAPTURE_MAGIC));
+	header.lel_version = htolel(SCCP_CAPTURE_VERSION);
+	if (fwrite(&header, sizeof(header), 1, file) != 1) {
+		fclose(file);
+		return NULL;
+	}
+	return file;
+}
+
+static int capture_writeRecord(FILE * file, uint32_t sessionId, sccp_capture_direction_t direction, const struct timeval * tv, const unsigned char * buffer, size_t len)
+{
+	sccp_capture_recordheader_t record = {
+		.lel_sec = htolel((uint32_t)tv->tv_sec),
+		.lel_usec = htolel((uint32_t)tv->tv_usec),
+		.lel_sessionId = htolel(sessionId),
+		.lel_direction = htolel(direction),
+		.lel_length = htolel((uint32_t)len),
+	};
+	if (fwrite(&record, sizeof(record), 1, file) != 1 || fwrite(buffer, 1, len, file) != len) {
+		return -1;
+	}
+	return 0;
+}
+
+static FILE * capture_openReader(const char * filename)
+{
+	sccp_capture_fileheader_t header;
+	FILE * file = fopen(filename, "r");
+
+	if (!file) {
+		return NULL;
+	}
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, SCCP_CAPTURE_MAGIC, sizeof(SCCP_CAPTURE_MAGIC)) || letohl(header.lel_version) != SCCP_CAPTURE_VERSION) {
+		fclose(file);
+		return NULL;
+	}
+	return file;
+}
+
+/*!
+ * \brief Read the next record from a capture file
+ * \return length of the packet stored in buffer, 0 at the end of the file, -1 on a corrupt/truncated record
+ */
+static int capture_readRecord(FILE * file, sccp_capture_recordheader_t * record, unsigned char * buffer, size_t buflen)
+{
+	uint32_t len = 0;
+
+	if (fread(record, sizeof(*record), 1, file) != 1) {
+		return feof(file) ? 0 : -1;
+	}
+	len = letohl(record->lel_length);
+	if (len < SCCP_PACKET_HEADER || len > buflen || fread(buffer, 1, len, file) != len) {
+		return -1;
+	}
+	return (int)len;
+}
+
+/* =========================================================================================================== CAPTURE */
+void sccp_capture_module_start(void)
+{
+	SCCP_RWLIST_HEAD_INIT(&captures);
+}
+
+void sccp_capture_module_stop(void)
+{
+	sccp_capture_t * capture = NULL;
+
+	SCCP_RWLIST_WRLOCK(&captures);
+	while ((capture = SCCP_RWLIST_REMOVE_HEAD(&captures, list))) {
+		pbx_log(LOG_NOTICE, "%s: Capture to '%s' stopped (%u packets, %zu bytes)\n", capture->deviceId, capture->filename, capture->records, capture->bytes);
+		fclose(capture->file);
+		pbx_mutex_destroy(&capture->lock);
+		sccp_free(capture);
+	}
+	capturesRunning = 0;
+	SCCP_RWLIST_UNLOCK(&captures);
+	SCCP_RWLIST_HEAD_DESTROY(&captures);
+}
+
+boolean_t sccp_capture_start(const char * deviceId, const char * filename)
+{
+	sccp_capture_t * capture = NULL;
+
+	SCCP_RWLIST_WRLOCK(&captures);
+	SCCP_RWLIST_TRAVERSE(&captures, capture, list) {
+		if (sccp_strequals(capture->deviceId, deviceId)) {
+			break;
+		}
+	}
+	if (capture) {
+		SCCP_RWLIST_UNLOCK(&captures);
+		pbx_log(LOG_WARNING, "%s: Capture to '%s' already running\n", deviceId, capture->filename);
+		return FALSE;
+	}
+	if (!(capture = (sccp_capture_t *)sccp_calloc(sizeof *capture, 1))) {
+		SCCP_RWLIST_UNLOCK(&captures);
+		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, deviceId);
+		return FALSE;
+	}
+	if (!(capture->file = capture_openWriter(filename))) {
+		SCCP_RWLIST_UNLOCK(&captures);
+		pbx_log(LOG_ERROR, "%s: Could not open capture file '%s': %s\n", deviceId, filename, strerror(errno));
+		sccp_free(capture);
+		return FALSE;
+	}
+	pbx_mutex_init(&capture->lock);
+	sccp_copy_string(capture->deviceId, deviceId, sizeof(capture->deviceId));
+	sccp_copy_string(capture->filename, filename, sizeof(capture->filename));
+	SCCP_RWLIST_INSERT_TAIL(&captures, capture, list);
+	capturesRunning++;
+	SCCP_RWLIST_UNLOCK(&captures);
+
+	sccp_log(DEBUGCAT_CORE)(VERBOSE_PREFIX_3 "%s: Capturing traffic to '%s'\n", deviceId, filename);
+	return TRUE;
+}
+
+boolean_t sccp_capture_stop(const char * deviceId)
+{
+	sccp_capture_t * capture = NULL;
+
+	SCCP_RWLIST_WRLOCK(&captures);
+	SCCP_RWLIST_TRAVERSE_SAFE_BEGIN(&captures, capture, list) {
+		if (sccp_strequals(capture->deviceId, deviceId)) {
+			SCCP_RWLIST_REMOVE_CURRENT(list);
+			capturesRunning--;
+			break;
+		}
+	}
+	SCCP_RWLIST_TRAVERSE_SAFE_END;
+	SCCP_RWLIST_UNLOCK(&captures);
+
+	if (!capture) {
+		return FALSE;
+	}
+	sccp_log(DEBUGCAT_CORE)(VERBOSE_PREFIX_3 "%s: Capture to '%s' stopped (%u packets, %zu bytes)\n", capture->deviceId, capture->filename, capture->records, capture->bytes);
+	fclose(capture->file);
+	pbx_mutex_destroy(&capture->lock);
+	sccp_free(capture);
+	return TRUE;
+}
+
+/*!
+ * \brief Is the traffic of deviceId being captured
+ * \note cheap while no capture is running at all, which is what the session checks for every packet
+ */
+boolean_t sccp_capture_isActive(const char * deviceId)
+{
+	sccp_capture_t * capture = NULL;
+
+	if (dont_expect(capturesRunning) && deviceId) {
+		SCCP_RWLIST_RDLOCK(&captures);
+		SCCP_RWLIST_TRAVERSE(&captures, capture, list) {
+			if (sccp_strequals(capture->deviceId, deviceId)) {
+				break;
+			}
+		}
+		SCCP_RWLIST_UNLOCK(&captures);
+	}
+	return capture ? TRUE : FALSE;
+}
+
+/*!
+ * \brief Append a packet to the capture file of deviceId
+ * \note buffer contains the complete packet as sent/received on the wire, nothing is written when deviceId is not being captured
+ */
+void sccp_capture_write(const char * deviceId, uint32_t sessionId, sccp_capture_direction_t direction, const struct timeval * tv, const unsigned char * buffer, size_t len)
+{
+	sccp_capture_t * capture = NULL;
+
+	SCCP_RWLIST_RDLOCK(&captures);
+	SCCP_RWLIST_TRAVERSE(&captures, capture, list) {
+		if (sccp_strequals(capture->deviceId, deviceId)) {
+			pbx_mutex_lock(&capture->lock);
+			if (capture_writeRecord(capture->file, sessionId, direction, tv, buffer, len) == 0) {
+				capture->records++;
+				capture->bytes += len;
+			} else {
+				pbx_log(LOG_WARNING, "%s: Writing to capture file '%s' failed: %s\n", deviceId, capture->filename, strerror(errno));
+			}
+			pbx_mutex_unlock(&capture->lock);
+			break;
+		}
+	}
+	SCCP_RWLIST_UNLOCK(&captures);
+}
+
+/*!
+ * \brief Device named by a register request, for sessions that do not have a device attached yet
+ * \return deviceId or NULL when buffer is not a register request
+ */
+static const char * capture_registerDeviceId(const unsigned char * buffer, size_t len, char * deviceId, size_t size)
+{
+	uint32_t messageId = 0;
+
+	if (len < SCCP_PACKET_HEADER + StationMaxDeviceNameSize) {
+		return NULL;
+	}
+	memcpy(&messageId, buffer + 8, 4);
+	switch (letohl(messageId)) {
+		case RegisterMessage:
+		case RegisterTokenRequest:
+		case SPCPRegisterTokenRequest:									/* all start with the StationIdentifier */
+			sccp_copy_string(deviceId, (const char *)buffer + SCCP_PACKET_HEADER, size < StationMaxDeviceNameSize ? size : StationMaxDeviceNameSize);
+			return deviceId;
+		default:
+			return NULL;
+	}
+}
+
+/*!
+ * \brief Record an inbound packet, called before the packet is dispatched so that it precedes its replies in the capture
+ * \param deviceId device attached to the session, NULL before registration (a register request is recorded for the device it names)
+ */
+void sccp_capture_inbound(const char * deviceId, uint32_t sessionId, const unsigned char * buffer, size_t len)
+{
+	char registerId[StationMaxDeviceNameSize];
+
+	if (!dont_expect(capturesRunning)) {
+		return;
+	}
+	if (!deviceId && !(deviceId = capture_registerDeviceId(buffer, len, registerId, sizeof(registerId)))) {
+		return;
+	}
+	if (sccp_capture_isActive(deviceId)) {
+		struct timeval now = pbx_tvnow();
+		sccp_capture_write(deviceId, sessionId, SCCP_CAPTURE_INBOUND, &now, buffer, len);
+	}
+}
+
+/* ============================================================================================================ REPLAY */
+static int64_t replay_usec(const sccp_capture_recordheader_t * record)
+{
+	return (int64_t)letohl(record->lel_sec) * 1000000 + letohl(record->lel_usec);
+}
+
+/*!
+ * \brief Time (in usec since the start of the replay) at which a record should be sent
+ */
+static int64_t replay_offset(int64_t recorded, int64_t first, double speed)
+{
+	if (speed <= 0 || recorded <= first) {
+		return 0;
+	}
+	return (int64_t)((recorded - first) / speed);
+}
+
+static size_t replay_drain(int sock)
+{
+	unsigned char buffer[SCCP_MAX_PACKET];
+	size_t total = 0;
+	ssize_t res = 0;
+
+	while ((res = recv(sock, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+		total += res;
+	}
+	return total;
+}
+
+static void * replay_thread(void * data)
+{
+	sccp_capture_replay_t * replay = (sccp_capture_replay_t *)data;
+	sccp_capture_recordheader_t record;
+	unsigned char buffer[SCCP_MAX_PACKET];
+	struct timeval start = { 0 };
+	int64_t first = -1;
+	int64_t offset = 0;
+	uint32_t sessionId = replay->sessionId;
+	uint32_t packets = 0;
+	size_t received = 0;
+	int sock = -1;
+	int len = 0;
+	FILE * file = NULL;
+
+	if (!(file = capture_openReader(replay->filename))) {
+		pbx_log(LOG_ERROR, "SCCP: (replay) Could not open capture file '%s'\n", replay->filename);
+		goto EXIT;
+	}
+	if ((sock = socket(replay->server.ss_family, SOCK_STREAM, IPPROTO_TCP)) < 0 || connect(sock, (struct sockaddr *)&replay->server, sccp_netsock_sizeof(&replay->server)) < 0) {
+		pbx_log(LOG_ERROR, "SCCP: (replay) Could not connect to %s: %s\n", sccp_netsock_stringify(&replay->server), strerror(errno));
+		goto EXIT;
+	}
+	pbx_log(LOG_NOTICE, "SCCP: (replay) Replaying '%s' to %s at speed %.2f\n", replay->filename, sccp_netsock_stringify(&replay->server), replay->speed);
+
+	start = pbx_tvnow();
+	while ((len = capture_readRecord(file, &record, buffer, sizeof(buffer))) > 0) {
+		if (letohl(record.lel_direction) != SCCP_CAPTURE_INBOUND) {
+			continue;
+		}
+		if (!sessionId) {
+			sessionId = letohl(record.lel_sessionId);
+		} else if (letohl(record.lel_sessionId) != sessionId) {
+			continue;
+		}
+		if (first < 0) {
+			first = replay_usec(&record);
+		}
+		offset = replay_offset(replay_usec(&record), first, replay->speed);
+		while (1) {
+			struct timeval delta = ast_tvsub(pbx_tvnow(), start);
+			int64_t elapsed = (int64_t)delta.tv_sec * 1000000 + delta.tv_usec;
+			received += replay_drain(sock);
+			if (elapsed >= offset) {
+				break;
+			}
+			usleep((useconds_t)((offset - elapsed) < 10000 ? (offset - elapsed) : 10000));
+		}
+		for (int sent = 0, res = 0; sent < len; sent += res) {
+			if ((res = send(sock, buffer + sent, len - sent, MSG_NOSIGNAL)) <= 0) {
+				pbx_log(LOG_ERROR, "SCCP: (replay) Connection lost after %u packets: %s\n", packets, strerror(errno));
+				goto EXIT;
+			}
+		}
+		packets++;
+	}
+	if (len < 0) {
+		pbx_log(LOG_WARNING, "SCCP: (replay) Capture file '%s' is truncated/corrupt after %u packets\n", replay->filename, packets);
+	}
+	for (int wait = 0; wait < SCCP_CAPTURE_REPLAY_DRAIN_TIME; wait += 10) {
+		received += replay_drain(sock);
+		usleep(10000);
+	}
+	pbx_log(LOG_NOTICE, "SCCP: (replay) Session %u: replayed %u packets in %.3f sec (recorded speed %.2f), received %zu bytes\n",
+		sessionId, packets, ast_tvdiff_ms(pbx_tvnow(), start) / 1000.0, replay->speed, received);
+EXIT:
+	if (sock >= 0) {
+		close(sock);
+	}
+	if (file) {
+		fclose(file);
+	}
+	sccp_free(replay);
+	return NULL;
+}
+
+/* =============================================================================================================== CLI */
+int sccp_cli_capture_start(int fd, int argc, char * argv[])
+{
+	char filename[SCCP_PATH_MAX];
+
+	if (argc < 4 || argc > 5 || sccp_strlen_zero(argv[3])) {
+		return RESULT_SHOWUSAGE;
+	}
+	AUTO_RELEASE(sccp_device_t, d, sccp_device_find_byid(argv[3], FALSE));
+	if (!d) {
+		pbx_cli(fd, "Can't find settings for device %s\n", argv[3]);
+		return RESULT_FAILURE;
+	}
+	if (argc == 5) {
+		sccp_copy_string(filename, argv[4], sizeof(filename));
+	} else {
+		snprintf(filename, sizeof(filename), "%s/sccp_capture_%s.cap", ast_config_AST_LOG_DIR, d->id);
+	}
+	if (!sccp_capture_start(d->id, filename)) {
+		pbx_cli(fd, "%s: Could not start capture to '%s'\n", d->id, filename);
+		return RESULT_FAILURE;
+	}
+	pbx_cli(fd, "%s: Capturing traffic to '%s'\n", d->id, filename);
+	return RESULT_SUCCESS;
+}
+
+int sccp_cli_capture_stop(int fd, int argc, char * argv[])
+{
+	if (argc != 4 || sccp_strlen_zero(argv[3])) {
+		return RESULT_SHOWUSAGE;
+	}
+	if (!sccp_capture_stop(argv[3])) {								/* by id, the device may be gone since the capture was started */
+		pbx_cli(fd, "%s: No capture running\n", argv[3]);
+		return RESULT_FAILURE;
+	}
+	pbx_cli(fd, "%s: Capture stopped\n", argv[3]);
+	return RESULT_SUCCESS;
+}
+
+int sccp_cli_capture_replay(int fd, int argc, char * argv[])
+{
+	sccp_capture_replay_t * replay = NULL;
+	const struct sockaddr_storage * bound = NULL;
+	pthread_t thread;
+	FILE * file = NULL;
+
+	if (argc < 4 || argc > 6 || sccp_strlen_zero(argv[3])) {
+		return RESULT_SHOWUSAGE;
+	}
+	if (!GLOB(srvcontexts[SCCP_SERVERCONTEXT_TCP]) || !(bound = sccp_servercontext_getBoundAddr(GLOB(srvcontexts[SCCP_SERVERCONTEXT_TCP])))) {
+		pbx_cli(fd, "SCCP: Not listening on tcp, cannot replay\n");
+		return RESULT_FAILURE;
+	}
+	if (!(file = capture_openReader(argv[3]))) {
+		pbx_cli(fd, "SCCP: '%s' is not a valid capture file\n", argv[3]);
+		return RESULT_FAILURE;
+	}
+	fclose(file);
+	if (!(replay = (sccp_capture_replay_t *)sccp_calloc(sizeof *replay, 1))) {
+		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, "SCCP");
+		return RESULT_FAILURE;
+	}
+	sccp_copy_string(replay->filename, argv[3], sizeof(replay->filename));
+	replay->speed = (argc > 4) ? strtod(argv[4], NULL) : 1.0;
+	replay->sessionId = (argc > 5) ? (uint32_t)strtoul(argv[5], NULL, 10) : 0;
+
+	/* connect to ourselves, using the loopback address when we are bound to any */
+	memcpy(&replay->server, bound, sizeof(replay->server));
+	if (sccp_netsock_is_any_addr(&replay->server)) {
+		uint16_t port = sccp_netsock_getPort(&replay->server);
+		if (sccp_netsock_is_IPv6(&replay->server)) {
+			((struct sockaddr_in6 *)&replay->server)->sin6_addr = in6addr_loopback;
+		} else {
+			((struct sockaddr_in *)&replay->server)->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		}
+		sccp_netsock_setPort(&replay->server, port);
+	}
+
+	if (pbx_pthread_create_detached(&thread, NULL, replay_thread, replay)) {
+		pbx_cli(fd, "SCCP: Could not start replay thread\n");
+		sccp_free(replay);
+		return RESULT_FAILURE;
+	}
+	pbx_cli(fd, "SCCP: Replaying '%s' (speed: %.2f), progress is reported in the log\n", argv[3], replay->speed);
+	return RESULT_SUCCESS;
+}
+
+#if CS_TEST_FRAMEWORK
+#include <asterisk/test.h>
+AST_TEST_DEFINE(sccp_capture_tests)
+{
+	char filename[] = "/tmp/sccp_capture_test_XXXXXX";
+	sccp_capture_recordheader_t record;
+	size_t registerLen = SCCP_PACKET_HEADER + sizeof(msg.data.RegisterMessage);
+	unsigned char buffer[SCCP_MAX_PACKET];
+	sccp_msg_t msg;
+	struct timeval tv = { 1000, 500000 };
+	FILE * file = NULL;
+	int tmpfd = -1;
+	int iter = 0;
+	enum ast_test_result_state res = AST_TEST_PASS;
+
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "capture";
+			info->category = "/channels/chan_sccp/capture/";
+			info->summary = "chan-sccp-b traffic capture test";
+			info->description = "chan-sccp-b capture file write/read roundtrip and replay timing";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+
+	if ((tmpfd = mkstemp(filename)) < 0) {
+		pbx_test_status_update(test, "Could not create temporary file\n");
+		return AST_TEST_FAIL;
+	}
+	close(tmpfd);
+
+	pbx_test_status_update(test, "Writing capture...\n");
+	file = capture_openWriter(filename);
+	pbx_test_validate_cleanup(test, file != NULL, res, cleanup);
+	memset(&msg, 0, sizeof(msg));
+	msg.header.length = htolel(4);
+	for (iter = 0; iter < 3; iter++) {
+		msg.header.lel_messageId = htolel(KeepAliveMessage + iter);
+		tv.tv_usec += 100000;
+		pbx_test_validate_cleanup(test, capture_writeRecord(file, 7, iter % 2 ? SCCP_CAPTURE_OUTBOUND : SCCP_CAPTURE_INBOUND, &tv, (unsigned char *)&msg, SCCP_PACKET_HEADER) == 0, res, cleanup);
+	}
+	fclose(file);
+	file = NULL;
+
+	pbx_test_status_update(test, "Reading capture...\n");
+	file = capture_openReader(filename);
+	pbx_test_validate_cleanup(test, file != NULL, res, cleanup);
+	for (iter = 0; iter < 3; iter++) {
+		pbx_test_validate_cleanup(test, capture_readRecord(file, &record, buffer, sizeof(buffer)) == SCCP_PACKET_HEADER, res, cleanup);
+		pbx_test_validate_cleanup(test, letohl(record.lel_sessionId) == 7, res, cleanup);
+		pbx_test_validate_cleanup(test, letohl(record.lel_direction) == (uint32_t)(iter % 2 ? SCCP_CAPTURE_OUTBOUND : SCCP_CAPTURE_INBOUND), res, cleanup);
+		pbx_test_validate_cleanup(test, letohl(((sccp_header_t *)buffer)->lel_messageId) == (uint32_t)(KeepAliveMessage + iter), res, cleanup);
+		pbx_test_validate_cleanup(test, replay_usec(&record) == 1000000000LL + 500000 + (iter + 1) * 100000, res, cleanup);
+	}
+	pbx_test_validate_cleanup(test, capture_readRecord(file, &record, buffer, sizeof(buffer)) == 0, res, cleanup);
+
+	pbx_test_status_update(test, "Replay timing...\n");
+	pbx_test_validate_cleanup(test, replay_offset(3000000, 1000000, 1.0) == 2000000, res, cleanup);
+	pbx_test_validate_cleanup(test, replay_offset(3000000, 1000000, 4.0) == 500000, res, cleanup);
+	pbx_test_validate_cleanup(test, replay_offset(3000000, 1000000, 0) == 0, res, cleanup);
+	pbx_test_validate_cleanup(test, replay_offset(1000000, 3000000, 1.0) == 0, res, cleanup);
+
+	fclose(file);
+	file = NULL;
+
+	pbx_test_status_update(test, "Capture by device id, register request before its reply...\n");
+	pbx_test_validate_cleanup(test, !sccp_capture_isActive("SEPCAPTURETEST"), res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_capture_start("SEPCAPTURETEST", filename), res, cleanup);
+	pbx_test_validate_cleanup(test, !sccp_capture_start("SEPCAPTURETEST", filename), res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_capture_isActive("SEPCAPTURETEST") && !sccp_capture_isActive("SEPOTHER"), res, cleanup);
+	memset(&msg, 0, sizeof(msg));
+	msg.header.length = htolel(registerLen - 8);
+	msg.header.lel_messageId = htolel(RegisterMessage);
+	sccp_copy_string(msg.data.RegisterMessage.sId.deviceName, "SEPCAPTURETEST", sizeof(msg.data.RegisterMessage.sId.deviceName));
+	sccp_capture_inbound(NULL, 8, (unsigned char *)&msg, registerLen);					/* no device attached yet */
+	sccp_copy_string(msg.data.RegisterMessage.sId.deviceName, "SEPOTHER", sizeof(msg.data.RegisterMessage.sId.deviceName));
+	sccp_capture_inbound(NULL, 9, (unsigned char *)&msg, registerLen);
+	memset(&msg, 0, sizeof(msg));
+	msg.header.length = htolel(4);
+	msg.header.lel_messageId = htolel(KeepAliveMessage);
+	sccp_capture_inbound(NULL, 8, (unsigned char *)&msg, SCCP_PACKET_HEADER);				/* not a register request, ignored */
+	sccp_capture_inbound("SEPOTHER", 9, (unsigned char *)&msg, SCCP_PACKET_HEADER);
+	msg.header.lel_messageId = htolel(RegisterAckMessage);
+	sccp_capture_write("SEPCAPTURETEST", 8, SCCP_CAPTURE_OUTBOUND, &tv, (unsigned char *)&msg, SCCP_PACKET_HEADER);
+	msg.header.lel_messageId = htolel(KeepAliveMessage);
+	sccp_capture_inbound("SEPCAPTURETEST", 8, (unsigned char *)&msg, SCCP_PACKET_HEADER);
+	pbx_test_validate_cleanup(test, sccp_capture_stop("SEPCAPTURETEST"), res, cleanup);
+	pbx_test_validate_cleanup(test, !sccp_capture_stop("SEPCAPTURETEST") && !sccp_capture_isActive("SEPCAPTURETEST"), res, cleanup);
+
+	file = capture_openReader(filename);
+	pbx_test_validate_cleanup(test, file != NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, capture_readRecord(file, &record, buffer, sizeof(buffer)) == (int)registerLen, res, cleanup);
+	pbx_test_validate_cleanup(test, letohl(record.lel_direction) == SCCP_CAPTURE_INBOUND && letohl(record.lel_sessionId) == 8, res, cleanup);
+	pbx_test_validate_cleanup(test, letohl(((sccp_header_t *)buffer)->lel_messageId) == RegisterMessage, res, cleanup);
+	pbx_test_validate_cleanup(test, capture_readRecord(file, &record, buffer, sizeof(buffer)) == SCCP_PACKET_HEADER, res, cleanup);
+	pbx_test_validate_cleanup(test, letohl(record.lel_direction) == SCCP_CAPTURE_OUTBOUND, res, cleanup);
+	pbx_test_validate_cleanup(test, letohl(((sccp_header_t *)buffer)->lel_messageId) == RegisterAckMessage, res, cleanup);
+	pbx_test_validate_cleanup(test, capture_readRecord(file, &record, buffer, sizeof(buffer)) == SCCP_PACKET_HEADER, res, cleanup);
+	pbx_test_validate_cleanup(test, letohl(record.lel_direction) == SCCP_CAPTURE_INBOUND, res, cleanup);
+	pbx_test_validate_cleanup(test, letohl(((sccp_header_t *)buffer)->lel_messageId) == KeepAliveMessage, res, cleanup);
+	pbx_test_validate_cleanup(test, capture_readRecord(file, &record, buffer, sizeof(buffer)) == 0, res, cleanup);
+
+cleanup:
+	sccp_capture_stop("SEPCAPTURETEST");
+	if (file) {
+		fclose(file);
+	}
+	unlink(filename);
+	return res;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_capture_tests);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_capture_tests);
+}
+#endif
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
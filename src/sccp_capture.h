@@ -0,0 +1,48 @@
+/*!
+ * \file        sccp_capture.h
+ * \brief       SCCP Traffic Capture and Replay Header
+ * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *              See the LICENSE file at the top of the source tree.
+ *
+ * Capture File Format (all fields little endian):
+ *  - file header:   char magic[8] ("SCCPCAP\0"), uint32_t version, uint32_t reserved
+ *  - record header: uint32_t sec, uint32_t usec, uint32_t sessionId, uint32_t direction, uint32_t length
+ *  - followed by length bytes of the raw skinny packet, exactly as seen on the wire (header included)
+ */
+#pragma once
+
+#define SCCP_CAPTURE_MAGIC "SCCPCAP"
+#define SCCP_CAPTURE_VERSION 1
+
+__BEGIN_C_EXTERN__
+typedef enum {
+	SCCP_CAPTURE_INBOUND  = 0,
+	SCCP_CAPTURE_OUTBOUND = 1,
+} sccp_capture_direction_t;
+
+typedef struct sccp_capture_fileheader {
+	char magic[8];
+	uint32_t lel_version;
+	uint32_t lel_reserved;
+} sccp_capture_fileheader_t;
+
+typedef struct sccp_capture_recordheader {
+	uint32_t lel_sec;
+	uint32_t lel_usec;
+	uint32_t lel_sessionId;
+	uint32_t lel_direction;
+	uint32_t lel_length;
+} sccp_capture_recordheader_t;
+
+SCCP_API void SCCP_CALL sccp_capture_module_start(void);
+SCCP_API void SCCP_CALL sccp_capture_module_stop(void);
+SCCP_API boolean_t SCCP_CALL sccp_capture_start(const char * deviceId, const char * filename);
+SCCP_API boolean_t SCCP_CALL sccp_capture_stop(const char * deviceId);
+SCCP_API boolean_t SCCP_CALL sccp_capture_isActive(const char * deviceId);
+SCCP_API void SCCP_CALL sccp_capture_write(const char * deviceId, uint32_t sessionId, sccp_capture_direction_t direction, const struct timeval * tv, const unsigned char * buffer, size_t len);
+SCCP_API void SCCP_CALL sccp_capture_inbound(const char * deviceId, uint32_t sessionId, const unsigned char * buffer, size_t len);
+SCCP_API int SCCP_CALL sccp_cli_capture_start(int fd, int argc, char * argv[]);
+SCCP_API int SCCP_CALL sccp_cli_capture_stop(int fd, int argc, char * argv[]);
+SCCP_API int SCCP_CALL sccp_cli_capture_replay(int fd, int argc, char * argv[]);
+__END_C_EXTERN__
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
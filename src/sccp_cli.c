@@ -56,6 +56,9 @@ SCCP_FILE_VERSION(__FILE__, "");
 #include "sccp_line.h"
 #include "sccp_linedevice.h"
 #include "sccp_session.h"
+#include "sccp_actions.h"
+#include "sccp_capture.h"
+#include "sccp_callstats.h"
 #include "sccp_conference.h"
 #include "sccp_utils.h"
 #include "sccp_config.h"
@@ -1820,6 +1823,54 @@ CLI_AMI_ENTRY(show_sessions, sccp_cli_show_sessions, "Show all SCCP sessions", c
 #undef CLI_COMPLETE
 #undef AMI_COMMAND
 #undef CLI_COMMAND
+#endif														/* DOXYGEN_SHOULD_SKIP_THIS */
+
+/* ------------------------------------------------------------------------------------------------------SHOW LISTENERS- */
+static char cli_listeners_usage[] = "Usage: sccp show listeners\n" "	Show listening sockets and their accept threads: listen backlog, current accept queue depth, accepted connections and accept errors.\n";
+static char ami_listeners_usage[] = "Usage: SCCPShowListeners\n" "Show listening sockets and their accept threads.\n\n" "PARAMS: None\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "show", "listeners"
+#define AMI_COMMAND "SCCPShowListeners"
+#define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
+#define CLI_AMI_PARAMS ""
+CLI_AMI_ENTRY(show_listeners, sccp_cli_show_listeners, "Show listening sockets and accept threads", cli_listeners_usage, FALSE, TRUE)
+#undef CLI_AMI_PARAMS
+#undef CLI_COMPLETE
+#undef AMI_COMMAND
+#undef CLI_COMMAND
+#endif														/* DOXYGEN_SHOULD_SKIP_THIS */
+
+/* -----------------------------------------------------------------------------------------------------SHOW SENDQUEUES- */
+static char cli_sendqueues_usage[] = "Usage: sccp show sendqueues\n" "	Show the outbound priority lanes (CallControl, UI, Bulk) per session: current and peak depth, messages sent, dropped and coalesced,\n" "	seconds the device has not been reading and queueing delay (usecs).\n";
+static char ami_sendqueues_usage[] = "Usage: SCCPShowSendQueues\n" "Show the outbound priority lanes per session.\n\n" "PARAMS: None\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "show", "sendqueues"
+#define AMI_COMMAND "SCCPShowSendQueues"
+#define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
+#define CLI_AMI_PARAMS ""
+CLI_AMI_ENTRY(show_sendqueues, sccp_cli_show_sendqueues, "Show outbound priority lanes per session", cli_sendqueues_usage, FALSE, TRUE)
+#undef CLI_AMI_PARAMS
+#undef CLI_COMPLETE
+#undef AMI_COMMAND
+#undef CLI_COMMAND
+#endif														/* DOXYGEN_SHOULD_SKIP_THIS */
+
+/* -----------------------------------------------------------------------------------------------------SHOW HANDSHAKES- */
+static char cli_handshakes_usage[] = "Usage: sccp show handshakes\n" "	Show connection setup statistics per transport: acl rejects, handshake latency, session resumptions, failures and timeouts.\n";
+static char ami_handshakes_usage[] = "Usage: SCCPShowHandshakes\n" "Show connection setup statistics per transport.\n\n" "PARAMS: None\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "show", "handshakes"
+#define AMI_COMMAND "SCCPShowHandshakes"
+#define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
+#define CLI_AMI_PARAMS ""
+CLI_AMI_ENTRY(show_handshakes, sccp_cli_show_handshakes, "Show connection setup statistics", cli_handshakes_usage, FALSE, TRUE)
+#undef CLI_AMI_PARAMS
+#undef CLI_COMPLETE
+#undef AMI_COMMAND
+#undef CLI_COMMAND
 #endif														/* DOXYGEN_SHOULD_SKIP_THIS */
     /* ---------------------------------------------------------------------------------------------SHOW_MWI_SUBSCRIPTIONS- */
     // sccp_show_mwi_subscriptions implementation moved to sccp_mwi.c, because of access to private struct
@@ -2347,6 +2398,54 @@ CLI_AMI_ENTRY(show_refcount, sccp_show_refcount, "Show all Refcount Entries", cl
 #undef CLI_COMPLETE
 #undef AMI_COMMAND
 #undef CLI_COMMAND
+#endif														/* DOXYGEN_SHOULD_SKIP_THIS */
+
+    /* ---------------------------------------------------------------------------------------------SHOW_MESSAGE_STATS - */
+static char cli_show_message_stats_usage[] = "Usage: sccp show stats messages [reset]\n" "	Show per message-id counters and latency (usec) for received/sent messages (requires message_stats=yes).\n";
+static char ami_show_message_stats_usage[] = "Usage: SCCPShowMessageStats\n" "Show per message-id counters and latency (usec) for received/sent messages.\n\n" "Optional PARAMS: Reset [reset]\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "show", "stats", "messages"
+#define AMI_COMMAND "SCCPShowMessageStats"
+#define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
+#define CLI_AMI_PARAMS "Reset"
+CLI_AMI_ENTRY(show_message_stats, sccp_show_message_stats, "Show per message-id statistics", cli_show_message_stats_usage, FALSE, TRUE)
+#undef CLI_AMI_PARAMS
+#undef CLI_COMPLETE
+#undef AMI_COMMAND
+#undef CLI_COMMAND
+#endif														/* DOXYGEN_SHOULD_SKIP_THIS */
+
+    /* ------------------------------------------------------------------------------------------------SHOW_CALL_STATS - */
+static char cli_show_call_stats_usage[] = "Usage: sccp show stats calls [all|devices|lines|reset]\n" "	Show global, per device and per line MOS, jitter and packet loss histograms collected from the phones' call statistics.\n";
+static char ami_show_call_stats_usage[] = "Usage: SCCPShowCallStats\n" "Show global, per device and per line MOS, jitter and packet loss histograms.\n\n" "Optional PARAMS: Filter [all|devices|lines|reset]\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "show", "stats", "calls"
+#define AMI_COMMAND "SCCPShowCallStats"
+#define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
+#define CLI_AMI_PARAMS "Filter"
+CLI_AMI_ENTRY(show_call_stats, sccp_show_call_stats, "Show call quality statistics", cli_show_call_stats_usage, FALSE, TRUE)
+#undef CLI_AMI_PARAMS
+#undef CLI_COMPLETE
+#undef AMI_COMMAND
+#undef CLI_COMMAND
+#endif														/* DOXYGEN_SHOULD_SKIP_THIS */
+
+    /* ------------------------------------------------------------------------------------------------------SHOW_LOCKS - */
+static char cli_show_locks_usage[] = "Usage: sccp show locks [count|reset]\n" "	Show the most contended lock sites: acquisitions, contention, wait and hold time (requires --enable-lock-profile).\n";
+static char ami_show_locks_usage[] = "Usage: SCCPShowLocks\n" "Show the most contended lock sites.\n\n" "Optional PARAMS: Count [count|reset]\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "show", "locks"
+#define AMI_COMMAND "SCCPShowLocks"
+#define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
+#define CLI_AMI_PARAMS "Count"
+CLI_AMI_ENTRY(show_locks, sccp_show_locks, "Show lock contention statistics", cli_show_locks_usage, FALSE, TRUE)
+#undef CLI_AMI_PARAMS
+#undef CLI_COMPLETE
+#undef AMI_COMMAND
+#undef CLI_COMMAND
 #endif														/* DOXYGEN_SHOULD_SKIP_THIS */
 
     /* --------------------------------------------------------------------------------------------------SHOW_SOKFTKEYSETS- */
@@ -2987,6 +3086,89 @@ static char no_debug_usage[] = "Usage: SCCP no debug\n" "       Disables dumping
 CLI_ENTRY(cli_no_debug, sccp_no_debug, "Set SCCP Debugging Types", no_debug_usage, FALSE)
 #undef CLI_COMMAND
 #undef CLI_COMPLETE
+#endif														/* DOXYGEN_SHOULD_SKIP_THIS */
+    /* ------------------------------------------------------------------------------------------------------------DO TRACE- */
+    /*!
+     * \brief Do Trace
+     * \param fd Fd as int
+     * \param argc Argc as int
+     * \param argv[] Argv[] as char
+     * \return Result as int
+     * 
+     * \called_from_asterisk
+     */
+static int sccp_do_trace(int fd, int argc, char *argv[])
+{
+	int32_t new_trace = GLOB(trace);
+	char device[StationMaxDeviceNameSize];
+
+	pbx_copy_string(device, sccp_trace_getdevice(), sizeof(device));
+	if (argc > 2) {
+		new_trace = sccp_parse_traceline(argv, 2, argc, new_trace, device, sizeof(device));
+		if (!new_trace) {
+			device[0] = '\0';
+		}
+		sccp_trace_setdevice(device);
+	}
+
+	char *tracecategories = sccp_get_debugcategories(new_trace);
+
+	if (argc > 2) {
+		pbx_cli(fd, "SCCP new trace status: (%d -> %d) %s, device: %s\n", GLOB(trace), new_trace, tracecategories ? tracecategories : "none", device[0] ? device : "all");
+	} else {
+		pbx_cli(fd, "SCCP trace status: (%d) %s, device: %s\n", GLOB(trace), tracecategories ? tracecategories : "none", device[0] ? device : "all");
+	}
+	sccp_free(tracecategories);
+
+	GLOB(trace) = new_trace;
+	return RESULT_SUCCESS;
+}
+
+static char do_trace_usage[] = "Usage: SCCP trace [no] <level or categories> [device <deviceId|all>]\n"
+			       "       Record the debug messages of these categories into the in-memory trace ring instead of logging them.\n"
+			       "       Messages are only formatted when dumped using 'sccp show trace' (or on a crash).\n"
+			       "       Categories are the same as for 'sccp debug', 'device' only records messages mentioning deviceId.\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "trace"
+#define CLI_COMPLETE SCCP_CLI_DEBUG_COMPLETER
+CLI_ENTRY(cli_do_trace, sccp_do_trace, "Set SCCP Trace Categories", do_trace_usage, TRUE)
+#undef CLI_COMPLETE
+#undef CLI_COMMAND
+#endif														/* DOXYGEN_SHOULD_SKIP_THIS */
+    /* ----------------------------------------------------------------------------------------------------------SHOW TRACE- */
+    /*!
+     * \brief Show Trace
+     * \param fd Fd as int
+     * \param argc Argc as int
+     * \param argv[] Argv[] as char
+     * \return Result as int
+     * 
+     * \called_from_asterisk
+     */
+static int sccp_show_trace(int fd, int argc, char *argv[])
+{
+	int count = 0;
+
+	if (argc > 4) {
+		return RESULT_SHOWUSAGE;
+	}
+	if (argc == 4 && (sscanf(argv[3], "%d", &count) != 1 || count < 0)) {
+		return RESULT_SHOWUSAGE;
+	}
+	count = sccp_trace_dump(fd, count);
+	pbx_cli(fd, "--- %d trace entries ---\n", count);
+	return RESULT_SUCCESS;
+}
+
+static char show_trace_usage[] = "Usage: sccp show trace [count]\n" "       Format and show the (last count) entries recorded in the trace ring, oldest first.\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "show", "trace"
+#define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
+CLI_ENTRY(cli_show_trace, sccp_show_trace, "Show SCCP Trace Ring", show_trace_usage, FALSE)
+#undef CLI_COMPLETE
+#undef CLI_COMMAND
 #endif														/* DOXYGEN_SHOULD_SKIP_THIS */
 /* --------------------------------------------------------------------------------------------------------------RELOAD- */
 /*!
@@ -3261,7 +3443,49 @@ EXIT:
 	return returnval;
 }
 
-static char reload_usage[] = "Usage: SCCP reload [force|file filename|device devicename|line linename]\n" "       Reloads SCCP configuration from sccp.conf or filename [force|file filename|device devicename|line linename]\n" "       (It will send a reset to all device which have changed (when they have an active channel reset will be postponed until device goes onhook))\n";
+/*!
+ * \brief Show which config changes would be applied live and which devices would restart, without reloading
+ * \param fd Fd as int
+ * \param argc Argc as int
+ * \param argv[] Argv[] as char
+ * \return Result as int
+ *
+ * \called_from_asterisk
+ */
+static int sccp_cli_reload_dryrun(int fd, int argc, char *argv[])
+{
+	char * filename = NULL;
+
+	if (argc < 3 || argc > 4) {
+		return RESULT_SHOWUSAGE;
+	}
+	if (argc == 4) {
+		if (argv[3][0] != '/') {
+			int filename_len = strlen(ast_config_AST_CONFIG_DIR) + strlen(argv[3]) + 2;
+			filename = (char *)alloca(filename_len);
+			snprintf(filename, filename_len, "%s/%s", ast_config_AST_CONFIG_DIR, argv[3]);
+		} else {
+			filename = pbx_strdupa(argv[3]);
+		}
+	}
+	pbx_rwlock_wrlock(&GLOB(lock));
+	if (GLOB(reload_in_progress) == TRUE) {
+		pbx_cli(fd, "SCCP reloading already in progress.\n");
+		pbx_rwlock_unlock(&GLOB(lock));
+		return RESULT_FAILURE;
+	}
+	GLOB(reload_in_progress) = TRUE;										/* keep GLOB(cfg) stable while comparing */
+	pbx_rwlock_unlock(&GLOB(lock));
+
+	sccp_configurationchange_t res = sccp_config_dryrun(fd, filename);
+
+	pbx_rwlock_wrlock(&GLOB(lock));
+	GLOB(reload_in_progress) = FALSE;
+	pbx_rwlock_unlock(&GLOB(lock));
+	return (res & SCCP_CONFIG_ERROR) ? RESULT_FAILURE : RESULT_SUCCESS;
+}
+
+static char reload_usage[] = "Usage: SCCP reload [force|file filename|device devicename|line linename|dryrun [filename]]\n" "       Reloads SCCP configuration from sccp.conf or filename [force|file filename|device devicename|line linename]\n" "       (It will send a reset to all device which have changed (when they have an active channel reset will be postponed until device goes onhook))\n" "       Labels, speeddials, softkeysets, cfwd and mwi settings are pushed to the registered devices without a reset\n" "       'dryrun' only shows which changes would be applied live and which devices would be reset\n";
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 #define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
@@ -3274,6 +3498,9 @@ CLI_ENTRY(cli_reload_file, sccp_cli_reload, "Reload the SCCP configuration", rel
 #define CLI_COMMAND "sccp", "reload", "force"
     CLI_ENTRY(cli_reload_force, sccp_cli_reload, "Reload the SCCP configuration", reload_usage, FALSE)
 #undef CLI_COMMAND
+#define CLI_COMMAND "sccp", "reload", "dryrun"
+    CLI_ENTRY(cli_reload_dryrun, sccp_cli_reload_dryrun, "Show what reloading the SCCP configuration would change", reload_usage, FALSE)
+#undef CLI_COMMAND
 #undef CLI_COMPLETE
 #define CLI_COMPLETE SCCP_CLI_DEVICE_COMPLETER
 #define CLI_COMMAND "sccp", "reload", "device"
@@ -4047,6 +4274,33 @@ CLI_AMI_ENTRY(microphone, sccp_microphone, "Turn microphone <on/off> on active c
 #	undef AMI_COMMAND
 #	undef CLI_COMPLETE
 #	undef CLI_COMMAND
+#endif /* DOXYGEN_SHOULD_SKIP_THIS */
+    /* ------------------------------------------------------------------------------------------------------------ CAPTURE - */
+static char cli_capture_start_usage[] = "Usage: sccp capture start <deviceId> [filename]\n" "	Capture all traffic of a device to a binary capture file (default: <logdir>/sccp_capture_<deviceId>.cap).\n";
+static char cli_capture_stop_usage[] = "Usage: sccp capture stop <deviceId>\n" "	Stop capturing the traffic of a device.\n";
+static char cli_capture_replay_usage[] = "Usage: sccp capture replay <filename> [speed] [sessionId]\n"
+					 "	Replay the inbound packets of a captured session over a new connection to this server.\n"
+					 "	speed: 1 = recorded timing (default), 2 = twice as fast, 0 = as fast as possible.\n"
+					 "	Note: the replayed session registers as the captured device, disconnecting the real device.\n";
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#define CLI_COMMAND "sccp", "capture", "start"
+#define CLI_COMPLETE SCCP_CLI_DEVICE_COMPLETER
+CLI_ENTRY(cli_capture_start, sccp_cli_capture_start, "Start capturing device traffic", cli_capture_start_usage, FALSE)
+#undef CLI_COMPLETE
+#undef CLI_COMMAND
+
+#define CLI_COMMAND "sccp", "capture", "stop"
+#define CLI_COMPLETE SCCP_CLI_DEVICE_COMPLETER
+CLI_ENTRY(cli_capture_stop, sccp_cli_capture_stop, "Stop capturing device traffic", cli_capture_stop_usage, FALSE)
+#undef CLI_COMPLETE
+#undef CLI_COMMAND
+
+#define CLI_COMMAND "sccp", "capture", "replay"
+#define CLI_COMPLETE SCCP_CLI_NULL_COMPLETER
+CLI_ENTRY(cli_capture_replay, sccp_cli_capture_replay, "Replay a traffic capture", cli_capture_replay_usage, FALSE)
+#undef CLI_COMPLETE
+#undef CLI_COMMAND
 #endif /* DOXYGEN_SHOULD_SKIP_THIS */
 
 /* --- Register Cli Entries-------------------------------------------------------------------------------------------- */
@@ -4074,14 +4328,20 @@ static struct pbx_cli_entry cli_entries[] = {
 	AST_CLI_DEFINE(cli_remove_line_from_device, "Remove a line from a device."),
 	AST_CLI_DEFINE(cli_add_line_to_device, "Add a line to a device."),
 	AST_CLI_DEFINE(cli_show_sessions, "Show All SCCP Sessions."),
+	AST_CLI_DEFINE(cli_show_listeners, "Show listening sockets and accept threads."),
+	AST_CLI_DEFINE(cli_show_sendqueues, "Show outbound priority lanes per session."),
+	AST_CLI_DEFINE(cli_show_handshakes, "Show connection setup statistics."),
 	AST_CLI_DEFINE(cli_dnd_device, "Set DND on a device"),
 	AST_CLI_DEFINE(cli_callforward, "Set CallForward on a line"),
 	AST_CLI_DEFINE(cli_do_debug, "Enable SCCP debugging."),
 	AST_CLI_DEFINE(cli_no_debug, "Disable SCCP debugging."),
+	AST_CLI_DEFINE(cli_do_trace, "Set SCCP trace categories."),
+	AST_CLI_DEFINE(cli_show_trace, "Show SCCP trace ring."),
 	AST_CLI_DEFINE(cli_config_generate, "SCCP generate config file."),
 	AST_CLI_DEFINE(cli_reload, "SCCP module reload."),
 	AST_CLI_DEFINE(cli_reload_file, "SCCP module reload file."),
 	AST_CLI_DEFINE(cli_reload_force, "SCCP module reload force."),
+	AST_CLI_DEFINE(cli_reload_dryrun, "SCCP module reload dryrun."),
 	AST_CLI_DEFINE(cli_reload_device, "SCCP module reload device."),
 	AST_CLI_DEFINE(cli_reload_line, "SCCP module reload line."),
 	AST_CLI_DEFINE(cli_restart, "Restart an SCCP device"),
@@ -4096,6 +4356,12 @@ static struct pbx_cli_entry cli_entries[] = {
 	AST_CLI_DEFINE(cli_test, "Test message."),
 #endif
 	AST_CLI_DEFINE(cli_show_refcount, "Test message."),
+	AST_CLI_DEFINE(cli_show_message_stats, "Show per message-id statistics."),
+	AST_CLI_DEFINE(cli_show_call_stats, "Show call quality statistics."),
+	AST_CLI_DEFINE(cli_show_locks, "Show lock contention statistics."),
+	AST_CLI_DEFINE(cli_capture_start, "Start capturing device traffic."),
+	AST_CLI_DEFINE(cli_capture_stop, "Stop capturing device traffic."),
+	AST_CLI_DEFINE(cli_capture_replay, "Replay a traffic capture."),
 	AST_CLI_DEFINE(cli_tokenack, "Send Token Acknowledgement."),
 #ifdef CS_SCCP_CONFERENCE
 	AST_CLI_DEFINE(cli_show_conferences, "Show running SCCP Conferences."),
@@ -4138,6 +4404,9 @@ int sccp_register_cli(void)
 	res |= pbx_manager_register("SCCPShowLine", _MAN_REP_FLAGS, manager_show_line, "show line", ami_line_usage);
 	res |= pbx_manager_register("SCCPShowChannels", _MAN_REP_FLAGS, manager_show_channels, "show channels", ami_channels_usage);
 	res |= pbx_manager_register("SCCPShowSessions", _MAN_REP_FLAGS, manager_show_sessions, "show sessions", ami_sessions_usage);
+	res |= pbx_manager_register("SCCPShowListeners", _MAN_REP_FLAGS, manager_show_listeners, "show listeners", ami_listeners_usage);
+	res |= pbx_manager_register("SCCPShowSendQueues", _MAN_REP_FLAGS, manager_show_sendqueues, "show sendqueues", ami_sendqueues_usage);
+	res |= pbx_manager_register("SCCPShowHandshakes", _MAN_REP_FLAGS, manager_show_handshakes, "show handshakes", ami_handshakes_usage);
 	res |= pbx_manager_register("SCCPShowMWISubscriptions", _MAN_REP_FLAGS, manager_show_mwi_subscriptions, "show mwi subscriptions", ami_mwi_subscriptions_usage);
 	res |= pbx_manager_register("SCCPShowSoftkeySets", _MAN_REP_FLAGS, manager_show_softkeysets, "show softkey sets", ami_show_softkeysets_usage);
 	res |= pbx_manager_register("SCCPMessageDevices", _MAN_REP_FLAGS, manager_message_devices, "message devices", ami_message_devices_usage);
@@ -4151,6 +4420,9 @@ int sccp_register_cli(void)
 	res |= pbx_manager_register("SCCPShowHintLineStates", _MAN_REP_FLAGS, manager_show_hint_lineStates, "show hint lineStates", ami_show_hint_lineStates_usage);
 	res |= pbx_manager_register("SCCPShowHintSubscriptions", _MAN_REP_FLAGS, manager_show_hint_subscriptions, "show hint subscriptions", ami_show_hint_subscriptions_usage);
 	res |= pbx_manager_register("SCCPShowRefcount", _MAN_REP_FLAGS, manager_show_refcount, "show refcount", ami_show_refcount_usage);
+	res |= pbx_manager_register("SCCPShowMessageStats", _MAN_REP_FLAGS, manager_show_message_stats, "show message statistics", ami_show_message_stats_usage);
+	res |= pbx_manager_register("SCCPShowCallStats", _MAN_REP_FLAGS, manager_show_call_stats, "show call quality statistics", ami_show_call_stats_usage);
+	res |= pbx_manager_register("SCCPShowLocks", _MAN_REP_FLAGS, manager_show_locks, "show lock contention statistics", ami_show_locks_usage);
 
 	res |= iPbx.register_manager(answerCall1_command, _MAN_REP_FLAGS, manager_answercall, NULL, NULL);
 	res |= iPbx.register_manager(callForward_command, _MAN_REP_FLAGS, manager_callforward, NULL, NULL);
@@ -4177,6 +4449,9 @@ int sccp_unregister_cli(void)
 	res |= pbx_manager_unregister("SCCPShowLine");
 	res |= pbx_manager_unregister("SCCPShowChannels");
 	res |= pbx_manager_unregister("SCCPShowSessions");
+	res |= pbx_manager_unregister("SCCPShowListeners");
+	res |= pbx_manager_unregister("SCCPShowSendQueues");
+	res |= pbx_manager_unregister("SCCPShowHandshakes");
 	res |= pbx_manager_unregister("SCCPShowMWISubscriptions");
 	res |= pbx_manager_unregister("SCCPShowSoftkeySets");
 	res |= pbx_manager_unregister("SCCPMessageDevices");
@@ -4190,6 +4465,9 @@ int sccp_unregister_cli(void)
 	res |= pbx_manager_unregister("SCCPShowHintLineStates");
 	res |= pbx_manager_unregister("SCCPShowHintSubscriptions");
 	res |= pbx_manager_unregister("SCCPShowRefcount");
+	res |= pbx_manager_unregister("SCCPShowMessageStats");
+	res |= pbx_manager_unregister("SCCPShowCallStats");
+	res |= pbx_manager_unregister("SCCPShowLocks");
 
 	res |= pbx_manager_unregister(answerCall1_command);
 	res |= pbx_manager_unregister(callForward_command);
@@ -0,0 +1,581 @@
+/*!
+ * \file        sccp_codepage.c
+ * \brief       SCCP Codepage Conversion
+ * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *              See the LICENSE file at the top of the source tree.
+ *
+ * Pre-java phones do not understand UTF-8, so callerid, prompts and labels have to be converted to the configured
+ * phonecodepage. Pure ASCII strings are copied as is. For the common single-byte codepages (ISO8859-x, CP1250-1252) a
+ * precomputed table, sorted by unicode codepoint, maps every non-ASCII character directly to its byte. The tables are
+ * const, so conversion needs neither a lock nor an allocation. Characters not available in the codepage are replaced
+ * by '?'. Other codepages are still handled by iconv (see sccp_device.c).
+ */
+
+#include "config.h"
+#include "common.h"
+#include "sccp_codepage.h"
+
+SCCP_FILE_VERSION(__FILE__, "");
+
+#include "sccp_utils.h"
+
+#define SCCP_CODEPAGE_MAXALIASES 3
+#define SCCP_CODEPAGE_UNMAPPED '?'
+
+typedef struct sccp_codepage_map {
+	uint16_t ucs;
+	uint8_t chr;
+} sccp_codepage_map_t;
+
+struct sccp_codepage {
+	const char *name;
+	const char *aliases[SCCP_CODEPAGE_MAXALIASES];						/*!< uppercase, without separators */
+	const sccp_codepage_map_t *map;								/*!< sorted by ucs */
+	uint8_t size;
+};
+
+/* generated from the unicode.org mapping tables, entries 0x80-0xFF only, sorted by codepoint */
+static const sccp_codepage_map_t codepage_iso8859_1[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A1, 0xA1}, {0x00A2, 0xA2}, {0x00A3, 0xA3}, {0x00A4, 0xA4}, {0x00A5, 0xA5}, {0x00A6, 0xA6}, {0x00A7, 0xA7},
+	{0x00A8, 0xA8}, {0x00A9, 0xA9}, {0x00AA, 0xAA}, {0x00AB, 0xAB}, {0x00AC, 0xAC}, {0x00AD, 0xAD}, {0x00AE, 0xAE}, {0x00AF, 0xAF},
+	{0x00B0, 0xB0}, {0x00B1, 0xB1}, {0x00B2, 0xB2}, {0x00B3, 0xB3}, {0x00B4, 0xB4}, {0x00B5, 0xB5}, {0x00B6, 0xB6}, {0x00B7, 0xB7},
+	{0x00B8, 0xB8}, {0x00B9, 0xB9}, {0x00BA, 0xBA}, {0x00BB, 0xBB}, {0x00BC, 0xBC}, {0x00BD, 0xBD}, {0x00BE, 0xBE}, {0x00BF, 0xBF},
+	{0x00C0, 0xC0}, {0x00C1, 0xC1}, {0x00C2, 0xC2}, {0x00C3, 0xC3}, {0x00C4, 0xC4}, {0x00C5, 0xC5}, {0x00C6, 0xC6}, {0x00C7, 0xC7},
+	{0x00C8, 0xC8}, {0x00C9, 0xC9}, {0x00CA, 0xCA}, {0x00CB, 0xCB}, {0x00CC, 0xCC}, {0x00CD, 0xCD}, {0x00CE, 0xCE}, {0x00CF, 0xCF},
+	{0x00D0, 0xD0}, {0x00D1, 0xD1}, {0x00D2, 0xD2}, {0x00D3, 0xD3}, {0x00D4, 0xD4}, {0x00D5, 0xD5}, {0x00D6, 0xD6}, {0x00D7, 0xD7},
+	{0x00D8, 0xD8}, {0x00D9, 0xD9}, {0x00DA, 0xDA}, {0x00DB, 0xDB}, {0x00DC, 0xDC}, {0x00DD, 0xDD}, {0x00DE, 0xDE}, {0x00DF, 0xDF},
+	{0x00E0, 0xE0}, {0x00E1, 0xE1}, {0x00E2, 0xE2}, {0x00E3, 0xE3}, {0x00E4, 0xE4}, {0x00E5, 0xE5}, {0x00E6, 0xE6}, {0x00E7, 0xE7},
+	{0x00E8, 0xE8}, {0x00E9, 0xE9}, {0x00EA, 0xEA}, {0x00EB, 0xEB}, {0x00EC, 0xEC}, {0x00ED, 0xED}, {0x00EE, 0xEE}, {0x00EF, 0xEF},
+	{0x00F0, 0xF0}, {0x00F1, 0xF1}, {0x00F2, 0xF2}, {0x00F3, 0xF3}, {0x00F4, 0xF4}, {0x00F5, 0xF5}, {0x00F6, 0xF6}, {0x00F7, 0xF7},
+	{0x00F8, 0xF8}, {0x00F9, 0xF9}, {0x00FA, 0xFA}, {0x00FB, 0xFB}, {0x00FC, 0xFC}, {0x00FD, 0xFD}, {0x00FE, 0xFE}, {0x00FF, 0xFF},
+};
+
+static const sccp_codepage_map_t codepage_iso8859_2[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A4, 0xA4}, {0x00A7, 0xA7}, {0x00A8, 0xA8}, {0x00AD, 0xAD}, {0x00B0, 0xB0}, {0x00B4, 0xB4}, {0x00B8, 0xB8},
+	{0x00C1, 0xC1}, {0x00C2, 0xC2}, {0x00C4, 0xC4}, {0x00C7, 0xC7}, {0x00C9, 0xC9}, {0x00CB, 0xCB}, {0x00CD, 0xCD}, {0x00CE, 0xCE},
+	{0x00D3, 0xD3}, {0x00D4, 0xD4}, {0x00D6, 0xD6}, {0x00D7, 0xD7}, {0x00DA, 0xDA}, {0x00DC, 0xDC}, {0x00DD, 0xDD}, {0x00DF, 0xDF},
+	{0x00E1, 0xE1}, {0x00E2, 0xE2}, {0x00E4, 0xE4}, {0x00E7, 0xE7}, {0x00E9, 0xE9}, {0x00EB, 0xEB}, {0x00ED, 0xED}, {0x00EE, 0xEE},
+	{0x00F3, 0xF3}, {0x00F4, 0xF4}, {0x00F6, 0xF6}, {0x00F7, 0xF7}, {0x00FA, 0xFA}, {0x00FC, 0xFC}, {0x00FD, 0xFD}, {0x0102, 0xC3},
+	{0x0103, 0xE3}, {0x0104, 0xA1}, {0x0105, 0xB1}, {0x0106, 0xC6}, {0x0107, 0xE6}, {0x010C, 0xC8}, {0x010D, 0xE8}, {0x010E, 0xCF},
+	{0x010F, 0xEF}, {0x0110, 0xD0}, {0x0111, 0xF0}, {0x0118, 0xCA}, {0x0119, 0xEA}, {0x011A, 0xCC}, {0x011B, 0xEC}, {0x0139, 0xC5},
+	{0x013A, 0xE5}, {0x013D, 0xA5}, {0x013E, 0xB5}, {0x0141, 0xA3}, {0x0142, 0xB3}, {0x0143, 0xD1}, {0x0144, 0xF1}, {0x0147, 0xD2},
+	{0x0148, 0xF2}, {0x0150, 0xD5}, {0x0151, 0xF5}, {0x0154, 0xC0}, {0x0155, 0xE0}, {0x0158, 0xD8}, {0x0159, 0xF8}, {0x015A, 0xA6},
+	{0x015B, 0xB6}, {0x015E, 0xAA}, {0x015F, 0xBA}, {0x0160, 0xA9}, {0x0161, 0xB9}, {0x0162, 0xDE}, {0x0163, 0xFE}, {0x0164, 0xAB},
+	{0x0165, 0xBB}, {0x016E, 0xD9}, {0x016F, 0xF9}, {0x0170, 0xDB}, {0x0171, 0xFB}, {0x0179, 0xAC}, {0x017A, 0xBC}, {0x017B, 0xAF},
+	{0x017C, 0xBF}, {0x017D, 0xAE}, {0x017E, 0xBE}, {0x02C7, 0xB7}, {0x02D8, 0xA2}, {0x02D9, 0xFF}, {0x02DB, 0xB2}, {0x02DD, 0xBD},
+};
+
+static const sccp_codepage_map_t codepage_iso8859_3[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A3, 0xA3}, {0x00A4, 0xA4}, {0x00A7, 0xA7}, {0x00A8, 0xA8}, {0x00AD, 0xAD}, {0x00B0, 0xB0}, {0x00B2, 0xB2},
+	{0x00B3, 0xB3}, {0x00B4, 0xB4}, {0x00B5, 0xB5}, {0x00B7, 0xB7}, {0x00B8, 0xB8}, {0x00BD, 0xBD}, {0x00C0, 0xC0}, {0x00C1, 0xC1},
+	{0x00C2, 0xC2}, {0x00C4, 0xC4}, {0x00C7, 0xC7}, {0x00C8, 0xC8}, {0x00C9, 0xC9}, {0x00CA, 0xCA}, {0x00CB, 0xCB}, {0x00CC, 0xCC},
+	{0x00CD, 0xCD}, {0x00CE, 0xCE}, {0x00CF, 0xCF}, {0x00D1, 0xD1}, {0x00D2, 0xD2}, {0x00D3, 0xD3}, {0x00D4, 0xD4}, {0x00D6, 0xD6},
+	{0x00D7, 0xD7}, {0x00D9, 0xD9}, {0x00DA, 0xDA}, {0x00DB, 0xDB}, {0x00DC, 0xDC}, {0x00DF, 0xDF}, {0x00E0, 0xE0}, {0x00E1, 0xE1},
+	{0x00E2, 0xE2}, {0x00E4, 0xE4}, {0x00E7, 0xE7}, {0x00E8, 0xE8}, {0x00E9, 0xE9}, {0x00EA, 0xEA}, {0x00EB, 0xEB}, {0x00EC, 0xEC},
+	{0x00ED, 0xED}, {0x00EE, 0xEE}, {0x00EF, 0xEF}, {0x00F1, 0xF1}, {0x00F2, 0xF2}, {0x00F3, 0xF3}, {0x00F4, 0xF4}, {0x00F6, 0xF6},
+	{0x00F7, 0xF7}, {0x00F9, 0xF9}, {0x00FA, 0xFA}, {0x00FB, 0xFB}, {0x00FC, 0xFC}, {0x0108, 0xC6}, {0x0109, 0xE6}, {0x010A, 0xC5},
+	{0x010B, 0xE5}, {0x011C, 0xD8}, {0x011D, 0xF8}, {0x011E, 0xAB}, {0x011F, 0xBB}, {0x0120, 0xD5}, {0x0121, 0xF5}, {0x0124, 0xA6},
+	{0x0125, 0xB6}, {0x0126, 0xA1}, {0x0127, 0xB1}, {0x0130, 0xA9}, {0x0131, 0xB9}, {0x0134, 0xAC}, {0x0135, 0xBC}, {0x015C, 0xDE},
+	{0x015D, 0xFE}, {0x015E, 0xAA}, {0x015F, 0xBA}, {0x016C, 0xDD}, {0x016D, 0xFD}, {0x017B, 0xAF}, {0x017C, 0xBF}, {0x02D8, 0xA2},
+	{0x02D9, 0xFF},
+};
+
+static const sccp_codepage_map_t codepage_iso8859_4[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A4, 0xA4}, {0x00A7, 0xA7}, {0x00A8, 0xA8}, {0x00AD, 0xAD}, {0x00AF, 0xAF}, {0x00B0, 0xB0}, {0x00B4, 0xB4},
+	{0x00B8, 0xB8}, {0x00C1, 0xC1}, {0x00C2, 0xC2}, {0x00C3, 0xC3}, {0x00C4, 0xC4}, {0x00C5, 0xC5}, {0x00C6, 0xC6}, {0x00C9, 0xC9},
+	{0x00CB, 0xCB}, {0x00CD, 0xCD}, {0x00CE, 0xCE}, {0x00D4, 0xD4}, {0x00D5, 0xD5}, {0x00D6, 0xD6}, {0x00D7, 0xD7}, {0x00D8, 0xD8},
+	{0x00DA, 0xDA}, {0x00DB, 0xDB}, {0x00DC, 0xDC}, {0x00DF, 0xDF}, {0x00E1, 0xE1}, {0x00E2, 0xE2}, {0x00E3, 0xE3}, {0x00E4, 0xE4},
+	{0x00E5, 0xE5}, {0x00E6, 0xE6}, {0x00E9, 0xE9}, {0x00EB, 0xEB}, {0x00ED, 0xED}, {0x00EE, 0xEE}, {0x00F4, 0xF4}, {0x00F5, 0xF5},
+	{0x00F6, 0xF6}, {0x00F7, 0xF7}, {0x00F8, 0xF8}, {0x00FA, 0xFA}, {0x00FB, 0xFB}, {0x00FC, 0xFC}, {0x0100, 0xC0}, {0x0101, 0xE0},
+	{0x0104, 0xA1}, {0x0105, 0xB1}, {0x010C, 0xC8}, {0x010D, 0xE8}, {0x0110, 0xD0}, {0x0111, 0xF0}, {0x0112, 0xAA}, {0x0113, 0xBA},
+	{0x0116, 0xCC}, {0x0117, 0xEC}, {0x0118, 0xCA}, {0x0119, 0xEA}, {0x0122, 0xAB}, {0x0123, 0xBB}, {0x0128, 0xA5}, {0x0129, 0xB5},
+	{0x012A, 0xCF}, {0x012B, 0xEF}, {0x012E, 0xC7}, {0x012F, 0xE7}, {0x0136, 0xD3}, {0x0137, 0xF3}, {0x0138, 0xA2}, {0x013B, 0xA6},
+	{0x013C, 0xB6}, {0x0145, 0xD1}, {0x0146, 0xF1}, {0x014A, 0xBD}, {0x014B, 0xBF}, {0x014C, 0xD2}, {0x014D, 0xF2}, {0x0156, 0xA3},
+	{0x0157, 0xB3}, {0x0160, 0xA9}, {0x0161, 0xB9}, {0x0166, 0xAC}, {0x0167, 0xBC}, {0x0168, 0xDD}, {0x0169, 0xFD}, {0x016A, 0xDE},
+	{0x016B, 0xFE}, {0x0172, 0xD9}, {0x0173, 0xF9}, {0x017D, 0xAE}, {0x017E, 0xBE}, {0x02C7, 0xB7}, {0x02D9, 0xFF}, {0x02DB, 0xB2},
+};
+
+static const sccp_codepage_map_t codepage_iso8859_5[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A7, 0xFD}, {0x00AD, 0xAD}, {0x0401, 0xA1}, {0x0402, 0xA2}, {0x0403, 0xA3}, {0x0404, 0xA4}, {0x0405, 0xA5},
+	{0x0406, 0xA6}, {0x0407, 0xA7}, {0x0408, 0xA8}, {0x0409, 0xA9}, {0x040A, 0xAA}, {0x040B, 0xAB}, {0x040C, 0xAC}, {0x040E, 0xAE},
+	{0x040F, 0xAF}, {0x0410, 0xB0}, {0x0411, 0xB1}, {0x0412, 0xB2}, {0x0413, 0xB3}, {0x0414, 0xB4}, {0x0415, 0xB5}, {0x0416, 0xB6},
+	{0x0417, 0xB7}, {0x0418, 0xB8}, {0x0419, 0xB9}, {0x041A, 0xBA}, {0x041B, 0xBB}, {0x041C, 0xBC}, {0x041D, 0xBD}, {0x041E, 0xBE},
+	{0x041F, 0xBF}, {0x0420, 0xC0}, {0x0421, 0xC1}, {0x0422, 0xC2}, {0x0423, 0xC3}, {0x0424, 0xC4}, {0x0425, 0xC5}, {0x0426, 0xC6},
+	{0x0427, 0xC7}, {0x0428, 0xC8}, {0x0429, 0xC9}, {0x042A, 0xCA}, {0x042B, 0xCB}, {0x042C, 0xCC}, {0x042D, 0xCD}, {0x042E, 0xCE},
+	{0x042F, 0xCF}, {0x0430, 0xD0}, {0x0431, 0xD1}, {0x0432, 0xD2}, {0x0433, 0xD3}, {0x0434, 0xD4}, {0x0435, 0xD5}, {0x0436, 0xD6},
+	{0x0437, 0xD7}, {0x0438, 0xD8}, {0x0439, 0xD9}, {0x043A, 0xDA}, {0x043B, 0xDB}, {0x043C, 0xDC}, {0x043D, 0xDD}, {0x043E, 0xDE},
+	{0x043F, 0xDF}, {0x0440, 0xE0}, {0x0441, 0xE1}, {0x0442, 0xE2}, {0x0443, 0xE3}, {0x0444, 0xE4}, {0x0445, 0xE5}, {0x0446, 0xE6},
+	{0x0447, 0xE7}, {0x0448, 0xE8}, {0x0449, 0xE9}, {0x044A, 0xEA}, {0x044B, 0xEB}, {0x044C, 0xEC}, {0x044D, 0xED}, {0x044E, 0xEE},
+	{0x044F, 0xEF}, {0x0451, 0xF1}, {0x0452, 0xF2}, {0x0453, 0xF3}, {0x0454, 0xF4}, {0x0455, 0xF5}, {0x0456, 0xF6}, {0x0457, 0xF7},
+	{0x0458, 0xF8}, {0x0459, 0xF9}, {0x045A, 0xFA}, {0x045B, 0xFB}, {0x045C, 0xFC}, {0x045E, 0xFE}, {0x045F, 0xFF}, {0x2116, 0xF0},
+};
+
+static const sccp_codepage_map_t codepage_iso8859_7[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A3, 0xA3}, {0x00A6, 0xA6}, {0x00A7, 0xA7}, {0x00A8, 0xA8}, {0x00A9, 0xA9}, {0x00AB, 0xAB}, {0x00AC, 0xAC},
+	{0x00AD, 0xAD}, {0x00B0, 0xB0}, {0x00B1, 0xB1}, {0x00B2, 0xB2}, {0x00B3, 0xB3}, {0x00B7, 0xB7}, {0x00BB, 0xBB}, {0x00BD, 0xBD},
+	{0x037A, 0xAA}, {0x0384, 0xB4}, {0x0385, 0xB5}, {0x0386, 0xB6}, {0x0388, 0xB8}, {0x0389, 0xB9}, {0x038A, 0xBA}, {0x038C, 0xBC},
+	{0x038E, 0xBE}, {0x038F, 0xBF}, {0x0390, 0xC0}, {0x0391, 0xC1}, {0x0392, 0xC2}, {0x0393, 0xC3}, {0x0394, 0xC4}, {0x0395, 0xC5},
+	{0x0396, 0xC6}, {0x0397, 0xC7}, {0x0398, 0xC8}, {0x0399, 0xC9}, {0x039A, 0xCA}, {0x039B, 0xCB}, {0x039C, 0xCC}, {0x039D, 0xCD},
+	{0x039E, 0xCE}, {0x039F, 0xCF}, {0x03A0, 0xD0}, {0x03A1, 0xD1}, {0x03A3, 0xD3}, {0x03A4, 0xD4}, {0x03A5, 0xD5}, {0x03A6, 0xD6},
+	{0x03A7, 0xD7}, {0x03A8, 0xD8}, {0x03A9, 0xD9}, {0x03AA, 0xDA}, {0x03AB, 0xDB}, {0x03AC, 0xDC}, {0x03AD, 0xDD}, {0x03AE, 0xDE},
+	{0x03AF, 0xDF}, {0x03B0, 0xE0}, {0x03B1, 0xE1}, {0x03B2, 0xE2}, {0x03B3, 0xE3}, {0x03B4, 0xE4}, {0x03B5, 0xE5}, {0x03B6, 0xE6},
+	{0x03B7, 0xE7}, {0x03B8, 0xE8}, {0x03B9, 0xE9}, {0x03BA, 0xEA}, {0x03BB, 0xEB}, {0x03BC, 0xEC}, {0x03BD, 0xED}, {0x03BE, 0xEE},
+	{0x03BF, 0xEF}, {0x03C0, 0xF0}, {0x03C1, 0xF1}, {0x03C2, 0xF2}, {0x03C3, 0xF3}, {0x03C4, 0xF4}, {0x03C5, 0xF5}, {0x03C6, 0xF6},
+	{0x03C7, 0xF7}, {0x03C8, 0xF8}, {0x03C9, 0xF9}, {0x03CA, 0xFA}, {0x03CB, 0xFB}, {0x03CC, 0xFC}, {0x03CD, 0xFD}, {0x03CE, 0xFE},
+	{0x2015, 0xAF}, {0x2018, 0xA1}, {0x2019, 0xA2}, {0x20AC, 0xA4}, {0x20AF, 0xA5},
+};
+
+static const sccp_codepage_map_t codepage_iso8859_9[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A1, 0xA1}, {0x00A2, 0xA2}, {0x00A3, 0xA3}, {0x00A4, 0xA4}, {0x00A5, 0xA5}, {0x00A6, 0xA6}, {0x00A7, 0xA7},
+	{0x00A8, 0xA8}, {0x00A9, 0xA9}, {0x00AA, 0xAA}, {0x00AB, 0xAB}, {0x00AC, 0xAC}, {0x00AD, 0xAD}, {0x00AE, 0xAE}, {0x00AF, 0xAF},
+	{0x00B0, 0xB0}, {0x00B1, 0xB1}, {0x00B2, 0xB2}, {0x00B3, 0xB3}, {0x00B4, 0xB4}, {0x00B5, 0xB5}, {0x00B6, 0xB6}, {0x00B7, 0xB7},
+	{0x00B8, 0xB8}, {0x00B9, 0xB9}, {0x00BA, 0xBA}, {0x00BB, 0xBB}, {0x00BC, 0xBC}, {0x00BD, 0xBD}, {0x00BE, 0xBE}, {0x00BF, 0xBF},
+	{0x00C0, 0xC0}, {0x00C1, 0xC1}, {0x00C2, 0xC2}, {0x00C3, 0xC3}, {0x00C4, 0xC4}, {0x00C5, 0xC5}, {0x00C6, 0xC6}, {0x00C7, 0xC7},
+	{0x00C8, 0xC8}, {0x00C9, 0xC9}, {0x00CA, 0xCA}, {0x00CB, 0xCB}, {0x00CC, 0xCC}, {0x00CD, 0xCD}, {0x00CE, 0xCE}, {0x00CF, 0xCF},
+	{0x00D1, 0xD1}, {0x00D2, 0xD2}, {0x00D3, 0xD3}, {0x00D4, 0xD4}, {0x00D5, 0xD5}, {0x00D6, 0xD6}, {0x00D7, 0xD7}, {0x00D8, 0xD8},
+	{0x00D9, 0xD9}, {0x00DA, 0xDA}, {0x00DB, 0xDB}, {0x00DC, 0xDC}, {0x00DF, 0xDF}, {0x00E0, 0xE0}, {0x00E1, 0xE1}, {0x00E2, 0xE2},
+	{0x00E3, 0xE3}, {0x00E4, 0xE4}, {0x00E5, 0xE5}, {0x00E6, 0xE6}, {0x00E7, 0xE7}, {0x00E8, 0xE8}, {0x00E9, 0xE9}, {0x00EA, 0xEA},
+	{0x00EB, 0xEB}, {0x00EC, 0xEC}, {0x00ED, 0xED}, {0x00EE, 0xEE}, {0x00EF, 0xEF}, {0x00F1, 0xF1}, {0x00F2, 0xF2}, {0x00F3, 0xF3},
+	{0x00F4, 0xF4}, {0x00F5, 0xF5}, {0x00F6, 0xF6}, {0x00F7, 0xF7}, {0x00F8, 0xF8}, {0x00F9, 0xF9}, {0x00FA, 0xFA}, {0x00FB, 0xFB},
+	{0x00FC, 0xFC}, {0x00FF, 0xFF}, {0x011E, 0xD0}, {0x011F, 0xF0}, {0x0130, 0xDD}, {0x0131, 0xFD}, {0x015E, 0xDE}, {0x015F, 0xFE},
+};
+
+static const sccp_codepage_map_t codepage_iso8859_13[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A2, 0xA2}, {0x00A3, 0xA3}, {0x00A4, 0xA4}, {0x00A6, 0xA6}, {0x00A7, 0xA7}, {0x00A9, 0xA9}, {0x00AB, 0xAB},
+	{0x00AC, 0xAC}, {0x00AD, 0xAD}, {0x00AE, 0xAE}, {0x00B0, 0xB0}, {0x00B1, 0xB1}, {0x00B2, 0xB2}, {0x00B3, 0xB3}, {0x00B5, 0xB5},
+	{0x00B6, 0xB6}, {0x00B7, 0xB7}, {0x00B9, 0xB9}, {0x00BB, 0xBB}, {0x00BC, 0xBC}, {0x00BD, 0xBD}, {0x00BE, 0xBE}, {0x00C4, 0xC4},
+	{0x00C5, 0xC5}, {0x00C6, 0xAF}, {0x00C9, 0xC9}, {0x00D3, 0xD3}, {0x00D5, 0xD5}, {0x00D6, 0xD6}, {0x00D7, 0xD7}, {0x00D8, 0xA8},
+	{0x00DC, 0xDC}, {0x00DF, 0xDF}, {0x00E4, 0xE4}, {0x00E5, 0xE5}, {0x00E6, 0xBF}, {0x00E9, 0xE9}, {0x00F3, 0xF3}, {0x00F5, 0xF5},
+	{0x00F6, 0xF6}, {0x00F7, 0xF7}, {0x00F8, 0xB8}, {0x00FC, 0xFC}, {0x0100, 0xC2}, {0x0101, 0xE2}, {0x0104, 0xC0}, {0x0105, 0xE0},
+	{0x0106, 0xC3}, {0x0107, 0xE3}, {0x010C, 0xC8}, {0x010D, 0xE8}, {0x0112, 0xC7}, {0x0113, 0xE7}, {0x0116, 0xCB}, {0x0117, 0xEB},
+	{0x0118, 0xC6}, {0x0119, 0xE6}, {0x0122, 0xCC}, {0x0123, 0xEC}, {0x012A, 0xCE}, {0x012B, 0xEE}, {0x012E, 0xC1}, {0x012F, 0xE1},
+	{0x0136, 0xCD}, {0x0137, 0xED}, {0x013B, 0xCF}, {0x013C, 0xEF}, {0x0141, 0xD9}, {0x0142, 0xF9}, {0x0143, 0xD1}, {0x0144, 0xF1},
+	{0x0145, 0xD2}, {0x0146, 0xF2}, {0x014C, 0xD4}, {0x014D, 0xF4}, {0x0156, 0xAA}, {0x0157, 0xBA}, {0x015A, 0xDA}, {0x015B, 0xFA},
+	{0x0160, 0xD0}, {0x0161, 0xF0}, {0x016A, 0xDB}, {0x016B, 0xFB}, {0x0172, 0xD8}, {0x0173, 0xF8}, {0x0179, 0xCA}, {0x017A, 0xEA},
+	{0x017B, 0xDD}, {0x017C, 0xFD}, {0x017D, 0xDE}, {0x017E, 0xFE}, {0x2019, 0xFF}, {0x201C, 0xB4}, {0x201D, 0xA1}, {0x201E, 0xA5},
+};
+
+static const sccp_codepage_map_t codepage_iso8859_15[] = {
+	{0x0080, 0x80}, {0x0081, 0x81}, {0x0082, 0x82}, {0x0083, 0x83}, {0x0084, 0x84}, {0x0085, 0x85}, {0x0086, 0x86}, {0x0087, 0x87},
+	{0x0088, 0x88}, {0x0089, 0x89}, {0x008A, 0x8A}, {0x008B, 0x8B}, {0x008C, 0x8C}, {0x008D, 0x8D}, {0x008E, 0x8E}, {0x008F, 0x8F},
+	{0x0090, 0x90}, {0x0091, 0x91}, {0x0092, 0x92}, {0x0093, 0x93}, {0x0094, 0x94}, {0x0095, 0x95}, {0x0096, 0x96}, {0x0097, 0x97},
+	{0x0098, 0x98}, {0x0099, 0x99}, {0x009A, 0x9A}, {0x009B, 0x9B}, {0x009C, 0x9C}, {0x009D, 0x9D}, {0x009E, 0x9E}, {0x009F, 0x9F},
+	{0x00A0, 0xA0}, {0x00A1, 0xA1}, {0x00A2, 0xA2}, {0x00A3, 0xA3}, {0x00A5, 0xA5}, {0x00A7, 0xA7}, {0x00A9, 0xA9}, {0x00AA, 0xAA},
+	{0x00AB, 0xAB}, {0x00AC, 0xAC}, {0x00AD, 0xAD}, {0x00AE, 0xAE}, {0x00AF, 0xAF}, {0x00B0, 0xB0}, {0x00B1, 0xB1}, {0x00B2, 0xB2},
+	{0x00B3, 0xB3}, {0x00B5, 0xB5}, {0x00B6, 0xB6}, {0x00B7, 0xB7}, {0x00B9, 0xB9}, {0x00BA, 0xBA}, {0x00BB, 0xBB}, {0x00BF, 0xBF},
+	{0x00C0, 0xC0}, {0x00C1, 0xC1}, {0x00C2, 0xC2}, {0x00C3, 0xC3}, {0x00C4, 0xC4}, {0x00C5, 0xC5}, {0x00C6, 0xC6}, {0x00C7, 0xC7},
+	{0x00C8, 0xC8}, {0x00C9, 0xC9}, {0x00CA, 0xCA}, {0x00CB, 0xCB}, {0x00CC, 0xCC}, {0x00CD, 0xCD}, {0x00CE, 0xCE}, {0x00CF, 0xCF},
+	{0x00D0, 0xD0}, {0x00D1, 0xD1}, {0x00D2, 0xD2}, {0x00D3, 0xD3}, {0x00D4, 0xD4}, {0x00D5, 0xD5}, {0x00D6, 0xD6}, {0x00D7, 0xD7},
+	{0x00D8, 0xD8}, {0x00D9, 0xD9}, {0x00DA, 0xDA}, {0x00DB, 0xDB}, {0x00DC, 0xDC}, {0x00DD, 0xDD}, {0x00DE, 0xDE}, {0x00DF, 0xDF},
+	{0x00E0, 0xE0}, {0x00E1, 0xE1}, {0x00E2, 0xE2}, {0x00E3, 0xE3}, {0x00E4, 0xE4}, {0x00E5, 0xE5}, {0x00E6, 0xE6}, {0x00E7, 0xE7},
+	{0x00E8, 0xE8}, {0x00E9, 0xE9}, {0x00EA, 0xEA}, {0x00EB, 0xEB}, {0x00EC, 0xEC}, {0x00ED, 0xED}, {0x00EE, 0xEE}, {0x00EF, 0xEF},
+	{0x00F0, 0xF0}, {0x00F1, 0xF1}, {0x00F2, 0xF2}, {0x00F3, 0xF3}, {0x00F4, 0xF4}, {0x00F5, 0xF5}, {0x00F6, 0xF6}, {0x00F7, 0xF7},
+	{0x00F8, 0xF8}, {0x00F9, 0xF9}, {0x00FA, 0xFA}, {0x00FB, 0xFB}, {0x00FC, 0xFC}, {0x00FD, 0xFD}, {0x00FE, 0xFE}, {0x00FF, 0xFF},
+	{0x0152, 0xBC}, {0x0153, 0xBD}, {0x0160, 0xA6}, {0x0161, 0xA8}, {0x0178, 0xBE}, {0x017D, 0xB4}, {0x017E, 0xB8}, {0x20AC, 0xA4},
+};
+
+static const sccp_codepage_map_t codepage_cp1250[] = {
+	{0x00A0, 0xA0}, {0x00A4, 0xA4}, {0x00A6, 0xA6}, {0x00A7, 0xA7}, {0x00A8, 0xA8}, {0x00A9, 0xA9}, {0x00AB, 0xAB}, {0x00AC, 0xAC},
+	{0x00AD, 0xAD}, {0x00AE, 0xAE}, {0x00B0, 0xB0}, {0x00B1, 0xB1}, {0x00B4, 0xB4}, {0x00B5, 0xB5}, {0x00B6, 0xB6}, {0x00B7, 0xB7},
+	{0x00B8, 0xB8}, {0x00BB, 0xBB}, {0x00C1, 0xC1}, {0x00C2, 0xC2}, {0x00C4, 0xC4}, {0x00C7, 0xC7}, {0x00C9, 0xC9}, {0x00CB, 0xCB},
+	{0x00CD, 0xCD}, {0x00CE, 0xCE}, {0x00D3, 0xD3}, {0x00D4, 0xD4}, {0x00D6, 0xD6}, {0x00D7, 0xD7}, {0x00DA, 0xDA}, {0x00DC, 0xDC},
+	{0x00DD, 0xDD}, {0x00DF, 0xDF}, {0x00E1, 0xE1}, {0x00E2, 0xE2}, {0x00E4, 0xE4}, {0x00E7, 0xE7}, {0x00E9, 0xE9}, {0x00EB, 0xEB},
+	{0x00ED, 0xED}, {0x00EE, 0xEE}, {0x00F3, 0xF3}, {0x00F4, 0xF4}, {0x00F6, 0xF6}, {0x00F7, 0xF7}, {0x00FA, 0xFA}, {0x00FC, 0xFC},
+	{0x00FD, 0xFD}, {0x0102, 0xC3}, {0x0103, 0xE3}, {0x0104, 0xA5}, {0x0105, 0xB9}, {0x0106, 0xC6}, {0x0107, 0xE6}, {0x010C, 0xC8},
+	{0x010D, 0xE8}, {0x010E, 0xCF}, {0x010F, 0xEF}, {0x0110, 0xD0}, {0x0111, 0xF0}, {0x0118, 0xCA}, {0x0119, 0xEA}, {0x011A, 0xCC},
+	{0x011B, 0xEC}, {0x0139, 0xC5}, {0x013A, 0xE5}, {0x013D, 0xBC}, {0x013E, 0xBE}, {0x0141, 0xA3}, {0x0142, 0xB3}, {0x0143, 0xD1},
+	{0x0144, 0xF1}, {0x0147, 0xD2}, {0x0148, 0xF2}, {0x0150, 0xD5}, {0x0151, 0xF5}, {0x0154, 0xC0}, {0x0155, 0xE0}, {0x0158, 0xD8},
+	{0x0159, 0xF8}, {0x015A, 0x8C}, {0x015B, 0x9C}, {0x015E, 0xAA}, {0x015F, 0xBA}, {0x0160, 0x8A}, {0x0161, 0x9A}, {0x0162, 0xDE},
+	{0x0163, 0xFE}, {0x0164, 0x8D}, {0x0165, 0x9D}, {0x016E, 0xD9}, {0x016F, 0xF9}, {0x0170, 0xDB}, {0x0171, 0xFB}, {0x0179, 0x8F},
+	{0x017A, 0x9F}, {0x017B, 0xAF}, {0x017C, 0xBF}, {0x017D, 0x8E}, {0x017E, 0x9E}, {0x02C7, 0xA1}, {0x02D8, 0xA2}, {0x02D9, 0xFF},
+	{0x02DB, 0xB2}, {0x02DD, 0xBD}, {0x2013, 0x96}, {0x2014, 0x97}, {0x2018, 0x91}, {0x2019, 0x92}, {0x201A, 0x82}, {0x201C, 0x93},
+	{0x201D, 0x94}, {0x201E, 0x84}, {0x2020, 0x86}, {0x2021, 0x87}, {0x2022, 0x95}, {0x2026, 0x85}, {0x2030, 0x89}, {0x2039, 0x8B},
+	{0x203A, 0x9B}, {0x20AC, 0x80}, {0x2122, 0x99},
+};
+
+static const sccp_codepage_map_t codepage_cp1251[] = {
+	{0x00A0, 0xA0}, {0x00A4, 0xA4}, {0x00A6, 0xA6}, {0x00A7, 0xA7}, {0x00A9, 0xA9}, {0x00AB, 0xAB}, {0x00AC, 0xAC}, {0x00AD, 0xAD},
+	{0x00AE, 0xAE}, {0x00B0, 0xB0}, {0x00B1, 0xB1}, {0x00B5, 0xB5}, {0x00B6, 0xB6}, {0x00B7, 0xB7}, {0x00BB, 0xBB}, {0x0401, 0xA8},
+	{0x0402, 0x80}, {0x0403, 0x81}, {0x0404, 0xAA}, {0x0405, 0xBD}, {0x0406, 0xB2}, {0x0407, 0xAF}, {0x0408, 0xA3}, {0x0409, 0x8A},
+	{0x040A, 0x8C}, {0x040B, 0x8E}, {0x040C, 0x8D}, {0x040E, 0xA1}, {0x040F, 0x8F}, {0x0410, 0xC0}, {0x0411, 0xC1}, {0x0412, 0xC2},
+	{0x0413, 0xC3}, {0x0414, 0xC4}, {0x0415, 0xC5}, {0x0416, 0xC6}, {0x0417, 0xC7}, {0x0418, 0xC8}, {0x0419, 0xC9}, {0x041A, 0xCA},
+	{0x041B, 0xCB}, {0x041C, 0xCC}, {0x041D, 0xCD}, {0x041E, 0xCE}, {0x041F, 0xCF}, {0x0420, 0xD0}, {0x0421, 0xD1}, {0x0422, 0xD2},
+	{0x0423, 0xD3}, {0x0424, 0xD4}, {0x0425, 0xD5}, {0x0426, 0xD6}, {0x0427, 0xD7}, {0x0428, 0xD8}, {0x0429, 0xD9}, {0x042A, 0xDA},
+	{0x042B, 0xDB}, {0x042C, 0xDC}, {0x042D, 0xDD}, {0x042E, 0xDE}, {0x042F, 0xDF}, {0x0430, 0xE0}, {0x0431, 0xE1}, {0x0432, 0xE2},
+	{0x0433, 0xE3}, {0x0434, 0xE4}, {0x0435, 0xE5}, {0x0436, 0xE6}, {0x0437, 0xE7}, {0x0438, 0xE8}, {0x0439, 0xE9}, {0x043A, 0xEA},
+	{0x043B, 0xEB}, {0x043C, 0xEC}, {0x043D, 0xED}, {0x043E, 0xEE}, {0x043F, 0xEF}, {0x0440, 0xF0}, {0x0441, 0xF1}, {0x0442, 0xF2},
+	{0x0443, 0xF3}, {0x0444, 0xF4}, {0x0445, 0xF5}, {0x0446, 0xF6}, {0x0447, 0xF7}, {0x0448, 0xF8}, {0x0449, 0xF9}, {0x044A, 0xFA},
+	{0x044B, 0xFB}, {0x044C, 0xFC}, {0x044D, 0xFD}, {0x044E, 0xFE}, {0x044F, 0xFF}, {0x0451, 0xB8}, {0x0452, 0x90}, {0x0453, 0x83},
+	{0x0454, 0xBA}, {0x0455, 0xBE}, {0x0456, 0xB3}, {0x0457, 0xBF}, {0x0458, 0xBC}, {0x0459, 0x9A}, {0x045A, 0x9C}, {0x045B, 0x9E},
+	{0x045C, 0x9D}, {0x045E, 0xA2}, {0x045F, 0x9F}, {0x0490, 0xA5}, {0x0491, 0xB4}, {0x2013, 0x96}, {0x2014, 0x97}, {0x2018, 0x91},
+	{0x2019, 0x92}, {0x201A, 0x82}, {0x201C, 0x93}, {0x201D, 0x94}, {0x201E, 0x84}, {0x2020, 0x86}, {0x2021, 0x87}, {0x2022, 0x95},
+	{0x2026, 0x85}, {0x2030, 0x89}, {0x2039, 0x8B}, {0x203A, 0x9B}, {0x20AC, 0x88}, {0x2116, 0xB9}, {0x2122, 0x99},
+};
+
+static const sccp_codepage_map_t codepage_cp1252[] = {
+	{0x00A0, 0xA0}, {0x00A1, 0xA1}, {0x00A2, 0xA2}, {0x00A3, 0xA3}, {0x00A4, 0xA4}, {0x00A5, 0xA5}, {0x00A6, 0xA6}, {0x00A7, 0xA7},
+	{0x00A8, 0xA8}, {0x00A9, 0xA9}, {0x00AA, 0xAA}, {0x00AB, 0xAB}, {0x00AC, 0xAC}, {0x00AD, 0xAD}, {0x00AE, 0xAE}, {0x00AF, 0xAF},
+	{0x00B0, 0xB0}, {0x00B1, 0xB1}, {0x00B2, 0xB2}, {0x00B3, 0xB3}, {0x00B4, 0xB4}, {0x00B5, 0xB5}, {0x00B6, 0xB6}, {0x00B7, 0xB7},
+	{0x00B8, 0xB8}, {0x00B9, 0xB9}, {0x00BA, 0xBA}, {0x00BB, 0xBB}, {0x00BC, 0xBC}, {0x00BD, 0xBD}, {0x00BE, 0xBE}, {0x00BF, 0xBF},
+	{0x00C0, 0xC0}, {0x00C1, 0xC1}, {0x00C2, 0xC2}, {0x00C3, 0xC3}, {0x00C4, 0xC4}, {0x00C5, 0xC5}, {0x00C6, 0xC6}, {0x00C7, 0xC7},
+	{0x00C8, 0xC8}, {0x00C9, 0xC9}, {0x00CA, 0xCA}, {0x00CB, 0xCB}, {0x00CC, 0xCC}, {0x00CD, 0xCD}, {0x00CE, 0xCE}, {0x00CF, 0xCF},
+	{0x00D0, 0xD0}, {0x00D1, 0xD1}, {0x00D2, 0xD2}, {0x00D3, 0xD3}, {0x00D4, 0xD4}, {0x00D5, 0xD5}, {0x00D6, 0xD6}, {0x00D7, 0xD7},
+	{0x00D8, 0xD8}, {0x00D9, 0xD9}, {0x00DA, 0xDA}, {0x00DB, 0xDB}, {0x00DC, 0xDC}, {0x00DD, 0xDD}, {0x00DE, 0xDE}, {0x00DF, 0xDF},
+	{0x00E0, 0xE0}, {0x00E1, 0xE1}, {0x00E2, 0xE2}, {0x00E3, 0xE3}, {0x00E4, 0xE4}, {0x00E5, 0xE5}, {0x00E6, 0xE6}, {0x00E7, 0xE7},
+	{0x00E8, 0xE8}, {0x00E9, 0xE9}, {0x00EA, 0xEA}, {0x00EB, 0xEB}, {0x00EC, 0xEC}, {0x00ED, 0xED}, {0x00EE, 0xEE}, {0x00EF, 0xEF},
+	{0x00F0, 0xF0}, {0x00F1, 0xF1}, {0x00F2, 0xF2}, {0x00F3, 0xF3}, {0x00F4, 0xF4}, {0x00F5, 0xF5}, {0x00F6, 0xF6}, {0x00F7, 0xF7},
+	{0x00F8, 0xF8}, {0x00F9, 0xF9}, {0x00FA, 0xFA}, {0x00FB, 0xFB}, {0x00FC, 0xFC}, {0x00FD, 0xFD}, {0x00FE, 0xFE}, {0x00FF, 0xFF},
+	{0x0152, 0x8C}, {0x0153, 0x9C}, {0x0160, 0x8A}, {0x0161, 0x9A}, {0x0178, 0x9F}, {0x017D, 0x8E}, {0x017E, 0x9E}, {0x0192, 0x83},
+	{0x02C6, 0x88}, {0x02DC, 0x98}, {0x2013, 0x96}, {0x2014, 0x97}, {0x2018, 0x91}, {0x2019, 0x92}, {0x201A, 0x82}, {0x201C, 0x93},
+	{0x201D, 0x94}, {0x201E, 0x84}, {0x2020, 0x86}, {0x2021, 0x87}, {0x2022, 0x95}, {0x2026, 0x85}, {0x2030, 0x89}, {0x2039, 0x8B},
+	{0x203A, 0x9B}, {0x20AC, 0x80}, {0x2122, 0x99},
+};
+
+static const sccp_codepage_t sccp_codepages[] = {
+	{"ISO8859-1", {"ISO88591", "LATIN1", "L1"}, codepage_iso8859_1, ARRAY_LEN(codepage_iso8859_1)},
+	{"ISO8859-2", {"ISO88592", "LATIN2", "L2"}, codepage_iso8859_2, ARRAY_LEN(codepage_iso8859_2)},
+	{"ISO8859-3", {"ISO88593", "LATIN3", "L3"}, codepage_iso8859_3, ARRAY_LEN(codepage_iso8859_3)},
+	{"ISO8859-4", {"ISO88594", "LATIN4", "L4"}, codepage_iso8859_4, ARRAY_LEN(codepage_iso8859_4)},
+	{"ISO8859-5", {"ISO88595", "CYRILLIC"}, codepage_iso8859_5, ARRAY_LEN(codepage_iso8859_5)},
+	{"ISO8859-7", {"ISO88597", "GREEK"}, codepage_iso8859_7, ARRAY_LEN(codepage_iso8859_7)},
+	{"ISO8859-9", {"ISO88599", "LATIN5", "L5"}, codepage_iso8859_9, ARRAY_LEN(codepage_iso8859_9)},
+	{"ISO8859-13", {"ISO885913", "LATIN7", "L7"}, codepage_iso8859_13, ARRAY_LEN(codepage_iso8859_13)},
+	{"ISO8859-15", {"ISO885915", "LATIN9", "L9"}, codepage_iso8859_15, ARRAY_LEN(codepage_iso8859_15)},
+	{"CP1250", {"CP1250", "WINDOWS1250"}, codepage_cp1250, ARRAY_LEN(codepage_cp1250)},
+	{"CP1251", {"CP1251", "WINDOWS1251"}, codepage_cp1251, ARRAY_LEN(codepage_cp1251)},
+	{"CP1252", {"CP1252", "WINDOWS1252"}, codepage_cp1252, ARRAY_LEN(codepage_cp1252)},
+};
+
+/*!
+ * \brief Find the direct conversion table for a codepage name
+ * \param name Codepage name as used by iconv (case and '-', '_', ' ' separators are ignored, an iconv "//" suffix is skipped)
+ * \return Codepage or NULL when there is no table for it (use iconv)
+ */
+const sccp_codepage_t *sccp_codepage_find(const char *name)
+{
+	char normalized[20] = "";
+	size_t len = 0;
+	uint8_t idx = 0;
+	uint8_t alias = 0;
+
+	if (sccp_strlen_zero(name)) {
+		return NULL;
+	}
+	for (; *name && len < sizeof(normalized) - 1; name++) {
+		if (*name == '/') {
+			break;
+		}
+		if (isalnum((unsigned char)*name)) {
+			normalized[len++] = toupper((unsigned char)*name);
+		}
+	}
+	normalized[len] = '\0';
+	for (idx = 0; idx < ARRAY_LEN(sccp_codepages); idx++) {
+		for (alias = 0; alias < SCCP_CODEPAGE_MAXALIASES && sccp_codepages[idx].aliases[alias]; alias++) {
+			if (sccp_strequals(normalized, sccp_codepages[idx].aliases[alias])) {
+				return &sccp_codepages[idx];
+			}
+		}
+	}
+	return NULL;
+}
+
+const char *sccp_codepage_name(const sccp_codepage_t * codepage)
+{
+	return codepage ? codepage->name : "";
+}
+
+/*!
+ * \brief Copy src to dst as long as it only contains ASCII
+ * \return TRUE when src was (up to dst_size - 1 bytes) pure ASCII, FALSE when a non-ASCII byte was found (dst is incomplete)
+ */
+boolean_t sccp_codepage_copyAscii(char *dst, const char *src, size_t dst_size)
+{
+	const unsigned char *in = (const unsigned char *)src;
+	size_t pos = 0;
+
+	if (!dst_size) {
+		return TRUE;
+	}
+	while (pos < dst_size - 1 && in[pos]) {
+		if (in[pos] & 0x80) {
+			dst[pos] = '\0';
+			return FALSE;
+		}
+		dst[pos] = in[pos];
+		pos++;
+	}
+	dst[pos] = '\0';
+	return TRUE;
+}
+
+static inline int codepage_lookup(const sccp_codepage_t * codepage, uint32_t ucs)
+{
+	int low = 0;
+	int high = codepage->size - 1;
+
+	while (low <= high) {
+		int mid = (low + high) / 2;
+		if (codepage->map[mid].ucs == ucs) {
+			return codepage->map[mid].chr;
+		} else if (codepage->map[mid].ucs < ucs) {
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	return SCCP_CODEPAGE_UNMAPPED;
+}
+
+/*!
+ * \brief Decode one UTF-8 sequence
+ * \return number of bytes consumed (at least 1), ucs is set to 0xFFFD for invalid sequences
+ */
+static inline int codepage_decodeUtf8(const unsigned char *in, uint32_t *ucs)
+{
+	int len = 0;
+	int idx = 0;
+
+	if (in[0] >= 0xC2 && in[0] <= 0xDF) {
+		len = 2;
+		*ucs = in[0] & 0x1F;
+	} else if (in[0] >= 0xE0 && in[0] <= 0xEF) {
+		len = 3;
+		*ucs = in[0] & 0x0F;
+	} else if (in[0] >= 0xF0 && in[0] <= 0xF4) {
+		len = 4;
+		*ucs = in[0] & 0x07;
+	} else {
+		*ucs = 0xFFFD;
+		return 1;
+	}
+	for (idx = 1; idx < len; idx++) {
+		if ((in[idx] & 0xC0) != 0x80) {								/* also stops at the terminating NUL */
+			*ucs = 0xFFFD;
+			return idx;
+		}
+		*ucs = (*ucs << 6) | (in[idx] & 0x3F);
+	}
+	return len;
+}
+
+/*!
+ * \brief Convert UTF-8 src into dst using a codepage table, dst is always terminated
+ */
+void sccp_codepage_convert(const sccp_codepage_t * codepage, char *dst, const char *src, size_t dst_size)
+{
+	const unsigned char *in = (const unsigned char *)src;
+	size_t pos = 0;
+	uint32_t ucs = 0;
+
+	if (!dst_size) {
+		return;
+	}
+	while (pos < dst_size - 1 && *in) {
+		if (!(*in & 0x80)) {
+			dst[pos++] = *in++;
+			continue;
+		}
+		in += codepage_decodeUtf8(in, &ucs);
+		dst[pos++] = codepage_lookup(codepage, ucs);
+	}
+	dst[pos] = '\0';
+}
+
+#if CS_TEST_FRAMEWORK
+#	include <asterisk/test.h>
+#	if HAVE_ICONV
+#		include <iconv.h>
+#	endif
+AST_TEST_DEFINE(sccp_codepage_convert_test)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "convert";
+			info->category = "/channels/chan_sccp/codepage/";
+			info->summary = "chan-sccp-b codepage conversion";
+			info->description = "Checks the direct UTF-8 to codepage conversion tables";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	char buf[20] = "";
+
+	pbx_test_status_update(test, "Find codepages\n");
+	pbx_test_validate(test, sccp_codepage_find("ISO8859-1") == sccp_codepage_find("iso-8859-1"));
+	pbx_test_validate(test, sccp_codepage_find("latin1") == sccp_codepage_find("ISO_8859-1"));
+	pbx_test_validate(test, sccp_strequals(sccp_codepage_name(sccp_codepage_find("windows-1252//TRANSLIT")), "CP1252"));
+	pbx_test_validate(test, sccp_codepage_find("UTF-8") == NULL);
+	pbx_test_validate(test, sccp_codepage_find("SHIFT_JIS") == NULL);
+
+	pbx_test_status_update(test, "ASCII fast path\n");
+	pbx_test_validate(test, sccp_codepage_copyAscii(buf, "Hello World", sizeof(buf)) && sccp_strequals(buf, "Hello World"));
+	pbx_test_validate(test, sccp_codepage_copyAscii(buf, "0123456789012345678901234", sizeof(buf)) && sccp_strlen(buf) == sizeof(buf) - 1);
+	pbx_test_validate(test, !sccp_codepage_copyAscii(buf, "Gr\xc3\xbc\xc3\x9f" "e", sizeof(buf)));
+
+	pbx_test_status_update(test, "Convert\n");
+	sccp_codepage_convert(sccp_codepage_find("CP1252"), buf, "Gr\xc3\xbc\xc3\x9f" "e \xe2\x82\xac", sizeof(buf));
+	pbx_test_validate(test, sccp_strequals(buf, "Gr\xfc\xdf" "e \x80"));
+	sccp_codepage_convert(sccp_codepage_find("ISO8859-1"), buf, "Gr\xc3\xbc\xc3\x9f" "e \xe2\x82\xac", sizeof(buf));
+	pbx_test_validate(test, sccp_strequals(buf, "Gr\xfc\xdf" "e ?"));
+	sccp_codepage_convert(sccp_codepage_find("ISO8859-15"), buf, "\xe2\x82\xac", sizeof(buf));
+	pbx_test_validate(test, sccp_strequals(buf, "\xa4"));
+	sccp_codepage_convert(sccp_codepage_find("CP1251"), buf, "\xd0\x9f\xd1\x80\xd0\xb8", sizeof(buf));		/* cyrillic "Pri" */
+	pbx_test_validate(test, sccp_strequals(buf, "\xcf\xf0\xe8"));
+	sccp_codepage_convert(sccp_codepage_find("CP1250"), buf, "\xc5\x81\xc3\xb3\x64\xc5\xba", sizeof(buf));		/* polish "Lodz" */
+	pbx_test_validate(test, sccp_strequals(buf, "\xa3\xf3" "d" "\x9f"));
+
+	pbx_test_status_update(test, "Invalid and truncated input\n");
+	sccp_codepage_convert(sccp_codepage_find("ISO8859-1"), buf, "a\xff" "b\xc3", sizeof(buf));
+	pbx_test_validate(test, sccp_strequals(buf, "a?b?"));
+	sccp_codepage_convert(sccp_codepage_find("ISO8859-1"), buf, "\xc3\xa4\xc3\xb6\xc3\xbc", 3);
+	pbx_test_validate(test, sccp_strequals(buf, "\xe4\xf6"));
+
+#if HAVE_ICONV
+	pbx_test_status_update(test, "Compare tables against iconv\n");
+	uint8_t idx = 0;
+	uint8_t entry = 0;
+	for (idx = 0; idx < ARRAY_LEN(sccp_codepages); idx++) {
+		const sccp_codepage_t *codepage = &sccp_codepages[idx];
+		iconv_t cd = iconv_open(codepage->name, "UTF-8");
+		if (cd == (iconv_t) -1) {
+			pbx_test_status_update(test, "iconv does not support %s, skipped\n", codepage->name);
+			continue;
+		}
+		for (entry = 0; entry < codepage->size; entry++) {
+			char utf8[4] = "";
+			char out[2] = "";
+			ICONV_CONST char *inptr = utf8;
+			char *outptr = out;
+			size_t incount = 0;
+			size_t outcount = 1;
+			uint16_t ucs = codepage->map[entry].ucs;
+
+			if (ucs < 0x800) {
+				utf8[0] = 0xC0 | (ucs >> 6);
+				utf8[1] = 0x80 | (ucs & 0x3F);
+				incount = 2;
+			} else {
+				utf8[0] = 0xE0 | (ucs >> 12);
+				utf8[1] = 0x80 | ((ucs >> 6) & 0x3F);
+				utf8[2] = 0x80 | (ucs & 0x3F);
+				incount = 3;
+			}
+			if (iconv(cd, &inptr, &incount, &outptr, &outcount) != (size_t) -1 && (uint8_t) out[0] != codepage->map[entry].chr) {
+				pbx_test_status_update(test, "%s: U+%04X maps to 0x%02X, iconv: 0x%02X\n", codepage->name, ucs, codepage->map[entry].chr, (uint8_t) out[0]);
+				iconv_close(cd);
+				return AST_TEST_FAIL;
+			}
+		}
+		iconv_close(cd);
+	}
+#endif
+	return AST_TEST_PASS;
+}
+
+AST_TEST_DEFINE(sccp_codepage_benchmark)
+{
+#define NUM_TEST_CONVERSIONS 100000
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "benchmark";
+			info->category = "/channels/chan_sccp/codepage/";
+			info->summary = "chan-sccp-b codepage conversion benchmark";
+			info->description = "Compares the ASCII fast path and the direct conversion tables against iconv";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	static const char ascii[] = "Conference Room 4711";
+	static const char latin[] = "J\xc3\xbcrgen M\xc3\xbcller-L\xc3\xbc\xc3\x9f";
+	const sccp_codepage_t *codepage = sccp_codepage_find("ISO8859-1");
+	char buf[40] = "";
+	struct timeval start;
+	int i = 0;
+
+	start = pbx_tvnow();
+	for (i = 0; i < NUM_TEST_CONVERSIONS; i++) {
+		sccp_codepage_copyAscii(buf, ascii, sizeof(buf));
+	}
+	pbx_test_status_update(test, "ascii fast path: %d conversions in %dms\n", NUM_TEST_CONVERSIONS, (int)ast_tvdiff_ms(pbx_tvnow(), start));
+
+	start = pbx_tvnow();
+	for (i = 0; i < NUM_TEST_CONVERSIONS; i++) {
+		if (!sccp_codepage_copyAscii(buf, latin, sizeof(buf))) {
+			sccp_codepage_convert(codepage, buf, latin, sizeof(buf));
+		}
+	}
+	pbx_test_status_update(test, "table (ISO8859-1): %d conversions in %dms\n", NUM_TEST_CONVERSIONS, (int)ast_tvdiff_ms(pbx_tvnow(), start));
+
+#if HAVE_ICONV
+	iconv_t cd = iconv_open("ISO8859-1", "UTF-8");
+	pbx_mutex_t lock;
+	if (cd != (iconv_t) -1) {
+		pbx_mutex_init(&lock);
+		start = pbx_tvnow();
+		for (i = 0; i < NUM_TEST_CONVERSIONS; i++) {
+			ICONV_CONST char *inptr = (ICONV_CONST char *)latin;
+			char *outptr = buf;
+			size_t incount = sizeof(latin) - 1;
+			size_t outcount = sizeof(buf) - 1;
+
+			pbx_mutex_lock(&lock);
+			iconv(cd, &inptr, &incount, &outptr, &outcount);
+			pbx_mutex_unlock(&lock);
+			*outptr = '\0';
+		}
+		pbx_test_status_update(test, "iconv (ISO8859-1): %d conversions in %dms\n", NUM_TEST_CONVERSIONS, (int)ast_tvdiff_ms(pbx_tvnow(), start));
+		pbx_mutex_destroy(&lock);
+		iconv_close(cd);
+	}
+#endif
+	return AST_TEST_PASS;
+#undef NUM_TEST_CONVERSIONS
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_codepage_convert_test);
+	AST_TEST_REGISTER(sccp_codepage_benchmark);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_codepage_convert_test);
+	AST_TEST_UNREGISTER(sccp_codepage_benchmark);
+}
+#endif
+
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
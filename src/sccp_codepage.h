@@ -0,0 +1,19 @@
+/*!
+ * \file        sccp_codepage.h
+ * \brief       SCCP Codepage Conversion Header
+ * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *              See the LICENSE file at the top of the source tree.
+ *
+ * Direct UTF-8 to single-byte codepage conversion for pre-java phones, without iconv and without locking.
+ */
+#pragma once
+
+__BEGIN_C_EXTERN__
+typedef struct sccp_codepage sccp_codepage_t;
+
+SCCP_API const sccp_codepage_t * SCCP_CALL sccp_codepage_find(const char *name);
+SCCP_API const char * SCCP_CALL sccp_codepage_name(const sccp_codepage_t * codepage);
+SCCP_API boolean_t SCCP_CALL sccp_codepage_copyAscii(char *dst, const char *src, size_t dst_size);
+SCCP_API void SCCP_CALL sccp_codepage_convert(const sccp_codepage_t * codepage, char *dst, const char *src, size_t dst_size);
+__END_C_EXTERN__
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
@@ -109,6 +109,16 @@ struct sccp_conference {
 	boolean_t isOnHold;
 	boolean_t mute_on_entry;										/*!< Mute new participant when they enter the conference */
 	boolean_t playback_announcements;									/*!< general hear announcements */
+	struct {
+		ast_mutex_t lock;										/*!< Mutex Lock protecting the shared conflist fragment */
+		char *items;											/*!< Shared participant MenuItems, without the per viewer part of the URL */
+		size_t len;											/*!< Length of items */
+		size_t size;											/*!< Allocated size of items */
+		size_t *splits;											/*!< Offsets in items where the per viewer part of the URL is spliced in */
+		uint32_t numSplits;										/*!< Number of splits (participants in items) */
+		uint32_t maxSplits;										/*!< Allocated number of splits */
+		boolean_t valid;										/*!< items reflects the current participant list */
+	} conflist;
 };														/*!< SCCP Conference Structure */
 
 struct sccp_participant {
@@ -119,6 +129,12 @@ struct sccp_participant {
 	PBX_CHANNEL_TYPE *conferenceBridgePeer;									/*!< the asterisk channel which joins the conference bridge */
 	struct ast_bridge_channel *bridge_channel;								/*!< Asterisk Conference Bridge Channel */
 	pthread_t joinThread;											/*!< Running in this Thread */
+#if ASTERISK_VERSION_GROUP >= 113
+	boolean_t imparted;											/*!< Imparted onto the bridge (conf_worker_pool), instead of running a joinThread */
+	struct ast_bridge_features *bridgeFeatures;								/*!< Features owned by the imparted bridge channel, mirrors features, protected by the bridge lock */
+	boolean_t bridgeLeft;											/*!< The leave hook ran, bridgeFeatures may be freed by the bridge, protected by the bridge lock */
+	struct timeval leftAt;											/*!< Time the participant left the bridge, for post-leave latency */
+#endif
 	sccp_conference_t *conference;										/*!< Conference this participant belongs to */
 	char *final_announcement;										/*!< Announcement playedback to participant after leaving the bridge */
 	boolean_t isModerator;											/*!< Is Participant a Moderator */
@@ -132,16 +148,30 @@ struct sccp_participant {
 	
 	char PartyName[StationMaxNameSize];
 	char PartyNumber[StationMaxDirnumSize];
+	char *listItem;												/*!< Cached conflist MenuItem, without the per viewer part of the URL */
+	size_t listItemLen;											/*!< Length of listItem */
+	size_t listItemSplit;											/*!< Offset in listItem where the per viewer part of the URL is spliced in */
+	int listItemIcon;											/*!< IconIndex listItem was rendered with, -1 forces a rerender */
 
 	struct ast_bridge_features features;									/*!< Enabled features information */
 };														/*!< SCCP Conference Participant Structure */
 
 static SCCP_LIST_HEAD (, sccp_conference_t) conferences;							/*!< our list of conferences */
+#if ASTERISK_VERSION_GROUP >= 113
+static sccp_threadpool_t *conference_workers = NULL;							/*!< shared pool handling the post-leave work of imparted participants */
+AST_MUTEX_DEFINE_STATIC(conference_workers_stats_lock);
+static struct {
+	uint32_t handled;											/*!< number of participants handled by the conference_workers */
+	uint64_t totalLatency;											/*!< sum of the time between leaving the bridge and being removed (ms) */
+	uint32_t maxLatency;											/*!< max time between leaving the bridge and being removed (ms) */
+} conference_workers_stats;
+#endif
 
 #define participantPtr sccp_participant_t *const
 #define constParticipantPtr const sccp_participant_t *const
 
 static void *sccp_conference_thread(void *data);
+static int sccp_conference_join(participantPtr participant);
 void sccp_conference_update_callInfo(constChannelPtr channel, PBX_CHANNEL_TYPE * pbxChannel, constParticipantPtr participant, uint32_t conferenceID);
 int playback_to_channel(participantPtr participant, const char *filename, int say_number);
 int playback_to_conference(conferencePtr conference, const char *filename, int say_number);
@@ -176,6 +206,12 @@ void sccp_conference_module_start(void)
  */
 void sccp_conference_module_stop(void)
 {
+#if ASTERISK_VERSION_GROUP >= 113
+	if (conference_workers) {
+		sccp_threadpool_destroy(conference_workers);
+		conference_workers = NULL;
+	}
+#endif
 	SCCP_LIST_HEAD_DESTROY(&conferences);
 }
 
@@ -211,6 +247,13 @@ static int __sccp_conference_destroy(const void *data)
 	}
 	SCCP_RWLIST_HEAD_DESTROY(&conference->participants);
 	pbx_mutex_destroy(&conference->playback.lock);
+	pbx_mutex_destroy(&conference->conflist.lock);
+	if (conference->conflist.items) {
+		sccp_free(conference->conflist.items);
+	}
+	if (conference->conflist.splits) {
+		sccp_free(conference->conflist.splits);
+	}
 
 #ifdef CS_MANAGER_EVENTS
 	if (GLOB(callevents)) {
@@ -232,6 +275,9 @@ static int __sccp_participant_destroy(const void *data)
 		participant->conference->num_moderators--;
 	}
 	pbx_bridge_features_cleanup(&participant->features);
+	if (participant->listItem) {
+		sccp_free(participant->listItem);
+	}
 #ifdef CS_MANAGER_EVENTS
 	if (GLOB(callevents)) {
 		/*
@@ -347,6 +393,7 @@ sccp_conference_t *sccp_conference_create(devicePtr device, channelPtr channel)
 
 	/* init playback lock */
 	pbx_mutex_init(&conference->playback.lock);
+	pbx_mutex_init(&conference->conflist.lock);
 
 	/* create new conference moderator channel */
 	sccp_log((DEBUGCAT_CORE + DEBUGCAT_CONFERENCE)) (VERBOSE_PREFIX_3 "SCCP: Adding moderator channel to SCCPCONF/%04d\n", conferenceID);
@@ -365,7 +412,7 @@ sccp_conference_t *sccp_conference_create(devicePtr device, channelPtr channel)
 		sccp_conference_update_callInfo(channel, participant->conferenceBridgePeer, participant, conference->id);
 		//ast_set_flag(&(participant->features.feature_flags), AST_BRIDGE_CHANNEL_FLAG_DISSOLVE_HANGUP);
 		
-		if (pbx_pthread_create_background(&participant->joinThread, NULL, sccp_conference_thread, participant) < 0) {
+		if (sccp_conference_join(participant) < 0) {
 			channel->hangupRequest(channel);
 			return NULL;
 		}
@@ -430,6 +477,7 @@ static sccp_participant_t *sccp_conference_createParticipant(constConferencePtr
 	participant->conferenceBridgePeer = NULL;
 	participant->playback_announcements = conference->playback_announcements;				// default
 	participant->onMusicOnHold = FALSE;
+	participant->listItemIcon = -1;
 	if (conference->mute_on_entry) {
 		sccp_log((DEBUGCAT_CORE + DEBUGCAT_CONFERENCE)) (VERBOSE_PREFIX_3 "SCCP: Participant: %d will be muted on entry\n", participant->id);
 		participant->features.mute = 1;
@@ -491,7 +539,7 @@ static boolean_t sccp_conference_masqueradeChannel(PBX_CHANNEL_TYPE * participan
 			return FALSE;
 		}
 		pbx_channel_ref(participant->conferenceBridgePeer);
-		if (pbx_pthread_create_background(&participant->joinThread, NULL, sccp_conference_thread, participant) < 0) {
+		if (sccp_conference_join(participant) < 0) {
 			pbx_hangup(participant->conferenceBridgePeer);
 			pbx_channel_unref(participant->conferenceBridgePeer);
 			return FALSE;
@@ -560,6 +608,7 @@ void sccp_conference_update_callInfo(constChannelPtr channel, PBX_CHANNEL_TYPE *
 		case SKINNY_CALLTYPE_SENTINEL:
 			break;
 	}
+	((participantPtr)participant)->listItemIcon = -1;							/* PartyName/PartyNumber may have changed, rerender the cached conflist item */
 
 	/* this is just a workaround to update sip and other channels also -MC */
 	/** @todo we should fix this workaround -MC */
@@ -680,7 +729,7 @@ static void sccp_conference_removeParticipant(conferencePtr conference, particip
 
 	sccp_log((DEBUGCAT_CORE + DEBUGCAT_CONFERENCE)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: Removing Participant %d.\n", conference->id, participant->id);
 
-	SCCP_RWLIST_RDLOCK(&(((conferencePtr)conference)->participants));
+	SCCP_RWLIST_WRLOCK(&(((conferencePtr)conference)->participants));
 	AUTO_RELEASE(sccp_participant_t, tmp_participant, SCCP_RWLIST_REMOVE(&conference->participants, (sccp_participant_t *)participant, list));
 	num_participants = SCCP_RWLIST_GETSIZE(&conference->participants);
 	SCCP_RWLIST_UNLOCK(&(((conferencePtr)conference)->participants));
@@ -696,6 +745,45 @@ static void sccp_conference_removeParticipant(conferencePtr conference, particip
 	sccp_log((DEBUGCAT_CORE + DEBUGCAT_CONFERENCE)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: Hanging up Participant %d\n", conference->id, tmp_participant->id);
 }
 
+/*!
+ * \brief Mark the participant as having left the conference bridge
+ */
+static void sccp_conference_participant_left(participantPtr participant)
+{
+	participant->pendingRemoval = TRUE;
+
+	sccp_log_and((DEBUGCAT_CONFERENCE + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: Left the conference bridge: %s as %d\n", participant->conference->id, participant->conferenceBridgePeer ? pbx_channel_name(participant->conferenceBridgePeer) : "NULL", participant->id);
+#ifdef CS_MANAGER_EVENTS
+	if (GLOB(callevents)) {
+		manager_event(EVENT_FLAG_CALL, "SCCPConfLeft", "ConfId: %d\r\n" "PartId: %d\r\n" "Channel: %s\r\n" "Uniqueid: %s\r\n", participant->conference ? participant->conference->id : 0, participant->id, participant->conferenceBridgePeer ? pbx_channel_name(participant->conferenceBridgePeer) : "NULL", participant->conferenceBridgePeer ? pbx_channel_uniqueid(participant->conferenceBridgePeer) : "NULL");
+	}
+#endif
+}
+
+/*!
+ * \brief Post-leave handling: hide the conflist, play the final announcement, hangup the bridge peer and remove the participant from the conference
+ */
+static void sccp_conference_finish_participant(participantPtr participant)
+{
+	if (participant->channel && participant->device) {
+		__sccp_conference_hide_list(participant);
+	}
+
+	if (participant->conferenceBridgePeer) {
+		if (participant->final_announcement) {
+			pbx_stream_and_wait(participant->conferenceBridgePeer, participant->final_announcement, "");
+			sccp_free(participant->final_announcement);
+		}
+		if (pbx_test_flag(pbx_channel_flags(participant->conferenceBridgePeer), AST_FLAG_BLOCKING)) {
+			ast_softhangup(participant->conferenceBridgePeer, AST_SOFTHANGUP_DEV);
+		} else {
+			pbx_hangup(participant->conferenceBridgePeer);
+		}
+		participant->conferenceBridgePeer = NULL;
+	}
+	sccp_conference_removeParticipant(participant->conference, participant);
+}
+
 /*!
  * \brief Every participant is running one of the threads as long as they are joined to the conference
  * When the thread is cancelled they will clean-up after them selves using the removeParticipant function
@@ -729,31 +817,8 @@ static void *sccp_conference_thread(void *data)
 #else
 		pbx_bridge_join(participant->conference->bridge, participant->conferenceBridgePeer, NULL, &participant->features, NULL, (enum ast_bridge_join_flags)0);
 #endif
-		participant->pendingRemoval = TRUE;
-
-		sccp_log_and((DEBUGCAT_CONFERENCE + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: Leaving pbx_bridge_join: %s as %d\n", participant->conference->id, pbx_channel_name(participant->conferenceBridgePeer), participant->id);
-#ifdef CS_MANAGER_EVENTS
-		if (GLOB(callevents)) {
-			manager_event(EVENT_FLAG_CALL, "SCCPConfLeft", "ConfId: %d\r\n" "PartId: %d\r\n" "Channel: %s\r\n" "Uniqueid: %s\r\n", participant->conference ? participant->conference->id : 0, participant->id, participant->conferenceBridgePeer ? pbx_channel_name(participant->conferenceBridgePeer) : "NULL", participant->conferenceBridgePeer ? pbx_channel_uniqueid(participant->conferenceBridgePeer) : "NULL");
-		}
-#endif
-		if (participant->channel && participant->device) {
-			__sccp_conference_hide_list(participant);
-		}
-	
-		if (participant->conferenceBridgePeer) {
-			if (participant->final_announcement) {
-				pbx_stream_and_wait(participant->conferenceBridgePeer, participant->final_announcement, "");
-				sccp_free(participant->final_announcement);
-			}
-			if (pbx_test_flag(pbx_channel_flags(participant->conferenceBridgePeer), AST_FLAG_BLOCKING)) {
-				ast_softhangup(participant->conferenceBridgePeer, AST_SOFTHANGUP_DEV);
-			} else {
-				pbx_hangup(participant->conferenceBridgePeer);
-			}
-			participant->conferenceBridgePeer = NULL;
-		}
-		sccp_conference_removeParticipant(participant->conference, participant);
+		sccp_conference_participant_left(participant);
+		sccp_conference_finish_participant(participant);
 		participant->joinThread = AST_PTHREADT_NULL;
 	} else {
 		pbx_log(LOG_WARNING, "SCCP: Conference thread could not be started because of missing conference (%d), participant (%d) or conference->bridge\n", (participant && participant->conference) ? participant->conference->id : 0, participant ? participant->id : 0);
@@ -761,6 +826,155 @@ static void *sccp_conference_thread(void *data)
 	return NULL;
 }
 
+#if ASTERISK_VERSION_GROUP >= 113
+/*!
+ * \brief Start the shared conference worker pool, if it is not running yet
+ */
+static boolean_t sccp_conference_workers_start(void)
+{
+	SCCP_LIST_LOCK(&conferences);
+	if (!conference_workers) {
+		conference_workers = sccp_threadpool_init(THREADPOOL_MIN_SIZE);
+	}
+	SCCP_LIST_UNLOCK(&conferences);
+	return conference_workers ? TRUE : FALSE;
+}
+
+/*!
+ * \brief Conference worker job: reap the imparted bridge channel and run the post-leave handling of the participant
+ * \note takes over the participant reference handed over by sccp_conference_dispatch_leave
+ */
+static void *sccp_conference_leave_worker(void *data)
+{
+	sccp_participant_t *participant = (sccp_participant_t *)data;
+	uint32_t latency = 0;
+
+	if (participant->imparted && participant->conferenceBridgePeer) {
+		pbx_bridge_depart(participant->conference->bridge, participant->conferenceBridgePeer);		/* the channel stays ours after depart */
+		participant->imparted = FALSE;
+	}
+	sccp_conference_finish_participant(participant);
+
+	latency = (uint32_t)ast_tvdiff_ms(pbx_tvnow(), participant->leftAt);
+	pbx_mutex_lock(&conference_workers_stats_lock);
+	conference_workers_stats.handled++;
+	conference_workers_stats.totalLatency += latency;
+	if (latency > conference_workers_stats.maxLatency) {
+		conference_workers_stats.maxLatency = latency;
+	}
+	pbx_mutex_unlock(&conference_workers_stats_lock);
+	sccp_log_and((DEBUGCAT_CONFERENCE + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: Participant %d handled %dms after leaving\n", participant->conference->id, participant->id, latency);
+
+	sccp_participant_release(&participant);									/* explicit release of the reference taken in sccp_conference_dispatch_leave */
+	return NULL;
+}
+
+/*!
+ * \brief Hand the post-leave handling of a participant over to the conference worker pool
+ * Falls back to a background thread, when the job cannot be queued
+ */
+static void sccp_conference_dispatch_leave(participantPtr participant)
+{
+	sccp_participant_t *ref = sccp_participant_retain(participant);
+	pthread_t thread;
+
+	if (!ref) {
+		return;
+	}
+	participant->leftAt = pbx_tvnow();
+	if (conference_workers && sccp_threadpool_add_work(conference_workers, sccp_conference_leave_worker, ref) > 0) {
+		return;
+	}
+	pbx_log(LOG_NOTICE, "SCCPCONF/%04d: Could not queue post-leave work for participant %d, using a separate thread\n", participant->conference->id, participant->id);
+	if (pbx_pthread_create_background(&thread, NULL, sccp_conference_leave_worker, ref) < 0) {
+		pbx_log(LOG_ERROR, "SCCPCONF/%04d: Failed to handle participant %d leaving\n", participant->conference->id, participant->id);
+		sccp_participant_release(&ref);									/* explicit release */
+	}
+}
+
+/*!
+ * \brief Leave hook of an imparted participant, runs on the bridge channel thread
+ * Only hands the participant over to the conference worker pool, so the bridge channel thread can exit immediately
+ */
+static int sccp_conference_leave_hook(struct ast_bridge_channel *bridge_channel, void *hook_pvt)
+{
+	sccp_participant_t *participant = (sccp_participant_t *)hook_pvt;
+
+	pbx_bridge_lock(participant->conference->bridge);
+	participant->bridgeFeatures = NULL;									/* owned by the bridge channel, which is going away */
+	participant->bridgeLeft = TRUE;
+	pbx_bridge_unlock(participant->conference->bridge);
+	sccp_conference_participant_left(participant);
+	sccp_conference_dispatch_leave(participant);
+	return -1;												/* remove hook */
+}
+
+static void sccp_conference_leave_hook_destroy(void *hook_pvt)
+{
+	sccp_participant_t *participant = (sccp_participant_t *)hook_pvt;
+	sccp_participant_release(&participant);									/* explicit release of the hook reference */
+}
+
+/*!
+ * \brief Impart the participant onto the conference bridge (non-blocking join)
+ * \return TRUE when imparted, FALSE when the caller should fall back to a join thread
+ */
+static boolean_t sccp_conference_impart(participantPtr participant)
+{
+	struct ast_bridge_features *features = NULL;
+	sccp_participant_t *hookRef = NULL;
+
+	if (!participant->conference || !participant->conference->bridge || !participant->conferenceBridgePeer || !sccp_conference_workers_start()) {
+		return FALSE;
+	}
+	if (!(features = pbx_bridge_features_new())) {
+		return FALSE;
+	}
+	features->mute = participant->features.mute;
+	features->dtmf_passthrough = participant->features.dtmf_passthrough;
+	if (!(hookRef = sccp_participant_retain(participant)) || pbx_bridge_leave_hook(features, sccp_conference_leave_hook, hookRef, sccp_conference_leave_hook_destroy, (enum ast_bridge_hook_remove_flags) 0)) {
+		if (hookRef) {
+			sccp_participant_release(&hookRef);							/* explicit release */
+		}
+		pbx_bridge_features_destroy(features);
+		return FALSE;
+	}
+#ifdef CS_MANAGER_EVENTS
+	if (GLOB(callevents)) {
+		manager_event(EVENT_FLAG_CALL, "SCCPConfEntered", "ConfId: %d\r\n" "PartId: %d\r\n" "Channel: %s\r\n" "Uniqueid: %s\r\n", participant->conference->id, participant->id, pbx_channel_name(participant->conferenceBridgePeer), pbx_channel_uniqueid(participant->conferenceBridgePeer));
+	}
+#endif
+	participant->imparted = TRUE;
+	if (pbx_bridge_impart(participant->conference->bridge, participant->conferenceBridgePeer, NULL, features, 0)) {	/* departable, features are consumed even on failure */
+		participant->imparted = FALSE;
+		return FALSE;
+	}
+	/* only publish the features while the bridge channel holds them, the leave hook may already have run */
+	pbx_bridge_lock(participant->conference->bridge);
+	if (!participant->bridgeLeft) {
+		participant->bridgeFeatures = features;
+	}
+	pbx_bridge_unlock(participant->conference->bridge);
+	sccp_log_and((DEBUGCAT_CONFERENCE + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: Imparted %s as %d\n", participant->conference->id, pbx_channel_name(participant->conferenceBridgePeer), participant->id);
+	return TRUE;
+}
+#endif
+
+/*!
+ * \brief Join the participant to the conference bridge
+ * Either imparted onto the bridge (conf_worker_pool=yes), or on a dedicated join thread
+ * \return 0 on success, -1 on failure
+ */
+static int sccp_conference_join(participantPtr participant)
+{
+#if ASTERISK_VERSION_GROUP >= 113
+	if (GLOB(conf_worker_pool) && sccp_conference_impart(participant)) {
+		return 0;
+	}
+#endif
+	return pbx_pthread_create_background(&participant->joinThread, NULL, sccp_conference_thread, participant) < 0 ? -1 : 0;
+}
+
 void sccp_conference_update(constConferencePtr conference)
 {
 	usleep(500); /* need time to settle into bridge, before updating links */
@@ -1198,10 +1412,122 @@ sccp_participant_t *sccp_participant_findByPBXChannel(constConferencePtr confere
  * UserCallDataSoftKey:STRING:INTEGER0:INTEGER1:INTEGER2:INTEGER3:STRING
  * UserCallData:INTEGER0:INTEGER1:INTEGER2:INTEGER3:STRING
  */
-void sccp_conference_show_list(constConferencePtr conference, constChannelPtr channel)
+/* static parts of the conflist, only depending on the protocol / icon support of the viewing device */
+static const char conflist_prompt[] = "<Prompt>Make Your Selection</Prompt>\n";
+static const char conflist_softkeys_exit[] = "<SoftKeyItem><Name>Exit</Name><Position>4</Position><URL>SoftKey:Exit</URL></SoftKeyItem>\n";
+static const char conflist_icons_enhanced[] =
+	"<IconItem><Index>0</Index><URL>Resource:Icon.Connected</URL></IconItem>"				// moderator
+	"<IconItem><Index>1</Index><URL>Resource:AnimatedIcon.Hold</URL></IconItem>"				// muted moderator
+	"<IconItem><Index>2</Index><URL>Resource:AnimatedIcon.StreamRxTx</URL></IconItem>"			// participant
+	"<IconItem><Index>3</Index><URL>Resource:AnimatedIcon.Hold</URL></IconItem>"				// muted participant
+	"<IconItem><Index>4</Index><URL>Resource:Icon.Speaker</URL></IconItem>"					// unlocked conference
+	"<IconItem><Index>5</Index><URL>Resource:Icon.SecureCall</URL></IconItem>\n";				// locked conference
+static const char conflist_icons_tftp[] =
+	"<IconItem><Index>0</Index><URL>TFTP:Icon.Connected.png</URL></IconItem>"				// moderator
+	"<IconItem><Index>1</Index><URL>TFTP:AnimatedIcon.Hold.png</URL></IconItem>"				// muted moderator
+	"<IconItem><Index>2</Index><URL>TFTP:AnimatedIcon.StreamRxTx.png</URL></IconItem>"			// participant
+	"<IconItem><Index>3</Index><URL>TFTP:AnimatedIcon.Hold.png</URL></IconItem>"				// muted participant
+	"<IconItem><Index>4</Index><URL>TFTP:Icon.Speaker.png</URL></IconItem>"					// unlocked conference
+	"<IconItem><Index>5</Index><URL>TFTP:Icon.SecureCall.png</URL></IconItem>\n";				// locked conference
+static const char conflist_icons_bitmap[] =
+	"<IconItem><Index>0</Index><Height>10</Height><Width>16</Width><Depth>2</Depth><Data>C3300000FF0F0000F3F30000F3FC0300F3FC0300FFF30000F30F0000FCF30300F0FC0F0000FF3F00</Data></IconItem>"		// moderator
+	"<IconItem><Index>1</Index><Height>10</Height><Width>16</Width><Depth>2</Depth><Data>C3300C00FF0F3C30F3F3F03CF3FCC333F3FC330FFFF3F03CF30FF0F3FCF333CFF0FC0F3C00FF3F30</Data></IconItem>"		// muted moderator
+	"<IconItem><Index>2</Index><Height>10</Height><Width>16</Width><Depth>2</Depth><Data>000000000000000000F30000C0FC0300C0FC030000F300000000000000F30300C0FC0F0030FF3F00</Data></IconItem>"		// participant
+	"<IconItem><Index>3</Index><Height>10</Height><Width>16</Width><Depth>2</Depth><Data>00000C0000003C3000F3F03CC0FCC333C0FC330F00F3F03C0000F0F300F333CFC0FC0F3C30FF3F30</Data></IconItem>\n";	// muted participant
+
+/*!
+ * \brief Render the cached conflist MenuItem of a participant, if it's icon or name changed since the last render
+ *
+ * The per viewer part of the URL (lineInstance:callReference:transactionID) is not part of the cached item, it is spliced in at listItemSplit
+ */
+static void sccp_participant_render_listItem(participantPtr part)
+{
+	char item[StationMaxNameSize + StationMaxDirnumSize + 128];
+	int use_icon = (part->isModerator ? 0 : 2) + (part->features.mute ? 1 : 0);
+	int len = 0;
+	int split = 0;
+
+	if (part->listItem && part->listItemIcon == use_icon) {
+		return;
+	}
+	len = snprintf(item, sizeof(item), "<MenuItem><IconIndex>%d</IconIndex><Name>%d:%s", use_icon, part->id, part->PartyName);
+	if (!sccp_strlen_zero(part->PartyNumber)) {
+		len += snprintf(item + len, sizeof(item) - len, " (%s)", part->PartyNumber);
+	}
+	split = len + snprintf(item + len, sizeof(item) - len, "</Name><URL>UserCallData:%d:", appID);
+	len = split + snprintf(item + split, sizeof(item) - split, ":%d</URL></MenuItem>\n", part->id);
+
+	if (part->listItem) {
+		sccp_free(part->listItem);
+	}
+	if ((part->listItem = pbx_strdup(item))) {
+		part->listItemLen = len;
+		part->listItemSplit = split;
+		part->listItemIcon = use_icon;
+	}
+}
+
+/*!
+ * \brief Rebuild the shared conflist fragment from the (cached) participant items, when it has been invalidated
+ * \note needs to be called with the participants list and conflist.lock locked
+ */
+static void sccp_conference_render_listItems(conferencePtr conference)
+{
+	sccp_participant_t *part = NULL;
+
+	if (conference->conflist.valid) {
+		return;
+	}
+	conference->conflist.len = 0;
+	conference->conflist.numSplits = 0;
+	SCCP_RWLIST_TRAVERSE(&conference->participants, part, list) {
+		if (part->pendingRemoval) {
+			continue;
+		}
+		sccp_participant_render_listItem(part);
+		if (!part->listItem) {
+			continue;
+		}
+		if (conference->conflist.len + part->listItemLen > conference->conflist.size) {
+			size_t newSize = conference->conflist.size ? conference->conflist.size * 2 : 1024;
+			while (newSize < conference->conflist.len + part->listItemLen) {
+				newSize *= 2;
+			}
+			char *newItems = (char *)sccp_realloc(conference->conflist.items, newSize);
+			if (!newItems) {
+				break;
+			}
+			conference->conflist.items = newItems;
+			conference->conflist.size = newSize;
+		}
+		if (conference->conflist.numSplits == conference->conflist.maxSplits) {
+			uint32_t newMax = conference->conflist.maxSplits ? conference->conflist.maxSplits * 2 : 16;
+			size_t *newSplits = (size_t *)sccp_realloc(conference->conflist.splits, newMax * sizeof(size_t));
+			if (!newSplits) {
+				break;
+			}
+			conference->conflist.splits = newSplits;
+			conference->conflist.maxSplits = newMax;
+		}
+		memcpy(conference->conflist.items + conference->conflist.len, part->listItem, part->listItemLen);
+		conference->conflist.splits[conference->conflist.numSplits++] = conference->conflist.len + part->listItemSplit;
+		conference->conflist.len += part->listItemLen;
+	}
+	conference->conflist.valid = TRUE;
+}
+
+/*!
+ * \brief Invalidate the shared conflist fragment, forcing it to be rebuilt on the next show_list
+ */
+static void sccp_conference_invalidate_list(constConferencePtr conference)
 {
-	int use_icon = 0;
+	pbx_mutex_lock(&((conferencePtr)conference)->conflist.lock);
+	((conferencePtr)conference)->conflist.valid = FALSE;
+	pbx_mutex_unlock(&((conferencePtr)conference)->conflist.lock);
+}
 
+static void __sccp_conference_show_list(constConferencePtr conference, constChannelPtr channel)
+{
 	if (!conference) {
 		pbx_log(LOG_WARNING, "SCCPCONF: No conference available to display list for\n");
 		return;
@@ -1232,136 +1558,108 @@ void sccp_conference_show_list(constConferencePtr conference, constChannelPtr ch
 			participant->transactionID = sccp_random() % 1000;
 		}
 
-		pbx_str_t *xmlStr = pbx_str_alloca(2048);
+		char header[256] = "";
+		char token[48] = "";
+		char softkeys[1024] = "";
+		const char *icons = NULL;
+		const char *footer = NULL;
+		int headerLen = 0;
+		int tokenLen = 0;
+		int softkeysLen = 0;
 
 		//snprintf(xmlTmp, sizeof(xmlTmp), "<CiscoIPPhoneIconMenu appId=\"%d\" onAppFocusLost=\"\" onAppFocusGained=\"\" onAppClosed=\"\">", appID);
 		if (participant->device->protocolversion >= 15) {
 			if (participant->device->hasEnhancedIconMenuSupport()) {
-				pbx_str_append(&xmlStr, 0, "<CiscoIPPhoneIconFileMenu appId=\"%d\" onAppClosed=\"%d\">", appID, appID);
-				if (conference->isLocked) {
-					pbx_str_append(&xmlStr, 0, "<Title IconIndex=\"5\">Conference %d</Title>\n", conference->id);
-				} else {
-					pbx_str_append(&xmlStr, 0, "<Title IconIndex=\"4\">Conference %d</Title>\n", conference->id);
-				}
+				headerLen = snprintf(header, sizeof(header), "<CiscoIPPhoneIconFileMenu appId=\"%d\" onAppClosed=\"%d\"><Title IconIndex=\"%d\">Conference %d</Title>\n", appID, appID, conference->isLocked ? 5 : 4, conference->id);
+				icons = conflist_icons_enhanced;
 			} else {
-				pbx_str_append(&xmlStr, 0, "<CiscoIPPhoneIconFileMenu>");
-				pbx_str_append(&xmlStr, 0, "<Title>Conference %d</Title>\n", conference->id);
+				headerLen = snprintf(header, sizeof(header), "<CiscoIPPhoneIconFileMenu><Title>Conference %d</Title>\n", conference->id);
+				icons = conflist_icons_tftp;
 			}
+			footer = "</CiscoIPPhoneIconFileMenu>\n";
 		} else {
-			pbx_str_append(&xmlStr, 0, "<CiscoIPPhoneIconMenu>");
-			pbx_str_append(&xmlStr, 0, "<Title>Conference %d</Title>\n", conference->id);
+			headerLen = snprintf(header, sizeof(header), "<CiscoIPPhoneIconMenu><Title>Conference %d</Title>\n", conference->id);
+			icons = conflist_icons_bitmap;
+			footer = "</CiscoIPPhoneIconMenu>\n";
 		}
-		pbx_str_append(&xmlStr, 0, "<Prompt>Make Your Selection</Prompt>\n");
-
-		// MenuItems
-
-		sccp_participant_t *part = NULL;
-
-		SCCP_RWLIST_RDLOCK(&(((conferencePtr)conference)->participants));
-		SCCP_RWLIST_TRAVERSE(&conference->participants, part, list) {
-			if (part->pendingRemoval) {
-				continue;
-			}
-			pbx_str_append(&xmlStr, 0, "<MenuItem>");
 
-			if (part->isModerator) {
-				use_icon = 0;
-			} else {
-				use_icon = 2;
-			}
-			if (part->features.mute) {
-				++use_icon;
-			}
-			pbx_str_append(&xmlStr, 0, "<IconIndex>");
-			pbx_str_append(&xmlStr, 0, "%d", use_icon);
-			pbx_str_append(&xmlStr, 0, "</IconIndex>");
-
-			pbx_str_append(&xmlStr, 0, "<Name>");
-			pbx_str_append(&xmlStr, 0, "%d:%s", part->id, part->PartyName);
-			if (!sccp_strlen_zero(part->PartyNumber)) {
-				pbx_str_append(&xmlStr, 0, " (%s)", part->PartyNumber);
-			}
-			pbx_str_append(&xmlStr, 0, "</Name>");
-			pbx_str_append(&xmlStr, 0, "<URL>UserCallData:%d:%d:%d:%d:%d</URL>", appID, participant->lineInstance, participant->callReference, participant->transactionID, part->id);
-			pbx_str_append(&xmlStr, 0, "</MenuItem>\n");
-		}
-		SCCP_RWLIST_UNLOCK(&(((conferencePtr)conference)->participants));
+		// per viewer part of the MenuItem URL's
+		tokenLen = snprintf(token, sizeof(token), "%d:%d:%d", participant->lineInstance, participant->callReference, participant->transactionID);
 
 		// SoftKeys
 		if (participant->isModerator) {
-			pbx_str_append(&xmlStr, 0, "<SoftKeyItem>");
-			pbx_str_append(&xmlStr, 0, "<Name>EndConf</Name>");
-			pbx_str_append(&xmlStr, 0, "<Position>1</Position>");
-			// pbx_str_append(&xmlStr, 0, "<URL>UserDataSoftKey:Select:%d:ENDCONF/%d/%d/%d/</URL>", 1, appID, participant->lineInstance, participant->transactionID);
-			pbx_str_append(&xmlStr, 0, "<URL>UserDataSoftKey:Select:%d:ENDCONF/%d</URL>", appID, participant->transactionID);
-			pbx_str_append(&xmlStr, 0, "</SoftKeyItem>\n");
-			pbx_str_append(&xmlStr, 0, "<SoftKeyItem>");
-			pbx_str_append(&xmlStr, 0, "<Name>Mute</Name>");
-			pbx_str_append(&xmlStr, 0, "<Position>2</Position>");
-			// pbx_str_append(&xmlStr, 0, "<URL>UserDataSoftKey:Select:%d:MUTE/%d/%d/%d/</URL>", 2, appID, participant->lineInstance, participant->transactionID);
-			pbx_str_append(&xmlStr, 0, "<URL>UserDataSoftKey:Select:%d:MUTE/%d</URL>", appID, participant->transactionID);
-			pbx_str_append(&xmlStr, 0, "</SoftKeyItem>\n");
-
-			pbx_str_append(&xmlStr, 0, "<SoftKeyItem>");
-			pbx_str_append(&xmlStr, 0, "<Name>Kick</Name>");
-			pbx_str_append(&xmlStr, 0, "<Position>3</Position>");
-			// pbx_str_append(&xmlStr, 0, "<URL>UserDataSoftKey:Select:%d:KICK/%d/%d/%d/</URL>", 3, appID, participant->lineInstance, participant->transactionID);
-			pbx_str_append(&xmlStr, 0, "<URL>UserDataSoftKey:Select:%d:KICK/%d</URL>", appID, participant->transactionID);
-			pbx_str_append(&xmlStr, 0, "</SoftKeyItem>\n");
-		}
-		pbx_str_append(&xmlStr, 0, "<SoftKeyItem>");
-		pbx_str_append(&xmlStr, 0, "<Name>Exit</Name>");
-		pbx_str_append(&xmlStr, 0, "<Position>4</Position>");
-		pbx_str_append(&xmlStr, 0, "<URL>SoftKey:Exit</URL>");
-		pbx_str_append(&xmlStr, 0, "</SoftKeyItem>\n");
-		if (participant->isModerator) {
-			pbx_str_append(&xmlStr, 0, "<SoftKeyItem>");
-			pbx_str_append(&xmlStr, 0, "<Name>Moderate</Name>");
-			pbx_str_append(&xmlStr, 0, "<Position>5</Position>");
-			pbx_str_append(&xmlStr, 0, "<URL>UserDataSoftKey:Select:%d:MODERATE/%d</URL>", appID, participant->transactionID);
-			pbx_str_append(&xmlStr, 0, "</SoftKeyItem>\n");
+			softkeysLen = snprintf(softkeys, sizeof(softkeys),
+				"<SoftKeyItem><Name>EndConf</Name><Position>1</Position><URL>UserDataSoftKey:Select:%d:ENDCONF/%d</URL></SoftKeyItem>\n"
+				"<SoftKeyItem><Name>Mute</Name><Position>2</Position><URL>UserDataSoftKey:Select:%d:MUTE/%d</URL></SoftKeyItem>\n"
+				"<SoftKeyItem><Name>Kick</Name><Position>3</Position><URL>UserDataSoftKey:Select:%d:KICK/%d</URL></SoftKeyItem>\n"
+				"%s"
+				"<SoftKeyItem><Name>Moderate</Name><Position>5</Position><URL>UserDataSoftKey:Select:%d:MODERATE/%d</URL></SoftKeyItem>\n",
+				appID, participant->transactionID, appID, participant->transactionID, appID, participant->transactionID,
+				conflist_softkeys_exit,
+				appID, participant->transactionID);
 #if 0 /* INVITE */
-			pbx_str_append(&xmlStr, 0, "<SoftKeyItem>");
-			pbx_str_append(&xmlStr, 0, "<Name>Invite</Name>");
-			pbx_str_append(&xmlStr, 0, "<Position>6</Position>");
-			pbx_str_append(&xmlStr, 0, "<URL>UserDataSoftKey:Select:%d:INVITE/%d/%d</URL>", appID, participant->lineInstance, participant->transactionID);
-			pbx_str_append(&xmlStr, 0, "</SoftKeyItem>\n");
+			softkeysLen += snprintf(softkeys + softkeysLen, sizeof(softkeys) - softkeysLen, "<SoftKeyItem><Name>Invite</Name><Position>6</Position><URL>UserDataSoftKey:Select:%d:INVITE/%d/%d</URL></SoftKeyItem>\n", appID, participant->lineInstance, participant->transactionID);
 #endif
-		}
-		// CiscoIPPhoneIconMenu Icons
-		if (participant->device->protocolversion >= 15) {
-			if (participant->device->hasEnhancedIconMenuSupport()) {
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>0</Index><URL>Resource:Icon.Connected</URL></IconItem>");	// moderator
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>1</Index><URL>Resource:AnimatedIcon.Hold</URL></IconItem>");	// muted moderator
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>2</Index><URL>Resource:AnimatedIcon.StreamRxTx</URL></IconItem>");	// participant
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>3</Index><URL>Resource:AnimatedIcon.Hold</URL></IconItem>");	// muted participant
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>4</Index><URL>Resource:Icon.Speaker</URL></IconItem>");	// unlocked conference
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>5</Index><URL>Resource:Icon.SecureCall</URL></IconItem>\n");	// locked conference
-			} else {
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>0</Index><URL>TFTP:Icon.Connected.png</URL></IconItem>");	// moderator
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>1</Index><URL>TFTP:AnimatedIcon.Hold.png</URL></IconItem>");	// muted moderator
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>2</Index><URL>TFTP:AnimatedIcon.StreamRxTx.png</URL></IconItem>");	// participant
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>3</Index><URL>TFTP:AnimatedIcon.Hold.png</URL></IconItem>");	// muted participant
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>4</Index><URL>TFTP:Icon.Speaker.png</URL></IconItem>");	// unlocked conference
-				pbx_str_append(&xmlStr, 0, "<IconItem><Index>5</Index><URL>TFTP:Icon.SecureCall.png</URL></IconItem>\n");	// locked conference
-			}
 		} else {
-			pbx_str_append(&xmlStr, 0, "<IconItem><Index>0</Index><Height>10</Height><Width>16</Width><Depth>2</Depth><Data>C3300000FF0F0000F3F30000F3FC0300F3FC0300FFF30000F30F0000FCF30300F0FC0F0000FF3F00</Data></IconItem>");	// moderator
-			pbx_str_append(&xmlStr, 0, "<IconItem><Index>1</Index><Height>10</Height><Width>16</Width><Depth>2</Depth><Data>C3300C00FF0F3C30F3F3F03CF3FCC333F3FC330FFFF3F03CF30FF0F3FCF333CFF0FC0F3C00FF3F30</Data></IconItem>");	// muted moderator
-			pbx_str_append(&xmlStr, 0, "<IconItem><Index>2</Index><Height>10</Height><Width>16</Width><Depth>2</Depth><Data>000000000000000000F30000C0FC0300C0FC030000F300000000000000F30300C0FC0F0030FF3F00</Data></IconItem>");	// participant
-			pbx_str_append(&xmlStr, 0, "<IconItem><Index>3</Index><Height>10</Height><Width>16</Width><Depth>2</Depth><Data>00000C0000003C3000F3F03CC0FCC333C0FC330F00F3F03C0000F0F300F333CFC0FC0F3C30FF3F30</Data></IconItem>\n");	// muted participant
+			softkeysLen = snprintf(softkeys, sizeof(softkeys), "%s", conflist_softkeys_exit);
 		}
 
-		if (participant->device->protocolversion >= 15) {
-			pbx_str_append(&xmlStr, 0, "</CiscoIPPhoneIconFileMenu>\n");
-		} else {
-			pbx_str_append(&xmlStr, 0, "</CiscoIPPhoneIconMenu>\n");
+		// MenuItems: splice the per viewer token into the shared participant fragment
+		size_t iconsLen = strlen(icons);
+		size_t footerLen = strlen(footer);
+		char *xml = NULL;
+		size_t pos = 0;
+
+		SCCP_RWLIST_RDLOCK(&(((conferencePtr)conference)->participants));
+		pbx_mutex_lock(&((conferencePtr)conference)->conflist.lock);
+		sccp_conference_render_listItems((conferencePtr)conference);
+		size_t xmlLen = headerLen + (sizeof(conflist_prompt) - 1) + conference->conflist.len + conference->conflist.numSplits * tokenLen + softkeysLen + iconsLen + footerLen;
+		if ((xml = (char *)sccp_malloc(xmlLen + 1))) {
+			size_t prev = 0;
+			uint32_t idx = 0;
+
+			memcpy(xml + pos, header, headerLen);
+			pos += headerLen;
+			memcpy(xml + pos, conflist_prompt, sizeof(conflist_prompt) - 1);
+			pos += sizeof(conflist_prompt) - 1;
+			for (idx = 0; idx < conference->conflist.numSplits; idx++) {
+				memcpy(xml + pos, conference->conflist.items + prev, conference->conflist.splits[idx] - prev);
+				pos += conference->conflist.splits[idx] - prev;
+				prev = conference->conflist.splits[idx];
+				memcpy(xml + pos, token, tokenLen);
+				pos += tokenLen;
+			}
+			memcpy(xml + pos, conference->conflist.items + prev, conference->conflist.len - prev);
+			pos += conference->conflist.len - prev;
 		}
+		pbx_mutex_unlock(&((conferencePtr)conference)->conflist.lock);
+		SCCP_RWLIST_UNLOCK(&(((conferencePtr)conference)->participants));
+		if (!xml) {
+			pbx_log(LOG_ERROR, "SCCPCONF/%04d: cannot alloc memory for conflist\n", conference->id);
+			return;
+		}
+		memcpy(xml + pos, softkeys, softkeysLen);
+		pos += softkeysLen;
+		memcpy(xml + pos, icons, iconsLen);
+		pos += iconsLen;
+		memcpy(xml + pos, footer, footerLen);
+		pos += footerLen;
+		xml[pos] = '\0';
+
 		sccp_log((DEBUGCAT_CONFERENCE + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: ShowList appID %d, lineInstance %d, callReference %d, transactionID %d\n", conference->id, appID, participant->callReference, participant->lineInstance, participant->transactionID);
-		sccp_log((DEBUGCAT_CONFERENCE + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: XML-message:\n%s\n", conference->id, pbx_str_buffer(xmlStr));
+		sccp_log((DEBUGCAT_CONFERENCE + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_4 "SCCPCONF/%04d: XML-message:\n%s\n", conference->id, xml);
 
-		participant->device->protocol->sendUserToDeviceDataVersionMessage(participant->device, appID, participant->callReference, participant->lineInstance, participant->transactionID, pbx_str_buffer(xmlStr), 2);
+		participant->device->protocol->sendUserToDeviceDataVersionMessage(participant->device, appID, participant->callReference, participant->lineInstance, participant->transactionID, xml, 2);
+		sccp_free(xml);
+	}
+}
+
+void sccp_conference_show_list(constConferencePtr conference, constChannelPtr channel)
+{
+	if (conference) {
+		sccp_conference_invalidate_list(conference);
 	}
+	__sccp_conference_show_list(conference, channel);
 }
 
 /*!
@@ -1412,10 +1710,11 @@ static void sccp_conference_update_conflist(conferencePtr conference)
 	if (!conference || ATOMIC_FETCH(&(conference)->finishing, &conference->lock)) {
 		return;
 	}
+	sccp_conference_invalidate_list(conference);								/* rebuilt once, shared by all viewers */
 	SCCP_RWLIST_RDLOCK(&(conference->participants));
 	SCCP_RWLIST_TRAVERSE(&(conference->participants), participant, list) {
 		if (participant->channel && participant->device && (participant->device->conferencelist_active || (participant->isModerator && !conference->isOnHold))) {
-			sccp_conference_show_list(conference, participant->channel);
+			__sccp_conference_show_list(conference, participant->channel);
 		}
 	}
 	SCCP_RWLIST_UNLOCK(&(conference->participants));
@@ -1557,6 +1856,14 @@ void sccp_conference_toggle_mute_participant(constConferencePtr conference, part
 		//participant->channel->setMicrophone(participant->channel, TRUE);
 		//}
 	}
+#if ASTERISK_VERSION_GROUP >= 113
+	pbx_bridge_lock(participant->conference->bridge);						/* the leave hook clears bridgeFeatures under this lock */
+	if (participant->bridgeFeatures) {
+		participant->bridgeFeatures->mute = participant->features.mute;
+		participant->bridgeFeatures->dtmf_passthrough = participant->features.dtmf_passthrough;
+	}
+	pbx_bridge_unlock(participant->conference->bridge);
+#endif
 	if (participant->channel && participant->device) {
 		sccp_dev_set_message(participant->device, participant->features.mute ? "You are muted" : "You are unmuted", 5, FALSE, FALSE);
 	}
@@ -2012,6 +2319,104 @@ int sccp_cli_conference_command(int fd, sccp_cli_totals_t *totals, struct manses
 	return res;
 }
 
+
+#if CS_TEST_FRAMEWORK && ASTERISK_VERSION_GROUP >= 113
+#	include <asterisk/test.h>
+#	define NUM_TEST_PARTICIPANTS 500
+AST_TEST_DEFINE(sccp_conference_worker_pool)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "WorkerPool";
+			info->category = "/channels/chan_sccp/conference/";
+			info->summary = "chan-sccp-b conference worker pool stress test";
+			info->description = "Has hundreds of participants leave at once and checks that their post-leave work is handled by a bounded number of conference workers";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	sccp_participant_t **participants = NULL;
+	uint32_t handled = 0;
+	uint32_t handledBefore = 0;
+	uint64_t latencyBefore = 0;
+	int maxThreads = 0;
+	int loopcount = 0;
+	int idx = 0;
+
+	pbx_test_validate(test, sccp_conference_workers_start());
+	sccp_conference_t *conference = (sccp_conference_t *) sccp_refcount_object_alloc(sizeof(sccp_conference_t), SCCP_REF_CONFERENCE, "SCCPCONF/TEST", __sccp_conference_destroy);
+	pbx_test_validate(test, conference != NULL);
+	memset(conference, 0, sizeof(sccp_conference_t));
+	conference->finishing = TRUE;										/* no announcements, and do not end the conference while participants leave */
+	SCCP_RWLIST_HEAD_INIT(&conference->participants);
+	pbx_mutex_init(&conference->playback.lock);
+	pbx_mutex_init(&conference->conflist.lock);
+
+	pbx_test_status_update(test, "Adding %d participants\n", NUM_TEST_PARTICIPANTS);
+	participants = (sccp_participant_t **) sccp_calloc(NUM_TEST_PARTICIPANTS, sizeof(sccp_participant_t *));
+	pbx_test_validate(test, participants != NULL);
+	struct timeval start = pbx_tvnow();
+	for (idx = 0; idx < NUM_TEST_PARTICIPANTS; idx++) {
+		if ((participants[idx] = sccp_conference_createParticipant(conference))) {
+			sccp_conference_addParticipant_toList(conference, participants[idx]);
+		}
+	}
+	pbx_test_status_update(test, "Added %d participants in %dms\n", SCCP_RWLIST_GETSIZE(&conference->participants), (int)ast_tvdiff_ms(pbx_tvnow(), start));
+	pbx_test_validate(test, SCCP_RWLIST_GETSIZE(&conference->participants) == NUM_TEST_PARTICIPANTS);
+
+	pbx_mutex_lock(&conference_workers_stats_lock);
+	handledBefore = conference_workers_stats.handled;
+	latencyBefore = conference_workers_stats.totalLatency;
+	conference_workers_stats.maxLatency = 0;
+	pbx_mutex_unlock(&conference_workers_stats_lock);
+
+	start = pbx_tvnow();
+	for (idx = 0; idx < NUM_TEST_PARTICIPANTS; idx++) {
+		if (participants[idx]) {
+			sccp_conference_participant_left(participants[idx]);
+			sccp_conference_dispatch_leave(participants[idx]);
+			sccp_participant_release(&participants[idx]);						/* explicit release */
+		}
+	}
+	pbx_test_status_update(test, "Dispatched %d leaving participants in %dms\n", NUM_TEST_PARTICIPANTS, (int)ast_tvdiff_ms(pbx_tvnow(), start));
+	sccp_free(participants);
+
+	do {
+		int threads = sccp_threadpool_thread_count(conference_workers);
+		if (threads > maxThreads) {
+			maxThreads = threads;
+		}
+		pbx_mutex_lock(&conference_workers_stats_lock);
+		handled = conference_workers_stats.handled - handledBefore;
+		pbx_mutex_unlock(&conference_workers_stats_lock);
+		if (handled < NUM_TEST_PARTICIPANTS) {
+			usleep(10000);
+		}
+	} while (handled < NUM_TEST_PARTICIPANTS && loopcount++ < 3000);
+
+	pbx_mutex_lock(&conference_workers_stats_lock);
+	pbx_test_status_update(test, "Handled %d participants in %dms using at most %d worker threads, latency avg: %dms, max: %dms\n", handled, (int)ast_tvdiff_ms(pbx_tvnow(), start), maxThreads,
+		handled ? (int)((conference_workers_stats.totalLatency - latencyBefore) / handled) : 0, conference_workers_stats.maxLatency);
+	pbx_mutex_unlock(&conference_workers_stats_lock);
+	pbx_test_validate(test, handled == NUM_TEST_PARTICIPANTS);
+	pbx_test_validate(test, SCCP_RWLIST_GETSIZE(&conference->participants) == 0);
+	pbx_test_validate(test, maxThreads <= THREADPOOL_MAX_SIZE);
+
+	sccp_conference_release(&conference);									/* explicit release */
+	return AST_TEST_PASS;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_conference_worker_pool);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_conference_worker_pool);
+}
+#endif
+
 #endif
 
 // kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
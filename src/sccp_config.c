@@ -41,6 +41,7 @@
  *      - parses sccp.conf for device
  *      - set defaults for device if necessary using the default from globals using the same parameter name
  *      - set pendingUpdate on device for parameters marked with SCCP_CONFIG_NEEDDEVICERESET (remove pendingDelete)
+ *      - set pendingLiveUpdate on device for parameters marked with SCCP_CONFIG_NEEDLIVEUPDATE (labels, speeddials, softkeyset, cfwd, mwi)
  *      .
  *    - calls sccp_config_buildLine as usual
  *      - find line
@@ -48,6 +49,7 @@
  *      - parses sccp.conf for line
  *      - set defaults for line if necessary using the default from globals using the same parameter name
  *      - set pendingUpdate on line for parameters marked with SCCP_CONFIG_NEEDDEVICERESET (remove pendingDelete)
+ *      - set pendingLiveUpdate on line for parameters marked with SCCP_CONFIG_NEEDLIVEUPDATE (label, description)
  *      .
  *    - calls sccp_config_softKeySet as usual ***
  *      - find softKeySet
@@ -59,6 +61,7 @@
  *  - checks pendingDelete and pendingUpdate for
  *    - skip when call in progress
  *    - devices (via sccp_device_post_reload),
+ *      - pushes pendingLiveUpdate changes to registered devices (via sccp_device_apply_liveupdate)
  *      - resets GLOB(device) if pendingUpdate
  *      - removes GLOB(devices) with pendingDelete
  *      .
@@ -201,6 +204,7 @@
 #include "sccp_linedevice.h"
 #include "sccp_mwi.h"
 #include "sccp_session.h"
+#include "sccp_threadpool.h"
 #include "sccp_utils.h"
 #include "sccp_labels.h"
 #include "revision.h"
@@ -307,6 +311,7 @@ sccp_value_changed_t sccp_config_parse_permithosts(void * const dest, const size
 sccp_value_changed_t sccp_config_parse_addons(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 sccp_value_changed_t sccp_config_parse_privacyFeature(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 sccp_value_changed_t sccp_config_parse_debug(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
+sccp_value_changed_t sccp_config_parse_trace(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 sccp_value_changed_t sccp_config_parse_ipaddress(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 sccp_value_changed_t sccp_config_parse_port(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 sccp_value_changed_t sccp_config_parse_context(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
@@ -320,6 +325,8 @@ sccp_value_changed_t sccp_config_parse_jbflags_maxsize(void * const dest, const
 sccp_value_changed_t sccp_config_parse_jbflags_impl(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 sccp_value_changed_t sccp_config_parse_jbflags_jbresyncthreshold(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 sccp_value_changed_t sccp_config_checkButton(sccp_buttonconfig_list_t * buttonconfigList, int buttonindex, sccp_config_buttontype_t type, const char * name, const char * options, const char * args);
+static void sccp_config_updateButton(sccp_buttonconfig_list_t * buttonconfigList, int buttonindex, sccp_config_buttontype_t type, const char * name, const char * options);
+static sccp_configurationchange_t sccp_config_applyDeviceOptions(devicePtr d, PBX_VARIABLE_TYPE * v, uint8_t * liveUpdate);
 sccp_value_changed_t sccp_config_parse_webdir(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 sccp_value_changed_t sccp_config_parse_earlyrtp(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment);
 
@@ -361,6 +368,109 @@ static const SCCPConfigSegment * sccp_find_segment(const sccp_config_segment_t s
 	return NULL;
 }
 
+/*!
+ * \brief Precompiled Config Option Lookup Table
+ *
+ * Every segment gets a table holding each option name and each of its '|' separated aliases, sorted case insensitively, so
+ * sccp_find_config can bsearch instead of scanning (and strtok'ing) the option array on every call. The tables are built once,
+ * when the module is loaded. Names are referenced by pointer/length into the option table, so nothing gets allocated.
+ */
+#define SCCP_CONFIG_MAX_ALIASES 3										/* full name + aliases ("disallow|allow" -> 3 entries) */
+typedef struct sccp_config_lookup_entry {
+	const char *             name;
+	size_t                   len;
+	const SCCPConfigOption * option;
+} sccp_config_lookup_entry_t;
+
+typedef struct sccp_config_lookup {
+	sccp_config_lookup_entry_t * entries;
+	size_t                       size;
+} sccp_config_lookup_t;
+
+static sccp_config_lookup_entry_t sccpGlobalConfigLookup[ARRAY_LEN(sccpGlobalConfigOptions) * SCCP_CONFIG_MAX_ALIASES];
+static sccp_config_lookup_entry_t sccpDeviceConfigLookup[ARRAY_LEN(sccpDeviceConfigOptions) * SCCP_CONFIG_MAX_ALIASES];
+static sccp_config_lookup_entry_t sccpLineConfigLookup[ARRAY_LEN(sccpLineConfigOptions) * SCCP_CONFIG_MAX_ALIASES];
+static sccp_config_lookup_entry_t sccpSoftKeyConfigLookup[ARRAY_LEN(sccpSoftKeyConfigOptions) * SCCP_CONFIG_MAX_ALIASES];
+
+/* same order as sccpConfigSegments */
+static sccp_config_lookup_t sccpConfigLookup[] = {
+	{ sccpGlobalConfigLookup, 0 },
+	{ sccpDeviceConfigLookup, 0 },
+	{ sccpLineConfigLookup, 0 },
+	{ sccpSoftKeyConfigLookup, 0 },
+};
+
+static int sccp_config_lookup_compare(const void * a, const void * b)
+{
+	const sccp_config_lookup_entry_t * entry_a = (const sccp_config_lookup_entry_t *)a;
+	const sccp_config_lookup_entry_t * entry_b = (const sccp_config_lookup_entry_t *)b;
+	int                                res     = strncasecmp(entry_a->name, entry_b->name, entry_a->len < entry_b->len ? entry_a->len : entry_b->len);
+
+	if (!res && entry_a->len != entry_b->len) {
+		res = entry_a->len < entry_b->len ? -1 : 1;
+	}
+	if (!res && entry_a->option != entry_b->option) {
+		res = entry_a->option < entry_b->option ? -1 : 1;					/* keep option table order for duplicate names */
+	}
+	return res;
+}
+
+static int sccp_config_lookup_search(const void * key, const void * member)
+{
+	const char *                       name  = (const char *)key;
+	const sccp_config_lookup_entry_t * entry = (const sccp_config_lookup_entry_t *)member;
+	int                                res   = strncasecmp(name, entry->name, entry->len);
+
+	if (!res && name[entry->len] != '\0') {
+		res = 1;
+	}
+	return res;
+}
+
+static void __attribute__((constructor)) sccp_config_lookup_build(void)
+{
+	for (uint8_t i = 0; i < ARRAY_LEN(sccpConfigSegments); i++) {
+		const SCCPConfigSegment *    sccpConfigSegment = &sccpConfigSegments[i];
+		sccp_config_lookup_t *       lookup            = &sccpConfigLookup[i];
+		sccp_config_lookup_entry_t * entries           = lookup->entries;
+		size_t                       size              = 0;
+
+		for (long unsigned int opt = 0; opt < sccpConfigSegment->config_size; opt++) {
+			const SCCPConfigOption * option = &sccpConfigSegment->config[opt];
+			const char *             name   = option->name;
+			const char *             delim  = NULL;
+			uint8_t                  added  = 0;
+
+			entries[size++] = (sccp_config_lookup_entry_t){ option->name, strlen(option->name), option };
+			added++;
+			if (strchr(name, '|')) {
+				do {
+					delim = strchr(name, '|');
+					size_t len = delim ? (size_t)(delim - name) : strlen(name);
+					if (len && added < SCCP_CONFIG_MAX_ALIASES) {
+						entries[size++] = (sccp_config_lookup_entry_t){ name, len, option };
+						added++;
+					}
+					if (delim) {
+						name = delim + 1;
+					}
+				} while (delim);
+			}
+		}
+		qsort(entries, size, sizeof(sccp_config_lookup_entry_t), sccp_config_lookup_compare);
+
+		/* drop duplicate names, the first option in table order wins (like the old linear scan) */
+		size_t unique = 0;
+		for (size_t cur = 0; cur < size; cur++) {
+			if (unique && entries[unique - 1].len == entries[cur].len && !strncasecmp(entries[unique - 1].name, entries[cur].name, entries[cur].len)) {
+				continue;
+			}
+			entries[unique++] = entries[cur];
+		}
+		lookup->size = unique;
+	}
+}
+
 /*!
  * \brief Find of SCCP Config Options
  */
@@ -371,6 +481,22 @@ static const SCCPConfigOption * sccp_find_config(const sccp_config_segment_t seg
 		pbx_log(LOG_ERROR, "Could not find segement:%d\n", segment);
 		return NULL;
 	}
+	const sccp_config_lookup_t *       lookup = &sccpConfigLookup[sccpConfigSegment - sccpConfigSegments];
+	const sccp_config_lookup_entry_t * entry  = (const sccp_config_lookup_entry_t *)bsearch(name, lookup->entries, lookup->size, sizeof(sccp_config_lookup_entry_t), sccp_config_lookup_search);
+
+	return entry ? entry->option : NULL;
+}
+
+#if CS_TEST_FRAMEWORK
+/*!
+ * \brief Linear Find of SCCP Config Options (reference implementation for the lookup table test)
+ */
+static const SCCPConfigOption * sccp_find_config_linear(const sccp_config_segment_t segment, const char * name)
+{
+	const SCCPConfigSegment * sccpConfigSegment = sccp_find_segment(segment);
+	if (!sccpConfigSegment) {
+		return NULL;
+	}
 	const SCCPConfigOption * config = sccpConfigSegment->config;
 
 	char   delims[]    = "|";
@@ -398,6 +524,7 @@ static const SCCPConfigOption * sccp_find_config(const sccp_config_segment_t seg
 
 	return NULL;
 }
+#endif
 
 /* Create new variable structure for Multi Entry Parameters */
 /*
@@ -845,9 +972,15 @@ static sccp_configurationchange_t sccp_config_object_setValue(void * const obj,
 	if (SCCP_CONFIG_CHANGE_CHANGED == changed) {
 		if (GLOB(reload_in_progress)) {
 			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "SCCP: config parameter %s='%s' in line %d changed. %s\n", name, value, lineno,
-						    SCCP_CONFIG_NEEDDEVICERESET == sccpConfigOption->change ? "(causes device reset)" : "");
+						    SCCP_CONFIG_NEEDDEVICERESET == sccpConfigOption->change ? "(causes device reset)" : SCCP_CONFIG_NEEDLIVEUPDATE == sccpConfigOption->change ? "(live update)" : "");
 		}
 		changes = sccpConfigOption->change;
+	} else if (SCCP_CONFIG_CHANGE_LIVE == changed) {
+		/* the parser decided that only live-applicable parts of a multi-entry changed (i.e. a speeddial label) */
+		if (GLOB(reload_in_progress)) {
+			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "SCCP: config parameter %s in line %d changed. (live update)\n", name, lineno);
+		}
+		changes = SCCP_CONFIG_NEEDLIVEUPDATE;
 	}
 
 	if ((SCCP_CONFIG_CHANGE_INVALIDVALUE != changed && SCCP_CONFIG_CHANGE_ERROR != changed)
@@ -878,6 +1011,8 @@ static sccp_configurationchange_t sccp_config_object_setValue(void * const obj,
  * check if we can find the param name in the segment specified and retrieving its value or default value
  * copy the string from the defaultSegment and run through the converter again
  */
+AST_MUTEX_DEFINE_STATIC(sccp_config_cfgBrowseLock);							/*!< serializes browsing GLOB(cfg) while devices/lines are built in parallel */
+
 static void sccp_config_set_defaults(void * const obj, const sccp_config_segment_t segment, boolean_t * SetEntries)
 {
 	if (!GLOB(cfg)) {
@@ -956,6 +1091,7 @@ static void sccp_config_set_defaults(void * const obj, const sccp_config_segment
 				snprintf(option_tokens, sizeof(option_tokens), "%s|", sccpDstConfig[cur_elem].name);
 				char * option_tokens_saveptr = NULL;
 				char * option_name           = strtok_r(option_tokens, "|", &option_tokens_saveptr);
+				pbx_mutex_lock(&sccp_config_cfgBrowseLock);
 				do {
 					/* search for the default values in the referred segment, if found break so we can pass on the cat_root */
 					for (cat_root = v = ast_variable_browse(GLOB(cfg), referral_cat); v; v = v->next) {
@@ -967,6 +1103,7 @@ static void sccp_config_set_defaults(void * const obj, const sccp_config_segment
 						}
 					}
 				} while ((option_name = strtok_r(NULL, "|", &option_tokens_saveptr)) != NULL);
+				pbx_mutex_unlock(&sccp_config_cfgBrowseLock);
 
 				if (referralValueFound && v) { /* if referred to other segment and a value was found, pass the newly found cat_root directly to setValue */
 					sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_3 "Refer default value lookup for parameter:'%s' through '%s' segment\n", sccpDstConfig[cur_elem].name, referral_cat);
@@ -1578,6 +1715,41 @@ sccp_value_changed_t sccp_config_parse_debug(void * const dest, const size_t siz
 	return changed;
 }
 
+/*!
+ * \brief Config Converter/Parser for Trace
+ *
+ * \note multi_entry, accepts the same categories as debug, optionally followed by "device <deviceId>"
+ */
+sccp_value_changed_t sccp_config_parse_trace(void * const dest, const size_t size, PBX_VARIABLE_TYPE * v, const sccp_config_segment_t segment)
+{
+	sccp_value_changed_t changed   = SCCP_CONFIG_CHANGE_NOCHANGE;
+	uint32_t             trace_new = 0;
+	char                 device[StationMaxDeviceNameSize] = "";
+	char *               trace_arr[16] = { 0 };
+
+	for (; v; v = v->next) {
+		char * value = pbx_strdup(v->value);
+		char * tokenrest = NULL;
+		int    ntokens = 0;
+		for (char * token = strtok_r(value, " \t", &tokenrest); token && ntokens < (int)ARRAY_LEN(trace_arr); token = strtok_r(NULL, " \t", &tokenrest)) {
+			trace_arr[ntokens++] = token;
+		}
+		if (ntokens > 0) {
+			trace_new = sccp_parse_traceline(trace_arr, 0, ntokens, trace_new, device, sizeof(device));
+		}
+		sccp_free(value);
+	}
+	if (!sccp_strequals(sccp_trace_getdevice(), device)) {
+		sccp_trace_setdevice(device);
+		changed = SCCP_CONFIG_CHANGE_CHANGED;
+	}
+	if (*(uint32_t *)dest != trace_new) {
+		*(uint32_t *)dest = trace_new;
+		changed           = SCCP_CONFIG_CHANGE_CHANGED;
+	}
+	return changed;
+}
+
 /*!
  * \brief Config Converter/Parser for Earlyrtp
  *
@@ -2014,6 +2186,7 @@ sccp_value_changed_t sccp_config_parse_button(void * const dest, const size_t si
 	/* temp */
 
 	if (GLOB(reload_in_progress)) {
+		boolean_t liveChanges = FALSE;
 		changed = SCCP_CONFIG_CHANGE_NOCHANGE;
 		sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_3 "SCCP: Checking Button Config\n");
 		/* check if the number of buttons got reduced */
@@ -2032,8 +2205,12 @@ sccp_value_changed_t sccp_config_parse_button(void * const dest, const size_t si
 				changed = SCCP_CONFIG_CHANGE_INVALIDVALUE;
 				type    = EMPTY;
 			}
-			if ((changed = sccp_config_checkButton(buttonconfigList, buttonindex, type, buttonName ? pbx_strip(buttonName) : NULL, buttonOption ? pbx_strip(buttonOption) : NULL,
-							       buttonArgs ? pbx_strip(buttonArgs) : NULL))) {
+			changed = sccp_config_checkButton(buttonconfigList, buttonindex, type, buttonName ? pbx_strip(buttonName) : NULL, buttonOption ? pbx_strip(buttonOption) : NULL,
+							  buttonArgs ? pbx_strip(buttonArgs) : NULL);
+			if (SCCP_CONFIG_CHANGE_LIVE == changed) {
+				liveChanges = TRUE;
+				changed     = SCCP_CONFIG_CHANGE_NOCHANGE;
+			} else if (changed) {
 				sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_3 "Button: %s changed. Giving up on checking buttonchanges, reloading all of them.\n", v->value);
 				break;
 			}
@@ -2056,6 +2233,20 @@ sccp_value_changed_t sccp_config_parse_button(void * const dest, const size_t si
 				config->pendingUpdate = 0;
 			}
 			SCCP_LIST_UNLOCK(buttonconfigList);
+			if (liveChanges) {
+				/* layout is unchanged, only labels/targets differ: update the existing buttons in place */
+				buttonindex = 0;
+				for (v = first_var; v && !sccp_strlen_zero(v->value); v = v->next) {
+					sccp_copy_string(k_button, v->value, sizeof(k_button));
+					splitter     = k_button;
+					buttonType   = strsep(&splitter, ",");
+					buttonName   = strsep(&splitter, ",");
+					buttonOption = strsep(&splitter, ",");
+					sccp_config_updateButton(buttonconfigList, buttonindex, sccp_config_buttontype_str2val(buttonType), buttonName ? pbx_strip(buttonName) : NULL, buttonOption ? pbx_strip(buttonOption) : NULL);
+					buttonindex++;
+				}
+				changed = SCCP_CONFIG_CHANGE_LIVE;
+			}
 		}
 	}
 	/* temp current buttonconfiglist status*/
@@ -2069,7 +2260,7 @@ sccp_value_changed_t sccp_config_parse_button(void * const dest, const size_t si
 		SCCP_LIST_UNLOCK(buttonconfigList);
 	}
 	/* temp */
-	if (changed) {
+	if (changed && SCCP_CONFIG_CHANGE_LIVE != changed) {
 		buttonindex = 0; /* buttonconfig has changed. Load all buttons as new ones */
 		sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_3 "Any Previous ButtonConfig will be discared during post-process\n");
 		for (v = first_var; v && !sccp_strlen_zero(v->value); v = v->next) {
@@ -2106,7 +2297,7 @@ sccp_value_changed_t sccp_config_parse_button(void * const dest, const size_t si
 
 	/* return changed status */
 	if (GLOB(reload_in_progress)) {
-		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_3 "buttonconfig: %s\n", changed ? "changed" : "remained the same");
+		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_3 "buttonconfig: %s\n", SCCP_CONFIG_CHANGE_LIVE == changed ? "labels changed" : changed ? "changed" : "remained the same");
 	}
 
 	return changed;
@@ -2182,22 +2373,30 @@ sccp_value_changed_t sccp_config_checkButton(sccp_buttonconfig_list_t * buttonco
 					break;
 				}
 			case SPEEDDIAL:
-				/* \todo check if values change */
-				if (SPEEDDIAL == config->type && sccp_strequals(config->label, name) && sccp_strequals(config->button.speeddial.ext, options)) {
-					if (!args || sccp_strequals(config->button.speeddial.hint, args)) {
+				/* the hint drives the subscriptions, label and extension can be pushed to the phone */
+				if (SPEEDDIAL == config->type && (!args || sccp_strequals(config->button.speeddial.hint, args))) {
+					if (sccp_strequals(config->label, name) && sccp_strequals(config->button.speeddial.ext, options)) {
 						sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Speeddial Button Definition remained the same\n");
 						changed = SCCP_CONFIG_CHANGE_NOCHANGE;
+					} else if (!sccp_strlen_zero(name) && options) {
+						sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Speeddial Button Label/Extension changed (live)\n");
+						changed = SCCP_CONFIG_CHANGE_LIVE;
 					}
 				}
 				break;
 			case SERVICE:
-				if (SERVICE == config->type && sccp_strequals(config->label, name) && sccp_strequals(config->button.service.url, options)) {
-					sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Service Button Definition remained the same\n");
-					changed = SCCP_CONFIG_CHANGE_NOCHANGE;
+				if (SERVICE == config->type) {
+					if (sccp_strequals(config->label, name) && sccp_strequals(config->button.service.url, options)) {
+						sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Service Button Definition remained the same\n");
+						changed = SCCP_CONFIG_CHANGE_NOCHANGE;
+					} else if (!sccp_strlen_zero(name) && options) {
+						sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Service Button Label/URL changed (live)\n");
+						changed = SCCP_CONFIG_CHANGE_LIVE;
+					}
 				}
 				break;
 			case FEATURE:
-				if (FEATURE == config->type && buttonindex == config->index && sccp_strequals(config->label, name) && config->button.feature.id == sccp_feature_type_str2val(options)) {
+				if (FEATURE == config->type && buttonindex == config->index && !sccp_strlen_zero(name) && config->button.feature.id == sccp_feature_type_str2val(options)) {
 					char * default_option        = "";
 					char * default_arg           = "";
 					char   combined_args[512]    = "";
@@ -2219,8 +2418,13 @@ sccp_value_changed_t sccp_config_checkButton(sccp_buttonconfig_list_t * buttonco
 					snprintf(combined_args, sizeof(combined_args), "%s, %s", elems.option ? elems.option : default_option, elems.arg ? elems.arg : default_arg);
 					sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "old:'%s' / new:'%s'\n", combined_current, combined_args);
 					if ((sccp_strequals(combined_current, combined_args))) {
-						sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Feature Button Definition remained the same\n");
-						changed = SCCP_CONFIG_CHANGE_NOCHANGE;
+						if (sccp_strequals(config->label, name)) {
+							sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Feature Button Definition remained the same\n");
+							changed = SCCP_CONFIG_CHANGE_NOCHANGE;
+						} else {
+							sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Feature Button Label changed (live)\n");
+							changed = SCCP_CONFIG_CHANGE_LIVE;
+						}
 						break;
 					}
 					sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "SCCP: Feature Button Definition changed\n");
@@ -2237,7 +2441,9 @@ sccp_value_changed_t sccp_config_checkButton(sccp_buttonconfig_list_t * buttonco
 				break;
 		}
 	}
-	if (changed) {
+	if (SCCP_CONFIG_CHANGE_LIVE == changed) {
+		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_4 "SCCP: ButtonTemplate remained the same, button labels changed\n");
+	} else if (changed) {
 		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_4 "SCCP: ButtonTemplate has changed\n");
 	} else {
 		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_4 "SCCP: ButtonTemplate remained the same\n");
@@ -2245,6 +2451,75 @@ sccp_value_changed_t sccp_config_checkButton(sccp_buttonconfig_list_t * buttonco
 	return changed;
 }
 
+/*!
+ * \brief Keep a label/ext/url replaced by sccp_config_updateButton until the buttonconfig is destroyed
+ * \note readers (serviceURL/feature/speeddial lookups, stimulus handlers) use these strings without the buttonconfig lock, so they
+ *       cannot be freed while the buttonconfig is still in use. On allocation failure the string is leaked instead of freed.
+ */
+static void sccp_config_retireButtonValue(sccp_buttonconfig_t * config, char * value)
+{
+	struct sccp_buttonconfig_retired * retired = NULL;
+
+	if (value && (retired = (struct sccp_buttonconfig_retired *)sccp_calloc(1, sizeof(struct sccp_buttonconfig_retired)))) {
+		retired->value  = value;
+		retired->next   = config->retired;
+		config->retired = retired;
+	}
+}
+
+/*!
+ * \brief update the label and target of an existing Button in place
+ *
+ * \param buttonconfigList pointer to the device->buttonconfig list
+ * \param buttonindex button index
+ * \param type type of button
+ * \param name name (label)
+ * \param options options (speeddial extension / service url)
+ *
+ * \note only to be used after sccp_config_checkButton returned SCCP_CONFIG_CHANGE_LIVE for the complete button set
+ */
+static void sccp_config_updateButton(sccp_buttonconfig_list_t * buttonconfigList, int buttonindex, sccp_config_buttontype_t type, const char * name, const char * options)
+{
+	sccp_buttonconfig_t * config   = NULL;
+	char *                oldLabel = NULL;
+	char *                oldValue = NULL;
+
+	SCCP_LIST_LOCK(buttonconfigList);
+	SCCP_LIST_TRAVERSE(buttonconfigList, config, list) {
+		if (config->index == buttonindex) {
+			break;
+		}
+	}
+	if (config && config->type == type && !sccp_strlen_zero(name)) {
+		if (!sccp_strequals(config->label, name)) {
+			oldLabel      = config->label;
+			config->label = pbx_strdup(name);
+		}
+		switch (type) {
+			case SPEEDDIAL:
+				if (options && !sccp_strequals(config->button.speeddial.ext, options)) {
+					oldValue                     = config->button.speeddial.ext;
+					config->button.speeddial.ext = pbx_strdup(options);
+				}
+				break;
+			case SERVICE:
+				if (options && !sccp_strequals(config->button.service.url, options)) {
+					oldValue                   = config->button.service.url;
+					config->button.service.url = pbx_strdup(options);
+				}
+				break;
+			default:
+				break;
+		}
+		if (oldLabel || oldValue) {
+			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_4 "SCCP: Updated %s Button at index:%d -> label:%s\n", sccp_config_buttontype2str(type), buttonindex, config->label);
+		}
+		sccp_config_retireButtonValue(config, oldLabel);
+		sccp_config_retireButtonValue(config, oldValue);
+	}
+	SCCP_LIST_UNLOCK(buttonconfigList);
+}
+
 /*!
  * \brief add a Button to a device
  *
@@ -2442,12 +2717,13 @@ static void sccp_config_buildLine(sccp_line_t * l, PBX_VARIABLE_TYPE * v, boolea
 	l->realtime = isRealtime;
 #endif
 	// if (GLOB(reload_in_progress) && res == SCCP_CONFIG_NEEDDEVICERESET && l && l->pendingDelete) {
-	if (GLOB(reload_in_progress) && res == SCCP_CONFIG_NEEDDEVICERESET) {
+	if (GLOB(reload_in_progress) && (res & SCCP_CONFIG_NEEDDEVICERESET)) {
 		sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_1 "%s: major line changes detected, device reset required -> pendingUpdate=1\n", l->name);
 		l->pendingUpdate = 1;
 	} else {
 		l->pendingUpdate = 0;
 	}
+	l->pendingLiveUpdate = (GLOB(reload_in_progress) && !l->pendingUpdate && (res & SCCP_CONFIG_NEEDLIVEUPDATE)) ? TRUE : FALSE;
 	sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "%s: Removing pendingDelete\n", l->name);
 	l->pendingDelete = 0;
 }
@@ -2472,17 +2748,22 @@ static void sccp_config_buildDevice(sccp_device_t * d, PBX_VARIABLE_TYPE * varia
 	}
 
 	/* apply configuration */
-	sccp_configurationchange_t res = sccp_config_applyDeviceConfiguration(d, v);
+	uint8_t                    liveUpdate = SCCP_DEVICE_LIVEUPDATE_NONE;
+	sccp_configurationchange_t res        = sccp_config_applyDeviceOptions(d, v, &liveUpdate);
 
 #ifdef CS_SCCP_REALTIME
 	d->realtime = isRealtime;
 #endif
-	if (GLOB(reload_in_progress) && res == SCCP_CONFIG_NEEDDEVICERESET && d) {
+	if (GLOB(reload_in_progress) && (res & SCCP_CONFIG_NEEDDEVICERESET) && d) {
 		sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_1 "%s: major changes for device detected, device reset required -> pendingUpdate=1\n", d->id);
 		d->pendingUpdate = 1;
 	} else {
 		d->pendingUpdate = 0;
 	}
+	if (GLOB(reload_in_progress) && !d->pendingUpdate && (res & SCCP_CONFIG_NEEDLIVEUPDATE)) {
+		sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_1 "%s: minor changes for device detected, pushing them without reset\n", d->id);
+		sccp_device_addLiveUpdate(d, liveUpdate);
+	}
 	d->pendingDelete = 0;
 }
 
@@ -2591,12 +2872,13 @@ boolean_t sccp_config_general(sccp_readingtype_t readingtype)
 		sccp_netsock_setPort(&GLOB(bindaddr), DEFAULT_SCCP_PORT);
 	}
 
-	if (GLOB(reload_in_progress) && res == SCCP_CONFIG_NEEDDEVICERESET) {
+	if (GLOB(reload_in_progress) && (res & SCCP_CONFIG_NEEDDEVICERESET)) {
 		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_1 "SCCP: major changes detected in globals, reset required -> pendingUpdate=1\n");
 		GLOB(pendingUpdate) = 1;
 	} else {
 		GLOB(pendingUpdate) = 0;
 	}
+	GLOB(pendingLiveUpdate) = (GLOB(reload_in_progress) && (res & SCCP_CONFIG_NEEDLIVEUPDATE)) ? TRUE : FALSE;
 
 	if (GLOB(regcontext)) {
 		/* setup regcontext */
@@ -2667,84 +2949,236 @@ void cleanup_stale_contexts(char * new_contexts, char * old_contexts)
 }
 
 /*!
- * \brief Read Lines from the Config File
- *
- * \param readingtype as SCCP Reading Type
- * \since 10.01.2008 - branche V3
- * \author Marcello Ceschia
- *
- * \callgraph
- * \callergraph
+ * \brief Temporary name index, used while reading devices and lines
  *
+ * sccp_device_find_byid / sccp_line_find_byname walk the global lists, which made reading n sections O(n^2). The index is
+ * filled once from the global lists and consulted instead during the parse pass. Every slot holds a reference to its object,
+ * which is released by sccp_config_index_destroy.
  */
-boolean_t sccp_config_readDevicesLines(sccp_readingtype_t readingtype)
-{
-	// struct ast_config *cfg = NULL;
+typedef struct sccp_config_index_slot {
+	const char * name;											/*!< points into obj (device->id / line->name) */
+	void * obj;
+	boolean_t isNew;											/*!< created during this read, not yet added to globals */
+	uint32_t item;												/*!< 1-based index of the first section read for this name, 0 = none */
+} sccp_config_index_slot_t;
+
+typedef struct sccp_config_index {
+	sccp_config_index_slot_t * slots;
+	uint32_t size;												/*!< power of 2 */
+	uint32_t count;
+} sccp_config_index_t;
 
-	char *              cat          = NULL;
-	PBX_VARIABLE_TYPE * v            = NULL;
-	uint8_t             device_count = 0;
-	uint8_t             line_count   = 0;
-	sccp_device_t *     d            = NULL;
+/*!
+ * \brief Counters collected while reading devices and lines
+ */
+typedef struct sccp_config_readstats {
+	uint32_t devices;
+	uint32_t newDevices;
+	uint32_t lines;
+	uint32_t newLines;
+	uint32_t softkeysets;
+} sccp_config_readstats_t;
+
+static uint32_t sccp_config_index_hash(const char * name)
+{
+	uint32_t hash = 2166136261U;										/* FNV-1a, case insensitive */
+	for (; *name; name++) {
+		hash = (hash ^ (uint8_t)tolower((unsigned char)*name)) * 16777619U;
+	}
+	return hash;
+}
 
-	sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_1 "Loading Devices and Lines from config\n");
+static boolean_t sccp_config_index_init(sccp_config_index_t * index, uint32_t expected)
+{
+	uint32_t size = 64;
+	while (size < expected * 2) {
+		size <<= 1;
+	}
+	if (!(index->slots = (sccp_config_index_slot_t *)sccp_calloc(size, sizeof(sccp_config_index_slot_t)))) {
+		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, "SCCP");
+		return FALSE;
+	}
+	index->size  = size;
+	index->count = 0;
+	return TRUE;
+}
 
-	sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_1 "Checking Reading Type:%s (%d)\n", readingtype == 0 ? "Module load" : "Reload", readingtype);
-	if (readingtype == SCCP_CONFIG_READRELOAD) {
-		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Device Pre Reload\n");
-		sccp_device_pre_reload();
-		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Line Pre Reload\n");
-		sccp_line_pre_reload();
-		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Softkey Pre Reload\n");
-		sccp_softkey_pre_reload();
+static sccp_config_index_slot_t * sccp_config_index_slot(const sccp_config_index_slot_t * const slots, uint32_t size, const char * name)
+{
+	uint32_t mask = size - 1;
+	uint32_t pos  = sccp_config_index_hash(name) & mask;
+	while (slots[pos].name && !sccp_strcaseequals(slots[pos].name, name)) {
+		pos = (pos + 1) & mask;
 	}
+	return (sccp_config_index_slot_t *)&slots[pos];
+}
 
-	if (!GLOB(cfg)) {
-		pbx_log(LOG_NOTICE, "SCCP: (sccp_config_readDevicesLines) Unable to load config file sccp.conf, SCCP disabled\n");
+static void * sccp_config_index_find(const sccp_config_index_t * index, const char * name)
+{
+	return sccp_config_index_slot(index->slots, index->size, name)->obj;
+}
+
+/*!
+ * \brief Add obj to the index, taking over the reference held by the caller
+ * \note on failure the reference is left with the caller
+ */
+static boolean_t sccp_config_index_add(sccp_config_index_t * index, const char * name, void * obj, boolean_t isNew)
+{
+	sccp_config_index_slot_t * slot = NULL;
+
+	if ((index->count + 1) * 2 > index->size) {
+		uint32_t                   size  = index->size << 1;
+		sccp_config_index_slot_t * slots = (sccp_config_index_slot_t *)sccp_calloc(size, sizeof(sccp_config_index_slot_t));
+		if (!slots) {
+			pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, "SCCP");
+			return FALSE;
+		}
+		for (uint32_t pos = 0; pos < index->size; pos++) {
+			if (index->slots[pos].name) {
+				*sccp_config_index_slot(slots, size, index->slots[pos].name) = index->slots[pos];
+			}
+		}
+		sccp_free(index->slots);
+		index->slots = slots;
+		index->size  = size;
+	}
+	slot = sccp_config_index_slot(index->slots, index->size, name);
+	if (slot->name) {
 		return FALSE;
 	}
+	slot->name  = name;
+	slot->obj   = obj;
+	slot->isNew = isNew;
+	index->count++;
+	return TRUE;
+}
 
-	while ((cat = pbx_category_browse(GLOB(cfg), cat))) {
-		const char * utype = NULL;
+/*!
+ * \brief Return the objects marked isNew, sorted using compare. Caller has to free the returned array.
+ */
+static void ** sccp_config_index_getNew(const sccp_config_index_t * index, uint32_t * count, int (*compare)(const void *, const void *))
+{
+	void ** objs = (void **)sccp_calloc(index->count + 1, sizeof(void *));
+	if (!objs) {
+		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, "SCCP");
+		*count = 0;
+		return NULL;
+	}
+	*count = 0;
+	for (uint32_t pos = 0; pos < index->size; pos++) {
+		if (index->slots[pos].name && index->slots[pos].isNew) {
+			objs[(*count)++] = index->slots[pos].obj;
+		}
+	}
+	qsort(objs, *count, sizeof(void *), compare);
+	return objs;
+}
 
-		if (!strcasecmp(cat, "general")) {
-			continue;
+static void sccp_config_index_destroy(sccp_config_index_t * index)
+{
+	if (!index->slots) {
+		return;
+	}
+	for (uint32_t pos = 0; pos < index->size; pos++) {
+		if (index->slots[pos].obj) {
+			sccp_refcount_release((const void **)&index->slots[pos].obj, __FILE__, __LINE__, __PRETTY_FUNCTION__);
 		}
-		utype = pbx_variable_retrieve(GLOB(cfg), cat, "type");
-		sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_2 "SCCP: (sccp_config_readDevicesLines) Reading Section Of Type %s\n", utype);
+	}
+	sccp_free(index->slots);
+	index->size  = 0;
+	index->count = 0;
+}
 
-		if (!utype) {
-			pbx_log(LOG_WARNING, "Section '%s' is missing a type parameter\n", cat);
-			continue;
-		} else if (!strcasecmp(utype, "device")) {
-			// check minimum requirements for a device
-			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Parsing device [%s]\n", cat);
-			v = ast_variable_browse(GLOB(cfg), cat);
+static int sccp_config_device_compare(const void * a, const void * b)
+{
+	return sccp_strversioncmp((*(sccp_device_t * const *)a)->id, (*(sccp_device_t * const *)b)->id);
+}
 
-			// Try to find out if we have the device already on file.
-			// However, do not look into realtime, since
-			// we might have been asked to create a device for realtime addition,
-			// thus causing an infinite loop / recursion.
-			AUTO_RELEASE(sccp_device_t, device, sccp_device_find_byid(cat, FALSE));
-			sccp_nat_t nat = SCCP_NAT_AUTO;
+static int sccp_config_line_compare(const void * a, const void * b)
+{
+	return sccp_strversioncmp((*(sccp_line_t * const *)a)->cid_num, (*(sccp_line_t * const *)b)->cid_num);
+}
 
-			/* create new device with default values */
-			if (!device) {
-				device = sccp_device_create(cat) /*ref_replace*/;
-				if (!device) {
-					return FALSE;
-				}
-				// sccp_copy_string(d->id, cat, sizeof(d->id));         /* set device name */
-				sccp_device_addToGlobals(device);
-				device_count++;
-			} else {
-				if (device->pendingDelete) {
-					nat                   = device->nat;
-					device->pendingDelete = 0;
-				}
+/*!
+ * \brief Fill the device and line name indexes from the global lists
+ */
+static boolean_t sccp_config_index_fill(sccp_config_index_t * devices, sccp_config_index_t * lines)
+{
+	boolean_t       res = TRUE;
+	sccp_device_t * d   = NULL;
+	sccp_line_t *   l   = NULL;
+
+	SCCP_RWLIST_RDLOCK(&GLOB(devices));
+	SCCP_RWLIST_TRAVERSE(&GLOB(devices), d, list) {
+		sccp_device_t * device = sccp_device_retain(d);
+		if (device && (sccp_config_index_find(devices, device->id) || !sccp_config_index_add(devices, device->id, device, FALSE))) {
+			sccp_device_release(&device);							/* explicit release, duplicate name or out of memory */
+			res = res && sccp_config_index_find(devices, d->id);
+		}
+	}
+	SCCP_RWLIST_UNLOCK(&GLOB(devices));
+
+	SCCP_RWLIST_RDLOCK(&GLOB(lines));
+	SCCP_RWLIST_TRAVERSE(&GLOB(lines), l, list) {
+		sccp_line_t * line = sccp_line_retain(l);
+		if (line && (sccp_config_index_find(lines, line->name) || !sccp_config_index_add(lines, line->name, line, FALSE))) {
+			sccp_line_release(&line);							/* explicit release, duplicate name or out of memory */
+			res = res && sccp_config_index_find(lines, l->name);
+		}
+	}
+	SCCP_RWLIST_UNLOCK(&GLOB(lines));
+	return res;
+}
+
+#define SCCP_CONFIG_READ_CHUNK 256										/* sections per threadpool job during a parallel load */
+
+/*!
+ * \brief One device or line section read from the config, to be built by sccp_config_buildItems
+ *
+ * When the same name appears in more than one section, the later sections are chained to the first one (next), so they are
+ * always applied to the object by the same thread and in config order.
+ */
+typedef struct sccp_config_readitem {
+	const char *        cat;
+	PBX_VARIABLE_TYPE * v;
+	sccp_device_t *     device;										/*!< reference held by the device index */
+	sccp_line_t *       line;										/*!< reference held by the line index */
+	uint32_t            ordinal;										/*!< device/line number, in config order */
+	uint32_t            next;										/*!< 1-based index of the next section for the same object, 0 = none */
+	uint32_t            last;										/*!< 1-based index of the last section in this chain */
+	boolean_t           isNew;
+	boolean_t           hasId;										/*!< line section sets 'id' */
+	boolean_t           chained;										/*!< built as part of an earlier item's chain */
+} sccp_config_readitem_t;
+
+/*!
+ * \brief Range of read items handed to a threadpool worker
+ */
+typedef struct sccp_config_readjob {
+	sccp_config_readitem_t * items;
+	uint32_t                 start;
+	uint32_t                 end;
+	pbx_mutex_t *            lock;
+	pbx_cond_t *             done;
+	uint32_t *               pending;
+} sccp_config_readjob_t;
+
+/*!
+ * \brief Apply the section(s) of one read item (and its chain) to its device or line
+ */
+static void sccp_config_buildItem(sccp_config_readitem_t * items, uint32_t idx)
+{
+	for (sccp_config_readitem_t * item = &items[idx]; item; item = item->next ? &items[item->next - 1] : NULL) {
+		if (item->device) {
+			sccp_device_t * device = item->device;
+			sccp_nat_t      nat    = SCCP_NAT_AUTO;
+
+			if (device->pendingDelete) {
+				nat                   = device->nat;
+				device->pendingDelete = 0;
 			}
-			sccp_config_buildDevice(device, v, FALSE);
-			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_3 "found device %d: %s\n", device_count, cat);
+			sccp_config_buildDevice(device, item->v, FALSE);
+			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_3 "found device %u: %s\n", item->ordinal, item->cat);
 			/* load saved settings from ast db */
 			// sccp_config_restoreDeviceFeatureStatus(device);
 
@@ -2754,57 +3188,362 @@ boolean_t sccp_config_readDevicesLines(sccp_readingtype_t readingtype)
 					device->nat = nat;
 				}
 			}
-		} else if (!strcasecmp(utype, "line")) {
-			/* check minimum requirements for a line */
-			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Parsing line [%s]\n", cat);
-
-			if ((!(!sccp_strlen_zero(pbx_variable_retrieve(GLOB(cfg), cat, "label"))) && (!sccp_strlen_zero(pbx_variable_retrieve(GLOB(cfg), cat, "cid_name")))
-			     && (!sccp_strlen_zero(pbx_variable_retrieve(GLOB(cfg), cat, "cid_num"))))) {
-				pbx_log(LOG_WARNING, "Unknown type '%s' for '%s' in %s\n", utype, cat, "sccp.conf");
-				continue;
-			}
-			line_count++;
-
-			v = ast_variable_browse(GLOB(cfg), cat);
-			AUTO_RELEASE(sccp_line_t, l, sccp_line_find_byname(cat, FALSE));
+		} else if (item->line) {
+			sccp_line_t * l = item->line;
 
-			/* check if we have this line already */
-			if (l) {
-				sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_3 "found line %d: %s, do update\n", line_count, cat);
-				sccp_config_buildLine(l, v, FALSE);
-			} else if ((l = sccp_line_create(cat)) /*ref_replace*/) {
-				sccp_config_buildLine(l, v, FALSE);
-				sccp_line_addToGlobals(l); /* may find another line instance create by another thread, in that case the newly created line is going to be dropped when l is released */
-			} else {
-				return FALSE;
+			if (!item->isNew) {
+				sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_3 "found line %u: %s, do update\n", item->ordinal, item->cat);
 			}
-		} else if (!strcasecmp(utype, "softkeyset")) {
-			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "parsing softkey [%s]\n", cat);
-			if (sccp_strcaseequals(cat, "default")) {
-				pbx_log(LOG_WARNING, "SCCP: (sccp_config_readDevicesLines) The 'default' softkeyset cannot be overriden, please use another name\n");
-			} else {
-				v = ast_variable_browse(GLOB(cfg), cat);
-				sccp_config_softKeySet(v, cat);
+			sccp_config_buildLine(l, item->v, FALSE);
+			if (item->isNew && !item->hasId) {
+				/* default id, numbered in config order (instead of by the global line list size), so it does not depend on
+				 * the order in which the lines are built */
+				snprintf(l->id, sizeof(l->id), "%04u", item->ordinal);
 			}
-		} else {
-			pbx_log(LOG_WARNING, "SCCP: (sccp_config_readDevicesLines) UNKNOWN SECTION / UTYPE, type: %s\n", utype);
 		}
 	}
-	sccp_config_add_default_softkeyset();
+}
 
-#ifdef CS_SCCP_REALTIME
-	/* reload realtime lines */
-	sccp_configurationchange_t res = SCCP_CONFIG_NOUPDATENEEDED;
-	PBX_VARIABLE_TYPE *        rv  = NULL;
+static void * sccp_config_buildItems(void * ptr)
+{
+	sccp_config_readjob_t * job = (sccp_config_readjob_t *)ptr;
 
-	sccp_line_t * l = NULL;
-	SCCP_RWLIST_RDLOCK(&GLOB(lines));
-	SCCP_RWLIST_TRAVERSE(&GLOB(lines), l, list) {
-		AUTO_RELEASE(sccp_line_t, line, sccp_line_retain(l));
-		if (line) {
-			do {
-				if (line->realtime == TRUE && line != GLOB(hotline)->line) {
-					sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_3 "%s: reload realtime line\n", line->name);
+	for (uint32_t idx = job->start; idx < job->end; idx++) {
+		if (!job->items[idx].chained) {
+			sccp_config_buildItem(job->items, idx);
+		}
+	}
+	pbx_mutex_lock(job->lock);
+	if (--(*job->pending) == 0) {
+		pbx_cond_signal(job->done);
+	}
+	pbx_mutex_unlock(job->lock);
+	return NULL;
+}
+
+/*!
+ * \brief Build the read items using a temporary threadpool
+ *
+ * Items are split into contiguous ranges, one job each. Every object is built by exactly one job (chains never cross a job,
+ * as chained items are skipped), and new objects are only added to the global lists afterwards, sorted, so the result does
+ * not depend on the number of threads or on scheduling.
+ *
+ * Shared state touched by buildDevice/buildLine while the jobs run:
+ * - GLOB(cfg): browsed by sccp_config_set_defaults for referred defaults, under sccp_config_cfgBrowseLock.
+ * - softKeySetConfig: not used, devices only store the softkeyset name, the softkeysets were read in the serial pass.
+ * - GLOB() settings, GLOB(devices), GLOB(lines): only read; nothing writes them until all jobs are done (initial load only).
+ */
+static boolean_t sccp_config_buildItemsParallel(sccp_config_readitem_t * items, uint32_t numItems)
+{
+	sccp_threadpool_t *     pool    = NULL;
+	sccp_config_readjob_t * jobs    = NULL;
+	uint32_t                numJobs = (numItems + SCCP_CONFIG_READ_CHUNK - 1) / SCCP_CONFIG_READ_CHUNK;
+	uint32_t                pending = 0;
+	pbx_mutex_t             lock;
+	pbx_cond_t              done;
+
+	if (!numJobs) {
+		return TRUE;
+	}
+	if (!(jobs = (sccp_config_readjob_t *)sccp_calloc(numJobs, sizeof(sccp_config_readjob_t)))) {
+		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, "SCCP");
+		return FALSE;
+	}
+	if (!(pool = sccp_threadpool_init(0))) {
+		sccp_free(jobs);
+		return FALSE;
+	}
+	pbx_mutex_init(&lock);
+	pbx_cond_init(&done, NULL);
+
+	pending = numJobs;											/* set before the first job can finish, the lock is not held while queueing */
+	for (uint32_t job = 0; job < numJobs; job++) {
+		uint32_t end = (job + 1) * SCCP_CONFIG_READ_CHUNK;
+		jobs[job]    = (sccp_config_readjob_t){ items, job * SCCP_CONFIG_READ_CHUNK, end < numItems ? end : numItems, &lock, &done, &pending };
+		if (!sccp_threadpool_add_work(pool, sccp_config_buildItems, &jobs[job])) {
+			sccp_config_buildItems(&jobs[job]);						/* pool refused the job, build it ourselves */
+		}
+	}
+	pbx_mutex_lock(&lock);
+	while (pending) {
+		pbx_cond_wait(&done, &lock);
+	}
+	pbx_mutex_unlock(&lock);
+
+	sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "SCCP: Built %u sections in %u jobs using %d threads\n", numItems, numJobs, sccp_threadpool_thread_count(pool));
+	sccp_threadpool_destroy(pool);
+	pbx_cond_destroy(&done);
+	pbx_mutex_destroy(&lock);
+	sccp_free(jobs);
+	return TRUE;
+}
+
+/*!
+ * \brief Parse all device, line and softkeyset sections of cfg
+ *
+ * A first pass over the categories looks up existing devices/lines in the name indexes, creates the new ones (added to the
+ * index, marked isNew, left for the caller to add to the global lists) and reads the softkeysets. The devices and lines are
+ * then built from their sections, either in this thread or, when parallel is set, spread over a temporary threadpool.
+ */
+static boolean_t sccp_config_readSections(struct ast_config * cfg, sccp_config_index_t * devices, sccp_config_index_t * lines, sccp_config_readstats_t * stats, boolean_t parallel)
+{
+	char *                   cat      = NULL;
+	PBX_VARIABLE_TYPE *      v        = NULL;
+	sccp_config_readitem_t * items    = NULL;
+	uint32_t                 numItems = 0;
+	uint32_t                 size     = 0;
+	uint32_t                 lineBase = SCCP_RWLIST_GETSIZE(&GLOB(lines));
+	boolean_t                res      = FALSE;
+
+	while ((cat = pbx_category_browse(cfg, cat))) {
+		const char *               utype    = NULL;
+		const char *               label    = NULL;
+		const char *               cid_name = NULL;
+		const char *               cid_num  = NULL;
+		boolean_t                  hasId    = FALSE;
+		sccp_config_index_slot_t * slot     = NULL;
+		sccp_config_readitem_t *   item     = NULL;
+
+		if (!strcasecmp(cat, "general")) {
+			continue;
+		}
+		/* collect the fields we need to decide on the section type, in one go */
+		for (v = ast_variable_browse(cfg, cat); v; v = v->next) {
+			if (!utype && !strcasecmp(v->name, "type")) {
+				utype = v->value;
+			} else if (!label && !strcasecmp(v->name, "label")) {
+				label = v->value;
+			} else if (!cid_name && !strcasecmp(v->name, "cid_name")) {
+				cid_name = v->value;
+			} else if (!cid_num && !strcasecmp(v->name, "cid_num")) {
+				cid_num = v->value;
+			} else if (!strcasecmp(v->name, "id")) {
+				hasId = TRUE;
+			}
+		}
+		v = ast_variable_browse(cfg, cat);
+		sccp_log_and((DEBUGCAT_CONFIG + DEBUGCAT_HIGH))(VERBOSE_PREFIX_2 "SCCP: (sccp_config_readDevicesLines) Reading Section Of Type %s\n", utype);
+
+		if (!utype) {
+			pbx_log(LOG_WARNING, "Section '%s' is missing a type parameter\n", cat);
+			continue;
+		} else if (!strcasecmp(utype, "softkeyset")) {
+			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "parsing softkey [%s]\n", cat);
+			if (sccp_strcaseequals(cat, "default")) {
+				pbx_log(LOG_WARNING, "SCCP: (sccp_config_readDevicesLines) The 'default' softkeyset cannot be overriden, please use another name\n");
+			} else {
+				sccp_config_softKeySet(v, cat);
+				stats->softkeysets++;
+			}
+			continue;
+		} else if (strcasecmp(utype, "device") && strcasecmp(utype, "line")) {
+			pbx_log(LOG_WARNING, "SCCP: (sccp_config_readDevicesLines) UNKNOWN SECTION / UTYPE, type: %s\n", utype);
+			continue;
+		}
+
+		if (numItems == size) {
+			sccp_config_readitem_t * newItems = (sccp_config_readitem_t *)sccp_realloc(items, (size ? size * 2 : 256) * sizeof(sccp_config_readitem_t));
+			if (!newItems) {
+				pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, "SCCP");
+				goto EXIT;
+			}
+			items = newItems;
+			size  = size ? size * 2 : 256;
+		}
+		item  = &items[numItems];
+		*item = (sccp_config_readitem_t){ .cat = cat, .v = v, .hasId = hasId };
+
+		if (!strcasecmp(utype, "device")) {
+			// check minimum requirements for a device
+			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Parsing device [%s]\n", cat);
+
+			// Try to find out if we have the device already on file.
+			// However, do not look into realtime, since
+			// we might have been asked to create a device for realtime addition,
+			// thus causing an infinite loop / recursion.
+			slot = sccp_config_index_slot(devices->slots, devices->size, cat);
+			if (!slot->obj) {
+				/* create new device with default values */
+				sccp_device_t * device = sccp_device_create(cat) /*ref_replace*/;
+				if (!device) {
+					goto EXIT;
+				}
+				if (!sccp_config_index_add(devices, device->id, device, TRUE)) {
+					sccp_device_release(&device);						/* explicit release */
+					goto EXIT;
+				}
+				slot = sccp_config_index_slot(devices->slots, devices->size, cat);	/* index may have grown */
+				stats->newDevices++;
+			}
+			item->device  = (sccp_device_t *)slot->obj;
+			item->ordinal = ++stats->devices;
+		} else {
+			/* check minimum requirements for a line */
+			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Parsing line [%s]\n", cat);
+
+			if ((!(!sccp_strlen_zero(label)) && (!sccp_strlen_zero(cid_name)) && (!sccp_strlen_zero(cid_num)))) {
+				pbx_log(LOG_WARNING, "Unknown type '%s' for '%s' in %s\n", utype, cat, "sccp.conf");
+				continue;
+			}
+			slot = sccp_config_index_slot(lines->slots, lines->size, cat);
+			if (!slot->obj) {
+				sccp_line_t * l = sccp_line_alloc(cat) /*ref_replace*/;
+				if (!l) {
+					goto EXIT;
+				}
+				if (!sccp_config_index_add(lines, l->name, l, TRUE)) {
+					sccp_line_release(&l);							/* explicit release */
+					goto EXIT;
+				}
+				slot = sccp_config_index_slot(lines->slots, lines->size, cat);		/* index may have grown */
+				stats->newLines++;
+			}
+			item->line    = (sccp_line_t *)slot->obj;
+			item->ordinal = ++stats->lines;
+		}
+		item->isNew = slot->isNew;
+		if (item->isNew && item->line) {
+			item->ordinal = lineBase + stats->newLines;
+		}
+		numItems++;
+
+		if (slot->item) {
+			/* already read in this pass: append to the chain of the first section for this name */
+			sccp_config_readitem_t * head = &items[slot->item - 1];
+			items[head->last - 1].next    = numItems;
+			head->last                    = numItems;
+			item->chained                 = TRUE;
+			item->ordinal                 = head->ordinal;
+		} else {
+			slot->item = numItems;
+			item->last = numItems;
+		}
+	}
+
+	if (parallel) {
+		res = sccp_config_buildItemsParallel(items, numItems);
+	} else {
+		for (uint32_t idx = 0; idx < numItems; idx++) {
+			if (!items[idx].chained) {
+				sccp_config_buildItem(items, idx);
+			}
+		}
+		res = TRUE;
+	}
+EXIT:
+	if (items) {
+		sccp_free(items);
+	}
+	return res;
+}
+
+/*!
+ * \brief Add the newly created lines and devices to the global lists
+ *
+ * New objects are added in list order (lines by cid_num, devices by id), so SCCP_LIST_INSERT_SORTALPHA can append at the tail
+ * instead of walking the list for every insert.
+ */
+static void sccp_config_mergeNew(const sccp_config_index_t * devices, const sccp_config_index_t * lines)
+{
+	uint32_t count = 0;
+	void **  objs  = NULL;
+
+	if ((objs = sccp_config_index_getNew(lines, &count, sccp_config_line_compare))) {
+		for (uint32_t idx = 0; idx < count; idx++) {
+			sccp_line_addToGlobals((sccp_line_t *)objs[idx]);
+		}
+		sccp_free(objs);
+	}
+	if ((objs = sccp_config_index_getNew(devices, &count, sccp_config_device_compare))) {
+		for (uint32_t idx = 0; idx < count; idx++) {
+			sccp_device_addToGlobals((sccp_device_t *)objs[idx]);
+		}
+		sccp_free(objs);
+	}
+}
+
+/*!
+ * \brief Read Lines from the Config File
+ *
+ * \param readingtype as SCCP Reading Type
+ * \since 10.01.2008 - branche V3
+ * \author Marcello Ceschia
+ *
+ * Runs in phases: index (name lookup table of the current devices/lines), parse (single pass over sccp.conf), merge (new
+ * objects added to the global lists in sorted order) and realtime. The time spent in each phase is logged with debug=core.
+ * At module load with parallel_load=yes, the devices and lines are built on a temporary threadpool during the parse phase.
+ *
+ * \callgraph
+ * \callergraph
+ *
+ */
+boolean_t sccp_config_readDevicesLines(sccp_readingtype_t readingtype)
+{
+	// struct ast_config *cfg = NULL;
+
+	sccp_device_t *         d             = NULL;
+	sccp_config_index_t     deviceIndex   = { 0 };
+	sccp_config_index_t     lineIndex     = { 0 };
+	sccp_config_readstats_t stats         = { 0 };
+	boolean_t               result        = FALSE;
+	struct timeval          start         = { 0 };
+	struct timeval          phase         = { 0 };
+	int                     index_time    = 0;
+	int                     parse_time    = 0;
+	int                     merge_time    = 0;
+	int                     realtime_time = 0;
+
+	sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_1 "Loading Devices and Lines from config\n");
+
+	sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_1 "Checking Reading Type:%s (%d)\n", readingtype == 0 ? "Module load" : "Reload", readingtype);
+	if (readingtype == SCCP_CONFIG_READRELOAD) {
+		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Device Pre Reload\n");
+		sccp_device_pre_reload();
+		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Line Pre Reload\n");
+		sccp_line_pre_reload();
+		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Softkey Pre Reload\n");
+		sccp_softkey_pre_reload();
+	}
+
+	if (!GLOB(cfg)) {
+		pbx_log(LOG_NOTICE, "SCCP: (sccp_config_readDevicesLines) Unable to load config file sccp.conf, SCCP disabled\n");
+		return FALSE;
+	}
+
+	start = phase = pbx_tvnow();
+	if (!sccp_config_index_init(&deviceIndex, SCCP_RWLIST_GETSIZE(&GLOB(devices))) || !sccp_config_index_init(&lineIndex, SCCP_RWLIST_GETSIZE(&GLOB(lines)))
+	    || !sccp_config_index_fill(&deviceIndex, &lineIndex)) {
+		goto EXIT;
+	}
+	index_time = (int)ast_tvdiff_ms(pbx_tvnow(), phase);
+
+	phase = pbx_tvnow();
+	if (!sccp_config_readSections(GLOB(cfg), &deviceIndex, &lineIndex, &stats, GLOB(parallel_load) && readingtype == SCCP_CONFIG_READINITIAL)) {
+		goto EXIT;
+	}
+	sccp_config_add_default_softkeyset();
+	parse_time = (int)ast_tvdiff_ms(pbx_tvnow(), phase);
+
+	phase = pbx_tvnow();
+	sccp_config_mergeNew(&deviceIndex, &lineIndex);
+	sccp_config_index_destroy(&deviceIndex);
+	sccp_config_index_destroy(&lineIndex);
+	merge_time = (int)ast_tvdiff_ms(pbx_tvnow(), phase);
+
+	phase = pbx_tvnow();
+#ifdef CS_SCCP_REALTIME
+	/* reload realtime lines */
+	sccp_configurationchange_t res = SCCP_CONFIG_NOUPDATENEEDED;
+	PBX_VARIABLE_TYPE *        rv  = NULL;
+
+	sccp_line_t * l = NULL;
+	SCCP_RWLIST_RDLOCK(&GLOB(lines));
+	SCCP_RWLIST_TRAVERSE(&GLOB(lines), l, list) {
+		AUTO_RELEASE(sccp_line_t, line, sccp_line_retain(l));
+		if (line) {
+			do {
+				if (line->realtime == TRUE && line != GLOB(hotline)->line) {
+					sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_3 "%s: reload realtime line\n", line->name);
 					rv = pbx_load_realtime(GLOB(realtimelinetable), "name", line->name, NULL);
 					/* we did not find this line, mark it for deletion */
 					if (!rv) {
@@ -2821,6 +3560,7 @@ boolean_t sccp_config_readDevicesLines(sccp_readingtype_t readingtype)
 					} else {
 						line->pendingUpdate = 0;
 					}
+					line->pendingLiveUpdate = (GLOB(reload_in_progress) && !line->pendingUpdate && (res & SCCP_CONFIG_NEEDLIVEUPDATE)) ? TRUE : FALSE;
 					pbx_variables_destroy(rv);
 				}
 			} while (0);
@@ -2845,13 +3585,17 @@ boolean_t sccp_config_readDevicesLines(sccp_readingtype_t readingtype)
 					}
 					device->pendingDelete = 0;
 
-					res = sccp_config_applyDeviceConfiguration(device, rv);
+					uint8_t liveUpdate = SCCP_DEVICE_LIVEUPDATE_NONE;
+					res = sccp_config_applyDeviceOptions(device, rv, &liveUpdate);
 					/* check if we did some changes that needs a device update */
 					if (GLOB(reload_in_progress) && res & SCCP_CONFIG_NEEDDEVICERESET) {
 						device->pendingUpdate = 1;
 					} else {
 						device->pendingUpdate = 0;
 					}
+					if (GLOB(reload_in_progress) && !device->pendingUpdate && (res & SCCP_CONFIG_NEEDLIVEUPDATE)) {
+						sccp_device_addLiveUpdate(device, liveUpdate);
+					}
 					pbx_variables_destroy(rv);
 				}
 			} while (0);
@@ -2859,6 +3603,9 @@ boolean_t sccp_config_readDevicesLines(sccp_readingtype_t readingtype)
 	}
 	SCCP_RWLIST_UNLOCK(&GLOB(devices));
 #endif
+	realtime_time = (int)ast_tvdiff_ms(pbx_tvnow(), phase);
+	sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_2 "SCCP: Read %u devices (%u new), %u lines (%u new), %u softkeysets in %dms (index:%dms, parse:%dms, merge:%dms, realtime:%dms)\n", stats.devices, stats.newDevices, stats.lines, stats.newLines,
+				  stats.softkeysets, (int)ast_tvdiff_ms(pbx_tvnow(), start), index_time, parse_time, merge_time, realtime_time);
 
 	if (GLOB(reload_in_progress) && GLOB(pendingUpdate)) {
 		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Global param changed needing restart ->  Restart all device\n");
@@ -2874,8 +3621,17 @@ boolean_t sccp_config_readDevicesLines(sccp_readingtype_t readingtype)
 		SCCP_RWLIST_UNLOCK(&GLOB(devices));
 	} else {
 		GLOB(pendingUpdate) = 0;
+		if (GLOB(reload_in_progress) && GLOB(pendingLiveUpdate)) {
+			sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Global param changed that can be applied live -> Update all devices\n");
+			SCCP_RWLIST_RDLOCK(&GLOB(devices));
+			SCCP_RWLIST_TRAVERSE(&GLOB(devices), d, list) {
+				sccp_device_addLiveUpdate(d, SCCP_DEVICE_LIVEUPDATE_SOFTKEYS | SCCP_DEVICE_LIVEUPDATE_MWI);
+			}
+			SCCP_RWLIST_UNLOCK(&GLOB(devices));
+		}
 	}
 	GLOB(pendingUpdate) = 0;
+	GLOB(pendingLiveUpdate) = 0;
 
 	sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_1 "Checking Reading Type\n");
 	if (readingtype == SCCP_CONFIG_READRELOAD) {
@@ -2889,7 +3645,11 @@ boolean_t sccp_config_readDevicesLines(sccp_readingtype_t readingtype)
 		sccp_log((DEBUGCAT_CONFIG))(VERBOSE_PREFIX_2 "Softkey Post Reload\n");
 		sccp_softkey_post_reload();
 	}
-	return TRUE;
+	result = TRUE;
+EXIT:
+	sccp_config_index_destroy(&deviceIndex);
+	sccp_config_index_destroy(&lineIndex);
+	return result;
 }
 
 /*!
@@ -2941,6 +3701,35 @@ sccp_configurationchange_t sccp_config_applyLineConfiguration(linePtr l, PBX_VAR
  *
  */
 sccp_configurationchange_t sccp_config_applyDeviceConfiguration(devicePtr d, PBX_VARIABLE_TYPE * v)
+{
+	return sccp_config_applyDeviceOptions(d, v, NULL);
+}
+
+/*!
+ * \brief Part of the registered device to refresh when a device option marked SCCP_CONFIG_NEEDLIVEUPDATE changed
+ * \return sccp_device_liveupdate_t bit
+ */
+static uint8_t sccp_config_deviceLiveUpdate(const char * name)
+{
+	if (sccp_strcaseequals(name, "button")) {
+		return SCCP_DEVICE_LIVEUPDATE_BUTTONS;
+	}
+	if (sccp_strcaseequals(name, "softkeyset") || !strncasecmp(name, "cfwd", 4)) {					/* cfwd* enable/disable the cfwd softkeys */
+		return SCCP_DEVICE_LIVEUPDATE_SOFTKEYS;
+	}
+	if (!strncasecmp(name, "mwi", 3)) {
+		return SCCP_DEVICE_LIVEUPDATE_MWI;
+	}
+	return SCCP_DEVICE_LIVEUPDATE_LINES;									/* description */
+}
+
+/*!
+ * \brief Apply Device Configuration from Asterisk Variable, collecting the live updates the changed options need
+ * \param d SCCP Device
+ * \param v Asterisk Variable
+ * \param liveUpdate sccp_device_liveupdate_t bits of the changed live options are added here (may be NULL)
+ */
+static sccp_configurationchange_t sccp_config_applyDeviceOptions(devicePtr d, PBX_VARIABLE_TYPE * v, uint8_t * liveUpdate)
 {
 	unsigned int        res                                            = SCCP_CONFIG_NOUPDATENEEDED;
 	boolean_t           SetEntries[ARRAY_LEN(sccpDeviceConfigOptions)] = { FALSE };
@@ -2954,7 +3743,11 @@ sccp_configurationchange_t sccp_config_applyDeviceConfiguration(devicePtr d, PBX
 		sccp_dev_clean_restart(d, FALSE);
 	}
 	for (; v; v = v->next) {
-		res |= sccp_config_object_setValue(d, cat_root, v->name, v->value, v->lineno, SCCP_CONFIG_DEVICE_SEGMENT, SetEntries, FALSE);
+		sccp_configurationchange_t change = sccp_config_object_setValue(d, cat_root, v->name, v->value, v->lineno, SCCP_CONFIG_DEVICE_SEGMENT, SetEntries, FALSE);
+		if (liveUpdate && (change & SCCP_CONFIG_NEEDLIVEUPDATE)) {
+			*liveUpdate |= sccp_config_deviceLiveUpdate(v->name);
+		}
+		res |= change;
 	}
 
 	sccp_config_set_defaults(d, SCCP_CONFIG_DEVICE_SEGMENT, SetEntries);
@@ -3045,6 +3838,344 @@ FUNC_EXIT:
 	return res;
 }
 
+/*!
+ * \brief Split a button definition 'type,name,option,args' into its (stripped) parts. buf is modified.
+ */
+static void sccp_config_splitButton(char * buf, char ** type, char ** name, char ** option, char ** args)
+{
+	char * splitter = buf;
+	char * part     = NULL;
+
+	part    = strsep(&splitter, ",");
+	*type   = part ? pbx_strip(part) : NULL;
+	part    = strsep(&splitter, ",");
+	*name   = part ? pbx_strip(part) : NULL;
+	part    = strsep(&splitter, ",");
+	*option = part ? pbx_strip(part) : NULL;
+	*args   = splitter ? pbx_strip(splitter) : NULL;
+}
+
+/*!
+ * \brief Classify the difference between two sets of button definitions, using the same rules as sccp_config_checkButton
+ * \return SCCP_CONFIG_NEEDDEVICERESET when the button layout changed, SCCP_CONFIG_NEEDLIVEUPDATE when only labels/targets changed
+ */
+static sccp_configurationchange_t sccp_config_classifyButtons(PBX_VARIABLE_TYPE * oldv, PBX_VARIABLE_TYPE * newv)
+{
+	const SCCPConfigOption *   buttonOption = sccp_find_config(SCCP_CONFIG_DEVICE_SEGMENT, "button");
+	sccp_configurationchange_t res          = SCCP_CONFIG_NOUPDATENEEDED;
+	char                       oldbuf[256];
+	char                       newbuf[256];
+	char *                     oldParts[4];
+	char *                     newParts[4];
+
+	for (;; oldv = oldv->next, newv = newv->next) {
+		while (oldv && sccp_find_config(SCCP_CONFIG_DEVICE_SEGMENT, oldv->name) != buttonOption) {
+			oldv = oldv->next;
+		}
+		while (newv && sccp_find_config(SCCP_CONFIG_DEVICE_SEGMENT, newv->name) != buttonOption) {
+			newv = newv->next;
+		}
+		if (!oldv || !newv) {
+			if (oldv || newv) {
+				res = SCCP_CONFIG_NEEDDEVICERESET; /* number of buttons changed */
+			}
+			break;
+		}
+		if (sccp_strequals(oldv->value, newv->value)) {
+			continue;
+		}
+		sccp_copy_string(oldbuf, oldv->value, sizeof(oldbuf));
+		sccp_copy_string(newbuf, newv->value, sizeof(newbuf));
+		sccp_config_splitButton(oldbuf, &oldParts[0], &oldParts[1], &oldParts[2], &oldParts[3]);
+		sccp_config_splitButton(newbuf, &newParts[0], &newParts[1], &newParts[2], &newParts[3]);
+
+		sccp_config_buttontype_t type = sccp_config_buttontype_str2val(newParts[0]);
+		if (type != sccp_config_buttontype_str2val(oldParts[0])) {
+			return SCCP_CONFIG_NEEDDEVICERESET;
+		}
+		switch (type) {
+			case SPEEDDIAL:
+				if (!sccp_strequals(oldParts[3], newParts[3])) { /* hint */
+					return SCCP_CONFIG_NEEDDEVICERESET;
+				}
+				res |= SCCP_CONFIG_NEEDLIVEUPDATE;
+				break;
+			case SERVICE:
+				res |= SCCP_CONFIG_NEEDLIVEUPDATE;
+				break;
+			case FEATURE:
+				if (!sccp_strequals(oldParts[2], newParts[2]) || !sccp_strequals(oldParts[3], newParts[3])) {
+					return SCCP_CONFIG_NEEDDEVICERESET;
+				}
+				res |= SCCP_CONFIG_NEEDLIVEUPDATE;
+				break;
+			case EMPTY:
+				break;
+			default:
+				return SCCP_CONFIG_NEEDDEVICERESET;
+		}
+	}
+	return res;
+}
+
+/*!
+ * \brief Does any variable in list (up to stop) map onto option
+ */
+static boolean_t sccp_config_diffSeen(PBX_VARIABLE_TYPE * list, const PBX_VARIABLE_TYPE * stop, const sccp_config_segment_t segment, const SCCPConfigOption * option)
+{
+	for (; list && list != stop; list = list->next) {
+		if (sccp_find_config(segment, list->name) == option) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*!
+ * \brief Collect all values of option in list, in config order
+ */
+static void sccp_config_diffValues(pbx_str_t ** buf, PBX_VARIABLE_TYPE * list, const sccp_config_segment_t segment, const SCCPConfigOption * option)
+{
+	pbx_str_reset(*buf);
+	for (; list; list = list->next) {
+		if (sccp_find_config(segment, list->name) == option) {
+			pbx_str_append(buf, 0, "%s%s", pbx_str_strlen(*buf) ? " | " : "", list->value);
+		}
+	}
+}
+
+/*!
+ * \brief Compare the variables of one config section and classify every changed option
+ * \param fd CLI File Descriptor to report the changes on, or -1
+ * \param segment config segment of the section
+ * \param section section name
+ * \param oldv currently loaded variables
+ * \param newv variables from the new config file
+ * \return sccp_configurationchange_t bitmask of all changes in this section
+ */
+static sccp_configurationchange_t sccp_config_diffSection(int fd, const sccp_config_segment_t segment, const char * section, PBX_VARIABLE_TYPE * oldv, PBX_VARIABLE_TYPE * newv)
+{
+	sccp_configurationchange_t res     = SCCP_CONFIG_NOUPDATENEEDED;
+	pbx_str_t *                oldbuf  = pbx_str_create(DEFAULT_PBX_STR_BUFFERSIZE);
+	pbx_str_t *                newbuf  = pbx_str_create(DEFAULT_PBX_STR_BUFFERSIZE);
+	PBX_VARIABLE_TYPE *        lists[] = { newv, oldv };
+
+	if (!oldbuf || !newbuf) {
+		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, "SCCP");
+		res = SCCP_CONFIG_ERROR;
+		goto EXIT;
+	}
+	for (uint8_t pass = 0; pass < ARRAY_LEN(lists); pass++) {
+		for (PBX_VARIABLE_TYPE * v = lists[pass]; v; v = v->next) {
+			const SCCPConfigOption * option = sccp_find_config(segment, v->name);
+			if (!option || !strcasecmp(v->name, "type")) {
+				continue;
+			}
+			/* only handle an option at its first occurrence */
+			if (sccp_config_diffSeen(lists[pass], v, segment, option) || (pass == 1 && sccp_config_diffSeen(newv, NULL, segment, option))) {
+				continue;
+			}
+			sccp_config_diffValues(&oldbuf, oldv, segment, option);
+			sccp_config_diffValues(&newbuf, newv, segment, option);
+			if (sccp_strequals(pbx_str_buffer(oldbuf), pbx_str_buffer(newbuf))) {
+				continue;
+			}
+			sccp_configurationchange_t change = option->change;
+			if (SCCP_CONFIG_DEVICE_SEGMENT == segment && option == sccp_find_config(SCCP_CONFIG_DEVICE_SEGMENT, "button")) {
+				change = sccp_config_classifyButtons(oldv, newv);
+			}
+			if (fd >= 0) {
+				pbx_cli(fd, "  %-20.20s %-20.20s %-8s '%s' -> '%s'\n", section, option->name,
+					(change & SCCP_CONFIG_NEEDDEVICERESET) ? "restart" : (change & SCCP_CONFIG_NEEDLIVEUPDATE) ? "live" : "none",
+					pbx_str_strlen(oldbuf) ? pbx_str_buffer(oldbuf) : "<default>", pbx_str_strlen(newbuf) ? pbx_str_buffer(newbuf) : "<default>");
+			}
+			res |= change;
+		}
+	}
+EXIT:
+	if (oldbuf) {
+		sccp_free(oldbuf);
+	}
+	if (newbuf) {
+		sccp_free(newbuf);
+	}
+	return res;
+}
+
+/*!
+ * \brief Add the (retained) device to index, unless it was already added
+ */
+static void sccp_config_dryrunMarkDevice(sccp_config_index_t * index, const char * deviceName)
+{
+	if (sccp_config_index_find(index, deviceName)) {
+		return;
+	}
+	sccp_device_t * device = sccp_device_find_byid(deviceName, FALSE);
+	if (device && !sccp_config_index_add(index, device->id, device, TRUE)) {
+		sccp_device_release(&device);									/* explicit release, out of memory */
+	}
+}
+
+/*!
+ * \brief Add all devices using line lineName to index
+ */
+static void sccp_config_dryrunMarkLine(sccp_config_index_t * index, const char * lineName)
+{
+	AUTO_RELEASE(sccp_line_t, l, sccp_line_find_byname(lineName, FALSE));
+	if (l) {
+		sccp_linedevice_t * ld = NULL;
+		SCCP_LIST_LOCK(&l->devices);
+		SCCP_LIST_TRAVERSE(&l->devices, ld, list) {
+			sccp_config_dryrunMarkDevice(index, ld->device->id);
+		}
+		SCCP_LIST_UNLOCK(&l->devices);
+	}
+}
+
+/*!
+ * \brief Add all known devices to index
+ */
+static void sccp_config_dryrunMarkAll(sccp_config_index_t * index)
+{
+	sccp_device_t * d = NULL;
+	SCCP_RWLIST_RDLOCK(&GLOB(devices));
+	SCCP_RWLIST_TRAVERSE(&GLOB(devices), d, list) {
+		sccp_config_dryrunMarkDevice(index, d->id);
+	}
+	SCCP_RWLIST_UNLOCK(&GLOB(devices));
+}
+
+/*!
+ * \brief Print the devices in index (skipping the ones in exclude), sorted by id
+ */
+static uint32_t sccp_config_dryrunPrintDevices(int fd, const char * header, const sccp_config_index_t * index, const sccp_config_index_t * exclude)
+{
+	uint32_t         count   = 0;
+	uint32_t         printed = 0;
+	sccp_device_t ** devices = (sccp_device_t **)sccp_config_index_getNew(index, &count, sccp_config_device_compare);
+
+	for (uint32_t pos = 0; pos < count; pos++) {
+		if (exclude && sccp_config_index_find(exclude, devices[pos]->id)) {
+			continue;
+		}
+		if (!printed++) {
+			pbx_cli(fd, "\n%s:\n", header);
+		}
+		pbx_cli(fd, "  %-20s %s\n", devices[pos]->id, sccp_device_getRegistrationState(devices[pos]) == SKINNY_DEVICE_RS_OK ? "(registered)" : "");
+	}
+	if (devices) {
+		sccp_free(devices);
+	}
+	return printed;
+}
+
+/*!
+ * \brief Compare a config file against the currently loaded configuration, without applying it
+ *
+ * Every changed option is reported as 'live' (pushed to the registered device on reload), 'restart' (device reset needed) or 'none'
+ * (takes effect for new calls), followed by the devices which would be restarted and the devices which would receive a live update.
+ *
+ * \param fd CLI File Descriptor
+ * \param filename config file to compare against, NULL to use the currently loaded config file name
+ * \return sccp_configurationchange_t bitmask of all changes, SCCP_CONFIG_ERROR if the config could not be compared
+ */
+sccp_configurationchange_t sccp_config_dryrun(int fd, const char * filename)
+{
+	sccp_configurationchange_t res          = SCCP_CONFIG_NOUPDATENEEDED;
+	struct ast_flags           config_flags = { 0 };
+	struct ast_config *        newcfg       = NULL;
+	sccp_config_index_t        restart      = { 0 };
+	sccp_config_index_t        live         = { 0 };
+	char *                     cat          = NULL;
+	const char *               name         = filename;
+
+	if (sccp_strlen_zero(name)) {
+		name = !sccp_strlen_zero(GLOB(config_file_name)) ? GLOB(config_file_name) : "sccp.conf";
+	}
+	if (!GLOB(cfg)) {
+		pbx_cli(fd, "No SCCP configuration loaded, nothing to compare against.\n");
+		return SCCP_CONFIG_ERROR;
+	}
+	newcfg = pbx_config_load(name, "chan_sccp", config_flags);
+	if (!newcfg || newcfg == CONFIG_STATUS_FILEMISSING || newcfg == CONFIG_STATUS_FILEINVALID) {
+		pbx_cli(fd, "Config file '%s' could not be loaded.\n", name);
+		return SCCP_CONFIG_ERROR;
+	}
+	if (!sccp_config_index_init(&restart, SCCP_RWLIST_GETSIZE(&GLOB(devices))) || !sccp_config_index_init(&live, SCCP_RWLIST_GETSIZE(&GLOB(devices)))) {
+		res = SCCP_CONFIG_ERROR;
+		goto EXIT;
+	}
+
+	pbx_cli(fd, "Comparing '%s' against the loaded configuration:\n\n", name);
+	pbx_cli(fd, "  %-20.20s %-20.20s %-8s %s\n", "Section", "Option", "Change", "Value");
+
+	sccp_configurationchange_t change = sccp_config_diffSection(fd, SCCP_CONFIG_GLOBAL_SEGMENT, "general", ast_variable_browse(GLOB(cfg), "general"), ast_variable_browse(newcfg, "general"));
+	if (change & SCCP_CONFIG_NEEDDEVICERESET) {
+		sccp_config_dryrunMarkAll(&restart);
+	} else if (change & SCCP_CONFIG_NEEDLIVEUPDATE) {
+		sccp_config_dryrunMarkAll(&live);
+	}
+	res |= change;
+
+	while ((cat = pbx_category_browse(newcfg, cat))) {
+		const char *          utype   = pbx_variable_retrieve(newcfg, cat, "type");
+		const char *          oldtype = pbx_variable_retrieve(GLOB(cfg), cat, "type");
+		sccp_config_segment_t segment = SCCP_CONFIG_GLOBAL_SEGMENT;
+
+		if (!strcasecmp(cat, "general") || sccp_strlen_zero(utype)) {
+			continue;
+		}
+		if (!strcasecmp(utype, "device")) {
+			segment = SCCP_CONFIG_DEVICE_SEGMENT;
+		} else if (!strcasecmp(utype, "line")) {
+			segment = SCCP_CONFIG_LINE_SEGMENT;
+		} else if (!strcasecmp(utype, "softkeyset")) {
+			segment = SCCP_CONFIG_SOFTKEY_SEGMENT;
+		} else {
+			continue;
+		}
+		if (!sccp_strcaseequals(utype, oldtype)) {
+			pbx_cli(fd, "  %-20.20s %-20.20s %-8s\n", cat, "(new section)", "none");
+			continue;
+		}
+		change = sccp_config_diffSection(fd, segment, cat, ast_variable_browse(GLOB(cfg), cat), ast_variable_browse(newcfg, cat));
+		if (SCCP_CONFIG_DEVICE_SEGMENT == segment && (change & (SCCP_CONFIG_NEEDDEVICERESET | SCCP_CONFIG_NEEDLIVEUPDATE))) {
+			sccp_config_dryrunMarkDevice((change & SCCP_CONFIG_NEEDDEVICERESET) ? &restart : &live, cat);
+		} else if (SCCP_CONFIG_LINE_SEGMENT == segment && (change & (SCCP_CONFIG_NEEDDEVICERESET | SCCP_CONFIG_NEEDLIVEUPDATE))) {
+			sccp_config_dryrunMarkLine((change & SCCP_CONFIG_NEEDDEVICERESET) ? &restart : &live, cat);
+		}
+		res |= change;
+	}
+
+	/* sections which are no longer present */
+	cat = NULL;
+	while ((cat = pbx_category_browse(GLOB(cfg), cat))) {
+		const char * oldtype = pbx_variable_retrieve(GLOB(cfg), cat, "type");
+		if (!strcasecmp(cat, "general") || sccp_strlen_zero(oldtype) || sccp_strcaseequals(oldtype, pbx_variable_retrieve(newcfg, cat, "type"))) {
+			continue;
+		}
+		if (!strcasecmp(oldtype, "device")) {
+			sccp_config_dryrunMarkDevice(&restart, cat);
+		} else if (!strcasecmp(oldtype, "line")) {
+			sccp_config_dryrunMarkLine(&restart, cat);
+		} else if (strcasecmp(oldtype, "softkeyset")) {
+			continue;
+		}
+		pbx_cli(fd, "  %-20.20s %-20.20s %-8s\n", cat, "(removed section)", "restart");
+		res |= SCCP_CONFIG_NEEDDEVICERESET;
+	}
+
+	uint32_t restarts = sccp_config_dryrunPrintDevices(fd, "Devices that would be restarted", &restart, NULL);
+	uint32_t updates  = sccp_config_dryrunPrintDevices(fd, "Devices that would receive a live update", &live, &restart);
+	pbx_cli(fd, "\n%u device(s) would be restarted, %u device(s) would be updated without restart.\n", restarts, updates);
+
+EXIT:
+	sccp_config_index_destroy(&restart);
+	sccp_config_index_destroy(&live);
+	pbx_config_destroy(newcfg);
+	return res;
+}
+
 /*!
  * \brief Soft Key Str to Label Mapping
  */
@@ -3999,6 +5130,312 @@ AST_TEST_DEFINE(sccp_config_tokenized_default)
 	return AST_TEST_PASS;
 }
 
+AST_TEST_DEFINE(sccp_config_lookup_table)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name        = "LookupTable";
+			info->category    = "/channels/chan_sccp/config/";
+			info->summary     = "chan-sccp-b config lookup table test";
+			info->description = "Cross check the precompiled config option lookup table against the option arrays";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+
+	char   name[80] = "";
+	char * token    = NULL;
+	char * rest     = NULL;
+
+	for (uint8_t i = 0; i < ARRAY_LEN(sccpConfigSegments); i++) {
+		const SCCPConfigSegment * sccpConfigSegment = &sccpConfigSegments[i];
+		uint32_t                  checked           = 0;
+
+		for (long unsigned int opt = 0; opt < sccpConfigSegment->config_size; opt++) {
+			const char * optname = sccpConfigSegment->config[opt].name;
+
+			/* full name, upper cased and every alias */
+			pbx_test_validate(test, sccp_find_config(sccpConfigSegment->segment, optname) == sccp_find_config_linear(sccpConfigSegment->segment, optname));
+			for (size_t pos = 0; pos < sizeof(name) - 1 && optname[pos]; pos++) {
+				name[pos]     = toupper((unsigned char)optname[pos]);
+				name[pos + 1] = '\0';
+			}
+			pbx_test_validate(test, sccp_find_config(sccpConfigSegment->segment, name) == sccp_find_config_linear(sccpConfigSegment->segment, name));
+			sccp_copy_string(name, optname, sizeof(name));
+			for (token = strtok_r(name, "|", &rest); token; token = strtok_r(NULL, "|", &rest)) {
+				pbx_test_validate(test, sccp_find_config(sccpConfigSegment->segment, token) != NULL);
+				pbx_test_validate(test, sccp_find_config(sccpConfigSegment->segment, token) == sccp_find_config_linear(sccpConfigSegment->segment, token));
+				checked++;
+			}
+		}
+		/* prefixes, extensions and unknown names should not resolve */
+		pbx_test_validate(test, sccp_find_config(sccpConfigSegment->segment, "") == NULL);
+		pbx_test_validate(test, sccp_find_config(sccpConfigSegment->segment, "disallo") == sccp_find_config_linear(sccpConfigSegment->segment, "disallo"));
+		pbx_test_validate(test, sccp_find_config(sccpConfigSegment->segment, "allow|") == sccp_find_config_linear(sccpConfigSegment->segment, "allow|"));
+		pbx_test_validate(test, sccp_find_config(sccpConfigSegment->segment, "doesnotexist") == NULL);
+		pbx_test_status_update(test, "segment %s: %u names checked, %lu lookup entries\n", sccpConfigSegment->name, checked, (unsigned long)sccpConfigLookup[i].size);
+	}
+	return AST_TEST_PASS;
+}
+
+static struct ast_config * sccp_config_generateBenchmarkConfig(uint32_t numDevices)
+{
+	struct ast_config * cfg = ast_config_new();
+	char                name[StationMaxDeviceNameSize] = "";
+	char                value[SCCP_MAX_EXTENSION]      = "";
+
+	for (uint32_t idx = 0; cfg && idx < numDevices; idx++) {
+		struct ast_category * devcat  = NULL;
+		struct ast_category * linecat = NULL;
+
+		snprintf(name, sizeof(name), "SEP%012X", idx);
+		snprintf(value, sizeof(value), "line,%u", 100000 + idx);
+		if (!(devcat = ast_category_new(name, "sccp_benchmark.conf", idx))) {
+			break;
+		}
+		ast_variable_append(devcat, ast_variable_new("type", "device", ""));
+		ast_variable_append(devcat, ast_variable_new("devicetype", "7970", ""));
+		ast_variable_append(devcat, ast_variable_new("description", name, ""));
+		ast_variable_append(devcat, ast_variable_new("button", value, ""));
+		ast_category_append(cfg, devcat);
+
+		snprintf(name, sizeof(name), "%u", 100000 + idx);
+		if (!(linecat = ast_category_new(name, "sccp_benchmark.conf", idx))) {
+			break;
+		}
+		ast_variable_append(linecat, ast_variable_new("type", "line", ""));
+		if (idx % 2) {
+			ast_variable_append(linecat, ast_variable_new("id", name, ""));			/* the others get a default id */
+		}
+		ast_variable_append(linecat, ast_variable_new("label", name, ""));
+		ast_variable_append(linecat, ast_variable_new("cid_name", name, ""));
+		ast_variable_append(linecat, ast_variable_new("cid_num", name, ""));
+		ast_category_append(cfg, linecat);
+	}
+	return cfg;
+}
+
+/* runs the index/parse/sort phases of sccp_config_readDevicesLines against a generated config, without touching the global lists */
+static int sccp_config_benchmarkRead(struct ast_test * test, uint32_t numDevices)
+{
+	struct ast_config *     cfg         = sccp_config_generateBenchmarkConfig(numDevices);
+	sccp_config_index_t     deviceIndex = { 0 };
+	sccp_config_index_t     lineIndex   = { 0 };
+	sccp_config_readstats_t stats       = { 0 };
+	struct timeval          start       = { 0 };
+	uint32_t                count       = 0;
+	void **                 objs        = NULL;
+	int                     elapsed     = -1;
+
+	if (!cfg) {
+		return -1;
+	}
+	start = pbx_tvnow();
+	if (sccp_config_index_init(&deviceIndex, 0) && sccp_config_index_init(&lineIndex, 0) && sccp_config_readSections(cfg, &deviceIndex, &lineIndex, &stats, FALSE)) {
+		if ((objs = sccp_config_index_getNew(&lineIndex, &count, sccp_config_line_compare))) {
+			sccp_free(objs);
+		}
+		if ((objs = sccp_config_index_getNew(&deviceIndex, &count, sccp_config_device_compare))) {
+			sccp_free(objs);
+		}
+		elapsed = (int)ast_tvdiff_ms(pbx_tvnow(), start);
+	}
+	pbx_test_status_update(test, "Read %u devices (%u new), %u lines (%u new) in %dms\n", stats.devices, stats.newDevices, stats.lines, stats.newLines, elapsed);
+	if (stats.newDevices != numDevices || stats.newLines != numDevices) {
+		elapsed = -1;
+	}
+	sccp_config_index_destroy(&deviceIndex);
+	sccp_config_index_destroy(&lineIndex);
+	ast_config_destroy(cfg);
+	return elapsed;
+}
+
+AST_TEST_DEFINE(sccp_config_reload_benchmark)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name        = "ReloadBenchmark";
+			info->category    = "/channels/chan_sccp/config/";
+			info->summary     = "chan-sccp-b config reload benchmark";
+			info->description = "Reads a generated 20k device / 20k line config and checks that read time grows linearly";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+
+	pbx_test_status_update(test, "Reading 10000 devices...\n");
+	int half = sccp_config_benchmarkRead(test, 10000);
+	pbx_test_validate(test, half >= 0);
+
+	pbx_test_status_update(test, "Reading 20000 devices...\n");
+	int full = sccp_config_benchmarkRead(test, 20000);
+	pbx_test_validate(test, full >= 0);
+
+	/* twice the input should take about twice the time, allow plenty of slack for a busy test machine */
+	pbx_test_status_update(test, "10000 devices: %dms, 20000 devices: %dms\n", half, full);
+	pbx_test_validate(test, full <= (half * 4) + 250);
+
+	return AST_TEST_PASS;
+}
+
+/* read cfg into fresh indexes and return a signature of every device/line built, in list order */
+static struct ast_str * sccp_config_readSignature(struct ast_config * cfg, boolean_t parallel)
+{
+	sccp_config_index_t     deviceIndex = { 0 };
+	sccp_config_index_t     lineIndex   = { 0 };
+	sccp_config_readstats_t stats       = { 0 };
+	struct ast_str *        sig         = ast_str_create(DEFAULT_PBX_STR_BUFFERSIZE);
+	uint32_t                count       = 0;
+	void **                 objs        = NULL;
+
+	if (sig && sccp_config_index_init(&deviceIndex, 0) && sccp_config_index_init(&lineIndex, 0) && sccp_config_readSections(cfg, &deviceIndex, &lineIndex, &stats, parallel)) {
+		if ((objs = sccp_config_index_getNew(&deviceIndex, &count, sccp_config_device_compare))) {
+			for (uint32_t idx = 0; idx < count; idx++) {
+				sccp_device_t * d = (sccp_device_t *)objs[idx];
+				pbx_str_append(&sig, 0, "%s:%s:%d:%d;", d->id, d->description ? d->description : "", SCCP_LIST_GETSIZE(&d->buttonconfig), d->keepalive);
+			}
+			sccp_free(objs);
+		}
+		if ((objs = sccp_config_index_getNew(&lineIndex, &count, sccp_config_line_compare))) {
+			for (uint32_t idx = 0; idx < count; idx++) {
+				sccp_line_t * l = (sccp_line_t *)objs[idx];
+				pbx_str_append(&sig, 0, "%s:%s:%s:%s;", l->name, l->id, l->label ? l->label : "", l->cid_num);
+			}
+			sccp_free(objs);
+		}
+	}
+	sccp_config_index_destroy(&deviceIndex);
+	sccp_config_index_destroy(&lineIndex);
+	return sig;
+}
+
+AST_TEST_DEFINE(sccp_config_parallel_read)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name        = "ParallelRead";
+			info->category    = "/channels/chan_sccp/config/";
+			info->summary     = "chan-sccp-b parallel config read test";
+			info->description = "Checks that building devices/lines on a threadpool gives the same result as a serial read";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+
+	struct ast_config *   cfg    = sccp_config_generateBenchmarkConfig(2000);
+	struct ast_category * devcat = NULL;
+	pbx_test_validate(test, cfg != NULL);
+
+	/* a second section for an existing device has to be applied after the first one */
+	if ((devcat = ast_category_new("SEP000000000001", "sccp_benchmark.conf", 0))) {
+		ast_variable_append(devcat, ast_variable_new("type", "device", ""));
+		ast_variable_append(devcat, ast_variable_new("description", "second section", ""));
+		ast_category_append(cfg, devcat);
+	}
+
+	struct ast_str * serial = sccp_config_readSignature(cfg, FALSE);
+	struct ast_str * first  = sccp_config_readSignature(cfg, TRUE);
+	struct ast_str * second = sccp_config_readSignature(cfg, TRUE);
+	ast_config_destroy(cfg);
+
+	pbx_test_validate(test, serial && first && second);
+	pbx_test_status_update(test, "signature length: %lu\n", (unsigned long)pbx_str_strlen(serial));
+	pbx_test_validate(test, strstr(pbx_str_buffer(serial), "SEP000000000001:second section:") != NULL);
+	pbx_test_validate(test, sccp_strequals(pbx_str_buffer(serial), pbx_str_buffer(first)));
+	pbx_test_validate(test, sccp_strequals(pbx_str_buffer(first), pbx_str_buffer(second)));
+	sccp_free(serial);
+	sccp_free(first);
+	sccp_free(second);
+
+	return AST_TEST_PASS;
+}
+
+static PBX_VARIABLE_TYPE * sccp_config_test_vars(const char * const pairs[][2], size_t count)
+{
+	PBX_VARIABLE_TYPE * root = NULL;
+	PBX_VARIABLE_TYPE * tail = NULL;
+	for (size_t pos = 0; pos < count; pos++) {
+		PBX_VARIABLE_TYPE * v = ast_variable_new(pairs[pos][0], pairs[pos][1], "");
+		if (tail) {
+			tail->next = v;
+		} else {
+			root = v;
+		}
+		tail = v;
+	}
+	return root;
+}
+
+AST_TEST_DEFINE(sccp_config_reload_diff)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name        = "ReloadDiff";
+			info->category    = "/channels/chan_sccp/config/";
+			info->summary     = "chan-sccp-b config reload diff test";
+			info->description = "classify config changes as live-applicable or restart-required";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	static const char * const base[][2] = {
+		{ "type", "device" }, { "description", "Desk" }, { "softkeyset", "default" }, { "tzoffset", "0" },
+		{ "button", "line, 100" }, { "button", "speeddial, Alice, 201, 201@hints" }, { "button", "feature, DND, dnd" }, { "button", "empty" },
+	};
+	static const char * const labels[][2] = {
+		{ "type", "device" }, { "description", "Desk 2" }, { "softkeyset", "other" }, { "tzoffset", "0" },
+		{ "button", "line, 100" }, { "button", "speeddial, Alice Smith, 2201, 201@hints" }, { "button", "feature, Do Not Disturb, dnd" }, { "button", "empty" },
+	};
+	static const char * const hint[][2] = {
+		{ "type", "device" }, { "description", "Desk" }, { "softkeyset", "default" }, { "tzoffset", "0" },
+		{ "button", "line, 100" }, { "button", "speeddial, Alice, 201, 202@hints" }, { "button", "feature, DND, dnd" }, { "button", "empty" },
+	};
+	static const char * const layout[][2] = {
+		{ "type", "device" }, { "description", "Desk" }, { "softkeyset", "default" }, { "tzoffset", "0" },
+		{ "button", "line, 101" }, { "button", "speeddial, Alice, 201, 201@hints" }, { "button", "feature, DND, dnd" },
+	};
+	static const char * const reset[][2] = {
+		{ "type", "device" }, { "description", "Desk" }, { "softkeyset", "default" }, { "tzoffset", "60" },
+		{ "button", "line, 100" }, { "button", "speeddial, Alice, 201, 201@hints" }, { "button", "feature, DND, dnd" }, { "button", "empty" },
+	};
+	PBX_VARIABLE_TYPE * oldv = sccp_config_test_vars(base, ARRAY_LEN(base));
+	PBX_VARIABLE_TYPE * newv = NULL;
+
+	pbx_test_status_update(test, "identical sections...\n");
+	newv = sccp_config_test_vars(base, ARRAY_LEN(base));
+	pbx_test_validate(test, sccp_config_diffSection(-1, SCCP_CONFIG_DEVICE_SEGMENT, "SEP001", oldv, newv) == SCCP_CONFIG_NOUPDATENEEDED);
+	pbx_variables_destroy(newv);
+
+	pbx_test_status_update(test, "description, softkeyset and button labels are live...\n");
+	newv = sccp_config_test_vars(labels, ARRAY_LEN(labels));
+	pbx_test_validate(test, sccp_config_classifyButtons(oldv, newv) == SCCP_CONFIG_NEEDLIVEUPDATE);
+	pbx_test_validate(test, sccp_config_diffSection(-1, SCCP_CONFIG_DEVICE_SEGMENT, "SEP001", oldv, newv) == SCCP_CONFIG_NEEDLIVEUPDATE);
+	pbx_variables_destroy(newv);
+
+	pbx_test_status_update(test, "speeddial hint change needs a restart...\n");
+	newv = sccp_config_test_vars(hint, ARRAY_LEN(hint));
+	pbx_test_validate(test, sccp_config_classifyButtons(oldv, newv) == SCCP_CONFIG_NEEDDEVICERESET);
+	pbx_variables_destroy(newv);
+
+	pbx_test_status_update(test, "line / number of buttons change needs a restart...\n");
+	newv = sccp_config_test_vars(layout, ARRAY_LEN(layout));
+	pbx_test_validate(test, sccp_config_classifyButtons(oldv, newv) == SCCP_CONFIG_NEEDDEVICERESET);
+	pbx_variables_destroy(newv);
+
+	pbx_test_status_update(test, "restart option...\n");
+	newv = sccp_config_test_vars(reset, ARRAY_LEN(reset));
+	pbx_test_validate(test, sccp_config_diffSection(-1, SCCP_CONFIG_DEVICE_SEGMENT, "SEP001", oldv, newv) == SCCP_CONFIG_NEEDDEVICERESET);
+	pbx_variables_destroy(newv);
+
+	pbx_test_status_update(test, "removed option falls back to default...\n");
+	newv = sccp_config_test_vars(base, 2);
+	pbx_test_validate(test, sccp_config_diffSection(-1, SCCP_CONFIG_DEVICE_SEGMENT, "SEP001", oldv, newv) & SCCP_CONFIG_NEEDDEVICERESET);
+	pbx_variables_destroy(newv);
+
+	pbx_variables_destroy(oldv);
+	return AST_TEST_PASS;
+}
+
 /*
 AST_TEST_DEFINE(sccp_config_setValue)
 {
@@ -4045,6 +5482,10 @@ static void __attribute__((constructor)) sccp_register_tests(void)
 	AST_TEST_REGISTER(sccp_config_base_functions);
 	AST_TEST_REGISTER(sccp_config_multientry);
 	AST_TEST_REGISTER(sccp_config_tokenized_default);
+	AST_TEST_REGISTER(sccp_config_reload_benchmark);
+	AST_TEST_REGISTER(sccp_config_lookup_table);
+	AST_TEST_REGISTER(sccp_config_parallel_read);
+	AST_TEST_REGISTER(sccp_config_reload_diff);
 	// AST_TEST_REGISTER(sccp_config_setValue);
 	// AST_TEST_REGISTER(sccp_config_setDefault);
 }
@@ -4054,6 +5495,10 @@ static void __attribute__((destructor)) sccp_unregister_tests(void)
 	AST_TEST_UNREGISTER(sccp_config_base_functions);
 	AST_TEST_UNREGISTER(sccp_config_multientry);
 	AST_TEST_UNREGISTER(sccp_config_tokenized_default);
+	AST_TEST_UNREGISTER(sccp_config_reload_benchmark);
+	AST_TEST_UNREGISTER(sccp_config_lookup_table);
+	AST_TEST_UNREGISTER(sccp_config_parallel_read);
+	AST_TEST_UNREGISTER(sccp_config_reload_diff);
 	// AST_TEST_UNREGISTER(sccp_config_setValue);
 	// AST_TEST_UNREGISTER(sccp_config_setDefault);
 }
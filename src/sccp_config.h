@@ -22,6 +22,7 @@ typedef enum {
 	SCCP_CONFIG_CHANGE_CHANGED,
 	SCCP_CONFIG_CHANGE_INVALIDVALUE,
 	SCCP_CONFIG_CHANGE_ERROR,
+	SCCP_CONFIG_CHANGE_LIVE,											/*!< changed, but can be pushed to a registered device without restarting it */
 } sccp_value_changed_t;
 
 /*!
@@ -57,6 +58,7 @@ typedef enum {
 } sccp_config_file_status_t;
 
 SCCP_API sccp_config_file_status_t SCCP_CALL sccp_config_getConfig(boolean_t force, const char * const filename);
+SCCP_API sccp_configurationchange_t SCCP_CALL sccp_config_dryrun(int fd, const char * filename);
 SCCP_API sccp_configurationchange_t SCCP_CALL sccp_config_applyGlobalConfiguration(PBX_VARIABLE_TYPE * v);
 SCCP_API sccp_configurationchange_t SCCP_CALL sccp_config_applyLineConfiguration(linePtr l, PBX_VARIABLE_TYPE * v);
 SCCP_API sccp_configurationchange_t SCCP_CALL sccp_config_applyDeviceConfiguration(devicePtr d, PBX_VARIABLE_TYPE * v);
@@ -5,12 +5,25 @@
  * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
  *              See the LICENSE file at the top of the source tree.
  * \since       2016-02-02
+ *
+ * Trace Ring:
+ * Debug categories enabled in GLOB(trace) are not formatted by pbx_log. Instead sccp_log() hands the format-string pointer
+ * and the raw arguments to sccp_trace_record(), which stores them in a fixed size entry inside a lock-free ring. Strings are
+ * copied into the entry, everything else is stored by value. Formatting only happens when the rings are dumped, either via
+ * "sccp show trace" or by the crash handler, which writes <logdir>/sccp_trace.<pid>.crash before chaining to the previous
+ * signal handler. Rings are selected by hashing the thread id, so a thread always writes into the same ring and the total
+ * memory used is bounded, however many session / pbx threads come and go.
+ * The crash handler is only installed once the first ring is allocated (i.e. once tracing was enabled) and only uses async
+ * signal safe calls: it formats the entries itself (conversions without width/precision) instead of using snprintf.
  */
 #include "config.h"
 #include "common.h"
 #include "sccp_debug.h"
 
 SCCP_FILE_VERSION(__FILE__, "");
+
+#include <asterisk/paths.h>				// ast_config_AST_LOG_DIR
+#include <fcntl.h>
 const char * SS_Memory_Allocation_Error = "%s: Memory Allocation Error.\n";
 
 /*!
@@ -152,4 +165,887 @@ char * sccp_get_debugcategories(int32_t debugvalue)
 	return res;
 }
 
+/* =================================================================================================================== TRACE RING */
+#define SCCP_TRACE_RINGS 16											/* power of 2 */
+#define SCCP_TRACE_RING_SIZE 512										/* power of 2, entries per ring */
+#define SCCP_TRACE_MAXARGS 10
+#define SCCP_TRACE_STRINGSIZE 112
+#define SCCP_TRACE_LINESIZE 1024
+#define SCCP_TRACE_NULLSTRING UINT16_MAX
+
+typedef enum {
+	SCCP_TRACE_ARG_NONE,
+	SCCP_TRACE_ARG_INT,
+	SCCP_TRACE_ARG_LONG,
+	SCCP_TRACE_ARG_LLONG,
+	SCCP_TRACE_ARG_SIZE,
+	SCCP_TRACE_ARG_PTRDIFF,
+	SCCP_TRACE_ARG_INTMAX,
+	SCCP_TRACE_ARG_DOUBLE,
+	SCCP_TRACE_ARG_PTR,
+	SCCP_TRACE_ARG_STRING,
+} sccp_trace_argtype_t;
+
+typedef union {
+	long long ll;
+	intmax_t j;
+	double d;
+	const void * p;
+	struct {
+		uint16_t offset;
+		uint16_t len;
+	} s;
+} sccp_trace_arg_t;
+
+typedef struct sccp_trace_entry {
+	volatile uint32_t seq;											/*!< ring position + 1 once the entry is complete, 0 while being written */
+	uint32_t category;
+	struct timeval tv;
+	unsigned long thread;
+	const char * file;
+	const char * function;
+	const char * format;
+	int line;
+	uint8_t nargs;
+	boolean_t truncated;											/*!< not all arguments could be captured */
+	uint8_t types[SCCP_TRACE_MAXARGS];
+	sccp_trace_arg_t args[SCCP_TRACE_MAXARGS];
+	char strings[SCCP_TRACE_STRINGSIZE];
+} sccp_trace_entry_t;
+
+typedef struct sccp_trace_ring {
+	volatile uint32_t head;
+	sccp_trace_entry_t entries[SCCP_TRACE_RING_SIZE];
+} sccp_trace_ring_t;
+
+typedef struct sccp_trace_spec {
+	const char * begin;											/*!< points at the '%' */
+	const char * end;											/*!< one past the conversion character */
+	uint8_t stars;												/*!< '*' width/precision arguments preceding the value */
+	sccp_trace_argtype_t type;
+} sccp_trace_spec_t;
+
+static sccp_trace_ring_t * volatile trace_rings[SCCP_TRACE_RINGS];
+static char trace_device[StationMaxDeviceNameSize];
+static const int trace_signals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+static struct sigaction trace_oldactions[ARRAY_LEN(trace_signals)];
+static volatile int trace_handlers_installed = 0;
+static char trace_crashfile[SCCP_PATH_MAX];									/*!< built when the handlers are installed, the handler can not format it */
+
+static void trace_installHandlers(void);
+
+/*!
+ * \brief Parse one printf conversion specification
+ * \param p points at the '%'
+ * \param spec Parsed Specification
+ * \return TRUE if the conversion is supported
+ */
+static boolean_t trace_parseSpec(const char * p, sccp_trace_spec_t * spec)
+{
+	uint8_t longs = 0;
+	char modifier = '\0';
+
+	spec->begin = p++;
+	spec->stars = 0;
+	spec->type = SCCP_TRACE_ARG_NONE;
+	while (*p && strchr("-+ #0'", *p)) {
+		p++;
+	}
+	if (*p == '*') {
+		spec->stars++;
+		p++;
+	}
+	while (isdigit((unsigned char)*p)) {
+		p++;
+	}
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->stars++;
+			p++;
+		}
+		while (isdigit((unsigned char)*p)) {
+			p++;
+		}
+	}
+	if (*p == 'h') {
+		p += (p[1] == 'h') ? 2 : 1;
+	} else if (*p == 'l') {
+		longs = (p[1] == 'l') ? 2 : 1;
+		p += longs;
+	} else if (*p && strchr("qjztL", *p)) {
+		modifier = *p++;
+	}
+	switch (*p) {
+		case 'd':
+		case 'i':
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'c':
+			if (longs == 2 || modifier == 'q') {
+				spec->type = SCCP_TRACE_ARG_LLONG;
+			} else if (longs == 1) {
+				spec->type = SCCP_TRACE_ARG_LONG;
+			} else if (modifier == 'z') {
+				spec->type = SCCP_TRACE_ARG_SIZE;
+			} else if (modifier == 't') {
+				spec->type = SCCP_TRACE_ARG_PTRDIFF;
+			} else if (modifier == 'j') {
+				spec->type = SCCP_TRACE_ARG_INTMAX;
+			} else if (modifier == '\0') {
+				spec->type = SCCP_TRACE_ARG_INT;
+			} else {
+				return FALSE;
+			}
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (modifier == 'L') {
+				return FALSE;
+			}
+			spec->type = SCCP_TRACE_ARG_DOUBLE;
+			break;
+		case 's':
+			if (longs || modifier) {
+				return FALSE;
+			}
+			spec->type = SCCP_TRACE_ARG_STRING;
+			break;
+		case 'p':
+			spec->type = SCCP_TRACE_ARG_PTR;
+			break;
+		case '%':
+		case 'm':
+			if (spec->stars) {
+				return FALSE;
+			}
+			break;
+		default:											/* %n, wide strings, end of format */
+			return FALSE;
+	}
+	spec->end = p + 1;
+	return TRUE;
+}
+
+/*!
+ * \brief Check if a string argument mentions the device we are tracing
+ */
+static inline boolean_t trace_matchDevice(const char * str, const char * deviceId)
+{
+	return str && strstr(str, deviceId) != NULL;
+}
+
+/*!
+ * \brief Capture the raw arguments belonging to format into entry
+ * \param deviceId when set, matched is set if any (complete, not yet truncated) string argument contains it
+ */
+static void trace_captureArgs(sccp_trace_entry_t * entry, const char * format, va_list ap, const char * deviceId, boolean_t * matched)
+{
+	sccp_trace_spec_t spec;
+	size_t stringpos = 0;
+	const char * p = format;
+
+	while ((p = strchr(p, '%'))) {
+		if (!trace_parseSpec(p, &spec) || entry->nargs + spec.stars + (spec.type != SCCP_TRACE_ARG_NONE) > SCCP_TRACE_MAXARGS) {
+			entry->truncated = TRUE;
+			return;
+		}
+		for (uint8_t star = 0; star < spec.stars; star++) {
+			entry->types[entry->nargs] = SCCP_TRACE_ARG_INT;
+			entry->args[entry->nargs++].ll = va_arg(ap, int);
+		}
+		switch (spec.type) {
+			case SCCP_TRACE_ARG_NONE:
+				break;
+			case SCCP_TRACE_ARG_INT:
+				entry->args[entry->nargs].ll = va_arg(ap, int);
+				break;
+			case SCCP_TRACE_ARG_LONG:
+				entry->args[entry->nargs].ll = va_arg(ap, long);
+				break;
+			case SCCP_TRACE_ARG_LLONG:
+				entry->args[entry->nargs].ll = va_arg(ap, long long);
+				break;
+			case SCCP_TRACE_ARG_SIZE:
+				entry->args[entry->nargs].ll = (long long)va_arg(ap, size_t);
+				break;
+			case SCCP_TRACE_ARG_PTRDIFF:
+				entry->args[entry->nargs].ll = va_arg(ap, ptrdiff_t);
+				break;
+			case SCCP_TRACE_ARG_INTMAX:
+				entry->args[entry->nargs].j = va_arg(ap, intmax_t);
+				break;
+			case SCCP_TRACE_ARG_DOUBLE:
+				entry->args[entry->nargs].d = va_arg(ap, double);
+				break;
+			case SCCP_TRACE_ARG_PTR:
+				entry->args[entry->nargs].p = va_arg(ap, void *);
+				break;
+			case SCCP_TRACE_ARG_STRING:
+				{
+					const char * str = va_arg(ap, const char *);
+					sccp_trace_arg_t * arg = &entry->args[entry->nargs];
+
+					if (deviceId && !*matched && trace_matchDevice(str, deviceId)) {
+						*matched = TRUE;
+					}
+					arg->s.offset = stringpos;
+					if (!str) {
+						arg->s.len = SCCP_TRACE_NULLSTRING;
+						break;
+					}
+					arg->s.len = 0;
+					while (str[arg->s.len] && stringpos + arg->s.len < SCCP_TRACE_STRINGSIZE - 1) {
+						entry->strings[stringpos + arg->s.len] = str[arg->s.len];
+						arg->s.len++;
+					}
+					entry->strings[stringpos + arg->s.len] = '\0';
+					stringpos += arg->s.len + (stringpos + arg->s.len < SCCP_TRACE_STRINGSIZE - 1);
+				}
+				break;
+		}
+		if (spec.type != SCCP_TRACE_ARG_NONE) {
+			entry->types[entry->nargs++] = spec.type;
+		}
+		p = spec.end;
+	}
+}
+
+/*!
+ * \brief Get the ring for the current thread, allocating it on first use
+ */
+static sccp_trace_ring_t * trace_getRing(void)
+{
+	uint32_t idx = (uint32_t)(((uint64_t)(uintptr_t)pthread_self() * 0x9E3779B97F4A7C15ULL) >> 32) & (SCCP_TRACE_RINGS - 1);
+	sccp_trace_ring_t * ring = trace_rings[idx];
+
+	if (!ring) {
+		sccp_trace_ring_t * newring = (sccp_trace_ring_t *)sccp_calloc(1, sizeof(sccp_trace_ring_t));
+		if (!newring) {
+			return NULL;
+		}
+		if (!__sync_bool_compare_and_swap(&trace_rings[idx], NULL, newring)) {
+			sccp_free(newring);
+		}
+		ring = trace_rings[idx];
+		if (!trace_handlers_installed) {
+			trace_installHandlers();
+		}
+	}
+	return ring;
+}
+
+/*!
+ * \brief Record a debug message into the trace ring of the current thread (called from sccp_log)
+ * \note does not format anything, the format pointer and the raw arguments are stored
+ */
+void sccp_trace_record(uint32_t category, const char * file, int line, const char * function, const char * format, ...)
+{
+	sccp_trace_entry_t entry;
+	sccp_trace_ring_t * ring = NULL;
+	boolean_t matched = FALSE;
+	uint32_t pos = 0;
+	va_list ap;
+
+	entry.seq = 0;
+	entry.category = category;
+	gettimeofday(&entry.tv, NULL);
+	entry.thread = (unsigned long)pthread_self();
+	entry.file = file;
+	entry.function = function;
+	entry.format = format;
+	entry.line = line;
+	entry.nargs = 0;
+	entry.truncated = FALSE;
+
+	va_start(ap, format);
+	trace_captureArgs(&entry, format, ap, trace_device[0] ? trace_device : NULL, &matched);
+	va_end(ap);
+
+	if (trace_device[0] && !matched) {
+		return;
+	}
+	if (!(ring = trace_getRing())) {
+		return;
+	}
+	pos = __sync_fetch_and_add(&ring->head, 1);
+	sccp_trace_entry_t * slot = &ring->entries[pos & (SCCP_TRACE_RING_SIZE - 1)];
+	slot->seq = 0;
+	__sync_synchronize();
+	memcpy((char *)slot + sizeof(slot->seq), (char *)&entry + sizeof(entry.seq), sizeof(entry) - sizeof(entry.seq));
+	__sync_synchronize();
+	slot->seq = pos + 1;
+}
+
+/*!
+ * \brief Copy a complete entry out of a ring, skipping entries that are being (over)written
+ */
+static boolean_t trace_readEntry(sccp_trace_ring_t * ring, uint32_t pos, sccp_trace_entry_t * entry)
+{
+	sccp_trace_entry_t * slot = &ring->entries[pos & (SCCP_TRACE_RING_SIZE - 1)];
+	uint32_t seq = slot->seq;
+
+	if (seq != pos + 1) {
+		return FALSE;
+	}
+	__sync_synchronize();
+	memcpy(entry, slot, sizeof(sccp_trace_entry_t));
+	__sync_synchronize();
+	return slot->seq == seq;
+}
+
+/*!
+ * \brief Format a recorded entry (lazily, at dump time)
+ * \return length of the formatted line
+ */
+static size_t trace_formatEntry(const sccp_trace_entry_t * entry, char * buf, size_t size)
+{
+	const char * categoryname = "";
+	const char * p = entry->format;
+	struct tm tm;
+	sccp_trace_spec_t spec;
+	char subformat[32];
+	uint8_t argi = 0;
+	size_t len = 0;
+	int res = 0;
+
+	for (uint32_t i = 2; i < ARRAY_LEN(sccp_debug_categories); i++) {
+		if (entry->category & sccp_debug_categories[i].category) {
+			categoryname = sccp_debug_categories[i].key;
+			break;
+		}
+	}
+	time_t sec = entry->tv.tv_sec;
+	localtime_r(&sec, &tm);
+	len = strftime(buf, size, "[%Y-%m-%d %H:%M:%S", &tm);
+	res = snprintf(buf + len, size - len, ".%06ld] [%lx] %s %s:%d %s: ", (long)entry->tv.tv_usec, entry->thread, categoryname, entry->file, entry->line, entry->function);
+	len += (res > 0) ? (((size_t)res < size - len) ? (size_t)res : size - len - 1) : 0;
+
+	while (*p && len < size - 1) {
+		if (*p != '%') {
+			buf[len++] = *p++;
+			continue;
+		}
+		if (!trace_parseSpec(p, &spec) || (size_t)(spec.end - spec.begin) >= sizeof(subformat) || argi + spec.stars + (spec.type != SCCP_TRACE_ARG_NONE) > entry->nargs) {
+			res = snprintf(buf + len, size - len, "%s", " <...>\n");
+			len += (res > 0) ? (((size_t)res < size - len) ? (size_t)res : size - len - 1) : 0;
+			break;
+		}
+		memcpy(subformat, spec.begin, spec.end - spec.begin);
+		subformat[spec.end - spec.begin] = '\0';
+
+		int width = (spec.stars > 0) ? (int)entry->args[argi].ll : 0;
+		int precision = (spec.stars > 1) ? (int)entry->args[argi + 1].ll : 0;
+		const sccp_trace_arg_t * arg = &entry->args[argi + spec.stars];
+
+#define TRACE_PRINT(_value)																			\
+		(spec.stars == 2 ? snprintf(buf + len, size - len, subformat, width, precision, _value) :						\
+		 spec.stars == 1 ? snprintf(buf + len, size - len, subformat, width, _value) : snprintf(buf + len, size - len, subformat, _value))
+		switch (spec.type) {
+			case SCCP_TRACE_ARG_NONE:
+				res = snprintf(buf + len, size - len, subformat, 0);
+				break;
+			case SCCP_TRACE_ARG_INT:
+				res = TRACE_PRINT((int)arg->ll);
+				break;
+			case SCCP_TRACE_ARG_LONG:
+				res = TRACE_PRINT((long)arg->ll);
+				break;
+			case SCCP_TRACE_ARG_LLONG:
+				res = TRACE_PRINT(arg->ll);
+				break;
+			case SCCP_TRACE_ARG_SIZE:
+				res = TRACE_PRINT((size_t)arg->ll);
+				break;
+			case SCCP_TRACE_ARG_PTRDIFF:
+				res = TRACE_PRINT((ptrdiff_t)arg->ll);
+				break;
+			case SCCP_TRACE_ARG_INTMAX:
+				res = TRACE_PRINT(arg->j);
+				break;
+			case SCCP_TRACE_ARG_DOUBLE:
+				res = TRACE_PRINT(arg->d);
+				break;
+			case SCCP_TRACE_ARG_PTR:
+				res = TRACE_PRINT(arg->p);
+				break;
+			case SCCP_TRACE_ARG_STRING:
+				res = TRACE_PRINT(arg->s.len == SCCP_TRACE_NULLSTRING ? "(null)" : &entry->strings[arg->s.offset]);
+				break;
+		}
+#undef TRACE_PRINT
+		len += (res > 0) ? (((size_t)res < size - len) ? (size_t)res : size - len - 1) : 0;
+		argi += spec.stars + (spec.type != SCCP_TRACE_ARG_NONE);
+		p = spec.end;
+	}
+	if (len > 0 && buf[len - 1] != '\n') {
+		if (len >= size - 1) {
+			len = size - 2;
+		}
+		buf[len++] = '\n';
+	}
+	buf[len] = '\0';
+	return len;
+}
+
+/* async signal safe appenders, used by trace_formatEntrySafe */
+static size_t trace_safeString(char * buf, size_t size, size_t len, const char * str)
+{
+	while (str && *str && len < size - 1) {
+		buf[len++] = *str++;
+	}
+	return len;
+}
+
+static size_t trace_safeNumber(char * buf, size_t size, size_t len, unsigned long long value, unsigned int base, unsigned int mindigits, boolean_t upper)
+{
+	const char * digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	char tmp[24];
+	unsigned int ndigits = 0;
+
+	do {
+		tmp[ndigits++] = digits[value % base];
+		value /= base;
+	} while (value && ndigits < sizeof(tmp));
+	while (ndigits < mindigits && ndigits < sizeof(tmp)) {
+		tmp[ndigits++] = '0';
+	}
+	while (ndigits && len < size - 1) {
+		buf[len++] = tmp[--ndigits];
+	}
+	return len;
+}
+
+static size_t trace_safeSigned(char * buf, size_t size, size_t len, long long value)
+{
+	if (value < 0 && len < size - 1) {
+		buf[len++] = '-';
+		return trace_safeNumber(buf, size, len, 0ULL - (unsigned long long)value, 10, 1, FALSE);
+	}
+	return trace_safeNumber(buf, size, len, (unsigned long long)value, 10, 1, FALSE);
+}
+
+/*!
+ * \brief Format a recorded entry using async signal safe calls only (crash handler)
+ * \note flags, width and precision are ignored, doubles are written with 6 decimals, the timestamp is written as seconds since the epoch
+ * \return length of the formatted line
+ */
+static size_t trace_formatEntrySafe(const sccp_trace_entry_t * entry, char * buf, size_t size)
+{
+	const char * categoryname = "";
+	const char * p = entry->format;
+	sccp_trace_spec_t spec;
+	uint8_t argi = 0;
+	size_t len = 0;
+
+	for (uint32_t i = 2; i < ARRAY_LEN(sccp_debug_categories); i++) {
+		if (entry->category & sccp_debug_categories[i].category) {
+			categoryname = sccp_debug_categories[i].key;
+			break;
+		}
+	}
+	len = trace_safeString(buf, size, len, "[");
+	len = trace_safeNumber(buf, size, len, (unsigned long long)entry->tv.tv_sec, 10, 1, FALSE);
+	len = trace_safeString(buf, size, len, ".");
+	len = trace_safeNumber(buf, size, len, (unsigned long long)entry->tv.tv_usec, 10, 6, FALSE);
+	len = trace_safeString(buf, size, len, "] [");
+	len = trace_safeNumber(buf, size, len, entry->thread, 16, 1, FALSE);
+	len = trace_safeString(buf, size, len, "] ");
+	len = trace_safeString(buf, size, len, categoryname);
+	len = trace_safeString(buf, size, len, " ");
+	len = trace_safeString(buf, size, len, entry->file);
+	len = trace_safeString(buf, size, len, ":");
+	len = trace_safeSigned(buf, size, len, entry->line);
+	len = trace_safeString(buf, size, len, " ");
+	len = trace_safeString(buf, size, len, entry->function);
+	len = trace_safeString(buf, size, len, ": ");
+
+	while (*p && len < size - 1) {
+		if (*p != '%') {
+			buf[len++] = *p++;
+			continue;
+		}
+		if (!trace_parseSpec(p, &spec) || argi + spec.stars + (spec.type != SCCP_TRACE_ARG_NONE) > entry->nargs) {
+			len = trace_safeString(buf, size, len, " <...>\n");
+			break;
+		}
+		const sccp_trace_arg_t * arg = &entry->args[argi + spec.stars];
+		char conversion = *(spec.end - 1);
+
+		switch (spec.type) {
+			case SCCP_TRACE_ARG_NONE:
+				len = trace_safeString(buf, size, len, conversion == '%' ? "%" : "%m");
+				break;
+			case SCCP_TRACE_ARG_INT:
+			case SCCP_TRACE_ARG_LONG:
+			case SCCP_TRACE_ARG_LLONG:
+			case SCCP_TRACE_ARG_SIZE:
+			case SCCP_TRACE_ARG_PTRDIFF:
+			case SCCP_TRACE_ARG_INTMAX:
+				{
+					long long value = (spec.type == SCCP_TRACE_ARG_INTMAX) ? (long long)arg->j : arg->ll;
+					if (conversion == 'c') {
+						char c[2] = { (char)value, '\0' };
+						len = trace_safeString(buf, size, len, c);
+					} else if (conversion == 'd' || conversion == 'i') {
+						len = trace_safeSigned(buf, size, len, value);
+					} else {
+						unsigned long long uvalue = (unsigned long long)value;
+						if (spec.type == SCCP_TRACE_ARG_INT) {
+							uvalue = (unsigned int)value;
+						}
+						len = trace_safeNumber(buf, size, len, uvalue, conversion == 'o' ? 8 : (conversion == 'u' ? 10 : 16), 1, conversion == 'X');
+					}
+				}
+				break;
+			case SCCP_TRACE_ARG_DOUBLE:
+				{
+					double value = arg->d;
+					if (value != value) {
+						len = trace_safeString(buf, size, len, "nan");
+						break;
+					}
+					if (value < 0) {
+						len = trace_safeString(buf, size, len, "-");
+						value = -value;
+					}
+					if (value >= 1e18) {
+						len = trace_safeString(buf, size, len, "inf");
+						break;
+					}
+					unsigned long long whole = (unsigned long long)value;
+					unsigned long long fraction = (unsigned long long)((value - (double)whole) * 1000000.0 + 0.5);
+					if (fraction >= 1000000ULL) {
+						whole++;
+						fraction -= 1000000ULL;
+					}
+					len = trace_safeNumber(buf, size, len, whole, 10, 1, FALSE);
+					len = trace_safeString(buf, size, len, ".");
+					len = trace_safeNumber(buf, size, len, fraction, 10, 6, FALSE);
+				}
+				break;
+			case SCCP_TRACE_ARG_PTR:
+				len = trace_safeString(buf, size, len, "0x");
+				len = trace_safeNumber(buf, size, len, (unsigned long long)(uintptr_t)arg->p, 16, 1, FALSE);
+				break;
+			case SCCP_TRACE_ARG_STRING:
+				len = trace_safeString(buf, size, len, arg->s.len == SCCP_TRACE_NULLSTRING ? "(null)" : &entry->strings[arg->s.offset]);
+				break;
+		}
+		argi += spec.stars + (spec.type != SCCP_TRACE_ARG_NONE);
+		p = spec.end;
+	}
+	if (len > 0 && buf[len - 1] != '\n') {
+		if (len >= size - 1) {
+			len = size - 2;
+		}
+		buf[len++] = '\n';
+	}
+	buf[len] = '\0';
+	return len;
+}
+
+static void trace_write(int fd, const char * buf, size_t len)
+{
+	while (len > 0) {
+		ssize_t res = write(fd, buf, len);
+		if (res < 0 && errno == EINTR) {
+			continue;
+		}
+		if (res <= 0) {
+			return;
+		}
+		buf += res;
+		len -= res;
+	}
+}
+
+/*!
+ * \brief Dump the trace rings to fd, merged in timestamp order
+ * \param fd File Descriptor to write to (cli or crash file)
+ * \param max Only the last max entries (0 for all)
+ * \param signalsafe format using trace_formatEntrySafe (crash handler)
+ * \return number of entries written
+ *
+ * \note does not allocate or lock, so it can be used from the crash handler
+ */
+static int trace_dumpRings(int fd, uint32_t max, boolean_t signalsafe)
+{
+	sccp_trace_entry_t pending[SCCP_TRACE_RINGS];
+	boolean_t valid[SCCP_TRACE_RINGS] = { FALSE };
+	uint32_t cursor[SCCP_TRACE_RINGS] = { 0 };
+	uint32_t end[SCCP_TRACE_RINGS] = { 0 };
+	char line[SCCP_TRACE_LINESIZE];
+	uint32_t total = 0;
+	uint32_t skip = 0;
+	int written = 0;
+
+	for (uint32_t r = 0; r < SCCP_TRACE_RINGS; r++) {
+		if (trace_rings[r]) {
+			end[r] = trace_rings[r]->head;
+			cursor[r] = (end[r] > SCCP_TRACE_RING_SIZE) ? end[r] - SCCP_TRACE_RING_SIZE : 0;
+			total += end[r] - cursor[r];
+		}
+	}
+	skip = (max && total > max) ? total - max : 0;
+
+	for (;;) {
+		int next = -1;
+
+		for (uint32_t r = 0; r < SCCP_TRACE_RINGS; r++) {
+			while (!valid[r] && cursor[r] < end[r]) {
+				valid[r] = trace_readEntry(trace_rings[r], cursor[r]++, &pending[r]);
+			}
+			if (valid[r] && (next < 0 || timercmp(&pending[r].tv, &pending[next].tv, <))) {
+				next = r;
+			}
+		}
+		if (next < 0) {
+			break;
+		}
+		valid[next] = FALSE;
+		if (skip) {
+			skip--;
+			continue;
+		}
+		trace_write(fd, line, signalsafe ? trace_formatEntrySafe(&pending[next], line, sizeof(line)) : trace_formatEntry(&pending[next], line, sizeof(line)));
+		written++;
+	}
+	return written;
+}
+
+/*!
+ * \brief Dump the trace rings to fd, merged in timestamp order
+ * \param fd File Descriptor to write to
+ * \param max Only the last max entries (0 for all)
+ * \return number of entries written
+ */
+int sccp_trace_dump(int fd, uint32_t max)
+{
+	return trace_dumpRings(fd, max, FALSE);
+}
+
+/*!
+ * \brief Write the trace rings to <logdir>/sccp_trace.<pid>.crash and chain to the previous handler
+ */
+static void trace_crashHandler(int signum)
+{
+	static volatile int crashed = 0;
+	boolean_t haverings = FALSE;
+
+	for (uint32_t r = 0; r < SCCP_TRACE_RINGS; r++) {
+		haverings |= (trace_rings[r] != NULL);
+	}
+	if (haverings && trace_crashfile[0] && !__sync_lock_test_and_set(&crashed, 1)) {
+		int fd = -1;
+
+		if ((fd = open(trace_crashfile, O_WRONLY | O_CREAT | O_TRUNC, 0600)) >= 0) {
+			trace_dumpRings(fd, 0, TRUE);
+			close(fd);
+		}
+	}
+	for (uint32_t i = 0; i < ARRAY_LEN(trace_signals); i++) {
+		if (trace_signals[i] == signum) {
+			sigaction(signum, &trace_oldactions[i], NULL);
+		}
+	}
+	raise(signum);
+}
+
+/*!
+ * \brief Install the crash handler, called when the first trace ring is allocated (so only when tracing is enabled)
+ */
+static void trace_installHandlers(void)
+{
+	struct sigaction action;
+
+	if (!__sync_bool_compare_and_swap(&trace_handlers_installed, 0, 1)) {
+		return;
+	}
+	snprintf(trace_crashfile, sizeof(trace_crashfile), "%s/sccp_trace.%d.crash", ast_config_AST_LOG_DIR, (int)getpid());
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = trace_crashHandler;
+	sigemptyset(&action.sa_mask);
+	for (uint32_t i = 0; i < ARRAY_LEN(trace_signals); i++) {
+		sigaction(trace_signals[i], &action, &trace_oldactions[i]);
+	}
+}
+
+void sccp_trace_module_stop(void)
+{
+	struct sigaction current;
+
+	if (trace_handlers_installed) {
+		for (uint32_t i = 0; i < ARRAY_LEN(trace_signals); i++) {
+			/* only restore when nobody chained on top of us in the meantime */
+			if (sigaction(trace_signals[i], NULL, &current) == 0 && current.sa_handler == trace_crashHandler) {
+				sigaction(trace_signals[i], &trace_oldactions[i], NULL);
+			}
+		}
+		trace_handlers_installed = 0;
+	}
+	for (uint32_t r = 0; r < SCCP_TRACE_RINGS; r++) {
+		sccp_trace_ring_t * ring = trace_rings[r];
+		trace_rings[r] = NULL;
+		if (ring) {
+			sccp_free(ring);
+		}
+	}
+	trace_device[0] = '\0';
+}
+
+/*!
+ * \brief Restrict tracing to messages mentioning deviceId (NULL/"" for all devices)
+ */
+void sccp_trace_setdevice(const char * deviceId)
+{
+	pbx_copy_string(trace_device, deviceId ? deviceId : "", sizeof(trace_device));
+}
+
+const char * sccp_trace_getdevice(void)
+{
+	return trace_device;
+}
+
+/*!
+ * \brief Parse a trace line ("<categories> [device <deviceId>]") to a trace value
+ * \param arguments Array of Arguments
+ * \param startat Start Point in the Arguments Array
+ * \param argc Count of Arguments
+ * \param new_trace_value as int32_t
+ * \param device buffer receiving the device filter, left untouched when no "device" argument was given
+ * \param devicelen size of the device buffer
+ * \return new_trace_value as int32_t
+ *
+ * \note categories are parsed by sccp_parse_debugline, "device all" removes the device filter
+ */
+int32_t sccp_parse_traceline(char * arguments[], int startat, int argc, int32_t new_trace_value, char * device, size_t devicelen)
+{
+	char * categories[32] = { NULL };
+	int ncategories = 0;
+
+	for (int argi = startat; argi < argc; argi++) {
+		if (!strcasecmp(arguments[argi], "device") && argi + 1 < argc) {
+			argi++;
+			pbx_copy_string(device, strcasecmp(arguments[argi], "all") ? arguments[argi] : "", devicelen);
+		} else if (ncategories < (int)ARRAY_LEN(categories)) {
+			categories[ncategories++] = arguments[argi];
+		}
+	}
+	if (ncategories > 0) {
+		new_trace_value = sccp_parse_debugline(categories, 0, ncategories, new_trace_value);
+	}
+	return new_trace_value;
+}
+
+#if CS_TEST_FRAMEWORK
+#include <asterisk/test.h>
+AST_TEST_DEFINE(sccp_trace_tests)
+{
+	sccp_trace_entry_t entry;
+	sccp_trace_ring_t * ring = NULL;
+	char line[SCCP_TRACE_LINESIZE];
+	const char * message = NULL;
+	const char * nullstring = NULL;
+	int pipefds[2] = { -1, -1 };
+	int res = AST_TEST_PASS;
+
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "trace";
+			info->category = "/channels/chan_sccp/debug/";
+			info->summary = "chan-sccp-b trace ring";
+			info->description = "chan-sccp-b trace ring record / lazy format";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+
+	pbx_test_status_update(test, "Capture / Format...\n");
+	sccp_trace_record(DEBUGCAT_DEVICE, __FILE__, __LINE__, __PRETTY_FUNCTION__, "%s: %d/%5.2f %*d %lu %zu [%-4s] %% %s\n", "SEP001", -5, 1.5, 4, 7, 12345678901UL, (size_t)42, "ab", nullstring);
+	ring = trace_getRing();
+	pbx_test_validate_cleanup(test, ring != NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, trace_readEntry(ring, ring->head - 1, &entry), res, cleanup);
+	pbx_test_validate_cleanup(test, entry.nargs == 9 && !entry.truncated, res, cleanup);
+	trace_formatEntry(&entry, line, sizeof(line));
+	message = strstr(line, __PRETTY_FUNCTION__);
+	pbx_test_validate_cleanup(test, message != NULL, res, cleanup);
+	message += strlen(__PRETTY_FUNCTION__) + 2;
+	pbx_test_status_update(test, "Formatted: %s", message);
+	pbx_test_validate_cleanup(test, !strcmp(message, "SEP001: -5/ 1.50    7 12345678901 42 [ab  ] % (null)\n"), res, cleanup);
+
+	pbx_test_status_update(test, "Signal Safe Format...\n");
+	trace_formatEntrySafe(&entry, line, sizeof(line));
+	message = strstr(line, __PRETTY_FUNCTION__);
+	pbx_test_validate_cleanup(test, message != NULL, res, cleanup);
+	message += strlen(__PRETTY_FUNCTION__) + 2;
+	pbx_test_status_update(test, "Formatted: %s", message);
+	pbx_test_validate_cleanup(test, !strcmp(message, "SEP001: -5/1.500000 7 12345678901 42 [ab] % (null)\n"), res, cleanup);
+
+	pbx_test_status_update(test, "Device Filter...\n");
+	pbx_test_validate_cleanup(test, trace_matchDevice("SEP001", "SEP001"), res, cleanup);
+	pbx_test_validate_cleanup(test, trace_matchDevice("SCCP/SEP001-00000001", "SEP001"), res, cleanup);
+	pbx_test_validate_cleanup(test, !trace_matchDevice("SEP001", "SEP002"), res, cleanup);
+	sccp_trace_setdevice("SEP002");
+	uint32_t head = ring->head;
+	sccp_trace_record(DEBUGCAT_DEVICE, __FILE__, __LINE__, __PRETTY_FUNCTION__, "%s: filtered\n", "SEP001");
+	pbx_test_validate_cleanup(test, ring->head == head, res, cleanup);
+	sccp_trace_record(DEBUGCAT_DEVICE, __FILE__, __LINE__, __PRETTY_FUNCTION__, "%s: passed\n", "SCCP/SEP002-00000002");
+	pbx_test_validate_cleanup(test, ring->head == head + 1, res, cleanup);
+	{
+		char longstring[SCCP_TRACE_STRINGSIZE + 16];
+		memset(longstring, 'x', sizeof(longstring) - 1);
+		longstring[sizeof(longstring) - 1] = '\0';
+		sccp_trace_record(DEBUGCAT_DEVICE, __FILE__, __LINE__, __PRETTY_FUNCTION__, "%s %s: passed, although truncated\n", longstring, "SEP002");
+		pbx_test_validate_cleanup(test, ring->head == head + 2, res, cleanup);
+	}
+	sccp_trace_setdevice(NULL);
+
+	pbx_test_status_update(test, "Unsupported Conversion...\n");
+	sccp_trace_record(DEBUGCAT_CORE, __FILE__, __LINE__, __PRETTY_FUNCTION__, "%d %Lf %d\n", 1, (long double)2.0, 3);
+	pbx_test_validate_cleanup(test, trace_readEntry(ring, ring->head - 1, &entry), res, cleanup);
+	pbx_test_validate_cleanup(test, entry.nargs == 1 && entry.truncated, res, cleanup);
+	trace_formatEntry(&entry, line, sizeof(line));
+	pbx_test_validate_cleanup(test, strstr(line, ": 1  <...>\n") != NULL, res, cleanup);
+
+	pbx_test_status_update(test, "Ring Wrap / Dump...\n");
+	for (int iter = 0; iter < SCCP_TRACE_RING_SIZE + 10; iter++) {
+		sccp_trace_record(DEBUGCAT_CORE, __FILE__, __LINE__, __PRETTY_FUNCTION__, "wrap %d\n", iter);
+	}
+	pbx_test_validate_cleanup(test, !trace_readEntry(ring, ring->head - SCCP_TRACE_RING_SIZE - 1, &entry), res, cleanup);
+	pbx_test_validate_cleanup(test, trace_readEntry(ring, ring->head - SCCP_TRACE_RING_SIZE, &entry), res, cleanup);
+	pbx_test_validate_cleanup(test, pipe(pipefds) == 0, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_trace_dump(pipefds[1], 1) == 1, res, cleanup);
+	memset(line, 0, sizeof(line));
+	pbx_test_validate_cleanup(test, read(pipefds[0], line, sizeof(line) - 1) > 0, res, cleanup);
+	pbx_test_validate_cleanup(test, strstr(line, "wrap 521\n") != NULL, res, cleanup);
+
+cleanup:
+	if (pipefds[0] >= 0) {
+		close(pipefds[0]);
+		close(pipefds[1]);
+	}
+	sccp_trace_setdevice(NULL);
+	return res;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_trace_tests);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_trace_tests);
+}
+#endif
+
 // kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
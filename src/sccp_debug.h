@@ -27,11 +27,16 @@
 		}                                                                                                                                                                                                               \
 	}
 #define sccp_log1(_format, ...)                                                                                                                                                                                                 \
-	sccp_log2(_format, ##__VA_ARGS__)                                                                                                                                                                                       \
+	if ((sccp_globals->trace & __sccp_cat)) {                                                                                                                                                                               \
+		sccp_trace_record(__sccp_cat, __FILE__, __LINE__, __PRETTY_FUNCTION__, _format, ##__VA_ARGS__);                                                                                                                 \
+	} else {                                                                                                                                                                                                                \
+		sccp_log2(_format, ##__VA_ARGS__)                                                                                                                                                                               \
+	}                                                                                                                                                                                                                       \
 	}                                                                                                                                                                                                                       \
 	})
-#define sccp_log(_x) ({if ((sccp_globals->debug & (_x))) {sccp_log1
-#define sccp_log_and(_x) ({if ((sccp_globals->debug & (_x)) == (_x)) {sccp_log1
+/* categories enabled in sccp_globals->trace are recorded into the binary trace ring instead of being formatted by pbx_log */
+#define sccp_log(_x) ({uint32_t __sccp_cat = (_x); if (((sccp_globals->debug | sccp_globals->trace) & __sccp_cat)) {sccp_log1
+#define sccp_log_and(_x) ({uint32_t __sccp_cat = (_x); if (((sccp_globals->debug | sccp_globals->trace) & __sccp_cat) == __sccp_cat) {sccp_log1
 __BEGIN_C_EXTERN__
 extern const char * SS_Memory_Allocation_Error;
 /*!
@@ -84,5 +89,13 @@ extern const struct sccp_debug_category sccp_debug_categories[32];
 
 SCCP_API int32_t SCCP_CALL sccp_parse_debugline(char * arguments[], int startat, int argc, int32_t new_debug_value);
 SCCP_API char * SCCP_CALL  sccp_get_debugcategories(int32_t debugvalue);
+
+/* binary trace ring */
+SCCP_API void SCCP_CALL sccp_trace_module_stop(void);
+SCCP_API void SCCP_CALL sccp_trace_record(uint32_t category, const char * file, int line, const char * function, const char * format, ...) __attribute__((format(printf, 5, 6)));
+SCCP_API int32_t SCCP_CALL sccp_parse_traceline(char * arguments[], int startat, int argc, int32_t new_trace_value, char * device, size_t devicelen);
+SCCP_API void SCCP_CALL sccp_trace_setdevice(const char * deviceId);
+SCCP_API const char * SCCP_CALL sccp_trace_getdevice(void);
+SCCP_API int SCCP_CALL sccp_trace_dump(int fd, uint32_t max);
 __END_C_EXTERN__
 // kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
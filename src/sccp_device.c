@@ -28,6 +28,7 @@
 #include "sccp_indicate.h"
 #include "sccp_utils.h"
 #include "sccp_atomic.h"
+#include "sccp_codepage.h"
 //#include "sccp_devstate.h"
 #include "sccp_featureParkingLot.h"
 #include "sccp_labels.h"
@@ -60,6 +61,7 @@ struct sccp_private_device_data {
 
 	skinny_registrationstate_t registrationState;
 
+	const sccp_codepage_t *codepage;										/*!< direct conversion table, NULL when using iconv */
 #if HAVE_ICONV
 	iconv_t iconv;
 	sccp_mutex_t iconv_lock;
@@ -236,6 +238,9 @@ static void sccp_device_copyStr2Locale_UTF8(constDevicePtr d, char *dst, ICONV_C
 #if HAVE_ICONV
 int sccp_device_createiconv(devicePtr d)
 {
+	if (d->privateData->iconv != (iconv_t) -1) {
+		return 1;
+	}
 	d->privateData->iconv = iconv_open(d->iconvcodepage, "UTF-8");
 	if (d->privateData->iconv == (iconv_t) -1) {
 		pbx_log(LOG_ERROR, "SCCP:conversion from 'UTF-8' to '%s' not available.\n", d->iconvcodepage);
@@ -253,49 +258,55 @@ void sccp_device_destroyiconv(devicePtr d)
 	}
 }
 
-static boolean_t sccp_device_convUtf8toLatin1(constDevicePtr d, ICONV_CONST char *utf8str, char *buf, size_t len) 
+static void sccp_device_convUtf8toLatin1(constDevicePtr d, ICONV_CONST char *utf8str, char *buf, size_t len) 
 {
-	if (d->privateData->iconv == (iconv_t) -1) {
-		// fallback to plain string copy
-		sccp_copy_string(buf, utf8str, len);
-		return TRUE;
-	}
-	size_t incount = 0;
-
-	size_t outcount = len;
-	incount = sccp_strlen(utf8str);
-	if (incount) {
-		pbx_mutex_lock(&d->privateData->iconv_lock);
-		if (iconv(d->privateData->iconv, &utf8str, &incount, &buf, &outcount) == (size_t) -1) {
-			if (errno == E2BIG) {
-				pbx_log(LOG_WARNING, "SCCP: Iconv: output buffer too small.\n");
-			} else if (errno == EILSEQ) {
-				pbx_log(LOG_WARNING, "SCCP: Iconv: illegal character.\n");
-			} else if (errno == EINVAL) {
-				pbx_log(LOG_WARNING, "SCCP: Iconv: incomplete character sequence.\n");
-			} else {
-				pbx_log(LOG_WARNING, "SCCP: Iconv: error %d: %s.\n", errno, strerror(errno));
-			}
+	size_t incount = sccp_strlen(utf8str);
+	size_t outcount = len - 1;
+
+	pbx_mutex_lock(&d->privateData->iconv_lock);
+	if (iconv(d->privateData->iconv, &utf8str, &incount, &buf, &outcount) == (size_t) -1) {
+		if (errno == E2BIG) {
+			pbx_log(LOG_WARNING, "SCCP: Iconv: output buffer too small.\n");
+		} else if (errno == EILSEQ) {
+			pbx_log(LOG_WARNING, "SCCP: Iconv: illegal character.\n");
+		} else if (errno == EINVAL) {
+			pbx_log(LOG_WARNING, "SCCP: Iconv: incomplete character sequence.\n");
+		} else {
+			pbx_log(LOG_WARNING, "SCCP: Iconv: error %d: %s.\n", errno, strerror(errno));
 		}
-		pbx_mutex_unlock(&d->privateData->iconv_lock);
 	}
-	return TRUE;
+	iconv(d->privateData->iconv, NULL, NULL, NULL, NULL);							/* reset shift state */
+	pbx_mutex_unlock(&d->privateData->iconv_lock);
+	*buf = '\0';
 }
+#endif
 
+/*!
+ * \brief Copy a UTF-8 string to a pre-java phone, converted to its codepage
+ * Pure ASCII is copied directly, the common single-byte codepages use the lock-free sccp_codepage tables, iconv is only
+ * used for other codepages.
+ */
 static void sccp_device_copyStr2Locale_Convert(constDevicePtr d, char *dst, ICONV_CONST char *src, size_t dst_size)
 {
-	if (!dst || !src) {
+	if (!dst || !src || !dst_size) {
 		return;
 	}
-	char *buf = (char *)sccp_alloca(dst_size);
-	size_t buf_len = dst_size;
-	memset(buf, 0, dst_size);
-	if (sccp_device_convUtf8toLatin1(d, src, buf, buf_len)) {
-		sccp_copy_string(dst, buf, dst_size);
+	if (sccp_codepage_copyAscii(dst, src, dst_size)) {
+		return;
+	}
+	if (d->privateData->codepage) {
+		sccp_codepage_convert(d->privateData->codepage, dst, src, dst_size);
+		return;
+	}
+#if HAVE_ICONV
+	if (d->privateData->iconv != (iconv_t) -1) {
+		sccp_device_convUtf8toLatin1(d, src, dst, dst_size);
 		return;
 	}
-}
 #endif
+	// fallback to plain string copy
+	sccp_copy_string(dst, src, dst_size);
+}
 
 /*
    static void sccp_device_startStream(const sccp_device_t *device, const char *address, uint32_t port){
@@ -454,6 +465,60 @@ boolean_t sccp_device_check_update(devicePtr device)
 	return res;
 }
 
+/*!
+ * \brief Push config changes that do not require a restart to a registered device
+ * \note See \ref sccp_config_reload
+ * \param device SCCP Device
+ * \return TRUE when the pending live updates have been sent (or were not needed)
+ *
+ * Labels, descriptions, speeddials, service urls, softkeysets, cfwd softkeys and MWI lamp changes are sent using the same
+ * messages the device would receive during registration. Updates are postponed while the device has active channels.
+ *
+ * \callgraph
+ * \callergraph
+ */
+boolean_t sccp_device_apply_liveupdate(devicePtr device)
+{
+	AUTO_RELEASE(sccp_device_t, d , device ? sccp_device_retain(device) : NULL);
+	boolean_t res = FALSE;
+
+	if (d && d->pendingLiveUpdate) {
+		do {
+			if (d->pendingUpdate || d->pendingDelete) {
+				sccp_device_clearLiveUpdate(d);							/* restart will resend everything */
+				res = TRUE;
+				break;
+			}
+			if (!d->session || sccp_device_getRegistrationState(d) != SKINNY_DEVICE_RS_OK) {
+				sccp_device_clearLiveUpdate(d);							/* device will pick up the new config when it registers */
+				res = TRUE;
+				break;
+			}
+			if (sccp_device_numberOfChannels(d) > 0) {
+				break;
+			}
+			uint8_t liveUpdate = sccp_device_clearLiveUpdate(d);
+			sccp_log((DEBUGCAT_CORE)) (VERBOSE_PREFIX_1 "Device %s: applying config changes without reset (lines:%s, buttons:%s, softkeys:%s, mwi:%s)\n", d->id,
+				(liveUpdate & SCCP_DEVICE_LIVEUPDATE_LINES) ? "yes" : "no", (liveUpdate & SCCP_DEVICE_LIVEUPDATE_BUTTONS) ? "yes" : "no",
+				(liveUpdate & SCCP_DEVICE_LIVEUPDATE_SOFTKEYS) ? "yes" : "no", (liveUpdate & SCCP_DEVICE_LIVEUPDATE_MWI) ? "yes" : "no");
+
+			if (liveUpdate & SCCP_DEVICE_LIVEUPDATE_BUTTONS) {
+				sccp_handle_buttonstat_refresh(d->session, d, FALSE);
+			} else if (liveUpdate & SCCP_DEVICE_LIVEUPDATE_LINES) {
+				sccp_handle_buttonstat_refresh(d->session, d, TRUE);
+			}
+			if (liveUpdate & SCCP_DEVICE_LIVEUPDATE_SOFTKEYS) {
+				sccp_handle_soft_key_set_req(d->session, d, NULL);
+			}
+			if (liveUpdate & SCCP_DEVICE_LIVEUPDATE_MWI) {
+				sccp_device_setMWI(d);
+			}
+			res = TRUE;
+		} while (0);
+	}
+	return res;
+}
+
 /*!
  * \brief run after the new device config is loaded during the reload process
  * \note See \ref sccp_config_reload
@@ -468,6 +533,9 @@ void sccp_device_post_reload(void)
 	sccp_log((DEBUGCAT_CONFIG)) (VERBOSE_PREFIX_1 "SCCP: (post_reload)\n");
 
 	SCCP_RWLIST_TRAVERSE_SAFE_BEGIN(&GLOB(devices), d, list) {
+		if (d->pendingLiveUpdate && !sccp_device_apply_liveupdate(d)) {
+			sccp_log((DEBUGCAT_CONFIG + DEBUGCAT_DEVICE)) (VERBOSE_PREFIX_3 "Device %s will receive config changes after current call is completed\n", d->id);
+		}
 		if (!d->pendingDelete && !d->pendingUpdate) {
 			continue;
 		}
@@ -609,6 +677,33 @@ int sccp_device_setRegistrationState(constDevicePtr d, const skinny_registration
 	return changed;
 }
 
+/*!
+ * \brief Add sccp_device_liveupdate_t bits to the live updates pending on the device
+ * \note pendingLiveUpdate is written by the reload and by the session thread, under the privateData lock
+ */
+void sccp_device_addLiveUpdate(constDevicePtr d, const uint8_t liveUpdate)
+{
+	pbx_assert(d != NULL && d->privateData != NULL);
+	sccp_private_lock(d->privateData);
+	((sccp_device_t * const)d)->pendingLiveUpdate |= liveUpdate;						/* discard const */
+	sccp_private_unlock(d->privateData);
+}
+
+/*!
+ * \brief Take the live updates pending on the device
+ * \return the sccp_device_liveupdate_t bits that were pending
+ */
+uint8_t sccp_device_clearLiveUpdate(constDevicePtr d)
+{
+	uint8_t liveUpdate = SCCP_DEVICE_LIVEUPDATE_NONE;
+	pbx_assert(d != NULL && d->privateData != NULL);
+	sccp_private_lock(d->privateData);
+	liveUpdate = d->pendingLiveUpdate;
+	((sccp_device_t * const)d)->pendingLiveUpdate = SCCP_DEVICE_LIVEUPDATE_NONE;				/* discard const */
+	sccp_private_unlock(d->privateData);
+	return liveUpdate;
+}
+
 /* ======================================================================================================== end getters / setters for privateData */
 
 /*!
@@ -848,12 +943,15 @@ void sccp_device_preregistration(devicePtr device)
 			device->indicate = &sccp_device_indication_olderDevices;
 			break;
 	}
-#if HAVE_ICONV
 	if (!(device->device_features.phoneFeatures[1] & SKINNY_PHONE_FEATURES1_UTF8)) {
-		sccp_device_createiconv(device);
+		device->privateData->codepage = sccp_codepage_find(device->iconvcodepage);
+#if HAVE_ICONV
+		if (!device->privateData->codepage) {
+			sccp_device_createiconv(device);
+		}
+#endif
 		device->copyStr2Locale = sccp_device_copyStr2Locale_Convert;
 	}
-#endif
 }
 
 /*!
@@ -1959,6 +2057,224 @@ void sccp_dev_displayprinotify_debug(constDevicePtr d, const char *msg, const sc
 	sccp_log((DEBUGCAT_DEVICE)) (VERBOSE_PREFIX_3 "%s: Display notify with timeout %d and priority %d\n", d->id, timeout, priority);
 }
 
+/*
+ * Button Index
+ *
+ * Immutable per device lookup tables, built from the buttonconfig after the button template has assigned the instances:
+ * one array per button type indexed by instance, and an open addressing hash of line name to line instance. Lookups do
+ * not walk or lock d->buttonconfig. A rebuild publishes a complete new index with a single pointer swap and waits for the
+ * readers still holding the previous one, so once the swap (or sccp_dev_clear_buttonindex) returns no reader can reach a
+ * buttonconfig entry through an index anymore and the entries may be destroyed.
+ */
+typedef enum {
+	SCCP_BUTTONINDEX_SPEEDDIAL,
+	SCCP_BUTTONINDEX_HINTEDSPEEDDIAL,									/* hinted speeddials can share the line instance range */
+	SCCP_BUTTONINDEX_SERVICE,
+	SCCP_BUTTONINDEX_FEATURE,
+	SCCP_BUTTONINDEX_SENTINEL
+} sccp_buttonindex_type_t;
+
+struct sccp_buttonindex {
+	sccp_buttonconfig_t **buttons[SCCP_BUTTONINDEX_SENTINEL];						/*!< indexed by instance */
+	uint16_t size[SCCP_BUTTONINDEX_SENTINEL];
+	struct {
+		char *name;
+		uint8_t instance;
+	} *lines;												/*!< line name to line instance, open addressing */
+	uint16_t linesMask;
+	uint32_t refcount;											/*!< device (while published) + readers, protected by sccp_buttonindex_lock */
+};
+
+AST_MUTEX_DEFINE_STATIC(sccp_buttonindex_lock);								/*!< only held to swap d->buttonIndex or to take / drop a reference */
+
+static inline uint32_t sccp_buttonindex_hash(const char *name)
+{
+	uint32_t hash = 2166136261U;										/* FNV-1a, case insensitive (lines are matched with strcasecmp) */
+	for (; *name; name++) {
+		hash = (hash ^ (uint8_t)tolower((unsigned char)*name)) * 16777619U;
+	}
+	return hash;
+}
+
+static inline sccp_buttonindex_type_t sccp_buttonindex_type(const sccp_buttonconfig_t * config)
+{
+	switch (config->type) {
+		case SPEEDDIAL:
+			return sccp_strlen_zero(config->button.speeddial.hint) ? SCCP_BUTTONINDEX_SPEEDDIAL : SCCP_BUTTONINDEX_HINTEDSPEEDDIAL;
+		case SERVICE:
+			return SCCP_BUTTONINDEX_SERVICE;
+		case FEATURE:
+			return SCCP_BUTTONINDEX_FEATURE;
+		default:
+			return SCCP_BUTTONINDEX_SENTINEL;
+	}
+}
+
+static void sccp_buttonindex_free(sccp_buttonindex_t * idx)
+{
+	uint8_t type = 0;
+	uint16_t pos = 0;
+
+	if (!idx) {
+		return;
+	}
+	for (type = 0; type < SCCP_BUTTONINDEX_SENTINEL; type++) {
+		if (idx->buttons[type]) {
+			sccp_free(idx->buttons[type]);
+		}
+	}
+	if (idx->lines) {
+		for (pos = 0; pos <= idx->linesMask; pos++) {
+			if (idx->lines[pos].name) {
+				sccp_free(idx->lines[pos].name);
+			}
+		}
+		sccp_free(idx->lines);
+	}
+	sccp_free(idx);
+}
+
+/*!
+ * \brief Take a reference on the published button index of a device
+ * \note release with sccp_buttonindex_release, the index and the buttonconfig entries it points to stay valid in between
+ */
+sccp_buttonindex_t *sccp_buttonindex_retain(constDevicePtr d)
+{
+	sccp_buttonindex_t *idx = NULL;
+
+	pbx_mutex_lock(&sccp_buttonindex_lock);
+	if ((idx = d->buttonIndex)) {
+		idx->refcount++;
+	}
+	pbx_mutex_unlock(&sccp_buttonindex_lock);
+	return idx;
+}
+
+void sccp_buttonindex_release(sccp_buttonindex_t * idx)
+{
+	uint32_t refcount = 0;
+
+	if (!idx) {
+		return;
+	}
+	pbx_mutex_lock(&sccp_buttonindex_lock);
+	refcount = --idx->refcount;
+	pbx_mutex_unlock(&sccp_buttonindex_lock);
+	if (!refcount) {
+		sccp_buttonindex_free(idx);
+	}
+}
+
+/*!
+ * \brief Replace the published button index of a device, wait for the readers of the old one and free it
+ * \note must not be called while holding a reference on the index of this device
+ */
+static void sccp_buttonindex_publish(devicePtr d, sccp_buttonindex_t * idx)
+{
+	sccp_buttonindex_t *old = NULL;
+
+	pbx_mutex_lock(&sccp_buttonindex_lock);
+	old = d->buttonIndex;
+	d->buttonIndex = idx;
+	while (old && old->refcount > 1) {									/* readers may still use the buttonconfig entries it points to */
+		pbx_mutex_unlock(&sccp_buttonindex_lock);
+		usleep(1000);
+		pbx_mutex_lock(&sccp_buttonindex_lock);
+	}
+	pbx_mutex_unlock(&sccp_buttonindex_lock);
+	sccp_buttonindex_release(old);										/* drops the device reference, the last one */
+}
+
+static inline sccp_buttonconfig_t *sccp_buttonindex_get(const sccp_buttonindex_t * idx, sccp_buttonindex_type_t type, uint16_t instance)
+{
+	if (idx && instance < idx->size[type]) {
+		return idx->buttons[type][instance];
+	}
+	return NULL;
+}
+
+/*!
+ * \brief Build the button index for a device and publish it
+ * \param d SCCP Device
+ *
+ * \note called after the button template and the lineButtons array have been created
+ */
+void sccp_dev_build_buttonindex(devicePtr d)
+{
+	sccp_buttonindex_t *idx = NULL;
+	sccp_buttonconfig_t *config = NULL;
+	sccp_buttonindex_type_t type = SCCP_BUTTONINDEX_SENTINEL;
+	uint16_t slots = 4;
+	uint8_t instance = 0;
+
+	if (!d || !(idx = (sccp_buttonindex_t *)sccp_calloc(1, sizeof(sccp_buttonindex_t)))) {
+		return;
+	}
+	idx->refcount = 1;											/* the device reference */
+
+	SCCP_LIST_LOCK(&d->buttonconfig);
+	SCCP_LIST_TRAVERSE(&d->buttonconfig, config, list) {
+		if (config->instance && (type = sccp_buttonindex_type(config)) != SCCP_BUTTONINDEX_SENTINEL && config->instance >= idx->size[type]) {
+			idx->size[type] = config->instance + 1;
+		}
+	}
+	for (type = 0; type < SCCP_BUTTONINDEX_SENTINEL; type++) {
+		if (idx->size[type] && !(idx->buttons[type] = (sccp_buttonconfig_t **)sccp_calloc(idx->size[type], sizeof(sccp_buttonconfig_t *)))) {
+			SCCP_LIST_UNLOCK(&d->buttonconfig);
+			pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, d->id);
+			sccp_buttonindex_free(idx);
+			return;
+		}
+	}
+	SCCP_LIST_TRAVERSE(&d->buttonconfig, config, list) {
+		if (config->instance && (type = sccp_buttonindex_type(config)) != SCCP_BUTTONINDEX_SENTINEL && !idx->buttons[type][config->instance]) {
+			idx->buttons[type][config->instance] = config;						/* first match wins, like the list traversal did */
+		}
+	}
+	SCCP_LIST_UNLOCK(&d->buttonconfig);
+
+	while (slots < d->lineButtons.size * 2) {
+		slots <<= 1;
+	}
+	if (!(idx->lines = sccp_calloc(slots, sizeof(*idx->lines)))) {
+		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, d->id);
+		sccp_buttonindex_free(idx);
+		return;
+	}
+	idx->linesMask = slots - 1;
+	for (instance = SCCP_FIRST_LINEINSTANCE; instance < d->lineButtons.size; instance++) {
+		if (d->lineButtons.instance[instance] && d->lineButtons.instance[instance]->line) {
+			const char *name = d->lineButtons.instance[instance]->line->name;
+			uint16_t pos = sccp_buttonindex_hash(name) & idx->linesMask;
+			while (idx->lines[pos].name && strcasecmp(idx->lines[pos].name, name)) {
+				pos = (pos + 1) & idx->linesMask;
+			}
+			if (!idx->lines[pos].name) {								/* first instance wins, like the array traversal did */
+				idx->lines[pos].name = pbx_strdup(name);
+				idx->lines[pos].instance = instance;
+			}
+		}
+	}
+
+	sccp_buttonindex_publish(d, idx);
+	sccp_log((DEBUGCAT_DEVICE + DEBUGCAT_BUTTONTEMPLATE)) (VERBOSE_PREFIX_3 "%s: Built button index (speeddials:%d/%d, services:%d, features:%d, lines:%d)\n", d->id,
+		idx->size[SCCP_BUTTONINDEX_SPEEDDIAL], idx->size[SCCP_BUTTONINDEX_HINTEDSPEEDDIAL], idx->size[SCCP_BUTTONINDEX_SERVICE], idx->size[SCCP_BUTTONINDEX_FEATURE], d->lineButtons.size);
+}
+
+/*!
+ * \brief Remove the button index from a device
+ * \param d SCCP Device
+ *
+ * \note called before the buttonconfig entries it points to are destroyed, returns once no reader uses the index anymore
+ */
+void sccp_dev_clear_buttonindex(devicePtr d)
+{
+	if (!d) {
+		return;
+	}
+	sccp_buttonindex_publish(d, NULL);
+}
+
 /*!
  * \brief Find SpeedDial by Index
  * \param d SCCP Device
@@ -1970,6 +2286,7 @@ void sccp_dev_displayprinotify_debug(constDevicePtr d, const char *msg, const sc
  */
 void sccp_dev_speed_find_byindex(constDevicePtr d, const uint16_t instance, boolean_t withHint, sccp_speed_t * const k)
 {
+	sccp_buttonindex_t *idx = NULL;
 	sccp_buttonconfig_t *config  = NULL;
 
 	if (!d || !d->session || instance == 0) {
@@ -1978,28 +2295,18 @@ void sccp_dev_speed_find_byindex(constDevicePtr d, const uint16_t instance, bool
 	memset(k, 0, sizeof(sccp_speed_t));
 	sccp_copy_string(k->name, "unknown speeddial", sizeof(k->name));
 
-	SCCP_LIST_LOCK(&(((devicePtr)d)->buttonconfig));
-	SCCP_LIST_TRAVERSE(&d->buttonconfig, config, list) {
-		if (config->type == SPEEDDIAL && config->instance == instance) {
-			/* we are searching for hinted speeddials */
-			if (TRUE == withHint && !sccp_strlen_zero(config->button.speeddial.hint)) {
-				k->valid = TRUE;
-				k->instance = instance;
-				k->type = SCCP_BUTTONTYPE_SPEEDDIAL;
-				sccp_copy_string(k->name, config->label, sizeof(k->name));
-				sccp_copy_string(k->ext, config->button.speeddial.ext, sizeof(k->ext));
-				sccp_copy_string(k->hint, config->button.speeddial.hint, sizeof(k->hint));
-				
-			} else if(FALSE == withHint && sccp_strlen_zero(config->button.speeddial.hint)) {
-				k->valid = TRUE;
-				k->instance = instance;
-				k->type = SCCP_BUTTONTYPE_SPEEDDIAL;
-				sccp_copy_string(k->name, config->label, sizeof(k->name));
-				sccp_copy_string(k->ext, config->button.speeddial.ext, sizeof(k->ext));
-			}
+	idx = sccp_buttonindex_retain(d);
+	if ((config = sccp_buttonindex_get(idx, withHint ? SCCP_BUTTONINDEX_HINTEDSPEEDDIAL : SCCP_BUTTONINDEX_SPEEDDIAL, instance))) {
+		k->valid = TRUE;										/* copied while the index reference keeps config alive */
+		k->instance = instance;
+		k->type = SCCP_BUTTONTYPE_SPEEDDIAL;
+		sccp_copy_string(k->name, config->label, sizeof(k->name));
+		sccp_copy_string(k->ext, config->button.speeddial.ext, sizeof(k->ext));
+		if (withHint) {
+			sccp_copy_string(k->hint, config->button.speeddial.hint, sizeof(k->hint));
 		}
 	}
-	SCCP_LIST_UNLOCK(&(((devicePtr)d)->buttonconfig));
+	sccp_buttonindex_release(idx);
 }
 
 /*!
@@ -2344,6 +2651,12 @@ static void sccp_buttonconfig_destroy(sccp_buttonconfig_t *buttonconfig)
 	if (buttonconfig->label) {
 		sccp_free(buttonconfig->label);
 	}
+	while (buttonconfig->retired) {
+		struct sccp_buttonconfig_retired *retired = buttonconfig->retired;
+		buttonconfig->retired = retired->next;
+		sccp_free(retired->value);
+		sccp_free(retired);
+	}
 	switch(buttonconfig->type) {
 		case LINE:
 			if (buttonconfig->button.line.name) {
@@ -2430,6 +2743,9 @@ void _sccp_dev_clean(devicePtr device, boolean_t remove_from_global, boolean_t r
 		if (d->currentLine) {
 			sccp_dev_setActiveLine(d, NULL);
 		}
+		/* drop the button index before buttonconfig entries get destroyed */
+		sccp_dev_clear_buttonindex(d);
+
 		/* hang up open channels and remove device from line */
 		SCCP_LIST_LOCK(&d->buttonconfig);
 		SCCP_LIST_TRAVERSE(&d->buttonconfig, config, list) {
@@ -2579,6 +2895,7 @@ int __sccp_device_destroy(const void *ptr)
 	// clean button config (only generated on read config, so do not remove during device clean)
 	{
 		sccp_buttonconfig_t *config = NULL;
+		sccp_dev_clear_buttonindex(d);
 		SCCP_LIST_LOCK(&d->buttonconfig);
 		while ((config = SCCP_LIST_REMOVE_HEAD(&d->buttonconfig, list))) {
 			sccp_buttonconfig_destroy(config);
@@ -2691,29 +3008,43 @@ boolean_t sccp_device_isVideoSupported(constDevicePtr device)
  * \brief Find ServiceURL by index
  * \param device SCCP Device
  * \param instance Instance as uint8_t
- * \return SCCP Service
+ * \param service SCCP Service (Returned by Ref)
+ * \return TRUE when found
  *
  */
-sccp_buttonconfig_t *sccp_dev_serviceURL_find_byindex(devicePtr device, uint16_t instance)
+boolean_t sccp_dev_serviceURL_find_byindex(devicePtr device, uint16_t instance, sccp_service_t * const service)
 {
+	sccp_buttonindex_t *idx = NULL;
 	sccp_buttonconfig_t *config = NULL;
+	boolean_t found = FALSE;
 
 	if (!device || !device->session) {
-		return NULL;
+		return FALSE;
 	}
+	memset(service, 0, sizeof(sccp_service_t));
 	sccp_log((DEBUGCAT_DEVICE + DEBUGCAT_BUTTONTEMPLATE)) (VERBOSE_PREFIX_3 "%s: searching for service with instance %d\n", device->id, instance);
-	SCCP_LIST_LOCK(&device->buttonconfig);
-	SCCP_LIST_TRAVERSE(&device->buttonconfig, config, list) {
-		sccp_log_and((DEBUGCAT_DEVICE + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_3 "%s: instance: %d buttontype: %d\n", device->id, config->instance, config->type);
-
-		if (config->type == SERVICE && config->instance == instance) {
-			sccp_log((DEBUGCAT_DEVICE + DEBUGCAT_BUTTONTEMPLATE)) (VERBOSE_PREFIX_3 "%s: found service: %s\n", device->id, config->label);
-			break;
-		}
+	idx = sccp_buttonindex_retain(device);
+	if ((config = sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_SERVICE, instance))) {
+		sccp_copy_string(service->label, config->label, sizeof(service->label));			/* copied while the index reference keeps config alive */
+		sccp_copy_string(service->url, config->button.service.url, sizeof(service->url));
+		found = TRUE;
+	}
+	sccp_buttonindex_release(idx);
+	if (found) {
+		sccp_log((DEBUGCAT_DEVICE + DEBUGCAT_BUTTONTEMPLATE)) (VERBOSE_PREFIX_3 "%s: found service: %s\n", device->id, service->label);
 	}
-	SCCP_LIST_UNLOCK(&device->buttonconfig);
+	return found;
+}
 
-	return config;
+/*!
+ * \brief Find Feature Button by index
+ * \param idx Button Index, retained by the caller with sccp_buttonindex_retain
+ * \param instance Instance as uint16_t
+ * \return SCCP Feature Button Config, only valid until idx is released
+ */
+sccp_buttonconfig_t *sccp_dev_feature_find_byindex(const sccp_buttonindex_t * idx, uint16_t instance)
+{
+	return sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_FEATURE, instance);
 }
 
 /*!
@@ -3263,9 +3594,24 @@ static sccp_push_result_t sccp_device_pushTextMessage(constDevicePtr device, con
  * \warning
  *   - device->buttonconfig is not always locked
  */
-uint8_t __PURE__ sccp_device_find_index_for_line(constDevicePtr d, const char *lineName)
+uint8_t sccp_device_find_index_for_line(constDevicePtr d, const char *lineName)
 {
-	for(uint8_t instance = SCCP_FIRST_LINEINSTANCE; instance < d->lineButtons.size; instance++) {
+	sccp_buttonindex_t *idx = sccp_buttonindex_retain(d);
+
+	if (idx && idx->lines && lineName) {
+		uint8_t instance = 0;
+		uint16_t pos = sccp_buttonindex_hash(lineName) & idx->linesMask;
+		for (; idx->lines[pos].name; pos = (pos + 1) & idx->linesMask) {
+			if (!strcasecmp(idx->lines[pos].name, lineName)) {
+				instance = idx->lines[pos].instance;
+				break;
+			}
+		}
+		sccp_buttonindex_release(idx);
+		return instance;
+	}
+	sccp_buttonindex_release(idx);
+	for (uint8_t instance = SCCP_FIRST_LINEINSTANCE; instance < d->lineButtons.size; instance++) {		/* no index (yet) */
 		if (d->lineButtons.instance[instance] && d->lineButtons.instance[instance]->line && !strcasecmp(d->lineButtons.instance[instance]->line->name, lineName)) {
 			return instance;
 		}
@@ -3434,4 +3780,169 @@ void sccp_device_indicateMWI(devicePtr device)
 		}
 	}
 }
+#if CS_TEST_FRAMEWORK
+#include <asterisk/test.h>
+
+/*!
+ * \brief append an already instanced button to the buttonconfig of a test device, the way the button template leaves it
+ */
+static sccp_buttonconfig_t * sccp_buttonindex_testAddButton(devicePtr d, sccp_config_buttontype_t type, uint8_t instance, const char * label, const char * value, const char * hint)
+{
+	sccp_buttonconfig_t * config = (sccp_buttonconfig_t *)sccp_calloc(sizeof *config, 1);
+
+	if (!config) {
+		return NULL;
+	}
+	config->type = type;
+	config->instance = instance;
+	config->index = SCCP_LIST_GETSIZE(&d->buttonconfig);
+	config->label = pbx_strdup(label);
+	switch (type) {
+		case SPEEDDIAL:
+			config->button.speeddial.ext = pbx_strdup(value);
+			config->button.speeddial.hint = hint ? pbx_strdup(hint) : NULL;
+			break;
+		case SERVICE:
+			config->button.service.url = pbx_strdup(value);
+			break;
+		case FEATURE:
+			config->button.feature.id = SCCP_FEATURE_DND;
+			config->button.feature.options = pbx_strdup(value);
+			break;
+		default:
+			break;
+	}
+	SCCP_LIST_LOCK(&d->buttonconfig);
+	SCCP_LIST_INSERT_TAIL(&d->buttonconfig, config, list);
+	SCCP_LIST_UNLOCK(&d->buttonconfig);
+	return config;
+}
+
+static void *sccp_buttonindex_testClear(void *data)
+{
+	sccp_device_t *d = (sccp_device_t *)data;
+
+	sccp_dev_clear_buttonindex(d);
+	return NULL;
+}
+
+AST_TEST_DEFINE(sccp_device_buttonindex)
+{
+	enum ast_test_result_state res = AST_TEST_PASS;
+	sccp_buttonconfig_t *plain = NULL, *plainDuplicate = NULL, *hinted = NULL, *plain3 = NULL, *service = NULL, *feature = NULL;
+	sccp_linedevice_t ld[3];
+	sccp_linedevice_t *lineButtons[4] = { NULL, &ld[0], &ld[1], &ld[2] };
+	sccp_line_t *lineA = NULL;
+	sccp_line_t *lineB = NULL;
+	sccp_buttonindex_t *idx = NULL;
+	pthread_t clearThread = AST_PTHREADT_NULL;
+
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "buttonindex";
+			info->category = "/channels/chan_sccp/device/";
+			info->summary = "chan-sccp-b device button index";
+			info->description = "chan-sccp-b button index build, speeddial/service/feature and line name lookups, reader references on clear";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+
+	AUTO_RELEASE(sccp_device_t, d, sccp_device_create("SEPBUTTONINDEX"));
+	pbx_test_validate_cleanup(test, d != NULL, res, cleanup);
+
+	plain = sccp_buttonindex_testAddButton(d, SPEEDDIAL, 1, "plain", "1001", NULL);
+	hinted = sccp_buttonindex_testAddButton(d, SPEEDDIAL, 1, "hinted", "2001", "2001@hints");
+	plainDuplicate = sccp_buttonindex_testAddButton(d, SPEEDDIAL, 1, "duplicate", "1002", NULL);
+	plain3 = sccp_buttonindex_testAddButton(d, SPEEDDIAL, 3, "plain3", "1003", NULL);
+	service = sccp_buttonindex_testAddButton(d, SERVICE, 2, "service", "http://localhost/service", NULL);
+	feature = sccp_buttonindex_testAddButton(d, FEATURE, 4, "dnd", "busy", NULL);
+	pbx_test_validate_cleanup(test, sccp_buttonindex_testAddButton(d, SPEEDDIAL, 0, "unassigned", "1004", NULL) != NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, plain && hinted && plainDuplicate && plain3 && service && feature, res, cleanup);
+
+	lineA = sccp_line_alloc("TestLineA");
+	lineB = sccp_line_alloc("testlineb");
+	pbx_test_validate_cleanup(test, lineA && lineB, res, cleanup);
+	memset(ld, 0, sizeof(ld));
+	ld[0].line = lineA;
+	ld[1].line = lineB;
+	ld[2].line = lineA;										/* same line on a second instance */
+	d->lineButtons.instance = lineButtons;
+	d->lineButtons.size = sizeof(lineButtons) / sizeof(lineButtons[0]);
+
+	pbx_test_status_update(test, "Build the index\n");
+	sccp_dev_build_buttonindex(d);
+	idx = sccp_buttonindex_retain(d);
+	pbx_test_validate_cleanup(test, idx != NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, idx->refcount == 2, res, cleanup);
+
+	pbx_test_status_update(test, "Plain and hinted speeddials sharing an instance\n");
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_SPEEDDIAL, 1) == plain, res, cleanup);		/* first match wins */
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_HINTEDSPEEDDIAL, 1) == hinted, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_SPEEDDIAL, 2) == NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_SPEEDDIAL, 3) == plain3, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_HINTEDSPEEDDIAL, 3) == NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_SPEEDDIAL, 0) == NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_SPEEDDIAL, 200) == NULL, res, cleanup);
+
+	pbx_test_status_update(test, "Service and feature buttons\n");
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_SERVICE, 2) == service, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_SERVICE, 1) == NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_dev_feature_find_byindex(idx, 4) == feature, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_dev_feature_find_byindex(idx, 2) == NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_dev_feature_find_byindex(NULL, 4) == NULL, res, cleanup);
+
+	pbx_test_status_update(test, "Case insensitive line names\n");
+	pbx_test_validate_cleanup(test, sccp_device_find_index_for_line(d, "TestLineA") == 1, res, cleanup);			/* first instance wins */
+	pbx_test_validate_cleanup(test, sccp_device_find_index_for_line(d, "TESTLINEA") == 1, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_device_find_index_for_line(d, "TestLineB") == 2, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_device_find_index_for_line(d, "TestLineC") == 0, res, cleanup);
+
+	pbx_test_status_update(test, "Clearing waits for the readers\n");
+	pbx_test_validate_cleanup(test, pbx_pthread_create(&clearThread, NULL, sccp_buttonindex_testClear, d) == 0, res, cleanup);
+	usleep(50000);
+	pbx_mutex_lock(&sccp_buttonindex_lock);
+	boolean_t unpublished = d->buttonIndex == NULL;
+	uint32_t refcount = idx->refcount;
+	pbx_mutex_unlock(&sccp_buttonindex_lock);
+	pbx_test_validate_cleanup(test, unpublished && refcount == 2, res, cleanup);						/* the clearing thread is still waiting for us */
+	pbx_test_validate_cleanup(test, sccp_buttonindex_get(idx, SCCP_BUTTONINDEX_HINTEDSPEEDDIAL, 1) == hinted, res, cleanup);
+	sccp_buttonindex_release(idx);
+	idx = NULL;
+	pthread_join(clearThread, NULL);
+	clearThread = AST_PTHREADT_NULL;
+	pbx_test_validate_cleanup(test, sccp_buttonindex_retain(d) == NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_device_find_index_for_line(d, "testlinea") == 1, res, cleanup);			/* without an index */
+
+cleanup:
+	if (idx) {
+		sccp_buttonindex_release(idx);
+	}
+	if (clearThread != AST_PTHREADT_NULL) {
+		pthread_join(clearThread, NULL);
+	}
+	if (d) {
+		d->lineButtons.instance = NULL;
+		d->lineButtons.size = 0;
+	}
+	if (lineA) {
+		sccp_line_release(&lineA);								/* explicit release */
+	}
+	if (lineB) {
+		sccp_line_release(&lineB);								/* explicit release */
+	}
+	return res;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_device_buttonindex);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_device_buttonindex);
+}
+#endif
+
 // kate: indent-width 4; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets on;
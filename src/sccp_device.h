@@ -69,6 +69,10 @@ struct sccp_buttonconfig {
 		} feature;											/*!< SCCP Button Feature Structure */
 	} button;												/*!< SCCP Button Structure */
 
+	struct sccp_buttonconfig_retired {
+		struct sccp_buttonconfig_retired *next;
+		char *value;
+	} *retired;												/*!< label/ext/url replaced by a live reload, freed with the buttonconfig (readers do not hold the buttonconfig lock) */
 	boolean_t pendingDelete;
 	boolean_t pendingUpdate;
 };														/*!< SCCP Button Configuration Structure */
@@ -89,6 +93,14 @@ struct sccp_speed {
 	SCCP_LIST_ENTRY (sccp_speed_t) list;									/*!< SpeedDial Linked List Entry */
 };
 
+/*!
+ * \brief SCCP Service URL Button Structure
+ */
+struct sccp_service {
+	char label[StationMaxNameSize];										/*!< The label of the service button */
+	char url[StationMaxServiceURLSize];									/*!< The URL of the service */
+};
+
 /*!
  * \brief Privacy Feature Enum
  */
@@ -159,6 +171,7 @@ struct sccp_device {
 		sccp_linedevice_t ** instance;
 		uint8_t size;
 	} lineButtons;
+	sccp_buttonindex_t *buttonIndex;									/*!< Immutable per instance button lookup tables, replaced when the button template is (re)built, refcounted (sccp_device.c) */
 	//SCCP_LIST_HEAD (, sccp_buttonconfig_t) buttonconfig;							/*!< SCCP Button Config Attached to this Device */
 	sccp_buttonconfig_list_t buttonconfig;									/*!< SCCP Button Config Attached to this Device */
 	SCCP_LIST_HEAD (, sccp_selectedchannel_t) selectedChannels;						/*!< Selected Channel List */
@@ -318,6 +331,7 @@ struct sccp_device {
 
 	boolean_t pendingDelete;										/*!< this bit will tell the scheduler to delete this line when unused */
 	boolean_t pendingUpdate;										/*!< this will contain the updated line struct once reloaded from config to update the line when unused */
+	uint8_t pendingLiveUpdate;										/*!< sccp_device_liveupdate_t bitmask of config changes to push to the registered device without a restart, changed via sccp_device_addLiveUpdate/clearLiveUpdate */
 };
 
 /*!
@@ -364,6 +378,8 @@ SCCP_API const SCCP_CALL sccp_devicestate_t sccp_device_getDeviceState(constDevi
 SCCP_API int SCCP_CALL sccp_device_setDeviceState(constDevicePtr d, const sccp_devicestate_t state);
 SCCP_API const SCCP_CALL skinny_registrationstate_t sccp_device_getRegistrationState(constDevicePtr d);
 SCCP_API int SCCP_CALL sccp_device_setRegistrationState(constDevicePtr d, const skinny_registrationstate_t state);
+SCCP_API void SCCP_CALL sccp_device_addLiveUpdate(constDevicePtr d, const uint8_t liveUpdate);
+SCCP_API uint8_t SCCP_CALL sccp_device_clearLiveUpdate(constDevicePtr d);
 /* ======================================================================================================== end getters / setters for privateData */
 
 SCCP_API devicePtr SCCP_CALL sccp_device_create(const char * id);
@@ -379,7 +395,12 @@ SCCP_API channelPtr SCCP_CALL sccp_device_getActiveChannel(constDevicePtr device
 #define sccp_device_setActiveChannel(_d,_c) __sccp_device_setActiveChannel(_d, _c, __FILE__, __LINE__, __PRETTY_FUNCTION__)
 SCCP_API void SCCP_CALL __sccp_device_setActiveChannel(constDevicePtr d, constChannelPtr channel, const char *file, uint32_t line, const char *func);
 
-SCCP_API sccp_buttonconfig_t * SCCP_CALL sccp_dev_serviceURL_find_byindex(devicePtr device, uint16_t instance);
+SCCP_API boolean_t SCCP_CALL sccp_dev_serviceURL_find_byindex(devicePtr device, uint16_t instance, sccp_service_t * const service);
+SCCP_API sccp_buttonconfig_t * SCCP_CALL sccp_dev_feature_find_byindex(const sccp_buttonindex_t * idx, uint16_t instance);
+SCCP_API void SCCP_CALL sccp_dev_build_buttonindex(devicePtr d);
+SCCP_API void SCCP_CALL sccp_dev_clear_buttonindex(devicePtr d);
+SCCP_API sccp_buttonindex_t * SCCP_CALL sccp_buttonindex_retain(constDevicePtr d);
+SCCP_API void SCCP_CALL sccp_buttonindex_release(sccp_buttonindex_t * idx);
 SCCP_API void SCCP_CALL sccp_dev_check_displayprompt(constDevicePtr d);
 SCCP_API void SCCP_CALL sccp_device_setLastNumberDialed(devicePtr device, const char * lastNumberDialed, const sccp_linedevice_t * ld);
 SCCP_API void SCCP_CALL sccp_device_preregistration(devicePtr device);
@@ -421,6 +442,7 @@ SCCP_API uint8_t SCCP_CALL sccp_device_find_index_for_line(constDevicePtr d, con
 SCCP_API uint8_t SCCP_CALL sccp_device_numberOfChannels(constDevicePtr device);
 SCCP_API boolean_t SCCP_CALL sccp_device_isVideoSupported(constDevicePtr device);
 SCCP_API boolean_t SCCP_CALL sccp_device_check_update(devicePtr device);
+SCCP_API boolean_t SCCP_CALL sccp_device_apply_liveupdate(devicePtr device);
 SCCP_INLINE SCCP_CALL int16_t sccp_device_buttonIndex2lineInstance(constDevicePtr d, uint16_t buttonIndex);
 
 // find device
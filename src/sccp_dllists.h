@@ -281,6 +281,8 @@
 		if (!(head)->first) {                                                                                                                                                                                           \
 			(head)->first = (elm);                                                                                                                                                                                  \
 			(head)->last  = (elm);                                                                                                                                                                                  \
+		} else if (sccp_strversioncmp((head)->last->sortfield, (elm)->sortfield) <= 0) {                                                                                                                                \
+			SCCP_LIST_INSERT_TAIL(head, elm, field); /* fast path for sorted input */                                                                                                                               \
 		} else {                                                                                                                                                                                                        \
 			typeof((head)->first) cur = (head)->first, prev = NULL;                                                                                                                                                 \
 			while (cur && sccp_strversioncmp((cur)->sortfield, (elm)->sortfield) < 0) {                                                                                                                             \
@@ -39,6 +39,7 @@ struct subscriptionId {
 struct sccp_global_vars {
 	int keepalive;												/*!< KeepAlive */
 	int32_t debug;												/*!< Debug */
+	int32_t trace;												/*!< Debug categories recorded into the binary trace ring */
 	int module_running;
 	pbx_rwlock_t lock;											/*!< Asterisk: Lock Me Up and Tie me Down */
 
@@ -67,7 +68,15 @@ struct sccp_global_vars {
 	struct sccp_ha *ha;											/*!< Permit or deny connections to the main socket */
 	struct sockaddr_storage bindaddr;									/*!< Bind IP Address */
 	struct sockaddr_storage secbindaddr;                                                                    /*!< Bind IP Address */
+	uint8_t accept_threads;											/*!< Number of Listening Sockets / Accept Threads per Server Context */
+	uint32_t listen_backlog;										/*!< Listen Backlog (Accept Queue Depth) */
+	uint16_t sendqueue_highwater;										/*!< Max Queued Outbound Messages per Session, the session is reset at twice this number */
+	uint16_t sendqueue_stalltimeout;									/*!< Seconds a Device may stop reading before its Session is reset */
 	char * cert_file;
+	uint32_t tls_session_cache;										/*!< TLS Session Cache Size (entries) */
+	uint32_t tls_session_timeout;										/*!< TLS Session / Ticket Lifetime (seconds) */
+	boolean_t tls_session_tickets;										/*!< Issue Stateless TLS Session Tickets */
+	uint32_t tls_ticket_rotation;										/*!< TLS Ticket Key Rotation Interval (seconds) */
 	struct sccp_ha *localaddr;										/*!< Localnet for Network Address Translation */
 
 	struct sockaddr_storage externip;									/*!< External IP Address (\todo should change to an array of external ip's, because externhost could resolv to multiple ip-addresses (h_addr_list)) */
@@ -112,6 +121,7 @@ struct sccp_global_vars {
 	boolean_t cfwdbusy;                                                                                     /*!< Call Forward on Busy Support (Boolean, default=on) */
 	boolean_t cfwdnoanswer;                                                                                 /*!< Call Forward on No-Answer Support (Boolean, default=on) */
 	uint16_t cfwdnoanswer_timeout;                                                                          /*!< Call Forward on No-Answer timeout */
+	uint16_t hint_debounce;											/*!< Hint Notification Coalescing Window (ms) */
 	char *meetmeopts;											/*!< Meetme Options to be Used */
 #if HAVE_ICONV
 	char *iconvcodepage;											/*!< Iconv Codepage to use during conversion from UTF-8, for old phone models */
@@ -165,8 +175,12 @@ struct sccp_global_vars {
 	int token_backoff_time;											/*!< Backoff time on TokenReject */
 	int server_priority;											/*!< Server Priority to fallback to */
 
+	boolean_t message_stats;										/*!< Collect per message-id counters and latency histograms */
+	boolean_t parallel_load;										/*!< Build devices and lines using a threadpool at module load */
+	boolean_t conf_worker_pool;										/*!< Impart conference participants and use a shared worker pool for their post-leave work */
 	boolean_t reload_in_progress;										/*!< Reload in Progress */
 	boolean_t pendingUpdate;
+	boolean_t pendingLiveUpdate;										/*!< Global param changed that can be pushed to registered devices without restart */
 };														/*!< SCCP Global Varable Structure */
 
 /*!
@@ -33,6 +33,7 @@ SCCP_FILE_VERSION(__FILE__, "");
 #include "sccp_indicate.h"											// only for SCCP_CHANNELSTATE_Idling
 #include "sccp_line.h"
 #include "sccp_linedevice.h"
+#include "sccp_session.h"
 #include "sccp_utils.h"
 #include "sccp_labels.h"
 
@@ -46,7 +47,13 @@ SCCP_FILE_VERSION(__FILE__, "");
  */
 typedef struct sccp_hint_SubscribingDevice sccp_hint_SubscribingDevice_t;
 typedef struct sccp_hint_list sccp_hint_list_t;
-#ifdef CS_USE_ASTERISK_DISTRIBUTED_DEVSTATE
+
+/*
+ * Callerid of remote hints, taken from distributed device state events (published by sccp_hint_notifySubscribersViaPbx). Only the
+ * ast_event based device state events carry the callerid, stasis device state messages (ast-12 and up) do not.
+ */
+#if defined(CS_USE_ASTERISK_DISTRIBUTED_DEVSTATE) && defined(CS_AST_HAS_EVENT) && ASTERISK_VERSION_GROUP >= 108 && ASTERISK_VERSION_GROUP < 112
+#  define SCCP_HINT_DISTRIBUTED_CID 1
 static char default_eid_str[32];
 #endif
 
@@ -104,8 +111,20 @@ struct sccp_hint_list {
 	skinny_calltype_t calltype;										/*!< Skinny Call Type */
 
 	int stateid;												/*!< subscription id in asterisk */
-#ifdef CS_USE_ASTERISK_DISTRIBUTED_DEVSTATE
-	PBX_EVENT_SUBSCRIPTION * device_state_sub; /*!< asterisk distributed device state subscription */
+	uint32_t initialNotifications;										/*!< initial state pushes, one per new subscriber */
+	uint32_t fanouts;											/*!< state changes notified to all subscribers */
+	uint32_t fanoutNotifications;										/*!< subscriber updates sent because of those fanouts */
+	uint32_t unchangedStateEvents;										/*!< pbx state events without a state or callerid change (not notified) */
+	char lastCidName[StationMaxNameSize];									/*!< callerid name seen by the last pbx state event */
+	char lastCidNumber[StationMaxDirnumSize];								/*!< callerid number seen by the last pbx state event */
+	sccp_callerid_presentation_t lastPresentation;								/*!< callerid presentation seen by the last pbx state event */
+	uint32_t coalescedNotifications;									/*!< state changes superseded within the debounce window (not notified) */
+	int debounceId;												/*!< scheduled (coalesced) notification, -1 when none */
+	uint32_t debounceRefs;											/*!< references: hint list (1) + scheduled notifications (callback releases), protected by sccp_hint_debounceLock */
+	sccp_channelstate_t notifiedState;									/*!< last state fanned out to the subscribers */
+	sccp_hint_list_t * extenNext;										/*!< next hint in the exten@context hash bucket */
+#ifdef SCCP_HINT_DISTRIBUTED_CID
+	sccp_hint_list_t * deviceNext;										/*!< next hint in the device (hint_dialplan) hash bucket */
 #endif
 
 	SCCP_LIST_HEAD (, sccp_hint_SubscribingDevice_t) subscribers;						/*!< Hint Type Subscribers Linked List Entry */
@@ -119,7 +138,12 @@ static void sccp_hint_updateLineStateForMultipleChannels(struct sccp_hint_lineSt
 static void sccp_hint_updateLineStateForSingleChannel(struct sccp_hint_lineState * lineState, sccp_channelstate_t state);
 static void              sccp_hint_checkForDND(struct sccp_hint_lineState * lineState, sccp_line_t * line);
 static sccp_hint_list_t *sccp_hint_create(char *hint_exten, char *hint_context);
+static void sccp_hint_subscribe(sccp_hint_list_t * hint);
 static void sccp_hint_notifySubscribers(sccp_hint_list_t * hint);			/* old */
+static void sccp_hint_scheduleNotifySubscribers(sccp_hint_list_t * hint);
+static void sccp_hint_destroy(sccp_hint_list_t * hint);
+static void sccp_hint_unref(sccp_hint_list_t * hint);
+static void sccp_hint_notifySubscriber(sccp_hint_list_t * hint, sccp_hint_SubscribingDevice_t * subscriber);
 static void sccp_hint_notifyLineStateUpdate(struct sccp_hint_lineState *linestate); 	/* new */
 static void sccp_hint_deviceRegistered(const sccp_device_t * device);
 static void sccp_hint_deviceUnRegistered(const char *deviceName);
@@ -132,66 +156,115 @@ static void sccp_hint_eventListener(const sccp_event_t * event);
 static gcc_inline boolean_t sccp_hint_isCIDavailabe(const sccp_device_t * device, const uint8_t positionOnDevice);
 #endif
 
-#ifdef CS_USE_ASTERISK_DISTRIBUTED_DEVSTATE
-#if ASTERISK_VERSION_GROUP >= 112
-static void sccp_hint_distributed_devstate_cb(void *data, struct stasis_subscription *sub, struct stasis_message *msg)
-#else
-static void sccp_hint_distributed_devstate_cb(const pbx_event_t * event, void *data)
+/* ========================================================================================================================= List Declarations */
+static SCCP_LIST_HEAD (, struct sccp_hint_lineState) lineStates;
+static SCCP_LIST_HEAD (, sccp_hint_list_t) sccp_hint_subscriptions;
+
+/*
+ * Hints are also indexed by exten@context (for subscribing devices) and by hint dialplan (for device state events). Both indexes are
+ * protected by the sccp_hint_subscriptions lock. Hints are only removed on module stop.
+ */
+AST_MUTEX_DEFINE_STATIC(sccp_hint_debounceLock);								/*!< protects hint->debounceId and hint->debounceRefs */
+#define SCCP_HINT_HASHSIZE 1024											/* power of 2 */
+static sccp_hint_list_t * hintsByExten[SCCP_HINT_HASHSIZE];
+#ifdef SCCP_HINT_DISTRIBUTED_CID
+static sccp_hint_list_t * hintsByDevice[SCCP_HINT_HASHSIZE];
+static PBX_EVENT_SUBSCRIPTION * sccp_hint_devstate_sub = NULL;						/*!< single device state subscription, dispatched to all hints */
 #endif
+
+static inline uint32_t sccp_hint_hashExten(const char *exten, const char *context)
 {
-	sccp_hint_list_t *hint = (sccp_hint_list_t *) data;
+	uint32_t hash = 2166136261U;										/* FNV-1a over "exten@context" */
+	for (; exten && *exten; exten++) {
+		hash = (hash ^ (uint8_t)*exten) * 16777619U;
+	}
+	hash = (hash ^ (uint8_t)'@') * 16777619U;
+	for (; context && *context; context++) {
+		hash = (hash ^ (uint8_t)*context) * 16777619U;
+	}
+	return hash & (SCCP_HINT_HASHSIZE - 1);
+}
+
+/* needs sccp_hint_subscriptions lock */
+static sccp_hint_list_t * sccp_hint_findByExten_locked(const char *exten, const char *context)
+{
+	sccp_hint_list_t * hint = NULL;
+	for (hint = hintsByExten[sccp_hint_hashExten(exten, context)]; hint; hint = hint->extenNext) {
+		if (sccp_strequals(exten, hint->exten) && sccp_strequals(context, hint->context)) {
+			break;
+		}
+	}
+	return hint;
+}
+
+#ifdef SCCP_HINT_DISTRIBUTED_CID
+static inline uint32_t sccp_hint_hashDevice(const char *device)
+{
+	uint32_t hash = 2166136261U;										/* FNV-1a, case insensitive (device names are) */
+	for (; *device; device++) {
+		hash = (hash ^ (uint8_t)tolower((unsigned char)*device)) * 16777619U;
+	}
+	return hash & (SCCP_HINT_HASHSIZE - 1);
+}
+#endif
+
+/* needs sccp_hint_subscriptions lock */
+static void sccp_hint_link_locked(sccp_hint_list_t * hint)
+{
+	uint32_t bucket = sccp_hint_hashExten(hint->exten, hint->context);
+	SCCP_LIST_INSERT_HEAD(&sccp_hint_subscriptions, hint, list);
+	hint->extenNext = hintsByExten[bucket];
+	hintsByExten[bucket] = hint;
+#ifdef SCCP_HINT_DISTRIBUTED_CID
+	bucket = sccp_hint_hashDevice(hint->hint_dialplan);
+	hint->deviceNext = hintsByDevice[bucket];
+	hintsByDevice[bucket] = hint;
+#endif
+}
+
+#ifdef SCCP_HINT_DISTRIBUTED_CID
+/*!
+ * \brief asterisk callback for (distributed) device state changes, dispatched to the hints using this device
+ * \note one subscription for all hints, instead of one per hint
+ */
+static void sccp_hint_distributed_devstate_cb(const pbx_event_t * event, void *data)
+{
+	sccp_hint_list_t *hint = NULL;
+	const char * device = NULL;
 	const char * cidName = NULL;
 	const char * cidNumber = NULL;
 	//enum ast_device_state state;		/* maybe we should store the last state */
 	
-#if ASTERISK_VERSION_GROUP >= 112
-	struct ast_device_state_message *dev_state = (struct ast_device_state_message *)stasis_message_data(msg);
-	if (ast_device_state_message_type() != stasis_message_type(msg)) {
-		return;
-	}
-	if (dev_state->eid) {
-		return;
-	}
-	//eid = dev_state->eid;
-	//state = dev_state->state;
-	cidName = "";
-	cidNumber = "";
-	// sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_3 "Got new hint event %s, cidname: %s, cidnum: %s\n", hint->hint_dialplan, cidName ? cidName : "NULL", cidNumber ? cidNumber : "NULL");
-#	else
 	const struct ast_eid *eid = (const struct ast_eid *)ast_event_get_ie_raw(event, AST_EVENT_IE_EID);
 	//state = pbx_event_get_ie_uint(ast_event, AST_EVENT_IE_STATE);
-#		if ASTERISK_VERSION_GROUP >= 108
+	device = pbx_event_get_ie_str(event, AST_EVENT_IE_DEVICE);
 	cidName = pbx_event_get_ie_str(event, AST_EVENT_IE_CEL_CIDNAME);
 	cidNumber = pbx_event_get_ie_str(event, AST_EVENT_IE_CEL_CIDNUM);
-#		else
-	cidName = "";
-	cidNumber = "";
-#		endif
 	char eid_str[32] = "";
 	ast_eid_to_str(eid_str, sizeof(eid_str), (struct ast_eid *) eid);
 	if (!ast_eid_cmp(&ast_eid_default, eid)) {
 		sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_3 "Skipping distribute devstate update from EID:'%s', MYEID:'%s' (i.e. myself)\n", eid_str, default_eid_str);
 		return;
 	}
-	sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_3 "Got new hint event %s, cidname: %s, cidnum: %s, originated from EID:'%s'\n", hint->hint_dialplan, cidName ? cidName : "NULL", cidNumber ? cidNumber : "NULL", eid_str);
-#	endif
+	sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_3 "Got new hint event %s, cidname: %s, cidnum: %s, originated from EID:'%s'\n", device ? device : "NULL", cidName ? cidName : "NULL", cidNumber ? cidNumber : "NULL", eid_str);
 
-	if(hint->callInfo && (!sccp_strlen_zero(cidNumber) || !sccp_strlen_zero(cidName))) {
-		if (hint->calltype == SKINNY_CALLTYPE_INBOUND) {
-			iCallInfo.Setter(hint->callInfo, SCCP_CALLINFO_CALLINGPARTY_NAME, cidName, SCCP_CALLINFO_CALLINGPARTY_NUMBER, cidNumber, SCCP_CALLINFO_KEY_SENTINEL);
-		} else {
-			iCallInfo.Setter(hint->callInfo, SCCP_CALLINFO_CALLEDPARTY_NAME, cidName, SCCP_CALLINFO_CALLEDPARTY_NUMBER, cidNumber, SCCP_CALLINFO_KEY_SENTINEL);
+	if (sccp_strlen_zero(device) || (sccp_strlen_zero(cidNumber) && sccp_strlen_zero(cidName))) {
+		return;
+	}
+	SCCP_LIST_LOCK(&sccp_hint_subscriptions);
+	for (hint = hintsByDevice[sccp_hint_hashDevice(device)]; hint; hint = hint->deviceNext) {
+		if (hint->callInfo && sccp_strcaseequals(hint->hint_dialplan, device)) {
+			if (hint->calltype == SKINNY_CALLTYPE_INBOUND) {
+				iCallInfo.Setter(hint->callInfo, SCCP_CALLINFO_CALLINGPARTY_NAME, cidName, SCCP_CALLINFO_CALLINGPARTY_NUMBER, cidNumber, SCCP_CALLINFO_KEY_SENTINEL);
+			} else {
+				iCallInfo.Setter(hint->callInfo, SCCP_CALLINFO_CALLEDPARTY_NAME, cidName, SCCP_CALLINFO_CALLEDPARTY_NUMBER, cidNumber, SCCP_CALLINFO_KEY_SENTINEL);
+			}
 		}
 	}
-
-	return;
+	SCCP_LIST_UNLOCK(&sccp_hint_subscriptions);
 }
 #endif
 
-/* ========================================================================================================================= List Declarations */
-static SCCP_LIST_HEAD (, struct sccp_hint_lineState) lineStates;
-static SCCP_LIST_HEAD (, sccp_hint_list_t) sccp_hint_subscriptions;
-
 /* ========================================================================================================================= Module Start/Stop */
 /*!
  * \brief starting hint-module
@@ -204,8 +277,9 @@ void sccp_hint_module_start(void)
 	sccp_event_subscribe(SCCP_EVENT_DEVICE_REGISTERED | SCCP_EVENT_DEVICE_ATTACHED | SCCP_EVENT_LINESTATUS_CHANGED, sccp_hint_eventListener, TRUE);
 	sccp_event_subscribe(SCCP_EVENT_DEVICE_UNREGISTERED | SCCP_EVENT_DEVICE_DETACHED, sccp_hint_eventListener, FALSE);
 	sccp_event_subscribe(SCCP_EVENT_FEATURE_CHANGED, sccp_hint_handleFeatureChangeEvent, TRUE);
-#ifdef CS_USE_ASTERISK_DISTRIBUTED_DEVSTATE
+#ifdef SCCP_HINT_DISTRIBUTED_CID
 	ast_eid_to_str(default_eid_str, sizeof(default_eid_str), &ast_eid_default);
+	sccp_hint_devstate_sub = pbx_event_subscribe(AST_EVENT_DEVICE_STATE_CHANGE, sccp_hint_distributed_devstate_cb, "sccp_hint_distributed_devstate_cb", NULL, AST_EVENT_IE_END);
 #endif
 }
 
@@ -233,14 +307,27 @@ void sccp_hint_module_stop(void)
 		sccp_hint_list_t * hint = NULL;
 		sccp_hint_SubscribingDevice_t * subscriber = NULL;
 
+#ifdef SCCP_HINT_DISTRIBUTED_CID
+		if (sccp_hint_devstate_sub) {
+			pbx_event_unsubscribe(sccp_hint_devstate_sub);
+			sccp_hint_devstate_sub = NULL;
+		}
+#endif
 		SCCP_LIST_LOCK(&sccp_hint_subscriptions);
-		while ((hint = SCCP_LIST_REMOVE_HEAD(&sccp_hint_subscriptions, list))) {
-#ifdef CS_USE_ASTERISK_DISTRIBUTED_DEVSTATE
-			if (hint->device_state_sub) {
-				pbx_event_unsubscribe(hint->device_state_sub);
-			}
+		memset(hintsByExten, 0, sizeof(hintsByExten));
+#ifdef SCCP_HINT_DISTRIBUTED_CID
+		memset(hintsByDevice, 0, sizeof(hintsByDevice));
 #endif
+		while ((hint = SCCP_LIST_REMOVE_HEAD(&sccp_hint_subscriptions, list))) {
 			ast_extension_state_del(hint->stateid, NULL);
+			pbx_mutex_lock(&sccp_hint_debounceLock);
+			if (hint->debounceId > -1) {
+				if (iPbx.sched_del(hint->debounceId) == 0) {
+					hint->debounceRefs--;							/* cancelled, otherwise the running callback releases it's reference */
+				}
+				hint->debounceId = -1;
+			}
+			pbx_mutex_unlock(&sccp_hint_debounceLock);
 
 			// All subscriptions that have this device should be removed, force cleanup 
 			SCCP_LIST_LOCK(&hint->subscribers);
@@ -253,9 +340,7 @@ void sccp_hint_module_stop(void)
 				}
 			}
 			SCCP_LIST_UNLOCK(&hint->subscribers);
-			SCCP_LIST_HEAD_DESTROY(&hint->subscribers);
-			iCallInfo.Destructor(&hint->callInfo);
-			sccp_free(hint);
+			sccp_hint_unref(hint);
 		}
 		SCCP_LIST_UNLOCK(&sccp_hint_subscriptions);
 	}
@@ -308,6 +393,7 @@ static int sccp_hint_devstate_cb(char *context, char *id, enum ast_extension_sta
 	//const char *cidNumber;
 	char cidName[StationMaxNameSize] = "";
 	char cidNumber[StationMaxDirnumSize] = "";
+	sccp_callerid_presentation_t presentation = CALLERID_PRESENTATION_ALLOWED;
 
 	hint = (sccp_hint_list_t *) data;
 	if (!hint) {
@@ -326,11 +412,13 @@ static int sccp_hint_devstate_cb(char *context, char *id, enum ast_extension_sta
 			iCallInfo.Getter(hint->callInfo, 
 				SCCP_CALLINFO_CALLINGPARTY_NAME, &cidName, 
 				SCCP_CALLINFO_CALLINGPARTY_NUMBER, &cidNumber, 
+				SCCP_CALLINFO_PRESENTATION, &presentation, 
 				SCCP_CALLINFO_KEY_SENTINEL);
 		} else {
 			iCallInfo.Getter(hint->callInfo, 
 				SCCP_CALLINFO_CALLEDPARTY_NAME, &cidName, 
 				SCCP_CALLINFO_CALLEDPARTY_NUMBER, &cidNumber, 
+				SCCP_CALLINFO_PRESENTATION, &presentation, 
 				SCCP_CALLINFO_KEY_SENTINEL);
 		}
 	}
@@ -377,9 +465,19 @@ static int sccp_hint_devstate_cb(char *context, char *id, enum ast_extension_sta
 			hint->currentState = SCCP_CHANNELSTATE_HOLD;
 			break;
 	}
+	/* callerid only changes (distributed devstate, non sccp hints) arrive here with an unchanged state and still need to be notified */
+	if (hint->currentState == previousState && presentation == hint->lastPresentation && sccp_strequals(cidName, hint->lastCidName) && sccp_strequals(cidNumber, hint->lastCidNumber)) {
+		/* nothing to tell, subscribers got this state and callerid already */
+		hint->unchangedStateEvents++;
+		sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_3 "%s (hint_devstate_cb) state %s and callerid did not change, skip notifying subscribers\n", hint->exten, sccp_channelstate2str(hint->currentState));
+		return 0;
+	}
+	sccp_copy_string(hint->lastCidName, cidName, sizeof(hint->lastCidName));
+	sccp_copy_string(hint->lastCidNumber, cidNumber, sizeof(hint->lastCidNumber));
+	hint->lastPresentation = presentation;
 	hint->previousState = previousState;
 
-	sccp_hint_notifySubscribers(hint);
+	sccp_hint_scheduleNotifySubscribers(hint);
 	return 0;
 }
 
@@ -501,9 +599,6 @@ static void sccp_hint_deviceUnRegistered(const char *deviceName)
  * \param instance Instance as int
  * \param positionOnDevice button index on device (used to detect devicetype)
  * 
- * \warning
- *  - sccp_hint_subscriptions is not always locked
- * 
  * \note called with retained device
  */
 static void sccp_hint_addSubscription4Device(const sccp_device_t * device, const char *hintStr, const uint8_t instance, const uint8_t positionOnDevice)
@@ -528,8 +623,9 @@ static void sccp_hint_addSubscription4Device(const sccp_device_t * device, const
 	hint_context = splitter;
 	if (hint_context) {
 		pbx_strip(hint_context);
-	} else {
-		hint_context = GLOB(context);
+	}
+	if (sccp_strlen_zero(hint_context)) {
+		hint_context = GLOB(context);							/* same default as sccp_hint_create, so the hash key matches */
 	}
 
 	/* skip subscribtions to already owned line */
@@ -542,27 +638,37 @@ static void sccp_hint_addSubscription4Device(const sccp_device_t * device, const
 	   } */
 	sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_3 "%s (hint_addSubscription4Device) Dialplan %s for exten: %s and context: %s\n", DEV_ID_LOG(device), hintStr, hint_exten, hint_context);
 
-	SCCP_LIST_TRAVERSE(&sccp_hint_subscriptions, hint, list) {
-		if (sccp_strlen(hint_exten) == sccp_strlen(hint->exten)
-		    && sccp_strlen(hint_context) == sccp_strlen(hint->context)
-		    && sccp_strequals(hint_exten, hint->exten)
-		    && sccp_strequals(hint_context, hint->context)) {
-			sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_addSubscription4Device) Hint found for exten '%s@%s'\n", DEV_ID_LOG(device), hint_exten, hint_context);
-			break;
-		}
+	if (sccp_strlen_zero(hint_exten)) {
+		return;
 	}
 
-	/* we have no hint */
-	if (!hint) {
+	SCCP_LIST_LOCK(&sccp_hint_subscriptions);
+	hint = sccp_hint_findByExten_locked(hint_exten, hint_context);
+	SCCP_LIST_UNLOCK(&sccp_hint_subscriptions);
+	if (hint) {
+		sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_addSubscription4Device) Hint found for exten '%s@%s'\n", DEV_ID_LOG(device), hint_exten, hint_context);
+	} else {
+		/* we have no hint. Created without holding the list lock: the pbx takes it's context/hint locks, from which it calls sccp_hint_devstate_cb */
 		sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_addSubscription4Device) create new hint for %s@%s\n", DEV_ID_LOG(device), hint_exten, hint_context);
-		hint = sccp_hint_create(hint_exten, hint_context);
-		if (!hint) {
+		sccp_hint_list_t * newHint = sccp_hint_create(hint_exten, hint_context);
+		if (!newHint) {
 			pbx_log(LOG_NOTICE, "%s (hint_addSubscription4Device) hint create failed for %s@%s\n", DEV_ID_LOG(device), hint_exten, hint_context);
 			return;
 		}
+		/* subscribed before it is linked, so that a device finding it in the list never gets the initial state */
+		sccp_hint_subscribe(newHint);
+
+		/* another device may have created the same hint in the mean time, only one of them gets linked */
 		SCCP_LIST_LOCK(&sccp_hint_subscriptions);
-		SCCP_LIST_INSERT_HEAD(&sccp_hint_subscriptions, hint, list);
+		if (!(hint = sccp_hint_findByExten_locked(hint_exten, hint_context))) {
+			sccp_hint_link_locked(newHint);
+			hint = newHint;
+		}
 		SCCP_LIST_UNLOCK(&sccp_hint_subscriptions);
+		if (hint != newHint) {
+			ast_extension_state_del(newHint->stateid, NULL);						/* nobody else knows about it, no subscribers, no debounce pending */
+			sccp_hint_unref(newHint);
+		}
 	}
 
 	/* add subscribing device */
@@ -586,11 +692,50 @@ static void sccp_hint_addSubscription4Device(const sccp_device_t * device, const
 	}
 
 	sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_addSubscription4Device) Adding subscription for hint %s@%s\n", DEV_ID_LOG(device), hint->exten, hint->context);
+	SCCP_LIST_LOCK(&hint->subscribers);
 	SCCP_LIST_INSERT_HEAD(&hint->subscribers, subscriber, list);
+	hint->initialNotifications++;
+	SCCP_LIST_UNLOCK(&hint->subscribers);
 
 	sccp_dev_set_keyset(device, subscriber->instance, 0, KEYMODE_ONHOOK);
 
-	sccp_hint_notifySubscribers(hint);
+	/* only the new subscriber needs the current state, the others already have it */
+	if (GLOB(module_running) && SCCP_REF_RUNNING == sccp_refcount_isRunning()) {
+		sccp_hint_notifySubscriber(hint, subscriber);
+	}
+}
+
+/*!
+ * \brief allocate a hint structure (not linked, not subscribed)
+ * \param hint_exten Hint Extension as char
+ * \param hint_context Hint Context as char
+ * \param hint_dialplan Hint devices, i.e. SCCP/98011&SIP/123
+ * \return SCCP Hint Linked List
+ */
+static sccp_hint_list_t * sccp_hint_alloc(const char * hint_exten, const char * hint_context, const char * hint_dialplan)
+{
+	sccp_hint_list_t * hint = (sccp_hint_list_t *)sccp_calloc(sizeof *hint, 1);
+
+	if (!hint) {
+		pbx_log(LOG_ERROR, "SCCP: (sccp_hint_create) Memory Allocation Error while creating hint list for hint: %s@%s\n", hint_exten, hint_context);
+		return NULL;
+	}
+	if (!(hint->callInfo = iCallInfo.Constructor(0, "hint"))) {
+		sccp_free(hint);
+		return NULL;
+	}
+	hint->calltype = SKINNY_CALLTYPE_SENTINEL;
+	hint->debounceId = -1;
+	hint->debounceRefs = 1;
+	hint->lastPresentation = CALLERID_PRESENTATION_ALLOWED;
+
+	SCCP_LIST_HEAD_INIT(&hint->subscribers);
+	//sccp_mutex_init(&hint->lock);
+
+	sccp_copy_string(hint->exten, hint_exten, sizeof(hint->exten));
+	sccp_copy_string(hint->context, hint_context, sizeof(hint->context));
+	sccp_copy_string(hint->hint_dialplan, hint_dialplan, sizeof(hint->hint_dialplan));
+	return hint;
 }
 
 /*!
@@ -601,7 +746,6 @@ static void sccp_hint_addSubscription4Device(const sccp_device_t * device, const
  */
 static sccp_hint_list_t *sccp_hint_create(char *hint_exten, char *hint_context)
 {
-	sccp_hint_list_t *hint = NULL;
 	char hint_dialplan[256] = "";
 
 	if (sccp_strlen_zero(hint_exten)) {
@@ -629,46 +773,19 @@ static sccp_hint_list_t *sccp_hint_create(char *hint_exten, char *hint_context)
 		}
 	}
 
-	hint = (sccp_hint_list_t *)sccp_calloc(sizeof *hint, 1);
-	if (!hint) {
-		pbx_log(LOG_ERROR, "SCCP: (sccp_hint_create) Memory Allocation Error while creating hint list for hint: %s@%s\n", hint_exten, hint_context);
-		return NULL;
-	}
-	if (!(hint->callInfo = iCallInfo.Constructor(0, "hint"))) {
-		sccp_free(hint);
-		return NULL;
-	}
-	hint->calltype = SKINNY_CALLTYPE_SENTINEL;
-
-	SCCP_LIST_HEAD_INIT(&hint->subscribers);
-	//sccp_mutex_init(&hint->lock);
-
-	sccp_copy_string(hint->exten, hint_exten, sizeof(hint->exten));
-	sccp_copy_string(hint->context, hint_context, sizeof(hint->context));
-	sccp_copy_string(hint->hint_dialplan, hint_dialplan, sizeof(hint_dialplan));
+	return sccp_hint_alloc(hint_exten, hint_context, hint_dialplan);
+}
 
+/*!
+ * \brief subscribe a hint (before it is linked) to the pbx extension state and fetch it's current state
+ * \note not to be called with the sccp_hint_subscriptions lock held (lock order: pbx context/hint locks before sccp_hint_subscriptions)
+ */
+static void sccp_hint_subscribe(sccp_hint_list_t * hint)
+{
 	/* subscripbe to the hint */
 	hint->stateid = pbx_extension_state_add(hint->context, hint->exten, sccp_hint_devstate_cb, hint);
 
-#ifdef CS_USE_ASTERISK_DISTRIBUTED_DEVSTATE
-	/* subscripbe to the distributed hint event */
-#if CS_AST_HAS_STASIS
-	struct stasis_topic *devstate_hint_dialplan = ast_device_state_topic(hint->hint_dialplan);
-	if (devstate_hint_dialplan) {
-		hint->device_state_sub = stasis_subscribe(devstate_hint_dialplan, sccp_hint_distributed_devstate_cb, hint);
-//#  if CS_AST_HAS_STASIS_SUBSCRIPTION_SET_FILTER
-//		if (hint->device_state_sub)
-//			stasis_subscription_accept_message_type((hint->device_state_sub)->event_sub, ast_device_state_message_type());
-//			stasis_subscription_set_filter((hint->device_state_sub)->event_sub, STASIS_SUBSCRIPTION_FILTER_SELECTIVE);
-//		}
-//#  endif
-	}
-#elif CS_AST_HAS_EVENT
-	hint->device_state_sub = pbx_event_subscribe(AST_EVENT_DEVICE_STATE_CHANGE, sccp_hint_distributed_devstate_cb, "sccp_hint_distributed_devstate_cb", hint, AST_EVENT_IE_DEVICE, AST_EVENT_IE_PLTYPE_STR, hint->hint_dialplan, AST_EVENT_IE_END);
-#else
-	pbx_log(LOG_ERROR, "SCCP: distributed devstate not supported\n");
-#endif
-#endif
+	/* distributed device state events reach this hint through sccp_hint_devstate_sub, see sccp_hint_link_locked */
 
 	/* force hint update to get currentState */
 #if ASTERISK_VERSION_GROUP >= 111
@@ -680,7 +797,6 @@ static sccp_hint_list_t *sccp_hint_create(char *hint_exten, char *hint_context)
 
 	sccp_hint_devstate_cb(hint->context, hint->exten, state, hint);
 #endif
-	return hint;
 }
 
 /* ========================================================================================================================= Event Handlers : LineState */
@@ -1099,7 +1215,201 @@ static enum ast_device_state sccp_hint_hint2DeviceState(sccp_channelstate_t stat
 
 /* ========================================================================================================================= Subscriber Notify : Updates Speeddial */
 /*!
- * \brief send hint status to subscriber
+ * \brief send the current hint status to one subscriber
+ * \param hint SCCP Hint Linked List Pointer
+ * \param subscriber Subscribing Device
+ */
+static void sccp_hint_notifySubscriber(sccp_hint_list_t * hint, sccp_hint_SubscribingDevice_t * subscriber)
+{
+	AUTO_RELEASE(sccp_device_t, d , sccp_device_retain((sccp_device_t *) subscriber->device));
+
+	if (d) {
+		sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_notifySubscribers) notify subscriber %s of %s's state %s (%d), devicetype:%s\n", DEV_ID_LOG(d), d->id, hint->hint_dialplan, sccp_channelstate2str(hint->currentState), hint->currentState, skinny_devicetype2str(subscriber->devicetype));
+#ifdef CS_DYNAMIC_SPEEDDIAL
+		sccp_msg_t *msg = NULL;
+		sccp_speed_t k;
+		char displayMessage[80] = "";
+		skinny_busylampfield_state_t status = SKINNY_BLF_STATUS_UNKNOWN;
+		if (d->inuseprotocolversion >= 15) {
+			sccp_dev_speed_find_byindex( d, subscriber->instance, TRUE, &k);
+			char cidName[StationMaxNameSize] = "";
+			char cidNumber[StationMaxDirnumSize] = "";
+
+			switch (hint->currentState) {
+			case SCCP_CHANNELSTATE_DOWN:
+				snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
+				status = SKINNY_BLF_STATUS_UNKNOWN;	/* default state */
+				break;
+
+			case SCCP_CHANNELSTATE_ONHOOK:
+				snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
+				status = SKINNY_BLF_STATUS_IDLE;
+				break;
+
+			case SCCP_CHANNELSTATE_DND:
+				snprintf(displayMessage, sizeof(displayMessage), "(DND) %s", k.name);
+				status = SKINNY_BLF_STATUS_DND;	/* dnd */
+				break;
+
+			case SCCP_CHANNELSTATE_CONGESTION:
+				snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
+				status = SKINNY_BLF_STATUS_UNKNOWN;	/* device/line not found */
+				break;
+
+			case SCCP_CHANNELSTATE_RINGING:
+				status = SKINNY_BLF_STATUS_ALERTING;	/* ringin */
+									/* fall through */
+
+			default:
+				if (sccp_hint_isCIDavailabe(d, subscriber->positionOnDevice) == TRUE) {
+					if (hint->calltype == SKINNY_CALLTYPE_INBOUND) {
+						iCallInfo.Getter(hint->callInfo, 
+							SCCP_CALLINFO_CALLINGPARTY_NAME, &cidName, 
+							SCCP_CALLINFO_CALLINGPARTY_NUMBER, &cidNumber, 
+							SCCP_CALLINFO_KEY_SENTINEL);
+					} else {
+						iCallInfo.Getter(hint->callInfo, 
+							SCCP_CALLINFO_CALLEDPARTY_NAME, &cidName, 
+							SCCP_CALLINFO_CALLEDPARTY_NUMBER, &cidNumber, 
+							SCCP_CALLINFO_KEY_SENTINEL);
+					}
+					if (strlen(cidName) > 0) {
+						snprintf(displayMessage, sizeof(displayMessage), "%s %s %s", cidName, (SCCP_CHANNELSTATE_CONNECTED == hint->currentState) ? "<=>" : ((hint->calltype == SKINNY_CALLTYPE_OUTBOUND) ? "<-" : "->"), k.name);
+					} else if (strlen(cidNumber) > 0) {
+						snprintf(displayMessage, sizeof(displayMessage), "%s %s %s", cidNumber, (SCCP_CHANNELSTATE_CONNECTED == hint->currentState) ? "<=>" : ((hint->calltype == SKINNY_CALLTYPE_OUTBOUND) ? "<-" : "->"), k.name);
+					} else {
+						snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
+					}
+				} else 
+				{
+					snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
+				}
+				if (status == SKINNY_BLF_STATUS_UNKNOWN) {	/* still default value --> set */
+					status = SKINNY_BLF_STATUS_INUSE;
+				}
+				break;
+			}
+
+			sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_notifySubscribers) notify device: %s@%d, displayMessage:%s, state: %s ->  %s\n", hint->exten, DEV_ID_LOG(d), subscriber->instance, displayMessage, sccp_channelstate2str(hint->currentState), skinny_busylampfield_state2str(status)); 
+
+			/*! Older 7914 expansion units attached to newer phones have problems displaying updated TextLabels
+			 * Resetting changed content back to the original
+			 */
+			if (subscriber->devicetype == SKINNY_DEVICETYPE_CISCO_ADDON_7914) {
+				snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
+			}
+			/*!
+			* hack to fix the white text without shadow issue -MC
+			*
+			* first send a label which is 1-character shorter than the correct one. 
+			* then send another message with a longer label (correct/final label) will force an update (in white over the back drop in black)
+			*/
+			REQ(msg, FeatureStatDynamicMessage);
+			if (!msg) {
+				return;
+			}
+			sccp_copy_string(msg->data.FeatureStatDynamicMessage.textLabel, displayMessage, sizeof(msg->data.FeatureStatDynamicMessage.textLabel));
+			msg->data.FeatureStatDynamicMessage.textLabel[strlen(displayMessage) - 1] = '\0';
+			msg->data.FeatureStatDynamicMessage.lel_lineInstance                      = htolel(subscriber->instance);
+			msg->data.FeatureStatDynamicMessage.lel_buttonType                        = htolel(SKINNY_BUTTONTYPE_BLFSPEEDDIAL);
+			msg->data.FeatureStatDynamicMessage.stateVal.lel_uint32                   = htolel(status);
+			sccp_session_sendPinned(d, msg);						/* not merged with the final label below, which would skip the repaint */
+
+			/*!
+			 * Send the actual message we wanted to send */
+			REQ(msg, FeatureStatDynamicMessage);
+			if (!msg) {
+				return;
+			}
+			sccp_copy_string(msg->data.FeatureStatDynamicMessage.textLabel, displayMessage, sizeof(msg->data.FeatureStatDynamicMessage.textLabel));
+			msg->data.FeatureStatDynamicMessage.lel_lineInstance    = htolel(subscriber->instance);
+			msg->data.FeatureStatDynamicMessage.lel_buttonType      = htolel(SKINNY_BUTTONTYPE_BLFSPEEDDIAL);
+			msg->data.FeatureStatDynamicMessage.stateVal.lel_uint32 = htolel(status);
+			sccp_dev_send(d, msg);
+		} else
+#endif
+		{
+			/*
+			   we have dynamic speeddial enabled, but subscriber can not handle this.
+			   We have to switch back to old hint style and send old state.
+			 */
+			sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_notifySubscribers) can not handle dynamic speeddial, fall back to old behavior using state %s (%d)\n", DEV_ID_LOG(d), sccp_channelstate2str(hint->currentState), hint->currentState);
+
+			/*
+			   With the old hint style we should only use SCCP_CHANNELSTATE_ONHOOK and SCCP_CHANNELSTATE_CALLREMOTEMULTILINE as callstate,
+			   otherwise we get a callplane on device -> set all states except onhook to SCCP_CHANNELSTATE_CALLREMOTEMULTILINE -MC
+			 */
+			skinny_callstate_t iconstate = SKINNY_CALLSTATE_CALLREMOTEMULTILINE;
+
+			switch (hint->currentState) {
+				case SCCP_CHANNELSTATE_DOWN:
+				case SCCP_CHANNELSTATE_ONHOOK:
+					iconstate = SKINNY_CALLSTATE_ONHOOK;
+					break;
+				case SCCP_CHANNELSTATE_RINGING:
+					if (d->allowRinginNotification) {
+						iconstate = SKINNY_CALLSTATE_RINGIN;
+					}
+					break;
+				case SCCP_CHANNELSTATE_ZOMBIE:
+				case SCCP_CHANNELSTATE_CONGESTION:
+				case SCCP_CHANNELSTATE_CONNECTED:
+				case SCCP_CHANNELSTATE_OFFHOOK:
+				case SCCP_CHANNELSTATE_RINGOUT:
+				case SCCP_CHANNELSTATE_RINGOUT_ALERTING:
+				case SCCP_CHANNELSTATE_BUSY:
+				case SCCP_CHANNELSTATE_HOLD:
+				case SCCP_CHANNELSTATE_CALLWAITING:
+				case SCCP_CHANNELSTATE_CALLPARK:
+				case SCCP_CHANNELSTATE_PROCEED:
+				case SCCP_CHANNELSTATE_CALLREMOTEMULTILINE:
+				case SCCP_CHANNELSTATE_INVALIDNUMBER:
+				case SCCP_CHANNELSTATE_DIALING:
+				case SCCP_CHANNELSTATE_PROGRESS:
+				case SCCP_CHANNELSTATE_GETDIGITS:
+				case SCCP_CHANNELSTATE_SPEEDDIAL:
+				case SCCP_CHANNELSTATE_DIGITSFOLL:
+				case SCCP_CHANNELSTATE_INVALIDCONFERENCE:
+				case SCCP_CHANNELSTATE_CONNECTEDCONFERENCE:
+				case SCCP_CHANNELSTATE_BLINDTRANSFER:
+				case SCCP_CHANNELSTATE_DND:
+				case SCCP_CHANNELSTATE_CALLTRANSFER:
+				case SCCP_CHANNELSTATE_CALLCONFERENCE:
+					iconstate = SKINNY_CALLSTATE_CALLREMOTEMULTILINE;
+					break;
+				case SCCP_CHANNELSTATE_SENTINEL:
+					break;
+			}
+			sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_notifySubscribers) setting icon to state %s (%d)\n", DEV_ID_LOG(d), skinny_callstate2str(iconstate), iconstate);
+
+			if (SCCP_CHANNELSTATE_RINGING == hint->previousState) {
+				/* we send a congestion to the phone, so call will not be marked as missed call */
+				sccp_device_sendcallstate(d, subscriber->instance, 0, SKINNY_CALLSTATE_CONGESTION, SKINNY_CALLPRIORITY_NORMAL, SKINNY_CALLINFO_VISIBILITY_HIDDEN);
+			}
+
+			sccp_device_sendcallstate(d, subscriber->instance, 0, iconstate, SKINNY_CALLPRIORITY_NORMAL, SKINNY_CALLINFO_VISIBILITY_DEFAULT); /** do not set visibility to COLLAPSED, this will hide callInfo in state CALLREMOTEMULTILINE */
+
+			if (hint->currentState == SCCP_CHANNELSTATE_ONHOOK || hint->currentState == SCCP_CHANNELSTATE_CONGESTION) {
+				sccp_device_setLamp(d, SKINNY_STIMULUS_LINE, subscriber->instance, SKINNY_LAMP_OFF);
+				sccp_dev_set_keyset(d, subscriber->instance, 0, KEYMODE_ONHOOK);
+
+			} else if (hint->currentState == SCCP_CHANNELSTATE_RINGING && d->allowRinginNotification) {
+				sccp_device_setLamp(d, SKINNY_STIMULUS_LINE, subscriber->instance, SKINNY_LAMP_BLINK);
+				sccp_dev_set_keyset(d, subscriber->instance, 0, KEYMODE_INUSEHINT);
+
+			} else {
+				iCallInfo.Send(hint->callInfo, 0 /*callid*/, (hint->calltype == SKINNY_CALLTYPE_OUTBOUND) ? SKINNY_CALLTYPE_OUTBOUND : SKINNY_CALLTYPE_INBOUND, subscriber->instance, d, TRUE);
+				sccp_device_setLamp(d, SKINNY_STIMULUS_LINE, subscriber->instance, SKINNY_LAMP_ON);
+				sccp_dev_set_keyset(d, subscriber->instance, 0 /*callid*/, KEYMODE_INUSEHINT);
+			}
+		}
+	} else {
+		sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "SCCP: (sccp_hint_notifySubscribers) device not found/retained\n");
+	}
+}
+
+/*!
+ * \brief send hint status to all subscribers (on hint state change)
  * \param hint SCCP Hint Linked List Pointer
  *
  * \todo Check if the actual device still exists while going throughthe hint->subscribers and not pointing at rubish
@@ -1121,194 +1431,105 @@ static void sccp_hint_notifySubscribers(sccp_hint_list_t * hint)
 	sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_3 "%s (hint_notifySubscribers) notify %u subscriber(s) of %s's state %s\n", hint->exten, SCCP_LIST_GETSIZE(&hint->subscribers), hint->hint_dialplan, sccp_channelstate2str(hint->currentState));
 
 	SCCP_LIST_LOCK(&hint->subscribers);
+	hint->fanouts++;
+	hint->notifiedState = hint->currentState;
 	SCCP_LIST_TRAVERSE(&hint->subscribers, subscriber, list) {
-		AUTO_RELEASE(sccp_device_t, d , sccp_device_retain((sccp_device_t *) subscriber->device));
-
-		if (d) {
-			sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_notifySubscribers) notify subscriber %s of %s's state %s (%d), devicetype:%s\n", DEV_ID_LOG(d), d->id, hint->hint_dialplan, sccp_channelstate2str(hint->currentState), hint->currentState, skinny_devicetype2str(subscriber->devicetype));
-#ifdef CS_DYNAMIC_SPEEDDIAL
-			sccp_msg_t *msg = NULL;
-			sccp_speed_t k;
-			char displayMessage[80] = "";
-			skinny_busylampfield_state_t status = SKINNY_BLF_STATUS_UNKNOWN;
-			if (d->inuseprotocolversion >= 15) {
-				sccp_dev_speed_find_byindex( d, subscriber->instance, TRUE, &k);
-				char cidName[StationMaxNameSize] = "";
-				char cidNumber[StationMaxDirnumSize] = "";
-
-				switch (hint->currentState) {
-				case SCCP_CHANNELSTATE_DOWN:
-					snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
-					status = SKINNY_BLF_STATUS_UNKNOWN;	/* default state */
-					break;
-
-				case SCCP_CHANNELSTATE_ONHOOK:
-					snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
-					status = SKINNY_BLF_STATUS_IDLE;
-					break;
-
-				case SCCP_CHANNELSTATE_DND:
-					snprintf(displayMessage, sizeof(displayMessage), "(DND) %s", k.name);
-					status = SKINNY_BLF_STATUS_DND;	/* dnd */
-					break;
-
-				case SCCP_CHANNELSTATE_CONGESTION:
-					snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
-					status = SKINNY_BLF_STATUS_UNKNOWN;	/* device/line not found */
-					break;
-
-				case SCCP_CHANNELSTATE_RINGING:
-					status = SKINNY_BLF_STATUS_ALERTING;	/* ringin */
-										/* fall through */
-
-				default:
-					if (sccp_hint_isCIDavailabe(d, subscriber->positionOnDevice) == TRUE) {
-						if (hint->calltype == SKINNY_CALLTYPE_INBOUND) {
-							iCallInfo.Getter(hint->callInfo, 
-								SCCP_CALLINFO_CALLINGPARTY_NAME, &cidName, 
-								SCCP_CALLINFO_CALLINGPARTY_NUMBER, &cidNumber, 
-								SCCP_CALLINFO_KEY_SENTINEL);
-						} else {
-							iCallInfo.Getter(hint->callInfo, 
-								SCCP_CALLINFO_CALLEDPARTY_NAME, &cidName, 
-								SCCP_CALLINFO_CALLEDPARTY_NUMBER, &cidNumber, 
-								SCCP_CALLINFO_KEY_SENTINEL);
-						}
-						if (strlen(cidName) > 0) {
-							snprintf(displayMessage, sizeof(displayMessage), "%s %s %s", cidName, (SCCP_CHANNELSTATE_CONNECTED == hint->currentState) ? "<=>" : ((hint->calltype == SKINNY_CALLTYPE_OUTBOUND) ? "<-" : "->"), k.name);
-						} else if (strlen(cidNumber) > 0) {
-							snprintf(displayMessage, sizeof(displayMessage), "%s %s %s", cidNumber, (SCCP_CHANNELSTATE_CONNECTED == hint->currentState) ? "<=>" : ((hint->calltype == SKINNY_CALLTYPE_OUTBOUND) ? "<-" : "->"), k.name);
-						} else {
-							snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
-						}
-					} else 
-					{
-						snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
-					}
-					if (status == SKINNY_BLF_STATUS_UNKNOWN) {	/* still default value --> set */
-						status = SKINNY_BLF_STATUS_INUSE;
-					}
-					break;
-				}
+		hint->fanoutNotifications++;
+		sccp_hint_notifySubscriber(hint, subscriber);
+	}
+	SCCP_LIST_UNLOCK(&hint->subscribers);
+}
 
-				sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_notifySubscribers) notify device: %s@%d, displayMessage:%s, state: %s ->  %s\n", hint->exten, DEV_ID_LOG(d), subscriber->instance, displayMessage, sccp_channelstate2str(hint->currentState), skinny_busylampfield_state2str(status)); 
+/* ========================================================================================================================= Subscriber Notify : Coalescing */
+/*!
+ * \brief free a hint which is not linked into sccp_hint_subscriptions (anymore)
+ */
+static void sccp_hint_destroy(sccp_hint_list_t * hint)
+{
+	SCCP_LIST_HEAD_DESTROY(&hint->subscribers);
+	iCallInfo.Destructor(&hint->callInfo);
+	sccp_free(hint);
+}
 
-				/*! Older 7914 expansion units attached to newer phones have problems displaying updated TextLabels
-				 * Resetting changed content back to the original
-				 */
-				if (subscriber->devicetype == SKINNY_DEVICETYPE_CISCO_ADDON_7914) {
-					snprintf(displayMessage, sizeof(displayMessage), "%s", k.name);
-				}
-				/*!
-				* hack to fix the white text without shadow issue -MC
-				*
-				* first send a label which is 1-character shorter than the correct one. 
-				* then send another message with a longer label (correct/final label) will force an update (in white over the back drop in black)
-				*/
-				REQ(msg, FeatureStatDynamicMessage);
-				if (!msg) {
-					return;
-				}
-				sccp_copy_string(msg->data.FeatureStatDynamicMessage.textLabel, displayMessage, sizeof(msg->data.FeatureStatDynamicMessage.textLabel));
-				msg->data.FeatureStatDynamicMessage.textLabel[strlen(displayMessage) - 1] = '\0';
-				msg->data.FeatureStatDynamicMessage.lel_lineInstance                      = htolel(subscriber->instance);
-				msg->data.FeatureStatDynamicMessage.lel_buttonType                        = htolel(SKINNY_BUTTONTYPE_BLFSPEEDDIAL);
-				msg->data.FeatureStatDynamicMessage.stateVal.lel_uint32                   = htolel(status);
-				sccp_dev_send(d, msg);
-
-				/*!
-				 * Send the actual message we wanted to send */
-				REQ(msg, FeatureStatDynamicMessage);
-				if (!msg) {
-					return;
-				}
-				sccp_copy_string(msg->data.FeatureStatDynamicMessage.textLabel, displayMessage, sizeof(msg->data.FeatureStatDynamicMessage.textLabel));
-				msg->data.FeatureStatDynamicMessage.lel_lineInstance    = htolel(subscriber->instance);
-				msg->data.FeatureStatDynamicMessage.lel_buttonType      = htolel(SKINNY_BUTTONTYPE_BLFSPEEDDIAL);
-				msg->data.FeatureStatDynamicMessage.stateVal.lel_uint32 = htolel(status);
-				sccp_dev_send(d, msg);
-			} else
-#endif
-			{
-				/*
-				   we have dynamic speeddial enabled, but subscriber can not handle this.
-				   We have to switch back to old hint style and send old state.
-				 */
-				sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_notifySubscribers) can not handle dynamic speeddial, fall back to old behavior using state %s (%d)\n", DEV_ID_LOG(d), sccp_channelstate2str(hint->currentState), hint->currentState);
-
-				/*
-				   With the old hint style we should only use SCCP_CHANNELSTATE_ONHOOK and SCCP_CHANNELSTATE_CALLREMOTEMULTILINE as callstate,
-				   otherwise we get a callplane on device -> set all states except onhook to SCCP_CHANNELSTATE_CALLREMOTEMULTILINE -MC
-				 */
-				skinny_callstate_t iconstate = SKINNY_CALLSTATE_CALLREMOTEMULTILINE;
-
-				switch (hint->currentState) {
-					case SCCP_CHANNELSTATE_DOWN:
-					case SCCP_CHANNELSTATE_ONHOOK:
-						iconstate = SKINNY_CALLSTATE_ONHOOK;
-						break;
-					case SCCP_CHANNELSTATE_RINGING:
-						if (d->allowRinginNotification) {
-							iconstate = SKINNY_CALLSTATE_RINGIN;
-						}
-						break;
-					case SCCP_CHANNELSTATE_ZOMBIE:
-					case SCCP_CHANNELSTATE_CONGESTION:
-					case SCCP_CHANNELSTATE_CONNECTED:
-					case SCCP_CHANNELSTATE_OFFHOOK:
-					case SCCP_CHANNELSTATE_RINGOUT:
-					case SCCP_CHANNELSTATE_RINGOUT_ALERTING:
-					case SCCP_CHANNELSTATE_BUSY:
-					case SCCP_CHANNELSTATE_HOLD:
-					case SCCP_CHANNELSTATE_CALLWAITING:
-					case SCCP_CHANNELSTATE_CALLPARK:
-					case SCCP_CHANNELSTATE_PROCEED:
-					case SCCP_CHANNELSTATE_CALLREMOTEMULTILINE:
-					case SCCP_CHANNELSTATE_INVALIDNUMBER:
-					case SCCP_CHANNELSTATE_DIALING:
-					case SCCP_CHANNELSTATE_PROGRESS:
-					case SCCP_CHANNELSTATE_GETDIGITS:
-					case SCCP_CHANNELSTATE_SPEEDDIAL:
-					case SCCP_CHANNELSTATE_DIGITSFOLL:
-					case SCCP_CHANNELSTATE_INVALIDCONFERENCE:
-					case SCCP_CHANNELSTATE_CONNECTEDCONFERENCE:
-					case SCCP_CHANNELSTATE_BLINDTRANSFER:
-					case SCCP_CHANNELSTATE_DND:
-					case SCCP_CHANNELSTATE_CALLTRANSFER:
-					case SCCP_CHANNELSTATE_CALLCONFERENCE:
-						iconstate = SKINNY_CALLSTATE_CALLREMOTEMULTILINE;
-						break;
-					case SCCP_CHANNELSTATE_SENTINEL:
-						break;
-				}
-				sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "%s (hint_notifySubscribers) setting icon to state %s (%d)\n", DEV_ID_LOG(d), skinny_callstate2str(iconstate), iconstate);
+/*!
+ * \brief release a hint reference, the last one frees it
+ * \note a scheduled notification holds a reference, so that a callback which could not be cancelled (already running) never uses a freed hint
+ */
+static void sccp_hint_unref(sccp_hint_list_t * hint)
+{
+	pbx_mutex_lock(&sccp_hint_debounceLock);
+	uint32_t remaining = --hint->debounceRefs;
+	pbx_mutex_unlock(&sccp_hint_debounceLock);
+	if (!remaining) {
+		sccp_hint_destroy(hint);
+	}
+}
 
-				if (SCCP_CHANNELSTATE_RINGING == hint->previousState) {
-					/* we send a congestion to the phone, so call will not be marked as missed call */
-					sccp_device_sendcallstate(d, subscriber->instance, 0, SKINNY_CALLSTATE_CONGESTION, SKINNY_CALLPRIORITY_NORMAL, SKINNY_CALLINFO_VISIBILITY_HIDDEN);
-				}
+/*!
+ * \brief scheduled end of a hint's debounce window: send the latest state
+ */
+static int sccp_hint_debounceExpired(const void *data)
+{
+	sccp_hint_list_t *hint = (sccp_hint_list_t *) data;
 
-				sccp_device_sendcallstate(d, subscriber->instance, 0, iconstate, SKINNY_CALLPRIORITY_NORMAL, SKINNY_CALLINFO_VISIBILITY_DEFAULT); /** do not set visibility to COLLAPSED, this will hide callInfo in state CALLREMOTEMULTILINE */
+	pbx_mutex_lock(&sccp_hint_debounceLock);
+	if (hint->debounceId < 0) {										/* cancelled, already notified */
+		pbx_mutex_unlock(&sccp_hint_debounceLock);
+		sccp_hint_unref(hint);
+		return 0;
+	}
+	hint->debounceId = -1;
+	pbx_mutex_unlock(&sccp_hint_debounceLock);
 
-				if (hint->currentState == SCCP_CHANNELSTATE_ONHOOK || hint->currentState == SCCP_CHANNELSTATE_CONGESTION) {
-					sccp_device_setLamp(d, SKINNY_STIMULUS_LINE, subscriber->instance, SKINNY_LAMP_OFF);
-					sccp_dev_set_keyset(d, subscriber->instance, 0, KEYMODE_ONHOOK);
+	/* states in between were never sent, so the subscribers previous state is the one they were last notified of */
+	hint->previousState = hint->notifiedState;
+	sccp_hint_notifySubscribers(hint);
+	sccp_hint_unref(hint);											/* reference taken when scheduling */
+	return 0;												// return 0 to release schedule !
+}
 
-				} else if (hint->currentState == SCCP_CHANNELSTATE_RINGING && d->allowRinginNotification) {
-					sccp_device_setLamp(d, SKINNY_STIMULUS_LINE, subscriber->instance, SKINNY_LAMP_BLINK);
-					sccp_dev_set_keyset(d, subscriber->instance, 0, KEYMODE_INUSEHINT);
+/*!
+ * \brief notify subscribers about a hint state change, coalescing changes within GLOB(hint_debounce) milliseconds
+ * Ringing is sent immediately (and replaces a pending notification), so that pickup is not delayed.
+ */
+static void sccp_hint_scheduleNotifySubscribers(sccp_hint_list_t * hint)
+{
+	uint16_t window = GLOB(hint_debounce);
 
-				} else {
-					iCallInfo.Send(hint->callInfo, 0 /*callid*/, (hint->calltype == SKINNY_CALLTYPE_OUTBOUND) ? SKINNY_CALLTYPE_OUTBOUND : SKINNY_CALLTYPE_INBOUND, subscriber->instance, d, TRUE);
-					sccp_device_setLamp(d, SKINNY_STIMULUS_LINE, subscriber->instance, SKINNY_LAMP_ON);
-					sccp_dev_set_keyset(d, subscriber->instance, 0 /*callid*/, KEYMODE_INUSEHINT);
-				}
-			}
-		} else {
-			sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_4 "SCCP: (sccp_hint_notifySubscribers) device not found/retained\n");
-		}
+	/* lock order: subscribers before sccp_hint_debounceLock. A subscriber added after this check is sent the current state by
+	 * sccp_hint_addSubscription4Device */
+	SCCP_LIST_LOCK(&hint->subscribers);
+	pbx_mutex_lock(&sccp_hint_debounceLock);
+	if (hint->debounceId < 0 && SCCP_LIST_GETSIZE(&hint->subscribers) == 0) {				/* nobody to tell (i.e. during sccp_hint_subscribe) */
+		hint->notifiedState = hint->currentState;
+		pbx_mutex_unlock(&sccp_hint_debounceLock);
+		SCCP_LIST_UNLOCK(&hint->subscribers);
+		return;
 	}
 	SCCP_LIST_UNLOCK(&hint->subscribers);
+	if (window && hint->currentState != SCCP_CHANNELSTATE_RINGING) {
+		if (hint->debounceId > -1) {									/* window already open, the latest state will be sent */
+			hint->coalescedNotifications++;
+			pbx_mutex_unlock(&sccp_hint_debounceLock);
+			return;
+		}
+		if ((hint->debounceId = iPbx.sched_add(window, sccp_hint_debounceExpired, hint)) > -1) {
+			hint->debounceRefs++;									/* released by sccp_hint_debounceExpired (or when cancelled) */
+			pbx_mutex_unlock(&sccp_hint_debounceLock);
+			return;
+		}
+		sccp_log((DEBUGCAT_HINT)) (VERBOSE_PREFIX_3 "%s (hint_scheduleNotifySubscribers) could not schedule notification, sending immediately\n", hint->exten);
+	} else if (hint->debounceId > -1) {
+		/* the pending notification is superseded by this one */
+		if (iPbx.sched_del(hint->debounceId) == 0) {
+			hint->debounceRefs--;									/* never the last one, the hint list holds one */
+		}
+		hint->debounceId = -1;										/* if the callback is already running, it will see it was cancelled */
+		hint->coalescedNotifications++;
+		hint->previousState = hint->notifiedState;
+	}
+	pbx_mutex_unlock(&sccp_hint_debounceLock);
+	sccp_hint_notifySubscribers(hint);
 }
 
 /* ========================================================================================================================= PBX Notify */
@@ -1419,7 +1640,7 @@ static void sccp_hint_notifyLineStateUpdate(struct sccp_hint_lineState *lineStat
 			if (newDeviceState == oldDeviceState) {
 				hint->previousState = hint->currentState;
 				hint->currentState = lineState->state;
-				sccp_hint_notifySubscribers(hint);							/* shortcut to inform sccp subscribers about cid update changes only */
+				sccp_hint_scheduleNotifySubscribers(hint);						/* shortcut to inform sccp subscribers about cid update changes only */
 			}
 		}
 	}
@@ -1594,7 +1815,12 @@ int sccp_show_hint_subscriptions(int fd, sccp_cli_totals_t *totals, struct manse
  		CLI_AMI_TABLE_FIELD(CallInfoNumber,	"-15.15",	s,	15,	cidNumber)			\
  		CLI_AMI_TABLE_FIELD(CallInfoName,	"-30.30",	s,	30,	cidName)			\
  		CLI_AMI_TABLE_FIELD(Direction,		"-10.10",	s,	10,	(subscription->calltype && subscription->calltype != SKINNY_CALLTYPE_SENTINEL) ? skinny_calltype2str(subscription->calltype) : "") \
- 		CLI_AMI_TABLE_FIELD(Subs,		"-4",		d,	4,	SCCP_LIST_GETSIZE(&subscription->subscribers))
+ 		CLI_AMI_TABLE_FIELD(Subs,		"-4",		d,	4,	SCCP_LIST_GETSIZE(&subscription->subscribers))		\
+ 		CLI_AMI_TABLE_FIELD(Initial,		"-7",		d,	7,	subscription->initialNotifications)			\
+ 		CLI_AMI_TABLE_FIELD(Fanouts,		"-7",		d,	7,	subscription->fanouts)					\
+ 		CLI_AMI_TABLE_FIELD(Updates,		"-8",		d,	8,	subscription->fanoutNotifications)			\
+ 		CLI_AMI_TABLE_FIELD(Unchanged,		"-9",		d,	9,	subscription->unchangedStateEvents)			\
+ 		CLI_AMI_TABLE_FIELD(Coalesced,		"-9",		d,	9,	subscription->coalescedNotifications)
 
 #include "sccp_cli_table.h"
 
@@ -1605,4 +1831,216 @@ int sccp_show_hint_subscriptions(int fd, sccp_cli_totals_t *totals, struct manse
 	return RESULT_SUCCESS;
 }
 
+#if CS_TEST_FRAMEWORK
+#	include <asterisk/test.h>
+
+/*!
+ * \brief hint for the tests: neither linked nor subscribed to the pbx, state changes are fed to it by sccp_hint_testState
+ */
+static sccp_hint_list_t * sccp_hint_testCreate(void)
+{
+	return sccp_hint_alloc("sccptest", "sccptest", "SCCP/sccptest");
+}
+
+/*!
+ * \brief feed a pbx extension state change to a hint, the way the pbx calls back
+ */
+static void sccp_hint_testState(sccp_hint_list_t * hint, enum ast_extension_states state)
+{
+#	if ASTERISK_VERSION_GROUP >= 111
+	struct ast_state_cb_info info = { 0 };
+	info.exten_state = state;
+	sccp_hint_devstate_cb(hint->context, hint->exten, &info, hint);
+#	else
+	sccp_hint_devstate_cb(hint->context, hint->exten, state, hint);
+#	endif
+}
+
+/*!
+ * \brief subscribe an unregistered device to a hint, the notifications sent to it are discarded
+ */
+static boolean_t sccp_hint_testSubscribe(sccp_hint_list_t * hint, const char * deviceName, uint8_t instance)
+{
+	AUTO_RELEASE(sccp_device_t, device, sccp_device_create(deviceName));
+	sccp_hint_SubscribingDevice_t * subscriber = NULL;
+
+	if (!device || !(subscriber = (sccp_hint_SubscribingDevice_t *)sccp_calloc(sizeof *subscriber, 1))) {
+		return FALSE;
+	}
+	subscriber->device = sccp_device_retain(device);
+	subscriber->instance = instance;
+	SCCP_LIST_LOCK(&hint->subscribers);
+	SCCP_LIST_INSERT_TAIL(&hint->subscribers, subscriber, list);
+	SCCP_LIST_UNLOCK(&hint->subscribers);
+	return TRUE;
+}
+
+static void sccp_hint_testUnsubscribeAll(sccp_hint_list_t * hint)
+{
+	sccp_hint_SubscribingDevice_t * subscriber = NULL;
+
+	SCCP_LIST_LOCK(&hint->subscribers);
+	while ((subscriber = SCCP_LIST_REMOVE_HEAD(&hint->subscribers, list))) {
+		sccp_device_release(&subscriber->device);							/* explicit release */
+		sccp_free(subscriber);
+	}
+	SCCP_LIST_UNLOCK(&hint->subscribers);
+}
+
+static boolean_t sccp_hint_testPending(sccp_hint_list_t * hint)
+{
+	pbx_mutex_lock(&sccp_hint_debounceLock);
+	boolean_t pending = hint->debounceId > -1;
+	pbx_mutex_unlock(&sccp_hint_debounceLock);
+	return pending;
+}
+
+/*!
+ * \brief wait for scheduled notifications to release their hint reference, they do so after notifying
+ * \return TRUE when the hint is down to refs references
+ */
+static boolean_t sccp_hint_testWaitRefs(sccp_hint_list_t * hint, uint32_t refs, int maxMs)
+{
+	uint32_t current = 0;
+
+	for (int waited = 0; waited <= maxMs; waited += 10) {
+		pbx_mutex_lock(&sccp_hint_debounceLock);
+		current = hint->debounceRefs;
+		pbx_mutex_unlock(&sccp_hint_debounceLock);
+		if (current == refs) {
+			return TRUE;
+		}
+		usleep(10000);
+	}
+	return FALSE;
+}
+
+AST_TEST_DEFINE(sccp_hint_debounce)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "debounce";
+			info->category = "/channels/chan_sccp/hint/";
+			info->summary = "chan-sccp-b hint notification coalescing";
+			info->description = "Checks that state changes within the debounce window result in a single notification of the latest state, that ringing "
+					    "is sent immediately and that a hint whose notification is still scheduled is only freed once the callback has run";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	enum ast_test_result_state res = AST_TEST_PASS;
+	uint16_t debounce = GLOB(hint_debounce);
+	sccp_hint_list_t * hint = sccp_hint_testCreate();
+	uint32_t fanouts = 0;
+
+	pbx_test_validate(test, hint != NULL);
+	GLOB(hint_debounce) = 50;
+	pbx_test_validate_cleanup(test, sccp_hint_testSubscribe(hint, "SEPTESTHINT001", 1), res, cleanup);
+
+	pbx_test_status_update(test, "State changes within the window result in a single notification of the latest state\n");
+	sccp_hint_testState(hint, AST_EXTENSION_INUSE);
+	sccp_hint_testState(hint, AST_EXTENSION_BUSY);
+	sccp_hint_testState(hint, AST_EXTENSION_ONHOLD);
+	sccp_hint_testState(hint, AST_EXTENSION_NOT_INUSE);
+	pbx_test_validate_cleanup(test, hint->fanouts == 0 && hint->coalescedNotifications == 3 && sccp_hint_testPending(hint), res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_hint_testWaitRefs(hint, 1, 1000) && !sccp_hint_testPending(hint), res, cleanup);
+	pbx_test_validate_cleanup(test, hint->fanouts == 1 && hint->fanoutNotifications == 1 && hint->notifiedState == SCCP_CHANNELSTATE_ONHOOK, res, cleanup);
+
+	pbx_test_status_update(test, "Ringing is sent immediately, and replaces a pending notification\n");
+	sccp_hint_testState(hint, AST_EXTENSION_RINGING);
+	pbx_test_validate_cleanup(test, hint->fanouts == 2 && hint->notifiedState == SCCP_CHANNELSTATE_RINGING, res, cleanup);
+	sccp_hint_testState(hint, AST_EXTENSION_INUSE);
+	pbx_test_validate_cleanup(test, hint->fanouts == 2 && sccp_hint_testPending(hint), res, cleanup);
+	sccp_hint_testState(hint, AST_EXTENSION_INUSE + AST_EXTENSION_RINGING);
+	pbx_test_validate_cleanup(test, hint->fanouts == 3 && !sccp_hint_testPending(hint) && hint->coalescedNotifications == 4, res, cleanup);
+	usleep(GLOB(hint_debounce) * 3 * 1000);
+	pbx_test_validate_cleanup(test, sccp_hint_testWaitRefs(hint, 1, 1000), res, cleanup);
+	pbx_test_validate_cleanup(test, hint->fanouts == 3 && hint->notifiedState == SCCP_CHANNELSTATE_RINGING, res, cleanup);
+
+	pbx_test_status_update(test, "A hint removed while it's notification is scheduled is freed by the callback\n");
+	sccp_hint_testState(hint, AST_EXTENSION_NOT_INUSE);
+	pbx_test_validate_cleanup(test, sccp_hint_testPending(hint) && sccp_hint_testWaitRefs(hint, 2, 0), res, cleanup);
+	sccp_hint_testUnsubscribeAll(hint);
+	fanouts = hint->fanouts;
+	pbx_mutex_lock(&sccp_hint_debounceLock);
+	hint->debounceRefs++;											/* held by the test, to see what the callback leaves behind */
+	hint->debounceId = -1;											/* as on module stop, when the callback could not be cancelled anymore */
+	pbx_mutex_unlock(&sccp_hint_debounceLock);
+	sccp_hint_unref(hint);											/* the hint list reference */
+	pbx_test_validate_cleanup(test, sccp_hint_testWaitRefs(hint, 1, 1000) && hint->fanouts == fanouts, res, cleanup);
+
+cleanup:
+	GLOB(hint_debounce) = debounce;
+	sccp_hint_testUnsubscribeAll(hint);
+	if (sccp_hint_testWaitRefs(hint, 1, 1000)) {							/* otherwise leaked, rather than freed under a running callback */
+		sccp_hint_unref(hint);
+	}
+	return res;
+}
+
+AST_TEST_DEFINE(sccp_hint_fanout)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "fanout";
+			info->category = "/channels/chan_sccp/hint/";
+			info->summary = "chan-sccp-b hint fanout";
+			info->description = "Checks the fanout counters, that pbx state events without a state or callerid change are not notified and that callerid "
+					    "only changes are";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	enum ast_test_result_state res = AST_TEST_PASS;
+	uint16_t debounce = GLOB(hint_debounce);
+	sccp_hint_list_t * hint = sccp_hint_testCreate();
+
+	pbx_test_validate(test, hint != NULL);
+	GLOB(hint_debounce) = 0;										/* notify immediately */
+	pbx_test_validate_cleanup(test, sccp_hint_testSubscribe(hint, "SEPTESTHINT001", 1), res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_hint_testSubscribe(hint, "SEPTESTHINT002", 3), res, cleanup);
+
+	pbx_test_status_update(test, "A state change is sent to every subscriber once\n");
+	sccp_hint_testState(hint, AST_EXTENSION_NOT_INUSE);
+	pbx_test_validate_cleanup(test, hint->fanouts == 1 && hint->fanoutNotifications == 2 && hint->unchangedStateEvents == 0, res, cleanup);
+
+	pbx_test_status_update(test, "An event without a state or callerid change is not sent\n");
+	sccp_hint_testState(hint, AST_EXTENSION_NOT_INUSE);
+	pbx_test_validate_cleanup(test, hint->fanouts == 1 && hint->fanoutNotifications == 2 && hint->unchangedStateEvents == 1, res, cleanup);
+
+	pbx_test_status_update(test, "A callerid only change is sent\n");
+	iCallInfo.Setter(hint->callInfo, SCCP_CALLINFO_CALLEDPARTY_NAME, "Alice", SCCP_CALLINFO_CALLEDPARTY_NUMBER, "100", SCCP_CALLINFO_KEY_SENTINEL);
+	sccp_hint_testState(hint, AST_EXTENSION_NOT_INUSE);
+	pbx_test_validate_cleanup(test, hint->fanouts == 2 && hint->fanoutNotifications == 4 && hint->unchangedStateEvents == 1, res, cleanup);
+	pbx_test_validate_cleanup(test, sccp_strequals(hint->lastCidName, "Alice") && sccp_strequals(hint->lastCidNumber, "100"), res, cleanup);
+	sccp_hint_testState(hint, AST_EXTENSION_NOT_INUSE);
+	pbx_test_validate_cleanup(test, hint->fanouts == 2 && hint->unchangedStateEvents == 2, res, cleanup);
+	iCallInfo.Setter(hint->callInfo, SCCP_CALLINFO_PRESENTATION, CALLERID_PRESENTATION_FORBIDDEN, SCCP_CALLINFO_KEY_SENTINEL);
+	sccp_hint_testState(hint, AST_EXTENSION_NOT_INUSE);
+	pbx_test_validate_cleanup(test, hint->fanouts == 3 && hint->lastPresentation == CALLERID_PRESENTATION_FORBIDDEN && hint->unchangedStateEvents == 2, res, cleanup);
+
+	pbx_test_status_update(test, "A state change with the same callerid is sent\n");
+	sccp_hint_testState(hint, AST_EXTENSION_BUSY);
+	pbx_test_validate_cleanup(test, hint->fanouts == 4 && hint->fanoutNotifications == 8 && hint->currentState == SCCP_CHANNELSTATE_BUSY, res, cleanup);
+
+cleanup:
+	GLOB(hint_debounce) = debounce;
+	sccp_hint_testUnsubscribeAll(hint);
+	sccp_hint_unref(hint);
+	return res;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_hint_debounce);
+	AST_TEST_REGISTER(sccp_hint_fanout);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_hint_debounce);
+	AST_TEST_UNREGISTER(sccp_hint_fanout);
+}
+#endif
+
 // kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
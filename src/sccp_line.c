@@ -67,6 +67,17 @@ void sccp_line_post_reload(void)
 	sccp_line_t *line = NULL;
 
 	SCCP_RWLIST_TRAVERSE_SAFE_BEGIN(&GLOB(lines), line, list) {
+		if (line->pendingLiveUpdate && !line->pendingDelete && !line->pendingUpdate) {
+			// only label/description changed, let the devices refresh their line buttons
+			sccp_linedevice_t * ld = NULL;
+			SCCP_LIST_LOCK(&line->devices);
+			SCCP_LIST_TRAVERSE(&line->devices, ld, list) {
+				sccp_device_addLiveUpdate(ld->device, SCCP_DEVICE_LIVEUPDATE_LINES);
+				sccp_log((DEBUGCAT_CONFIG + DEBUGCAT_LINE))(VERBOSE_PREFIX_3 "%s: LineDevice (line_post_reload) live update on device:%s\n", line->name, ld->device->id);
+			}
+			SCCP_LIST_UNLOCK(&line->devices);
+		}
+		line->pendingLiveUpdate = FALSE;
 		if (!line->pendingDelete && !line->pendingUpdate) {
 			continue;
 		}
@@ -113,8 +124,17 @@ linePtr sccp_line_create(const char * name)
 		sccp_line_release(&l);						/* explicit release of found line */
 		return NULL;
 	}
-	
-	l = (sccp_line_t *) sccp_refcount_object_alloc(sizeof(sccp_line_t), SCCP_REF_LINE, name, __sccp_line_destroy);
+	return sccp_line_alloc(name);
+}
+
+/*!
+ * \brief Allocate a new SCCP Line, without checking the global line list for an existing line by the same name
+ *
+ * \note only to be used when the caller already knows the line does not exist (i.e. sccp_config_readDevicesLines' name index)
+ */
+linePtr sccp_line_alloc(const char * name)
+{
+	sccp_line_t *l = (sccp_line_t *) sccp_refcount_object_alloc(sizeof(sccp_line_t), SCCP_REF_LINE, name, __sccp_line_destroy);
 	if (!l) {
 		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, name);
 		return NULL;
@@ -102,6 +102,7 @@ struct sccp_line {
 	/* this is for reload routines */
 	boolean_t pendingDelete;										/*!< this bit will tell the scheduler to delete this line when unused */
 	boolean_t pendingUpdate;										/*!< this bit will tell the scheduler to update this line when unused */
+	boolean_t pendingLiveUpdate;										/*!< this bit will push the changed label/description to the devices using this line */
 };														/*!< SCCP Line Structure */
 
 /*!
@@ -118,6 +119,7 @@ SCCP_API void SCCP_CALL sccp_line_post_reload(void);
 /* live cycle */
 SCCP_API void * SCCP_CALL sccp_create_hotline(void);
 SCCP_API linePtr SCCP_CALL sccp_line_create(const char * name);
+SCCP_API linePtr SCCP_CALL sccp_line_alloc(const char * name);
 SCCP_API void SCCP_CALL sccp_line_addToGlobals(constLinePtr line);
 SCCP_API void SCCP_CALL sccp_line_removeFromGlobals(sccp_line_t * line);
 SCCP_API void SCCP_CALL sccp_line_addChannel(constLinePtr line, constChannelPtr channel);
@@ -0,0 +1,312 @@
+/*!
+ * \file        sccp_lockprofile.c
+ * \brief       SCCP Lock Contention Profiling
+ * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *              See the LICENSE file at the top of the source tree.
+ *
+ * Every lock call site gets a slot in a fixed size, lock-free hash table keyed by file/line. A lock attempt first tries
+ * to get the lock without blocking; only when that fails the site is counted as contended and the blocking wait is timed.
+ * The time the lock is held is measured from acquisition to the matching unlock by the same thread and attributed to the
+ * acquiring site (note: this includes the time spent inside a condition wait on that lock).
+ *
+ * Only built into the wrappers when configured with --enable-lock-profile, so the production lock path stays untouched
+ * otherwise. Asterisk's DEBUG_THREADS is not required.
+ */
+
+#include "config.h"
+#include "common.h"
+#include "sccp_lockprofile.h"
+
+SCCP_FILE_VERSION(__FILE__, "");
+
+#include "sccp_utils.h"
+
+#if CS_LOCK_PROFILE
+typedef struct sccp_lockprofile_site {
+	volatile int state;											/*!< 0: free, 1: being claimed, 2: ready */
+	const char * file;
+	int line;
+	const char * function;
+	const char * name;
+	sccp_lockprofile_type_t type;
+	volatile uint64_t acquired;
+	volatile uint64_t contended;
+	volatile uint64_t wait_total;										/*!< nsec */
+	volatile uint64_t wait_max;
+	volatile uint64_t hold_total;										/*!< nsec */
+	volatile uint64_t hold_max;
+} sccp_lockprofile_site_t;
+
+typedef struct sccp_lockprofile_held {
+	uint32_t depth;
+	struct {
+		const void * lock;
+		sccp_lockprofile_site_t * site;
+		uint64_t acquired;
+	} entries[SCCP_LOCKPROFILE_MAXHELD];
+} sccp_lockprofile_held_t;
+
+static sccp_lockprofile_site_t lockprofile_sites[SCCP_LOCKPROFILE_SITES];
+static sccp_lockprofile_site_t lockprofile_overflow = { 2, "overflow", 0, "", "(site table full)", SCCP_LOCKPROFILE_MUTEX, 0, 0, 0, 0, 0, 0 };
+AST_THREADSTORAGE(lockprofile_held_buf);
+
+static inline uint64_t lockprofile_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline void lockprofile_max(volatile uint64_t * max, uint64_t value)
+{
+	uint64_t current = *max;
+
+	while (value > current && !__sync_bool_compare_and_swap(max, current, value)) {
+		current = *max;
+	}
+}
+
+/*!
+ * \brief Find or claim the slot for a lock site
+ */
+static sccp_lockprofile_site_t * lockprofile_getSite(sccp_lockprofile_type_t type, const char * file, int line, const char * function, const char * name)
+{
+	uint32_t hash = (uint32_t)(((uintptr_t)file >> 3) ^ ((uint32_t)line * 2654435761U));
+
+	for (uint32_t probe = 0; probe < SCCP_LOCKPROFILE_SITES; probe++) {
+		sccp_lockprofile_site_t * site = &lockprofile_sites[(hash + probe) & (SCCP_LOCKPROFILE_SITES - 1)];
+		if (site->state == 0 && __sync_bool_compare_and_swap(&site->state, 0, 1)) {
+			site->file = file;
+			site->line = line;
+			site->function = function;
+			site->name = name;
+			site->type = type;
+			__sync_synchronize();
+			site->state = 2;
+			return site;
+		}
+		while (site->state == 1) {									/* another thread is filling in this slot */
+			sched_yield();
+		}
+		if (site->line == line && (site->file == file || !strcmp(site->file, file))) {
+			return site;
+		}
+	}
+	return &lockprofile_overflow;
+}
+
+static inline int lockprofile_trylock(sccp_lockprofile_type_t type, void * lock)
+{
+	switch (type) {
+		case SCCP_LOCKPROFILE_RDLOCK:
+			return ast_rwlock_tryrdlock((ast_rwlock_t *)lock);
+		case SCCP_LOCKPROFILE_WRLOCK:
+			return ast_rwlock_trywrlock((ast_rwlock_t *)lock);
+		case SCCP_LOCKPROFILE_MUTEX:
+		default:
+			return ast_mutex_trylock((ast_mutex_t *)lock);
+	}
+}
+
+static inline int lockprofile_lock(sccp_lockprofile_type_t type, void * lock)
+{
+	switch (type) {
+		case SCCP_LOCKPROFILE_RDLOCK:
+			return ast_rwlock_rdlock((ast_rwlock_t *)lock);
+		case SCCP_LOCKPROFILE_WRLOCK:
+			return ast_rwlock_wrlock((ast_rwlock_t *)lock);
+		case SCCP_LOCKPROFILE_MUTEX:
+		default:
+			return ast_mutex_lock((ast_mutex_t *)lock);
+	}
+}
+
+static void lockprofile_acquired(sccp_lockprofile_site_t * site, const void * lock, uint64_t now)
+{
+	sccp_lockprofile_held_t * held = (sccp_lockprofile_held_t *)ast_threadstorage_get(&lockprofile_held_buf, sizeof(sccp_lockprofile_held_t));
+
+	__sync_fetch_and_add(&site->acquired, 1);
+	if (held && held->depth < SCCP_LOCKPROFILE_MAXHELD) {
+		held->entries[held->depth].lock = lock;
+		held->entries[held->depth].site = site;
+		held->entries[held->depth].acquired = now;
+		held->depth++;
+	}
+}
+
+int sccp_lockprofile_lock(sccp_lockprofile_type_t type, void * lock, const char * file, int line, const char * function, const char * name)
+{
+	sccp_lockprofile_site_t * site = lockprofile_getSite(type, file, line, function, name);
+	uint64_t now = 0;
+	int res = lockprofile_trylock(type, lock);
+
+	if (res == 0) {
+		now = lockprofile_now();
+	} else {
+		uint64_t start = lockprofile_now();
+		res = lockprofile_lock(type, lock);
+		now = lockprofile_now();
+		__sync_fetch_and_add(&site->contended, 1);
+		__sync_fetch_and_add(&site->wait_total, now - start);
+		lockprofile_max(&site->wait_max, now - start);
+	}
+	if (res == 0) {
+		lockprofile_acquired(site, lock, now);
+	}
+	return res;
+}
+
+int sccp_lockprofile_trylock(sccp_lockprofile_type_t type, void * lock, const char * file, int line, const char * function, const char * name)
+{
+	sccp_lockprofile_site_t * site = lockprofile_getSite(type, file, line, function, name);
+	int res = lockprofile_trylock(type, lock);
+
+	if (res == 0) {
+		lockprofile_acquired(site, lock, lockprofile_now());
+	} else {
+		__sync_fetch_and_add(&site->contended, 1);
+	}
+	return res;
+}
+
+int sccp_lockprofile_unlock(sccp_lockprofile_type_t type, void * lock)
+{
+	sccp_lockprofile_held_t * held = (sccp_lockprofile_held_t *)ast_threadstorage_get(&lockprofile_held_buf, sizeof(sccp_lockprofile_held_t));
+
+	if (held) {
+		for (int idx = (int)held->depth - 1; idx >= 0; idx--) {
+			if (held->entries[idx].lock == lock) {
+				sccp_lockprofile_site_t * site = held->entries[idx].site;
+				uint64_t hold = lockprofile_now() - held->entries[idx].acquired;
+				__sync_fetch_and_add(&site->hold_total, hold);
+				lockprofile_max(&site->hold_max, hold);
+				held->depth--;
+				memmove(&held->entries[idx], &held->entries[idx + 1], (held->depth - idx) * sizeof(held->entries[0]));
+				break;
+			}
+		}
+	}
+	if (type == SCCP_LOCKPROFILE_MUTEX) {
+		return ast_mutex_unlock((ast_mutex_t *)lock);
+	}
+	return ast_rwlock_unlock((ast_rwlock_t *)lock);
+}
+
+void sccp_lockprofile_reset(void)
+{
+	for (uint32_t idx = 0; idx < SCCP_LOCKPROFILE_SITES; idx++) {
+		sccp_lockprofile_site_t * site = &lockprofile_sites[idx];
+		site->acquired = site->contended = 0;
+		site->wait_total = site->wait_max = 0;
+		site->hold_total = site->hold_max = 0;
+	}
+	lockprofile_overflow.acquired = lockprofile_overflow.contended = 0;
+	lockprofile_overflow.wait_total = lockprofile_overflow.wait_max = 0;
+	lockprofile_overflow.hold_total = lockprofile_overflow.hold_max = 0;
+}
+
+static int lockprofile_compare(const void * a, const void * b)
+{
+	const sccp_lockprofile_site_t * site_a = *(const sccp_lockprofile_site_t * const *)a;
+	const sccp_lockprofile_site_t * site_b = *(const sccp_lockprofile_site_t * const *)b;
+
+	if (site_a->wait_total != site_b->wait_total) {
+		return site_a->wait_total < site_b->wait_total ? 1 : -1;
+	}
+	if (site_a->contended != site_b->contended) {
+		return site_a->contended < site_b->contended ? 1 : -1;
+	}
+	return site_a->hold_total < site_b->hold_total ? 1 : (site_a->hold_total > site_b->hold_total ? -1 : 0);
+}
+
+static const char * lockprofile_type2str(sccp_lockprofile_type_t type)
+{
+	switch (type) {
+		case SCCP_LOCKPROFILE_RDLOCK:
+			return "rd";
+		case SCCP_LOCKPROFILE_WRLOCK:
+			return "wr";
+		case SCCP_LOCKPROFILE_MUTEX:
+		default:
+			return "mutex";
+	}
+}
+#endif
+
+/*!
+ * \brief Show the most contended lock sites
+ * \param fd Fd as int
+ * \param totals Total number of lines as int
+ * \param s AMI Session
+ * \param m Message
+ * \param argc Argc as int
+ * \param argv[] Argv[] as char
+ * \return Result as int
+ *
+ * \called_from_asterisk
+ */
+int sccp_show_locks(int fd, sccp_cli_totals_t * totals, struct mansession * s, const struct message * m, int argc, char * argv[])
+{
+	int local_line_total = 0;
+#if CS_LOCK_PROFILE
+	sccp_lockprofile_site_t * sorted[SCCP_LOCKPROFILE_SITES + 1];
+	int limit = 20;
+	int nsites = 0;
+	int idx = 0;
+
+	if (argc == 4 && sccp_strcaseequals(argv[3], "reset")) {
+		sccp_lockprofile_reset();
+		CLI_AMI_OUTPUT(fd, s, "Lock statistics have been reset\n");
+		if (s) {
+			totals->lines = local_line_total;
+		}
+		return RESULT_SUCCESS;
+	}
+	if (argc == 4 && (sscanf(argv[3], "%d", &limit) != 1 || limit <= 0)) {
+		return RESULT_SHOWUSAGE;
+	}
+	for (idx = 0; idx < SCCP_LOCKPROFILE_SITES; idx++) {
+		if (lockprofile_sites[idx].state == 2 && lockprofile_sites[idx].acquired) {
+			sorted[nsites++] = &lockprofile_sites[idx];
+		}
+	}
+	if (lockprofile_overflow.acquired) {
+		sorted[nsites++] = &lockprofile_overflow;
+	}
+	qsort(sorted, nsites, sizeof(sorted[0]), lockprofile_compare);
+
+#define CLI_AMI_TABLE_NAME Locks
+#define CLI_AMI_TABLE_PER_ENTRY_NAME Lock
+#define CLI_AMI_TABLE_ITERATOR for (idx = 0; idx < nsites && idx < limit; idx++)
+#define CLI_AMI_TABLE_BEFORE_ITERATION											\
+		sccp_lockprofile_site_t *site = sorted[idx];								\
+		char location[48];											\
+		snprintf(location, sizeof(location), "%s:%d", site->file, site->line);
+#define CLI_AMI_TABLE_FIELDS 												\
+		CLI_AMI_TABLE_FIELD(Site,		"-32.32",	s,	32,	location)			\
+		CLI_AMI_TABLE_FIELD(Function,		"-30.30",	s,	30,	site->function)			\
+		CLI_AMI_TABLE_FIELD(Lock,		"-30.30",	s,	30,	site->name)			\
+		CLI_AMI_TABLE_FIELD(Type,		"-5.5",		s,	5,	lockprofile_type2str(site->type))	\
+		CLI_AMI_TABLE_FIELD(Acquired,		"10",		lu,	10,	(unsigned long)site->acquired)	\
+		CLI_AMI_TABLE_FIELD(Contended,		"9",		lu,	9,	(unsigned long)site->contended)	\
+		CLI_AMI_TABLE_FIELD(WaitTotalMs,	"11",		lu,	11,	(unsigned long)(site->wait_total / 1000000))	\
+		CLI_AMI_TABLE_FIELD(WaitMaxUs,		"9",		lu,	9,	(unsigned long)(site->wait_max / 1000))	\
+		CLI_AMI_TABLE_FIELD(HoldAvgUs,		"9",		lu,	9,	(unsigned long)(site->acquired ? site->hold_total / site->acquired / 1000 : 0))	\
+		CLI_AMI_TABLE_FIELD(HoldMaxUs,		"9",		lu,	9,	(unsigned long)(site->hold_max / 1000))
+#include "sccp_cli_table.h"
+
+	if (s) {
+		totals->lines = local_line_total;
+		totals->tables = 1;
+	}
+#else
+	CLI_AMI_OUTPUT(fd, s, "Lock profiling is not available, reconfigure chan-sccp using --enable-lock-profile\n");
+	if (s) {
+		totals->lines = local_line_total;
+	}
+#endif
+	return RESULT_SUCCESS;
+}
+
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
@@ -0,0 +1,32 @@
+/*!
+ * \file        sccp_lockprofile.h
+ * \brief       SCCP Lock Contention Profiling Header
+ * \note        This program is free software and may be modified and distributed under the terms of the GNU Public License.
+ *              See the LICENSE file at the top of the source tree.
+ *
+ * When configured with --enable-lock-profile, pbx_mutex_* / pbx_rwlock_* (and therefor sccp_mutex_lock, SCCP_LIST_LOCK and
+ * SCCP_RWLIST_RDLOCK/WRLOCK) are routed through the functions below, which record acquisitions, contention, wait time and
+ * hold time per lock site (file:line of the lock call). Use "sccp show locks" to list the most contended sites.
+ */
+#pragma once
+#include "sccp_cli.h"
+
+#define SCCP_LOCKPROFILE_SITES 1024										/* power of 2 */
+#define SCCP_LOCKPROFILE_MAXHELD 32										/* locks held at the same time by one thread */
+
+__BEGIN_C_EXTERN__
+typedef enum {
+	SCCP_LOCKPROFILE_MUTEX,
+	SCCP_LOCKPROFILE_RDLOCK,
+	SCCP_LOCKPROFILE_WRLOCK,
+} sccp_lockprofile_type_t;
+
+#if CS_LOCK_PROFILE
+SCCP_API int SCCP_CALL sccp_lockprofile_lock(sccp_lockprofile_type_t type, void * lock, const char * file, int line, const char * function, const char * name);
+SCCP_API int SCCP_CALL sccp_lockprofile_trylock(sccp_lockprofile_type_t type, void * lock, const char * file, int line, const char * function, const char * name);
+SCCP_API int SCCP_CALL sccp_lockprofile_unlock(sccp_lockprofile_type_t type, void * lock);
+SCCP_API void SCCP_CALL sccp_lockprofile_reset(void);
+#endif
+SCCP_API int SCCP_CALL sccp_show_locks(int fd, sccp_cli_totals_t * totals, struct mansession * s, const struct message * m, int argc, char * argv[]);
+__END_C_EXTERN__
+// kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
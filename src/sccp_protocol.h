@@ -26,7 +26,7 @@ __BEGIN_C_EXTERN__
 
 #define DEFAULT_SCCP_PORT				2000							/*!< SCCP uses port 2000. */
 #define DEFAULT_SCCP_SECURE_PORT			2443							/*!< SCCP secure port 2443. */
-#define DEFAULT_SCCP_BACKLOG				16							/*!< the listen baklog. */
+#define DEFAULT_SCCP_BACKLOG				128							/*!< the listen baklog (when not configured). */
 #define SCCP_MAX_AUTOLOGIN				100							/*!< Maximum allowed of autologins per device */
 #define SCCP_MIN_KEEPALIVE				30							/*!< Minimal keepalive time if not specified in sccp.conf. */
 
@@ -15,13 +15,16 @@
 SCCP_FILE_VERSION(__FILE__, "");
 
 #include "sccp_actions.h"
+#include "sccp_capture.h"
 #include "sccp_cli.h"
 #include "sccp_device.h"
 #include "sccp_netsock.h"
 #include "sccp_utils.h"
 #include "sccp_transport.h"
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/un.h>
+#include <fcntl.h>
 
 #ifndef CS_USE_POLL_COMPAT
 #include <poll.h>
@@ -45,12 +48,14 @@ SCCP_FILE_VERSION(__FILE__, "");
 // static pthread_t accept_tid;
 // static int accept_sock = -1;
 
-#define WRITE_BACKOFF 500											/* backoff time in millisecs, doubled every write retry (150+300+600+1200+2400+4800 = 9450 millisecs = 9.5 sec) */
 #define SESSION_DEVICE_CLEANUP_TIME 10										/* wait time before destroying a device on thread exit */
 #define KEEPALIVE_ADDITIONAL_PERCENT_SESSION 1.05								/* extra time allowed for device keepalive overrun (percentage of GLOB(keepalive)) */
 #define KEEPALIVE_ADDITIONAL_PERCENT_DEVICE 1.20								/* extra time allowed for device keepalive overrun (percentage of GLOB(keepalive)) */
 #define KEEPALIVE_ADDITIONAL_PERCENT_ON_CALL 2.00								/* extra time allowed for device keepalive overrun (percentage of GLOB(keepalive)) */
 #define SESSION_REQUEST_TIMEOUT              5
+#define SESSION_HANDSHAKE_TIMEOUT            10									/* max seconds a transport handshake (tls) may take, before the connection is dropped */
+#define SESSION_MAX_ACCEPTORS                16									/* max number of listening sockets / accept threads per server context */
+#define SESSION_FLUSH_TIMEOUT                1000								/* max millisecs spent flushing call control (reset / reject) to a stopping session */
 
 /* Lock Macro for Sessions */
 #define sccp_session_lock(x)			pbx_mutex_lock(&(x)->lock)
@@ -63,18 +68,86 @@ void sccp_session_device_thread_exit(void *session);
 void *sccp_session_device_thread(void *session);
 void __sccp_session_stopthread(sessionPtr session, skinny_registrationstate_t newRegistrationState);
 gcc_inline void recalc_wait_time(sccp_session_t *s);
+static ssize_t session_writeBuffer(sccp_session_t * s, const uint8_t * bufAddr, ssize_t bufLen);
+static void session_setup(sccp_session_t * s);
+static boolean_t session_enqueue(sccp_session_t * s, sccp_msg_t * msg, const uint8_t * bufAddr, ssize_t bufLen, uint32_t msgid, const struct timeval * start, boolean_t pinned);
+static void session_drainLanes(sccp_session_t * s);
+static void session_writable(sccp_session_t * s);
+static boolean_t session_checkStalled(sccp_session_t * s);
+static void session_flushCallControl(sccp_session_t * s);
+static uint32_t session_queueDepth(sccp_session_t * s);
 static struct ast_sockaddr internip;
+static uint32_t sessionCount = 0;
+AST_MUTEX_DEFINE_STATIC(sessionCountLock);
+
+/*!
+ * \brief Connection setup statistics per server context type
+ * latency histogram buckets: <10ms, <50ms, <250ms, <1000ms, >=1000ms
+ */
+static struct {
+	const char * name;
+	uint32_t denied;											/*!< Rejected by the deny/permit acl, before any handshake */
+	uint32_t attempts;
+	uint32_t inProgress;
+	uint32_t succeeded;
+	uint32_t resumed;											/*!< Succeeded by resuming a previous (tls) session */
+	uint32_t failed;
+	uint32_t timedout;
+	uint64_t latencyTotal;
+	uint64_t resumedLatencyTotal;
+	uint32_t latencyMax;
+	uint32_t latency[5];
+} handshakeStats[] = {
+	[SCCP_SERVERCONTEXT_TCP] = { .name = "TCP" },
+#ifdef HAVE_LIBSSL
+	[SCCP_SERVERCONTEXT_TLS] = { .name = "TLS" },
+#endif
+};
+AST_MUTEX_DEFINE_STATIC(handshakeStatsLock);
+
+/*!
+ * \brief Acceptor: one listening socket and the thread accepting on it
+ * With more than one acceptor per server context, every acceptor has it's own SO_REUSEPORT socket bound to the same address,
+ * and the kernel distributes incoming connections between them.
+ */
+typedef struct sccp_acceptor {
+	sccp_servercontext_t * context;
+	sccp_socket_connection_t sc;
+	pthread_t tid;
+	uint32_t accepted;
+	uint32_t errors;
+} sccp_acceptor_t;
 
 struct sccp_servercontext {
 	sccp_servercontexttype_t type;
 	const sccp_transport_t * transport;
 	struct sockaddr_storage boundaddr;
-	pthread_t accept_tid;
-	sccp_socket_connection_t sc;
+	int backlog;
+	uint8_t numAcceptors;
+	sccp_acceptor_t acceptors[SESSION_MAX_ACCEPTORS];
 	boolean_t (*bind_and_listen)(sccp_servercontext_t * context, struct sockaddr_storage * bindaddr);
 	int (*stopListening)(sccp_servercontext_t * context);
 };
 
+static gcc_inline boolean_t servercontext_isListening(const sccp_servercontext_t * context)
+{
+	return context->acceptors[0].sc.fd > -1;
+}
+
+static gcc_inline int servercontext_configuredBacklog(void)
+{
+	return GLOB(listen_backlog) ? (int)GLOB(listen_backlog) : DEFAULT_SCCP_BACKLOG;
+}
+
+static gcc_inline uint8_t servercontext_configuredAcceptors(void)
+{
+#ifdef SO_REUSEPORT
+	return GLOB(accept_threads) < 1 ? 1 : GLOB(accept_threads) > SESSION_MAX_ACCEPTORS ? SESSION_MAX_ACCEPTORS : (uint8_t)GLOB(accept_threads);
+#else
+	return 1;
+#endif
+}
+
 sccp_servercontext_t * sccp_servercontext_create(struct sockaddr_storage * bindaddr, sccp_servercontexttype_t type)
 {
 	sccp_servercontext_t * context = NULL;
@@ -104,8 +177,11 @@ sccp_servercontext_t * sccp_servercontext_create(struct sockaddr_storage * binda
 	}
 	context->bind_and_listen = sccp_session_bind_and_listen;
 	context->stopListening = sccp_servercontext_stopListening;
-	context->sc.fd = -1;
-	context->accept_tid = AST_PTHREADT_NULL;
+	for (int idx = 0; idx < SESSION_MAX_ACCEPTORS; idx++) {
+		context->acceptors[idx].context = context;
+		context->acceptors[idx].sc.fd = -1;
+		context->acceptors[idx].tid = AST_PTHREADT_NULL;
+	}
 	return sccp_servercontext_reload(context, bindaddr) ? context : NULL;
 }
 
@@ -131,9 +207,19 @@ int sccp_servercontext_destroy(sccp_servercontext_t * context)
 
 int sccp_servercontext_reload(sccp_servercontext_t * context, struct sockaddr_storage * bindaddr)
 {
-	if(context->sc.fd > -1 && (sccp_netsock_getPort(&context->boundaddr) != sccp_netsock_getPort(bindaddr) || sccp_netsock_cmp_addr(&context->boundaddr, bindaddr))) {
+	if(servercontext_isListening(context)
+	   && (sccp_netsock_getPort(&context->boundaddr) != sccp_netsock_getPort(bindaddr) || sccp_netsock_cmp_addr(&context->boundaddr, bindaddr) || context->numAcceptors != servercontext_configuredAcceptors())) {
 		sccp_session_stop_accept_thread(context);
 	}
+	if (servercontext_isListening(context) && context->backlog != servercontext_configuredBacklog()) {
+		/* a listening socket accepts a new backlog without having to be re-created (dropping queued connections) */
+		context->backlog = servercontext_configuredBacklog();
+		for (int idx = 0; idx < context->numAcceptors; idx++) {
+			if (context->transport->listen(&context->acceptors[idx].sc, context->backlog)) {
+				pbx_log(LOG_WARNING, "SCCP: Failed to change listen backlog on socket:%d to %d: %s\n", context->acceptors[idx].sc.fd, context->backlog, strerror(errno));
+			}
+		}
+	}
 	return context->bind_and_listen(context, bindaddr);
 }
 
@@ -142,6 +228,33 @@ const struct sockaddr_storage * const sccp_servercontext_getBoundAddr(sccp_serve
 	return context ? &context->boundaddr : NULL;
 }
 
+/*!
+ * \brief Outbound message priority lanes, a lane is only drained when all lanes before it are empty
+ */
+typedef enum {
+	SESSION_LANE_CALLCONTROL,										/*!< call state, media setup and everything not classified below */
+	SESSION_LANE_UI,											/*!< status updates: blf / feature, speeddial, line, forward and notify prompts */
+	SESSION_LANE_BULK,											/*!< user to device data (chunked xml pushes) */
+	SESSION_LANE_SENTINEL,
+} session_lane_t;
+
+static const char * const session_lane2str[SESSION_LANE_SENTINEL] = { "CallControl", "UI", "Bulk" };
+
+/*!
+ * \brief Encoded message waiting in one of the session lanes
+ */
+typedef struct session_outmsg session_outmsg_t;
+struct session_outmsg {
+	SCCP_LIST_ENTRY (session_outmsg_t) list;
+	sccp_msg_t * msg;											/*!< Owned message (freed after the write), NULL for a static preencoded buffer */
+	const uint8_t * bufAddr;
+	ssize_t bufLen;
+	uint32_t msgid;
+	struct timeval queued;
+	struct timeval start;											/*!< Message statistics start (zero when message_stats is off) */
+	boolean_t pinned;											/*!< Must reach the device as is: never replaced by a later update for the same button */
+};
+
 /*!
  * \brief SCCP Session Structure
  * \note This contains the current session the phone is in
@@ -157,14 +270,34 @@ struct sccp_session {
 	struct sockaddr_storage sin;										/*!< Incoming Socket Address */
 	uint32_t protocolType;
 	volatile boolean_t session_stop;									/*!< Signal Session Stop */
-	sccp_mutex_t write_lock;										/*!< Prevent multiple threads writing to the socket at the same time */
+	sccp_mutex_t write_lock;										/*!< Held by the thread draining the lanes, only that thread writes to the socket */
+	session_outmsg_t * inflight;										/*!< Message partially written when the socket stopped accepting data (write_lock) */
+	ssize_t inflightSent;
+	volatile time_t writeBlockedSince;									/*!< When the socket stopped accepting data, 0 while it is writable */
+	volatile boolean_t writeFailed;										/*!< Socket write error, nothing more can be sent */
+	int wakeFd[2];												/*!< Pipe waking up the session thread, to wait for the socket to become writable */
 	sccp_mutex_t lock;											/*!< Asterisk: Lock Me Up and Tie me Down */
 	pthread_t session_thread;										/*!< Session Thread */
+	uint32_t id;												/*!< Unique Session Id (used in traffic captures) */
 	struct sockaddr_storage ourip;										/*!< Our IP is for rtp use */
 	struct sockaddr_storage ourIPv4;
 	char designator[40];
 	uint16_t requestsInFlight;
 	pbx_cond_t pendingRequest;
+	uint32_t keepAlivesFastPath;										/*!< KeepAlives answered directly by the session reader */
+	sccp_session_t * ptrNext;										/*!< Session Registry: next in pointer hash bucket */
+	sccp_session_t ** ptrPprev;										/*!< Session Registry: link pointing at us in pointer hash bucket */
+	sccp_session_t * addrNext;										/*!< Session Registry: next in remote address hash bucket */
+	sccp_session_t ** addrPprev;										/*!< Session Registry: link pointing at us in remote address hash bucket */
+	struct {
+		SCCP_LIST_HEAD (, session_outmsg_t) queue;							/*!< Messages waiting to be written, protected by the list lock */
+		uint32_t sent;
+		uint64_t delayTotal;										/*!< Accumulated queueing delay (usecs) */
+		uint32_t delayMax;										/*!< Longest queueing delay (usecs) */
+		uint32_t peak;											/*!< Highest depth seen */
+		uint32_t overflow;										/*!< Queued while the session was above the high-water mark */
+		uint32_t coalesced;										/*!< Replaced a queued update for the same button / prompt */
+	} lanes[SESSION_LANE_SENTINEL];
 };														/*!< SCCP Session Structure */
 
 int sccp_session_getFD(sccp_session_t * s)
@@ -401,6 +534,48 @@ static gcc_inline int session_buffer2msg(sccp_session_t * s, const unsigned char
 	return res;
 }
 
+/*!
+ * \brief Preencoded KeepAliveAck (length:4, protocolVer:0, messageId:KeepAliveAckMessage), little endian on the wire
+ */
+static const uint8_t keepAliveAck[SCCP_PACKET_HEADER] = {
+	0x04, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00,
+	KeepAliveAckMessage & 0xFF, (KeepAliveAckMessage >> 8) & 0xFF, 0x00, 0x00,
+};
+
+/*!
+ * \brief Answer a KeepAlive frame straight from the receive buffer, without decoding it into a message and entering the dispatcher
+ * \param s SCCP Session
+ * \param buffer Receive buffer, starting at the frame header
+ * \param payload_len Size of the complete frame
+ * \return TRUE when the frame was handled (or the session is going down), FALSE when it has to take the normal path
+ *
+ * \note Falls back to the normal path when the frame has to be visible elsewhere: message debugging, message statistics or a traffic capture.
+ */
+static gcc_inline boolean_t session_fastpath_keepalive(sccp_session_t * s, const unsigned char * const buffer, uint32_t payload_len)
+{
+	uint32_t messageId = 0;
+
+	if (payload_len != SCCP_PACKET_HEADER) {
+		return FALSE;
+	}
+	memcpy(&messageId, buffer + 8, 4);
+	if (letohl(messageId) != KeepAliveMessage) {
+		return FALSE;
+	}
+	if ((GLOB(debug) & DEBUGCAT_MESSAGE) != 0 || GLOB(message_stats) || (s->device && sccp_capture_isActive(s->device->id))) {
+		return FALSE;
+	}
+	if (session_enqueue(s, NULL, keepAliveAck, sizeof(keepAliveAck), KeepAliveAckMessage, NULL, FALSE)) {
+		session_drainLanes(s);
+		if (!s->session_stop) {
+			s->lastKeepAlive = time(0);
+			s->keepAlivesFastPath++;
+		}
+	}
+	return TRUE;
+}
+
 static gcc_inline int process_buffer(sccp_session_t * s, sccp_msg_t * msg, unsigned char * const buffer, size_t * len)
 {
 	int res = 0;
@@ -417,6 +592,14 @@ static gcc_inline int process_buffer(sccp_session_t * s, sccp_msg_t * msg, unsig
 			res = -1;
 			break;
 		}
+		if (session_fastpath_keepalive(s, buffer, payload_len)) {
+			*len -= payload_len;
+			if (*len > 0) {
+				memmove(buffer + 0, buffer + payload_len, *len);
+			}
+			continue;
+		}
+		sccp_capture_inbound(s->device ? s->device->id : NULL, s->id, buffer, payload_len);			// before dispatching, so it precedes its replies
 		if (dont_expect(session_buffer2msg(s, buffer, payload_len, msg) != 0)) {
 			res = -2;
 			break;
@@ -430,49 +613,112 @@ static gcc_inline int process_buffer(sccp_session_t * s, sccp_msg_t * msg, unsig
 	return res;
 }
 
+/*
+ * Session Registry
+ * GLOB(sessions) stays the ordered list used for iteration. Next to it every registered session is linked into two hash tables
+ * (by session pointer and by remote address, port excluded), so that add, remove and lookups do not have to walk all sessions
+ * during a mass reconnect. Everything is protected by the GLOB(sessions) rwlock.
+ */
+#define SESSION_REGISTRY_BUCKETS 2048										/* power of 2 */
+static sccp_session_t * sessionsByPtr[SESSION_REGISTRY_BUCKETS];
+static sccp_session_t * sessionsByAddr[SESSION_REGISTRY_BUCKETS];
+
+static gcc_inline uint32_t session_registry_hashPtr(const sccp_session_t * s)
+{
+	uint64_t hash = (uint64_t)(uintptr_t)s;
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	return (uint32_t)hash & (SESSION_REGISTRY_BUCKETS - 1);
+}
+
+static uint32_t session_registry_hashAddr(const struct sockaddr_storage * sin)
+{
+	struct sockaddr_storage mapped;
+	const unsigned char * addr = NULL;
+	size_t len = 0;
+	uint32_t hash = 2166136261U;
+
+	if (sccp_netsock_ipv4_mapped(sin, &mapped)) {
+		sin = &mapped;
+	}
+	if (sin->ss_family == AF_INET) {
+		addr = (const unsigned char *)&((const struct sockaddr_in *)sin)->sin_addr;
+		len = sizeof(struct in_addr);
+	} else if (sin->ss_family == AF_INET6) {
+		addr = (const unsigned char *)&((const struct sockaddr_in6 *)sin)->sin6_addr;
+		len = sizeof(struct in6_addr);
+	}
+	while (len--) {
+		hash = (hash ^ *addr++) * 16777619U;
+	}
+	return hash & (SESSION_REGISTRY_BUCKETS - 1);
+}
+
+/* requires GLOB(sessions) lock */
+static gcc_inline boolean_t session_registry_contains(const sccp_session_t * s)
+{
+	sccp_session_t * session = NULL;
+
+	for (session = sessionsByPtr[session_registry_hashPtr(s)]; session; session = session->ptrNext) {
+		if (session == s) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 /*!
  * \brief Find Session in Globals Lists
  * \param s SCCP Session
  * \return boolean
  *
  * \lock
- *      - session
+ *      - sessions
  */
 static boolean_t sccp_session_findBySession(sccp_session_t * s)
 {
-	sccp_session_t * session = NULL;
 	boolean_t res = FALSE;
 
 	SCCP_RWLIST_RDLOCK(&GLOB(sessions));
-	SCCP_RWLIST_TRAVERSE(&GLOB(sessions), session, list) {
-		if (session == s) {
-			res = TRUE;
-			break;
-		}
-	}
+	res = session_registry_contains(s);
 	SCCP_RWLIST_UNLOCK(&GLOB(sessions));
 	return res;
 }
 
 /*!
  * \brief Add a session to the global sccp_sessions list
- * \param s SCCP Session
+ * \param s SCCP Session (remote address (sin) needs to be set)
  * \return boolean
  *
  * \lock
- *      - session
+ *      - sessions
  */
 static boolean_t sccp_session_addToGlobals(sccp_session_t * s)
 {
 	boolean_t res = FALSE;
 
 	if (s) {
-		if (!sccp_session_findBySession(s)) {;
-			SCCP_RWLIST_WRLOCK(&GLOB(sessions));
+		SCCP_RWLIST_WRLOCK(&GLOB(sessions));
+		if (!session_registry_contains(s)) {
+			sccp_session_t ** bucket = &sessionsByPtr[session_registry_hashPtr(s)];
+			if ((s->ptrNext = *bucket)) {
+				(*bucket)->ptrPprev = &s->ptrNext;
+			}
+			s->ptrPprev = bucket;
+			*bucket = s;
+
+			bucket = &sessionsByAddr[session_registry_hashAddr(&s->sin)];
+			if ((s->addrNext = *bucket)) {
+				(*bucket)->addrPprev = &s->addrNext;
+			}
+			s->addrPprev = bucket;
+			*bucket = s;
+
 			SCCP_LIST_INSERT_HEAD(&GLOB(sessions), s, list);
 			res = TRUE;
-			SCCP_RWLIST_UNLOCK(&GLOB(sessions));
 		}
+		SCCP_RWLIST_UNLOCK(&GLOB(sessions));
 	}
 	return res;
 }
@@ -487,19 +733,22 @@ static boolean_t sccp_session_addToGlobals(sccp_session_t * s)
  */
 static boolean_t sccp_session_removeFromGlobals(sccp_session_t * s)
 {
-	sccp_session_t * session = NULL;
 	boolean_t res = FALSE;
 
 	if (s) {
 		SCCP_RWLIST_WRLOCK(&GLOB(sessions));
-		SCCP_RWLIST_TRAVERSE_SAFE_BEGIN(&GLOB(sessions), session, list) {
-			if (session == s) {
-				SCCP_LIST_REMOVE_CURRENT(list);
-				res = TRUE;
-				break;
+		if (session_registry_contains(s)) {
+			if ((*s->ptrPprev = s->ptrNext)) {
+				s->ptrNext->ptrPprev = s->ptrPprev;
 			}
+			if ((*s->addrPprev = s->addrNext)) {
+				s->addrNext->addrPprev = s->addrPprev;
+			}
+			s->ptrNext = s->addrNext = NULL;
+			s->ptrPprev = s->addrPprev = NULL;
+			SCCP_LIST_REMOVE(&GLOB(sessions), s, list);
+			res = TRUE;
 		}
-		SCCP_RWLIST_TRAVERSE_SAFE_END;
 		SCCP_RWLIST_UNLOCK(&GLOB(sessions));
 	}
 	return res;
@@ -647,6 +896,8 @@ static void destroy_session(sccp_session_t * s)
 	
 	if (s) {
 		sccp_log((DEBUGCAT_SOCKET)) (VERBOSE_PREFIX_3 "SCCP: Destroy Session %s\n", addrStr);
+		session_flushCallControl(s);
+
 		/* closing fd's */
 		sccp_session_lock(s);
 		if(s->sc.fd > 0) {
@@ -658,6 +909,34 @@ static void destroy_session(sccp_session_t * s)
 		}
 		sccp_session_unlock(s);
 
+		/* dropping messages which never made it out */
+		session_outmsg_t * out = NULL;
+		pbx_mutex_lock(&s->write_lock);
+		if ((out = s->inflight)) {
+			s->inflight = NULL;
+			if (out->msg) {
+				sccp_free(out->msg);
+			}
+			sccp_free(out);
+		}
+		for (int lane = 0; lane < SESSION_LANE_SENTINEL; lane++) {
+			SCCP_LIST_LOCK(&s->lanes[lane].queue);
+			while ((out = SCCP_LIST_REMOVE_HEAD(&s->lanes[lane].queue, list))) {
+				if (out->msg) {
+					sccp_free(out->msg);
+				}
+				sccp_free(out);
+			}
+			SCCP_LIST_UNLOCK(&s->lanes[lane].queue);
+			SCCP_LIST_HEAD_DESTROY(&s->lanes[lane].queue);
+		}
+		pbx_mutex_unlock(&s->write_lock);
+		for (int idx = 0; idx < 2; idx++) {
+			if (s->wakeFd[idx] > -1) {
+				close(s->wakeFd[idx]);
+			}
+		}
+
 		/* destroying mutex and cleaning the session */
 		sccp_mutex_destroy(&s->lock);
 		sccp_mutex_destroy(&s->write_lock);
@@ -727,6 +1006,54 @@ gcc_inline void recalc_wait_time(sccp_session_t *s)
 	}
 }
 
+/*!
+ * \brief Run the transport handshake (if any) on the session thread, recording latency and failures
+ * \param s SCCP Session
+ * \return TRUE when the session can continue
+ */
+static boolean_t session_handshake(sccp_session_t * s)
+{
+	sccp_servercontext_t * context = s->srvcontext;
+	struct timeval start = pbx_tvnow();
+	char addrStr[INET6_ADDRSTRLEN];
+
+	pbx_mutex_lock(&handshakeStatsLock);
+	handshakeStats[context->type].attempts++;
+	handshakeStats[context->type].inProgress++;
+	pbx_mutex_unlock(&handshakeStatsLock);
+
+	int res = context->transport->handshake(&s->sc, SESSION_HANDSHAKE_TIMEOUT * 1000);
+	uint32_t elapsed = (uint32_t)ast_tvdiff_ms(pbx_tvnow(), start);
+
+	pbx_mutex_lock(&handshakeStatsLock);
+	handshakeStats[context->type].inProgress--;
+	if (res >= 0) {
+		handshakeStats[context->type].succeeded++;
+		handshakeStats[context->type].latencyTotal += elapsed;
+		if (res == 1) {
+			handshakeStats[context->type].resumed++;
+			handshakeStats[context->type].resumedLatencyTotal += elapsed;
+		}
+		if (elapsed > handshakeStats[context->type].latencyMax) {
+			handshakeStats[context->type].latencyMax = elapsed;
+		}
+		handshakeStats[context->type].latency[elapsed < 10 ? 0 : elapsed < 50 ? 1 : elapsed < 250 ? 2 : elapsed < 1000 ? 3 : 4]++;
+	} else if (res == -2) {
+		handshakeStats[context->type].timedout++;
+	} else {
+		handshakeStats[context->type].failed++;
+	}
+	pbx_mutex_unlock(&handshakeStatsLock);
+
+	sccp_copy_string(addrStr, sccp_netsock_stringify(&s->sin), sizeof(addrStr));
+	if (res < 0) {
+		pbx_log(LOG_NOTICE, "SCCP: %s handshake with %s %s after %u ms, closing connection\n", context->transport->name, addrStr, res == -2 ? "timed out" : "failed", elapsed);
+		return FALSE;
+	}
+	sccp_log((DEBUGCAT_SOCKET))(VERBOSE_PREFIX_3 "SCCP: %s handshake with %s completed in %u ms%s\n", context->transport->name, addrStr, elapsed, res == 1 ? " (resumed)" : "");
+	return TRUE;
+}
+
 /*!
  * \brief Socket Device Thread
  * \param session SCCP Session
@@ -745,6 +1072,7 @@ void *sccp_session_device_thread(void *session)
 
 	boolean_t oncall = TRUE;
 	boolean_t tokenThread = FALSE;
+	boolean_t moreData = FALSE;										/* last recv filled the buffer, the transport may hold more */
 	unsigned char recv_buffer[SCCP_MAX_PACKET * 2] = "";
 	size_t recv_len = 0;
 	sccp_msg_t msg = { {0,} };
@@ -753,10 +1081,18 @@ void *sccp_session_device_thread(void *session)
 	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
 	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
 
-	struct pollfd fds[1] = { { 0 } };
+	struct pollfd fds[2] = { { 0 } };
 	fds[0].events = POLLIN | POLLPRI;
 	fds[0].revents = 0;
 	fds[0].fd = s->sc.fd;
+	fds[1].events = POLLIN;											/* wakeup: a writer found the socket buffer full */
+	fds[1].revents = 0;
+	fds[1].fd = s->wakeFd[0];
+
+	session_setup(s);
+	if (s->srvcontext->transport->handshake && !session_handshake(s)) {
+		s->session_stop = TRUE;
+	}
 
 	while(s->sc.fd > 0 && !s->session_stop) {
 		if (s->device) {
@@ -773,6 +1109,14 @@ void *sccp_session_device_thread(void *session)
 					continue;
 				}
 			}
+			if (d->pendingLiveUpdate && !d->active_channel) {
+				pbx_rwlock_rdlock(&GLOB(lock));
+				boolean_t reload_in_progress = GLOB(reload_in_progress);
+				pbx_rwlock_unlock(&GLOB(lock));
+				if (reload_in_progress == FALSE) {
+					sccp_device_apply_liveupdate(d);
+				}
+			}
 			if ((d->active_channel ? TRUE : FALSE) != oncall) {
 				recalc_wait_time(s);
 				oncall = (d->active_channel) ? TRUE : FALSE;
@@ -781,10 +1125,22 @@ void *sccp_session_device_thread(void *session)
 				tokenThread = TRUE;								// only does TCP-Keepalive
 			}
 		}
+		if (session_checkStalled(s)) {
+			break;
+		}
+		time_t blockedSince = s->writeBlockedSince;
+		fds[0].events = POLLIN | POLLPRI | (blockedSince ? POLLOUT : 0);
 		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 		sccp_log_and((DEBUGCAT_SOCKET + DEBUGCAT_HIGH))(VERBOSE_PREFIX_4 "%s: set poll timeout %d for session %d\n", DEV_ID_LOG(s->device), (int)s->keepAliveInterval, fds[0].fd);
 
-		res = sccp_netsock_poll(fds, 1, s->keepAliveInterval * 1000);
+		if (moreData) {
+			res = 1;										/* don't wait for the fd, data may already be buffered/decrypted by the transport */
+			fds[0].revents = POLLIN;
+			fds[1].revents = 0;
+		} else {
+			res = sccp_netsock_poll(fds, fds[1].fd > -1 ? 2 : 1, blockedSince ? 1000 : s->keepAliveInterval * 1000);	/* wake up every second to check for a stalled device */
+		}
+		moreData = FALSE;
 		pthread_testcancel();
 		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
 		if (-1 == res) {										/* poll data processing */
@@ -802,26 +1158,39 @@ void *sccp_session_device_thread(void *session)
 				break;
 			}
 		} else if (res > 0) {										/* poll data processing */
+			if (fds[1].revents & POLLIN) {
+				char drain[16];
+				while (read(fds[1].fd, drain, sizeof(drain)) > 0) {
+				}
+			}
+			if (fds[0].revents & POLLOUT) {
+				session_writable(s);
+			}
 			if(fds[0].revents & POLLIN || fds[0].revents & POLLPRI) {                               /* POLLIN | POLLPRI */
 				// sccp_log_and((DEBUGCAT_SOCKET + DEBUGCAT_HIGH)) (VERBOSE_PREFIX_2 "%s: Session New Data Arriving at buffer position:%lu\n", DEV_ID_LOG(s->device), recv_len);
-				int result       = s->srvcontext->transport->recv(&s->sc, recv_buffer + recv_len, (ARRAY_LEN(recv_buffer) * sizeof(unsigned char)) - recv_len, 0);
+				size_t space     = (ARRAY_LEN(recv_buffer) * sizeof(unsigned char)) - recv_len;
+				int result       = s->srvcontext->transport->recv(&s->sc, recv_buffer + recv_len, space, 0);
 				s->lastKeepAlive = time(0);
-				if (result <= 0) {
-					if (result < 0 || (errno != EINTR || errno != EAGAIN)) {
-						socket_get_error(s, __FILE__, __LINE__, __PRETTY_FUNCTION__);
+				if (result < 0 && (errno == EAGAIN || errno == EINTR)) {
+					// no complete (tls) record available yet, wait for more
+				} else if (result <= 0) {
+					socket_get_error(s, __FILE__, __LINE__, __PRETTY_FUNCTION__);
+					break;
+				} else {
+					recv_len += result;
+					moreData = ((size_t)result == space);
+					if (process_buffer(s, &msg, recv_buffer, &recv_len) != 0 || recv_len >= ARRAY_LEN(recv_buffer)) {
+						pbx_log(LOG_ERROR, "%s: (netsock_device_thread) Received a packet or message (with result:%d) which we could not handle, giving up session: %p!\n", s->designator, result, s);
+						sccp_dump_msg(&msg);
+						if (s->device) {
+							sccp_device_sendReset(s->device, SKINNY_RESETTYPE_RESTART);
+						}
+						__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
 						break;
 					}
-				} else if (!((recv_len += result) && ((ARRAY_LEN(recv_buffer) * sizeof(unsigned char)) - recv_len) && process_buffer(s, &msg, recv_buffer, &recv_len) == 0)) {
-					pbx_log(LOG_ERROR, "%s: (netsock_device_thread) Received a packet or message (with result:%d) which we could not handle, giving up session: %p!\n", s->designator, result, s);
-					sccp_dump_msg(&msg);
-					if (s->device) {
-						sccp_device_sendReset(s->device, SKINNY_RESETTYPE_RESTART);
-					}
-					__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
-					break;
 				}
 				s->lastKeepAlive = time(0);
-			} else { /* POLLHUP / POLLERR */
+			} else if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
 				pbx_log(LOG_NOTICE, "%s: Closing session because we received POLLPRI/POLLHUP/POLLERR\n", s->designator);
 				__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
 				break;
@@ -926,6 +1295,18 @@ static sccp_session_t * sccp_create_session(sccp_servercontext_t * context, sccp
 	sccp_mutex_init(&s->lock);
 	pbx_cond_init(&s->pendingRequest, NULL);
 	sccp_mutex_init(&s->write_lock);
+	for (int lane = 0; lane < SESSION_LANE_SENTINEL; lane++) {
+		SCCP_LIST_HEAD_INIT(&s->lanes[lane].queue);
+	}
+	if (pipe(s->wakeFd) || fcntl(s->wakeFd[0], F_SETFL, O_NONBLOCK) < 0 || fcntl(s->wakeFd[1], F_SETFL, O_NONBLOCK) < 0) {
+		pbx_log(LOG_WARNING, "SCCP: Failed to create session wakeup pipe: %s, a stalled device will only be retried on the next send\n", strerror(errno));
+		for (int idx = 0; idx < 2; idx++) {
+			if (s->wakeFd[idx] > 0) {
+				close(s->wakeFd[idx]);
+			}
+			s->wakeFd[idx] = -1;
+		}
+	}
 
 	s->sc.fd = sc->fd;
 	s->sc.ssl = sc->ssl;
@@ -933,6 +1314,10 @@ static sccp_session_t * sccp_create_session(sccp_servercontext_t * context, sccp
 	s->srvcontext = context;
 
 	s->lastKeepAlive = time(0);
+
+	sccp_mutex_lock(&sessionCountLock);
+	s->id = ++sessionCount;
+	sccp_mutex_unlock(&sessionCountLock);
 	
 	return s;
 }
@@ -965,37 +1350,54 @@ static boolean_t sccp_session_set_ourip(sccp_session_t * s)
 	return TRUE;
 }
 
+/*!
+ * \brief Per connection setup, run on the new session thread instead of the accept thread
+ * \param s SCCP Session
+ */
+static void session_setup(sccp_session_t * s)
+{
+	sccp_netsock_setoptions(s->sc.fd, /*reuse*/ -1, /*linger*/ 0, /*keepalive*/ -1, /*sndtimeout*/ -1, /*rcvtimeout*/ 0);
+	sccp_session_set_ourip(s);
+	sccp_session_addToGlobals(s);
+	recalc_wait_time(s);
+}
+
 /*!
  * Accept Thread
  * continuesly waits for devices trying to connect, when they do it
  * - checks if the incoming ip-address is within the global deny/permit range
  * - creates a new session struct
- * - adds the new session struct to the global sessions list
- * - starts a new sccp_session_device_thread
+ * - starts a new sccp_session_device_thread, which does the rest of the setup (see session_setup), so that this thread can
+ *   return to accepting the next connection as soon as possible
  */
 static void * accept_thread(void * data)
 {
-	sccp_servercontext_t * context = (sccp_servercontext_t *)data;
+	sccp_acceptor_t * acceptor = (sccp_acceptor_t *)data;
+	sccp_servercontext_t * context = acceptor->context;
 	sccp_socket_connection_t new_sc = { 0, 0 };
 	struct sockaddr_storage incoming;
 	sccp_session_t *s = NULL;
-	socklen_t length = (socklen_t)(sizeof(struct sockaddr_storage));
+	socklen_t length = 0;
 
 	while (GLOB(module_running)) {
 		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
 		pthread_testcancel();
 		memset(&new_sc, 0, sizeof(new_sc));
-		context->transport->accept(&context->sc, (struct sockaddr *)&incoming, &length, &new_sc);
+		length = (socklen_t)(sizeof(struct sockaddr_storage));
+		context->transport->accept(&acceptor->sc, (struct sockaddr *)&incoming, &length, &new_sc);
 		if(new_sc.fd < 0) {
-			pbx_log(LOG_ERROR, "Error accepting new socket %s on acceptFD:%d\n", strerror(errno), context->sc.fd);
+			acceptor->errors++;
+			pbx_log(LOG_ERROR, "Error accepting new socket %s on acceptFD:%d\n", strerror(errno), acceptor->sc.fd);
 			usleep(1000);
 			continue;
 		}
+		acceptor->accepted++;
 
 		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-		sccp_netsock_setoptions(new_sc.fd, /*reuse*/ -1, /*linger*/ 0, /*keepalive*/ -1, /*sndtimeout*/ -1, /*rcvtimeout*/ 0);
-
 		if (!sccp_session_new_socket_allowed(&incoming)) {
+			pbx_mutex_lock(&handshakeStatsLock);
+			handshakeStats[context->type].denied++;
+			pbx_mutex_unlock(&handshakeStatsLock);
 			context->transport->close(&new_sc);
 			continue;
 		}
@@ -1006,10 +1408,7 @@ static void * accept_thread(void * data)
 			continue;
 		}
 		memcpy(&s->sin, &incoming, sizeof(s->sin));
-		sccp_session_set_ourip(s);
-		sccp_session_addToGlobals(s);
-		recalc_wait_time(s);
-	
+
 		// Create a detached thread, since the sccp_session_device_thread will not be joined from another thread
 		// Only detached threads free their stack and control structures after termination, otherwise a pthread_join is mandatory for this to take place (davidded).
 		if (pbx_pthread_create_detached(&s->session_thread, NULL, sccp_session_device_thread, s)) {
@@ -1017,20 +1416,25 @@ static void * accept_thread(void * data)
 		}
 	}
 	context->transport->close(&new_sc);
-	if(context->sc.fd > -1) {
-		sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_3 "Closing Listening Port:%d\n", context->sc.fd);
-		context->transport->close(&context->sc);
-		context->sc.fd = -1;
+	if(acceptor->sc.fd > -1) {
+		sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_3 "Closing Listening Port:%d\n", acceptor->sc.fd);
+		context->transport->close(&acceptor->sc);
+		acceptor->sc.fd = -1;
 	}
 	return 0;
 }
 
 /*!
- * Start the session accept thread
+ * Start the session accept threads (one per listening socket)
  */
 static void sccp_session_start_accept_thread(sccp_servercontext_t * context)
 {
-	ast_pthread_create_background(&context->accept_tid, NULL, accept_thread, (void *)context);
+	for (int idx = 0; idx < context->numAcceptors; idx++) {
+		if (ast_pthread_create_background(&context->acceptors[idx].tid, NULL, accept_thread, (void *)&context->acceptors[idx])) {
+			pbx_log(LOG_ERROR, "SCCP: Unable to start accept thread %d for socket:%d\n", idx, context->acceptors[idx].sc.fd);
+			context->acceptors[idx].tid = AST_PTHREADT_NULL;
+		}
+	}
 }
 
 /*!
@@ -1041,18 +1445,22 @@ void sccp_session_stop_accept_thread(sccp_servercontext_t * context)
 {
 	sccp_log((DEBUGCAT_CORE)) (VERBOSE_PREFIX_3 "Stopping Accepting Thread\n");
 	pbx_rwlock_wrlock(&GLOB(lock));
-	if(context->accept_tid && (context->accept_tid != AST_PTHREADT_STOP)) {
-		if (pthread_cancel(context->accept_tid) != 0) {
-			pthread_kill(context->accept_tid, SIGURG);
+	for (int idx = 0; idx < SESSION_MAX_ACCEPTORS; idx++) {
+		sccp_acceptor_t * acceptor = &context->acceptors[idx];
+		if(acceptor->tid && acceptor->tid != AST_PTHREADT_NULL && acceptor->tid != AST_PTHREADT_STOP) {
+			if (pthread_cancel(acceptor->tid) != 0) {
+				pthread_kill(acceptor->tid, SIGURG);
+			}
+			pthread_join(acceptor->tid, NULL);
+		}
+		acceptor->tid = AST_PTHREADT_STOP;
+		if(acceptor->sc.fd > -1) {
+			sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_3 "Closing Listening Port:%d\n", acceptor->sc.fd);
+			context->transport->close(&acceptor->sc);
+			acceptor->sc.fd = -1;
 		}
-		pthread_join(context->accept_tid, NULL);
-	}
-	context->accept_tid = AST_PTHREADT_STOP;
-	if(context->sc.fd > -1) {
-		sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_3 "Closing Listening Port:%d\n", context->sc.fd);
-		context->transport->close(&context->sc);
-		context->sc.fd = -1;
 	}
+	context->numAcceptors = 0;
 	pbx_rwlock_unlock(&GLOB(lock));
 }
 
@@ -1084,10 +1492,12 @@ boolean_t sccp_session_bind_and_listen(sccp_servercontext_t * context, struct so
 	*/
 
 	sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_3 "Running bind and listen '%s'\n", addrStr);
-	if(context->sc.fd < 0) {
+	if(!servercontext_isListening(context)) {
 		int status = 0;
+		uint8_t numAcceptors = servercontext_configuredAcceptors();
 		port = sccp_netsock_getPort(bindaddr);
 		memcpy(&context->boundaddr, bindaddr, sizeof(struct sockaddr_storage));
+		context->backlog = servercontext_configuredBacklog();
 		char port_str[15] = "cisco-sccp";
 
 		struct addrinfo hints;
@@ -1107,44 +1517,61 @@ boolean_t sccp_session_bind_and_listen(sccp_servercontext_t * context, struct so
 			pbx_log(LOG_ERROR, "Failed to get addressinfo for %s:%s, error: %s!\n", sccp_netsock_stringify_addr(bindaddr), port_str, gai_strerror(status));
 			return FALSE;
 		}
-		do {
-			context->sc.fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-			if(context->sc.fd < 0) {
+		for (context->numAcceptors = 0; context->numAcceptors < numAcceptors; context->numAcceptors++) {
+			sccp_socket_connection_t * sc = &context->acceptors[context->numAcceptors].sc;
+			sc->fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+			if(sc->fd < 0) {
 				pbx_log(LOG_ERROR, "Unable to create SCCP socket: %s\n", strerror(errno));
 				break;
 			}
-			sccp_netsock_setoptions(context->sc.fd, /*reuse*/ 1, /*linger*/ -1, /*keepalive*/ -1, /*sndtimeout*/ 0, /*rcvtimeout*/ 0);
-			if(context->transport->bind(&context->sc, res->ai_addr, res->ai_addrlen) < 0) {
+			sccp_netsock_setoptions(sc->fd, /*reuse*/ 1, /*linger*/ -1, /*keepalive*/ -1, /*sndtimeout*/ 0, /*rcvtimeout*/ 0);
+#ifdef SO_REUSEPORT
+			if (numAcceptors > 1) {
+				int on = 1;
+				if (setsockopt(sc->fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+					pbx_log(LOG_WARNING, "SCCP: Failed to set SO_REUSEPORT on socket:%d (%s), using a single accept thread\n", sc->fd, strerror(errno));
+					numAcceptors = 1;
+				}
+			}
+#endif
+			if(context->transport->bind(sc, res->ai_addr, res->ai_addrlen) < 0) {
 				pbx_log(LOG_ERROR, "Failed to bind to %s:%d: %s!\n", addrStr, port, strerror(errno));
-				context->transport->close(&context->sc);
-				context->sc.fd = -1;
+				context->transport->close(sc);
+				sc->fd = -1;
 				break;
 			}
 
-			struct ast_sockaddr tmp_sa;
-			ast_sockaddr_copy(&internip, storage2ast_sockaddr(bindaddr, &tmp_sa));
-			if(ast_find_ourip(&internip, &tmp_sa, 0)) {
-				ast_log(LOG_ERROR, "Unable to get own IP address\n");
-				context->transport->close(&context->sc);
-				context->sc.fd = -1;
-				break;
+			if (context->numAcceptors == 0) {
+				struct ast_sockaddr tmp_sa;
+				ast_sockaddr_copy(&internip, storage2ast_sockaddr(bindaddr, &tmp_sa));
+				if(ast_find_ourip(&internip, &tmp_sa, 0)) {
+					ast_log(LOG_ERROR, "Unable to get own IP address\n");
+					context->transport->close(sc);
+					sc->fd = -1;
+					break;
+				}
 			}
 
-			if(listen(context->sc.fd, DEFAULT_SCCP_BACKLOG)) {
+			if(context->transport->listen(sc, context->backlog)) {
 				pbx_log(LOG_ERROR, "Failed to start listening to %s:%d: %s\n", addrStr, port, strerror(errno));
-				context->transport->close(&context->sc);
-				context->sc.fd = -1;
+				context->transport->close(sc);
+				sc->fd = -1;
 				break;
 			}
-			sccp_session_start_accept_thread(context);
-		} while(0);
+		}
 		freeaddrinfo(res);
+		if (context->numAcceptors > 0) {
+			if (context->numAcceptors < numAcceptors) {
+				pbx_log(LOG_WARNING, "SCCP: Only %d of %d listening sockets could be created on %s:%d\n", context->numAcceptors, numAcceptors, addrStr, port);
+			}
+			sccp_session_start_accept_thread(context);
+		}
 	} else {
 		sccp_log((DEBUGCAT_CORE)) (VERBOSE_PREFIX_3 "Socket has not changed so we are reusing it\n");
 	}
 
-	if(context->sc.fd > -1) {
-		sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_3 "SCCP: Listening on %s:%d using socket:%d\n", addrStr, port, context->sc.fd);
+	if(servercontext_isListening(context)) {
+		sccp_log((DEBUGCAT_CORE))(VERBOSE_PREFIX_3 "SCCP: Listening on %s:%d using socket:%d (accept threads:%d, backlog:%d)\n", addrStr, port, context->acceptors[0].sc.fd, context->numAcceptors, context->backlog);
 		sccp_log((DEBUGCAT_SOCKET))(VERBOSE_PREFIX_3 "SCCP: using default ip:%s\n", ast_sockaddr_stringify_addr(&internip));
 		result = TRUE;
 	}
@@ -1188,126 +1615,516 @@ int sccp_session_send(constDevicePtr device, const sccp_msg_t * msg_in)
 }
 
 /*!
- * \brief Socket Send Message
- * \param session Session SCCP Session (can't be null)
- * \param msg Message Data Structure (sccp_msg_t) (Will be freed automatically at the end)
- * \return Result as Int
+ * \brief Write as much of a buffer as the session socket accepts without blocking
+ * \param s SCCP Session (can't be null)
+ * \param bufAddr Encoded message
+ * \param bufLen Number of bytes to write
+ * \return Number of bytes written (less than bufLen when the socket would block), -1 on failure (in which case the session is being stopped)
  *
- * \lock
- *      - session
+ * \note Only called by the thread draining the lanes (holding write_lock)
  */
-int sccp_session_send2(constSessionPtr session, sccp_msg_t * msg)
+static ssize_t session_writeBuffer(sccp_session_t * s, const uint8_t * bufAddr, ssize_t bufLen)
 {
-	sessionPtr s = (sessionPtr)session;										/* discard const */
 	ssize_t res = 0;
-	uint32_t msgid = letohl(msg->header.lel_messageId);
 	ssize_t bytesSent = 0;
-	ssize_t bufLen = 0;
-	uint8_t * bufAddr = NULL;
-
-	if (s && s->session_stop) {
-		return -2;
-	}
 
-	if(!s || s->sc.fd <= 0) {
-		sccp_log((DEBUGCAT_HIGH)) (VERBOSE_PREFIX_3 "SCCP: Tried to send packet over DOWN device.\n");
-		if (s) {
+	do {
+		res = s->srvcontext->transport->send(&s->sc, (void *)(bufAddr + bytesSent), bufLen - bytesSent, MSG_DONTWAIT);			/* discard const */
+		if (res == 0) {
+			/* nothing written without an error being reported, errno is stale: treat as a connection that went away */
+			sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_3 "%s: Socket did not accept any data, closing connection\n", DEV_ID_LOG(s->device));
+			s->writeFailed = TRUE;
 			__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
+			return -1;
 		}
-		sccp_free(msg);
-		msg = NULL;
-		return -3;
-	}
-	if (msgid == KeepAliveAckMessage || msgid == RegisterAckMessage || msgid == UnregisterAckMessage) {
-		msg->header.lel_protocolVer = 0;
-	} else if (s->device && s->device->protocol) {
-		msg->header.lel_protocolVer = s->device->protocol->version < 10 ? 0 : htolel(s->device->protocol->version);
-	}
-
-	uint backoff = WRITE_BACKOFF;
-	bytesSent = 0;
-	bufAddr = ((uint8_t *) msg);
-	bufLen = (ssize_t) (letohl(msg->header.length) + 8);
-
-	struct messageinfo * msginfo = lookupMsgInfoStruct(msgid);
-	if(msginfo) {
-		if(msginfo->messageId != msgid) {
-			pbx_log(LOG_ERROR, "%s: (session_send2) messageId %d (0x%x) unknown. matched:0x%x discarding message.\n", DEV_ID_LOG(s->device), msgid, msgid, msginfo->messageId);
-			return -4;
-		}
-		if(msginfo->type == SKINNY_MSGTYPE_REQUEST) {
-			request_pending(s);
-			sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_3 "%s: Request '%s' to device Pending\n", DEV_ID_LOG(s->device), msginfo->text);
-		}
-		if((GLOB(debug) & DEBUGCAT_MESSAGE) != 0) {
-			pbx_log(LOG_NOTICE, "%s: Sending Message: %s(0x%04X) %d bytes length\n", DEV_ID_LOG(s->device), msginfo->text, msgid, msg->header.length);
-			sccp_dump_msg(msg);
-		}
-	}
-	do {
-		pbx_mutex_lock(&s->write_lock);									/* prevent two threads writing at the same time. That should happen in a synchronized way */
-		res = s->srvcontext->transport->send(&s->sc, bufAddr + bytesSent, bufLen - bytesSent, 0);
-		pbx_mutex_unlock(&s->write_lock);
-		if (res <= 0) {
+		if (res < 0) {
 			if (errno == EINTR) {
-				usleep(backoff);								/* back off to give network/other threads some time */
-				backoff *= 2;
 				continue;
 			}
-			socket_get_error(s, __FILE__, __LINE__, __PRETTY_FUNCTION__);
-			if (s) {
-				__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;										/* socket buffer full, the session thread continues when it becomes writable */
 			}
-			res = -1;
-			break;
+			socket_get_error(s, __FILE__, __LINE__, __PRETTY_FUNCTION__);
+			s->writeFailed = TRUE;
+			__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
+			return -1;
 		}
 		bytesSent += res;
-	} while(bytesSent < bufLen && s && !s->session_stop && s->sc.fd > 0);
-
-	sccp_free(msg);
-	msg = NULL;
-
-	if (bytesSent < bufLen) {
-		pbx_log(LOG_ERROR, "%s: Could only send %d of %d bytes!\n", DEV_ID_LOG(s->device), (int) bytesSent, (int) bufLen);
-		res = -1;
-	}
-
-	return res;
+	} while(bytesSent < bufLen && s->sc.fd > 0);
+	return bytesSent;
 }
 
 /*!
- * \brief Send a Reject Message to Device.
- * \param session SCCP Session Pointer
- * \param message Message as char (reason of rejection)
+ * \brief Classify an outbound message into a priority lane
+ * \note A display message and the message clearing it always share a lane, so that the clear can not overtake the display.
+ * DisplayPromptStatus / ClearPromptStatus and DisplayText / ClearDisplay stay in the call control lane with the call state they belong to.
  */
-sccp_session_t *sccp_session_reject(constSessionPtr session, char *message)
+static session_lane_t session_lane(uint32_t msgid)
 {
-	sccp_msg_t *msg = NULL;
-	sessionPtr s = (sessionPtr)session;										/* discard const */
-
-	REQ(msg, RegisterRejectMessage);
-	if (!msg) {
-		return NULL;
+	switch (msgid) {
+		case UserToDeviceDataMessage:
+		case UserToDeviceDataVersion1Message:
+			return SESSION_LANE_BULK;
+		case ForwardStatMessage:
+		case SpeedDialStatMessage:
+		case LineStatMessage:
+		case FeatureStatMessage:
+		case FeatureStatDynamicMessage:
+		case LineStatDynamicMessage:
+		case SpeedDialStatDynamicMessage:
+		case DisplayNotifyMessage:
+		case DisplayPriNotifyMessage:
+		case DisplayDynamicNotifyMessage:
+		case DisplayDynamicPriNotifyMessage:
+		case ClearNotifyMessage:
+		case ClearPriNotifyMessage:
+			return SESSION_LANE_UI;
+		default:
+			return SESSION_LANE_CALLCONTROL;
 	}
-	sccp_copy_string(msg->data.RegisterRejectMessage.text, message, sizeof(msg->data.RegisterRejectMessage.text));
-	sccp_session_send2(s, msg);
-	return NULL;
 }
 
 /*!
- * \brief Send a Reject Message to Device.
- * \param current_session SCCP Session Pointer
- * \param previous_session SCCP Session Pointer
- * \param token Do we need to return a token reject or a session reject (as Boolean)
+ * \brief Key identifying the button / prompt an idempotent ui message updates
+ * \return TRUE when a newer message with the same key makes a queued one obsolete
  */
-void sccp_session_crossdevice_cleanup(constSessionPtr current_session, sessionPtr previous_session)
+static boolean_t session_coalesceKey(uint32_t msgid, const uint8_t * bufAddr, ssize_t bufLen, uint32_t * key)
 {
-	if (!current_session || !previous_session) {
-		return;
-	}
-	if (current_session != previous_session && previous_session->session_thread) {
-		sccp_log(DEBUGCAT_CORE) (VERBOSE_PREFIX_2 "%s: Session %p needs to be closed!\n", current_session->designator, previous_session->designator);
-		__sccp_netsock_end_device_thread(previous_session);
+	switch (msgid) {
+		case SpeedDialStatMessage:
+		case LineStatMessage:
+		case FeatureStatMessage:
+		case FeatureStatDynamicMessage:
+		case LineStatDynamicMessage:
+		case SpeedDialStatDynamicMessage:
+			/* first payload field: line / speeddial / feature instance */
+			if (bufLen < SCCP_PACKET_HEADER + 4) {
+				return FALSE;
+			}
+			memcpy(key, bufAddr + SCCP_PACKET_HEADER, 4);
+			return TRUE;
+		case ForwardStatMessage:
+			/* second payload field: line number (v3 and v18 layout) */
+			if (bufLen < SCCP_PACKET_HEADER + 8) {
+				return FALSE;
+			}
+			memcpy(key, bufAddr + SCCP_PACKET_HEADER + 4, 4);
+			return TRUE;
+		case DisplayNotifyMessage:
+		case DisplayDynamicNotifyMessage:
+			*key = 0;
+			return TRUE;
+		case DisplayPriNotifyMessage:
+		case DisplayDynamicPriNotifyMessage:
+			/* second payload field: priority */
+			if (bufLen < SCCP_PACKET_HEADER + 8) {
+				return FALSE;
+			}
+			memcpy(key, bufAddr + SCCP_PACKET_HEADER + 4, 4);
+			return TRUE;
+		default:
+			return FALSE;
+	}
+}
+
+/*!
+ * \brief Does (queued) message clearId remove the prompt shown by msgid
+ */
+static boolean_t session_clearsPrompt(uint32_t clearId, uint32_t msgid)
+{
+	switch (clearId) {
+		case ClearNotifyMessage:
+			return msgid == DisplayNotifyMessage || msgid == DisplayDynamicNotifyMessage;
+		case ClearPriNotifyMessage:
+			return msgid == DisplayPriNotifyMessage || msgid == DisplayDynamicPriNotifyMessage;
+		default:
+			return FALSE;
+	}
+}
+
+static uint32_t session_queueDepth(sccp_session_t * s)
+{
+	uint32_t depth = 0;
+	for (int lane = 0; lane < SESSION_LANE_SENTINEL; lane++) {
+		SCCP_LIST_LOCK(&s->lanes[lane].queue);
+		depth += SCCP_LIST_GETSIZE(&s->lanes[lane].queue);
+		SCCP_LIST_UNLOCK(&s->lanes[lane].queue);
+	}
+	return depth;
+}
+
+/*!
+ * \brief Add an encoded message to the tail of its lane
+ * \param s SCCP Session (can't be null)
+ * \param msg Message to be freed after the write (or NULL when bufAddr points to a static buffer)
+ * \param bufAddr Encoded message
+ * \param bufLen Number of bytes to write
+ * \param msgid Message Id
+ * \param start Message statistics start (or NULL)
+ * \param pinned Message has to reach the device as is, it is not merged into a queued update and later updates are not merged into it
+ * \return TRUE when queued (or merged into a queued update), FALSE when out of memory (msg is freed in both cases)
+ *
+ * \note A ui update replaces the queued update for the same button / prompt (unless a clear for it, or a pinned update for the same
+ * button, was queued in between). The replaced entry keeps its place in the lane, but takes the queued / statistics time of the new one.
+ * Nothing is ever dropped: a ui update carries the current state of a button / prompt, losing it would leave the phone showing a stale
+ * state. Coalescing keeps at most one queued update per button / prompt, which bounds the ui lane, and the high-water mark only
+ * bounds the rest: above GLOB(sendqueue_highwater) queued messages the overflow is counted, at twice the high-water mark the device is
+ * considered a slow consumer and the session is reset.
+ */
+static boolean_t session_enqueue(sccp_session_t * s, sccp_msg_t * msg, const uint8_t * bufAddr, ssize_t bufLen, uint32_t msgid, const struct timeval * start, boolean_t pinned)
+{
+	session_lane_t lane = session_lane(msgid);
+	session_outmsg_t * out = NULL;
+	uint32_t key = 0;
+	uint32_t depth = 0;
+	uint32_t highwater = GLOB(sendqueue_highwater);
+
+	if (lane == SESSION_LANE_UI && !pinned && session_coalesceKey(msgid, bufAddr, bufLen, &key)) {
+		session_outmsg_t * queued = NULL;
+		sccp_msg_t * obsolete = NULL;
+		uint32_t queuedKey = 0;
+		SCCP_LIST_LOCK(&s->lanes[lane].queue);
+		SCCP_LIST_TRAVERSE(&s->lanes[lane].queue, queued, list) {
+			if (queued->msgid == msgid && session_coalesceKey(queued->msgid, queued->bufAddr, queued->bufLen, &queuedKey) && queuedKey == key) {
+				out = queued->pinned ? NULL : queued;						/* merging past a pinned update would reorder the pair */
+			} else if (out && session_clearsPrompt(queued->msgid, msgid)) {
+				out = NULL;										/* merging would move the new prompt in front of this clear */
+			}
+		}
+		if (out) {
+			obsolete = out->msg;									/* keeps it's place in the lane */
+			out->msg = msg;
+			out->bufAddr = bufAddr;
+			out->bufLen = bufLen;
+			out->queued = pbx_tvnow();
+			out->start = start ? *start : ast_tv(0, 0);
+			s->lanes[lane].coalesced++;
+		}
+		SCCP_LIST_UNLOCK(&s->lanes[lane].queue);
+		if (out) {
+			if (obsolete) {
+				sccp_free(obsolete);
+			}
+			return TRUE;
+		}
+	}
+
+	depth = session_queueDepth(s);
+	if (highwater && depth >= highwater) {
+		SCCP_LIST_LOCK(&s->lanes[lane].queue);
+		s->lanes[lane].overflow++;
+		SCCP_LIST_UNLOCK(&s->lanes[lane].queue);
+		sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_3 "%s: Send queue above high-water mark (%d), queueing %s\n", DEV_ID_LOG(s->device), highwater, msginfo2str((sccp_mid_t)msgid));
+		if (depth >= highwater * 2 && !s->session_stop) {
+			pbx_log(LOG_WARNING, "%s: Device is not reading, %d messages queued. Resetting session (ip-address: %s)\n", DEV_ID_LOG(s->device), depth, s->designator);
+			__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
+		}
+	}
+
+	if (!(out = (session_outmsg_t *)sccp_calloc(sizeof *out, 1))) {
+		pbx_log(LOG_ERROR, SS_Memory_Allocation_Error, DEV_ID_LOG(s->device));
+		if (msg) {
+			sccp_free(msg);
+		}
+		return FALSE;
+	}
+	out->msg = msg;
+	out->bufAddr = bufAddr;
+	out->bufLen = bufLen;
+	out->msgid = msgid;
+	out->pinned = pinned;
+	out->queued = pbx_tvnow();
+	if (start) {
+		out->start = *start;
+	}
+	SCCP_LIST_LOCK(&s->lanes[lane].queue);
+	SCCP_LIST_INSERT_TAIL(&s->lanes[lane].queue, out, list);
+	if (SCCP_LIST_GETSIZE(&s->lanes[lane].queue) > s->lanes[lane].peak) {
+		s->lanes[lane].peak = SCCP_LIST_GETSIZE(&s->lanes[lane].queue);
+	}
+	SCCP_LIST_UNLOCK(&s->lanes[lane].queue);
+	return TRUE;
+}
+
+/*!
+ * \brief Take the oldest message from the highest priority lane (up to lastLane) holding one, recording its queueing delay
+ */
+static session_outmsg_t * session_dequeue(sccp_session_t * s, session_lane_t lastLane)
+{
+	session_outmsg_t * out = NULL;
+	for (int lane = 0; lane <= (int)lastLane && !out; lane++) {
+		SCCP_LIST_LOCK(&s->lanes[lane].queue);
+		if ((out = SCCP_LIST_REMOVE_HEAD(&s->lanes[lane].queue, list))) {
+			uint32_t delay = (uint32_t)ast_tvdiff_us(pbx_tvnow(), out->queued);
+			s->lanes[lane].sent++;
+			s->lanes[lane].delayTotal += delay;
+			if (delay > s->lanes[lane].delayMax) {
+				s->lanes[lane].delayMax = delay;
+			}
+		}
+		SCCP_LIST_UNLOCK(&s->lanes[lane].queue);
+	}
+	return out;
+}
+
+/*!
+ * \brief Continue writing the inflight message (or drop it when the session is going down), freeing it once it is out
+ * \return FALSE when the socket stopped accepting data
+ */
+static boolean_t session_writeInflight(sccp_session_t * s)
+{
+	session_outmsg_t * out = s->inflight;
+
+	if (!s->writeFailed && s->sc.fd > 0) {
+		if (dont_expect(s->inflightSent == 0 && s->device && sccp_capture_isActive(s->device->id))) {
+			struct timeval now = pbx_tvnow();
+			sccp_capture_write(s->device->id, s->id, SCCP_CAPTURE_OUTBOUND, &now, out->bufAddr, out->bufLen);
+		}
+		ssize_t res = session_writeBuffer(s, out->bufAddr + s->inflightSent, out->bufLen - s->inflightSent);
+		if (res < 0) {
+			pbx_log(LOG_ERROR, "%s: Could only send %d of %d bytes!\n", DEV_ID_LOG(s->device), (int) s->inflightSent, (int) out->bufLen);
+		} else if ((s->inflightSent += res) < out->bufLen) {
+			if (!s->writeBlockedSince) {
+				s->writeBlockedSince = time(0);
+				if (s->wakeFd[1] > -1 && write(s->wakeFd[1], "w", 1) < 0 && errno != EAGAIN) {
+					pbx_log(LOG_WARNING, "%s: Failed to wake up session thread: %s\n", DEV_ID_LOG(s->device), strerror(errno));
+				}
+			}
+			return FALSE;
+		} else if (!ast_tvzero(out->start)) {
+			sccp_messagestat_recordOutbound(out->msgid, &out->start);
+		}
+	}
+	s->inflight = NULL;
+	s->inflightSent = 0;
+	if (out->msg) {
+		sccp_free(out->msg);
+	}
+	sccp_free(out);
+	return TRUE;
+}
+
+/*!
+ * \brief Drain the session lanes, call control first
+ *
+ * Whichever sending thread gets hold of write_lock becomes the writer and drains the lanes on behalf of the others, who just queue and
+ * return. This way a burst of ui / bulk messages is never written in front of call control that was queued in the meantime, without
+ * needing an extra writer thread per session. The queue is checked again after giving up write_lock, so a message queued while the
+ * previous writer was finishing does not get stranded.
+ *
+ * Writes never block: when the socket buffer is full the partially written message is kept as inflight and the session thread takes
+ * over once the socket is writable again (see session_writable). Until then senders only queue.
+ *
+ * Once the session is stopping, draining stops as well: whatever is still queued is left for session_flushCallControl.
+ */
+static void session_drainLanes(sccp_session_t * s)
+{
+	do {
+		if (pbx_mutex_trylock(&s->write_lock)) {
+			return;											/* the current writer will send our message as well */
+		}
+		while (!s->session_stop && !s->writeBlockedSince && (s->inflight || (s->inflight = session_dequeue(s, SESSION_LANE_BULK)))) {
+			if (!session_writeInflight(s)) {
+				break;
+			}
+		}
+		pbx_mutex_unlock(&s->write_lock);
+	} while (!s->session_stop && !s->writeBlockedSince && session_queueDepth(s) > 0);
+}
+
+/*!
+ * \brief Last chance for call control queued before the session was stopped (i.e. a Reset or RegisterReject) to reach the device
+ *
+ * Waits for the current writer to finish, completes the inflight message and writes the call control lane, waiting up to
+ * SESSION_FLUSH_TIMEOUT for the socket to become writable. UI and bulk messages are of no use to a device that is going away.
+ * Called from destroy_session, before the socket is closed.
+ */
+static void session_flushCallControl(sccp_session_t * s)
+{
+	struct timeval flush_timeout = {
+		SESSION_FLUSH_TIMEOUT / 1000, (SESSION_FLUSH_TIMEOUT % 1000) * 1000,
+	};
+	struct timeval deadline = ast_tvadd(pbx_tvnow(), flush_timeout);
+	int remaining = 0;
+
+	pbx_mutex_lock(&s->write_lock);
+	while (!s->writeFailed && s->sc.fd > 0 && (s->inflight || (s->inflight = session_dequeue(s, SESSION_LANE_CALLCONTROL)))) {
+		if (session_writeInflight(s)) {
+			continue;
+		}
+		struct pollfd fds[1] = { { .fd = s->sc.fd, .events = POLLOUT } };
+		if ((remaining = (int)ast_tvdiff_ms(deadline, pbx_tvnow())) <= 0 || sccp_netsock_poll(fds, 1, remaining) <= 0) {
+			sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_3 "%s: Device did not read the last messages, dropping them\n", DEV_ID_LOG(s->device));
+			break;
+		}
+		s->writeBlockedSince = 0;
+	}
+	pbx_mutex_unlock(&s->write_lock);
+}
+
+/*!
+ * \brief Reset the session when the device did not read anything for GLOB(sendqueue_stalltimeout) seconds (called from the session thread)
+ * \return TRUE when the session is being stopped
+ */
+static boolean_t session_checkStalled(sccp_session_t * s)
+{
+	time_t blockedSince = s->writeBlockedSince;
+
+	if (blockedSince && GLOB(sendqueue_stalltimeout) && (uintmax_t)(time(0) - blockedSince) >= GLOB(sendqueue_stalltimeout)) {
+		pbx_log(LOG_NOTICE, "%s: Closing session because the device did not read for %ju seconds, %d messages queued (ip-address: %s).\n", DEV_ID_LOG(s->device), (uintmax_t)(time(0) - blockedSince), session_queueDepth(s), s->designator);
+		__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*!
+ * \brief Session socket became writable again (called from the session thread)
+ */
+static void session_writable(sccp_session_t * s)
+{
+	s->writeBlockedSince = 0;
+	session_drainLanes(s);
+}
+
+/*!
+ * \brief Socket Send Message
+ * \param s Session SCCP Session (can't be null)
+ * \param msg Message Data Structure (sccp_msg_t) (Will be freed automatically at the end)
+ * \param pinned see session_enqueue
+ * \return Number of bytes queued, negative on failure
+ *
+ * \note The message is queued in its priority lane (see session_lane) and written by the thread currently draining the lanes
+ *
+ * \lock
+ *      - session
+ */
+static int session_send(sessionPtr s, sccp_msg_t * msg, boolean_t pinned)
+{
+	uint32_t msgid = letohl(msg->header.lel_messageId);
+	ssize_t bufLen = 0;
+	struct timeval start = {0};
+
+	if (s && s->session_stop) {
+		return -2;
+	}
+	if (GLOB(message_stats)) {
+		start = pbx_tvnow();
+	}
+
+	if(!s || s->sc.fd <= 0) {
+		sccp_log((DEBUGCAT_HIGH)) (VERBOSE_PREFIX_3 "SCCP: Tried to send packet over DOWN device.\n");
+		if (s) {
+			__sccp_session_stopthread(s, SKINNY_DEVICE_RS_FAILED);
+		}
+		sccp_free(msg);
+		msg = NULL;
+		return -3;
+	}
+	if (msgid == KeepAliveAckMessage || msgid == RegisterAckMessage || msgid == UnregisterAckMessage) {
+		msg->header.lel_protocolVer = 0;
+	} else if (s->device && s->device->protocol) {
+		msg->header.lel_protocolVer = s->device->protocol->version < 10 ? 0 : htolel(s->device->protocol->version);
+	}
+
+	bufLen = (ssize_t) (letohl(msg->header.length) + 8);
+
+	struct messageinfo * msginfo = lookupMsgInfoStruct(msgid);
+	if(msginfo) {
+		if(msginfo->messageId != msgid) {
+			pbx_log(LOG_ERROR, "%s: (session_send2) messageId %d (0x%x) unknown. matched:0x%x discarding message.\n", DEV_ID_LOG(s->device), msgid, msgid, msginfo->messageId);
+			return -4;
+		}
+		if(msginfo->type == SKINNY_MSGTYPE_REQUEST) {
+			request_pending(s);
+			sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_3 "%s: Request '%s' to device Pending\n", DEV_ID_LOG(s->device), msginfo->text);
+		}
+		if((GLOB(debug) & DEBUGCAT_MESSAGE) != 0) {
+			pbx_log(LOG_NOTICE, "%s: Sending Message: %s(0x%04X) %d bytes length\n", DEV_ID_LOG(s->device), msginfo->text, msgid, msg->header.length);
+			sccp_dump_msg(msg);
+		}
+	}
+	if (!session_enqueue(s, msg, (uint8_t *) msg, bufLen, msgid, &start, pinned)) {
+		return -1;
+	}
+	msg = NULL;
+	session_drainLanes(s);
+
+	return s->session_stop ? -1 : (int) bufLen;
+}
+
+int sccp_session_send2(constSessionPtr session, sccp_msg_t * msg)
+{
+	return session_send((sessionPtr)session, msg, FALSE);							/* discard const */
+}
+
+/*!
+ * \brief Send a ui update which has to reach the device as is, i.e. the first of two updates for the same button sent to force the phone
+ * to repaint it. It is never merged with another queued update for the same button.
+ * \param device SCCP Device
+ * \param msg Message Data Structure (sccp_msg_t) (Will be freed automatically at the end)
+ */
+int sccp_session_sendPinned(constDevicePtr device, sccp_msg_t * msg)
+{
+	const sccp_session_t * const s = device && device->session ? device->session : NULL;
+
+	if (s && !s->session_stop) {
+		return session_send((sessionPtr)s, msg, TRUE);							/* discard const */
+	}
+	sccp_free(msg);
+	return -1;
+}
+
+/*!
+ * \brief Send a Reject Message to Device.
+ * \param session SCCP Session Pointer
+ * \param message Message as char (reason of rejection)
+ */
+sccp_session_t *sccp_session_reject(constSessionPtr session, char *message)
+{
+	sccp_msg_t *msg = NULL;
+	sessionPtr s = (sessionPtr)session;										/* discard const */
+
+	REQ(msg, RegisterRejectMessage);
+	if (!msg) {
+		return NULL;
+	}
+	sccp_copy_string(msg->data.RegisterRejectMessage.text, message, sizeof(msg->data.RegisterRejectMessage.text));
+	sccp_session_send2(s, msg);
+	return NULL;
+}
+
+/*!
+ * \brief Send a Reject Message to Device.
+ * \param current_session SCCP Session Pointer
+ * \param previous_session SCCP Session Pointer
+ * \param token Do we need to return a token reject or a session reject (as Boolean)
+ */
+void sccp_session_crossdevice_cleanup(constSessionPtr current_session, sessionPtr previous_session)
+{
+	if (!current_session || !previous_session) {
+		return;
+	}
+	/* other stale sessions from the same phone (same remote address, still holding the same device) */
+	if (previous_session->device) {
+		sccp_session_t * session = NULL;
+		SCCP_RWLIST_RDLOCK(&GLOB(sessions));
+		for (session = sessionsByAddr[session_registry_hashAddr(&current_session->sin)]; session; session = session->addrNext) {
+			if (session != current_session && session != previous_session && !session->session_stop && session->device == previous_session->device
+			    && sccp_netsock_cmp_addr(&session->sin, &current_session->sin) == 0) {
+				sccp_log(DEBUGCAT_CORE)(VERBOSE_PREFIX_2 "%s: Stale session %p from the same phone needs to be closed!\n", current_session->designator, session);
+				/* only signal the session thread, the device registration belongs to the current session now */
+				session->session_stop = TRUE;
+				if (AST_PTHREADT_NULL != session->session_thread) {
+					session->srvcontext->transport->shutdown(&session->sc, SHUT_RD);
+				}
+			}
+		}
+		SCCP_RWLIST_UNLOCK(&GLOB(sessions));
+	}
+	if (current_session != previous_session && previous_session->session_thread) {
+		sccp_log(DEBUGCAT_CORE) (VERBOSE_PREFIX_2 "%s: Session %p needs to be closed!\n", current_session->designator, previous_session->designator);
+		__sccp_netsock_end_device_thread(previous_session);
 	}
 }
 
@@ -1501,6 +2318,7 @@ int sccp_cli_show_sessions(int fd, sccp_cli_totals_t *totals, struct mansession
 	CLI_AMI_TABLE_FIELD(KALST, "-5", d, 5, (uint32_t)(time(0) - session->lastKeepAlive))                                           \
 	CLI_AMI_TABLE_FIELD(KAINT, "-5", d, 5, (d ? d->keepaliveinterval : session->keepAliveInterval))                                \
 	CLI_AMI_TABLE_FIELD(KAMAX, "-5", d, 5, session->keepAlive)                                                                     \
+	CLI_AMI_TABLE_FIELD(KAFast, "-6", d, 6, session->keepAlivesFastPath)                                                           \
 	CLI_AMI_TABLE_FIELD(DeviceName, "15", s, 15, (d) ? d->id : "--")                                                               \
 	CLI_AMI_TABLE_FIELD(State, "-14.14", s, 14, (d) ? sccp_devicestate2str(sccp_device_getDeviceState(d)) : "--")                  \
 	CLI_AMI_TABLE_FIELD(Type, "-15.15", s, 15, (d) ? skinny_devicetype2str(d->skinny_type) : "--")                                 \
@@ -1516,4 +2334,565 @@ int sccp_cli_show_sessions(int fd, sccp_cli_totals_t *totals, struct mansession
 	return RESULT_SUCCESS;
 }
 
+/*!
+ * \brief Current accept queue depth of a listening socket (-1 when not available on this platform)
+ */
+static int servercontext_acceptQueueDepth(const sccp_acceptor_t * acceptor)
+{
+#if defined(__linux__) && defined(TCP_INFO)
+	struct tcp_info info = { 0 };
+	socklen_t len = sizeof(info);
+	if (acceptor->sc.fd > -1 && getsockopt(acceptor->sc.fd, IPPROTO_TCP, TCP_INFO, &info, &len) == 0) {
+		return (int)info.tcpi_unacked;								/* for a listening socket: connections waiting in the accept queue */
+	}
+#endif
+	return -1;
+}
+
+/*!
+ * \brief Show Listening Sockets / Accept Threads
+ * \param fd Fd as int
+ * \param totals Total number of lines as int
+ * \param s AMI Session
+ * \param m Message
+ * \param argc Argc as int
+ * \param argv[] Argv[] as char
+ * \return Result as int
+ */
+int sccp_cli_show_listeners(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[])
+{
+	int local_line_total = 0;
+	int ctx = 0;
+	int idx = 0;
+	sccp_servercontext_t * context = NULL;
+
+	pbx_rwlock_rdlock(&GLOB(lock));
+#define CLI_AMI_TABLE_NAME Listeners
+#define CLI_AMI_TABLE_PER_ENTRY_NAME Listener
+#define CLI_AMI_TABLE_ITERATOR                                                                                                                             \
+	for (ctx = 0; ctx < (int)ARRAY_LEN(GLOB(srvcontexts)); ctx++)                                                                                      \
+		for (context = GLOB(srvcontexts[ctx]), idx = 0; context && idx < context->numAcceptors; idx++)
+#define CLI_AMI_TABLE_FIELDS                                                                                                                               \
+	CLI_AMI_TABLE_FIELD(Trans, "5.5", s, 5, context->transport->name)                                                                                   \
+	CLI_AMI_TABLE_FIELD(Address, "-40.40", s, 40, sccp_netsock_stringify(&context->boundaddr))                                                         \
+	CLI_AMI_TABLE_FIELD(Thread, "-6", d, 6, idx)                                                                                                        \
+	CLI_AMI_TABLE_FIELD(Socket, "-6", d, 6, context->acceptors[idx].sc.fd)                                                                              \
+	CLI_AMI_TABLE_FIELD(Backlog, "-7", d, 7, context->backlog)                                                                                          \
+	CLI_AMI_TABLE_FIELD(Queued, "-6", d, 6, servercontext_acceptQueueDepth(&context->acceptors[idx]))                                                  \
+	CLI_AMI_TABLE_FIELD(Accepted, "-8", d, 8, context->acceptors[idx].accepted)                                                                         \
+	CLI_AMI_TABLE_FIELD(Errors, "-6", d, 6, context->acceptors[idx].errors)
+#include "sccp_cli_table.h"
+	pbx_rwlock_unlock(&GLOB(lock));
+
+	if (s) {
+		totals->lines = local_line_total;
+		totals->tables = 1;
+	}
+	return RESULT_SUCCESS;
+}
+
+/*!
+ * \brief Show Outbound Priority Lanes per Session
+ * \param fd Fd as int
+ * \param totals Total number of lines as int
+ * \param s AMI Session
+ * \param m Message
+ * \param argc Argc as int
+ * \param argv[] Argv[] as char
+ * \return Result as int
+ */
+int sccp_cli_show_sendqueues(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[])
+{
+	int local_line_total = 0;
+	int lane = 0;
+	sccp_session_t * session = NULL;
+	uint32_t depth = 0;
+	uint32_t sent = 0;
+	uint32_t delayAvg = 0;
+	uint32_t delayMax = 0;
+	uint32_t peak = 0;
+	uint32_t overflow = 0;
+	uint32_t coalesced = 0;
+
+	if (!s) {
+		CLI_AMI_OUTPUT(fd, s, "High-water mark: %d messages per session (0: unbounded), stall timeout: %d seconds\n", GLOB(sendqueue_highwater), GLOB(sendqueue_stalltimeout));
+	}
+	SCCP_RWLIST_RDLOCK(&GLOB(sessions));
+#define CLI_AMI_TABLE_NAME SendQueues
+#define CLI_AMI_TABLE_PER_ENTRY_NAME SendQueue
+#define CLI_AMI_TABLE_ITERATOR                                                                                                                             \
+	SCCP_RWLIST_TRAVERSE(&GLOB(sessions), session, list)                                                                                               \
+		for (lane = 0; lane < SESSION_LANE_SENTINEL; lane++)
+#define CLI_AMI_TABLE_BEFORE_ITERATION                                                                                                                     \
+	SCCP_LIST_LOCK(&session->lanes[lane].queue);                                                                                                       \
+	depth = SCCP_LIST_GETSIZE(&session->lanes[lane].queue);                                                                                            \
+	sent = session->lanes[lane].sent;                                                                                                                  \
+	delayAvg = sent ? (uint32_t)(session->lanes[lane].delayTotal / sent) : 0;                                                                          \
+	delayMax = session->lanes[lane].delayMax;                                                                                                          \
+	peak = session->lanes[lane].peak;                                                                                                                  \
+	overflow = session->lanes[lane].overflow;                                                                                                          \
+	coalesced = session->lanes[lane].coalesced;                                                                                                        \
+	SCCP_LIST_UNLOCK(&session->lanes[lane].queue);
+#define CLI_AMI_TABLE_FIELDS                                                                                                                               \
+	CLI_AMI_TABLE_FIELD(Socket, "-6", d, 6, session->sc.fd)                                                                                             \
+	CLI_AMI_TABLE_FIELD(DeviceName, "15", s, 15, DEV_ID_LOG(session->device))                                                                          \
+	CLI_AMI_TABLE_FIELD(Lane, "-11.11", s, 11, session_lane2str[lane])                                                                                  \
+	CLI_AMI_TABLE_FIELD(Depth, "-5", d, 5, depth)                                                                                                       \
+	CLI_AMI_TABLE_FIELD(Peak, "-5", d, 5, peak)                                                                                                         \
+	CLI_AMI_TABLE_FIELD(Sent, "-8", d, 8, sent)                                                                                                         \
+	CLI_AMI_TABLE_FIELD(Overflow, "-8", d, 8, overflow)                                                                                                 \
+	CLI_AMI_TABLE_FIELD(Coalesced, "-9", d, 9, coalesced)                                                                                               \
+	CLI_AMI_TABLE_FIELD(Blocked, "-7", d, 7, session->writeBlockedSince ? (uint32_t)(time(0) - session->writeBlockedSince) : 0)                          \
+	CLI_AMI_TABLE_FIELD(AvgUs, "-8", d, 8, delayAvg)                                                                                                    \
+	CLI_AMI_TABLE_FIELD(MaxUs, "-8", d, 8, delayMax)
+#include "sccp_cli_table.h"
+	SCCP_RWLIST_UNLOCK(&GLOB(sessions));
+
+	if (s) {
+		totals->lines = local_line_total;
+		totals->tables = 1;
+	}
+	return RESULT_SUCCESS;
+}
+
+/*!
+ * \brief Show connection setup (acl and handshake) statistics per transport
+ */
+int sccp_cli_show_handshakes(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[])
+{
+	int local_line_total = 0;
+	int idx = 0;
+	char latencyHistogram[40] = "";
+
+	if (!s) {
+		CLI_AMI_OUTPUT(fd, s, "Handshake timeout: %d seconds. Latency buckets (ms): <10/<50/<250/<1000/>=1000\n", SESSION_HANDSHAKE_TIMEOUT);
+	}
+	pbx_mutex_lock(&handshakeStatsLock);
+#define CLI_AMI_TABLE_NAME Handshakes
+#define CLI_AMI_TABLE_PER_ENTRY_NAME Handshake
+#define CLI_AMI_TABLE_ITERATOR for (idx = 0; idx < (int)ARRAY_LEN(handshakeStats); idx++)
+#define CLI_AMI_TABLE_BEFORE_ITERATION                                                                                                                     \
+	snprintf(latencyHistogram, sizeof(latencyHistogram), "%u/%u/%u/%u/%u", handshakeStats[idx].latency[0], handshakeStats[idx].latency[1],               \
+	         handshakeStats[idx].latency[2], handshakeStats[idx].latency[3], handshakeStats[idx].latency[4]);
+#define CLI_AMI_TABLE_FIELDS                                                                                                                               \
+	CLI_AMI_TABLE_FIELD(Trans, "5.5", s, 5, handshakeStats[idx].name)                                                                                   \
+	CLI_AMI_TABLE_FIELD(Denied, "-8", d, 8, handshakeStats[idx].denied)                                                                                 \
+	CLI_AMI_TABLE_FIELD(Attempts, "-8", d, 8, handshakeStats[idx].attempts)                                                                             \
+	CLI_AMI_TABLE_FIELD(Busy, "-4", d, 4, handshakeStats[idx].inProgress)                                                                               \
+	CLI_AMI_TABLE_FIELD(OK, "-8", d, 8, handshakeStats[idx].succeeded)                                                                                  \
+	CLI_AMI_TABLE_FIELD(Resumed, "-8", d, 8, handshakeStats[idx].resumed)                                                                               \
+	CLI_AMI_TABLE_FIELD(ResPct, "-6", d, 6, handshakeStats[idx].succeeded ? handshakeStats[idx].resumed * 100 / handshakeStats[idx].succeeded : 0)     \
+	CLI_AMI_TABLE_FIELD(Failed, "-6", d, 6, handshakeStats[idx].failed)                                                                                 \
+	CLI_AMI_TABLE_FIELD(Timeout, "-7", d, 7, handshakeStats[idx].timedout)                                                                              \
+	CLI_AMI_TABLE_FIELD(AvgMs, "-6", d, 6, handshakeStats[idx].succeeded ? (uint32_t)(handshakeStats[idx].latencyTotal / handshakeStats[idx].succeeded) : 0) \
+	CLI_AMI_TABLE_FIELD(ResAvgMs, "-8", d, 8, handshakeStats[idx].resumed ? (uint32_t)(handshakeStats[idx].resumedLatencyTotal / handshakeStats[idx].resumed) : 0) \
+	CLI_AMI_TABLE_FIELD(MaxMs, "-6", d, 6, handshakeStats[idx].latencyMax)                                                                              \
+	CLI_AMI_TABLE_FIELD(LatencyHistogram, "-30.30", s, 30, latencyHistogram)
+#include "sccp_cli_table.h"
+	pbx_mutex_unlock(&handshakeStatsLock);
+
+	if (s) {
+		totals->lines = local_line_total;
+		totals->tables = 1;
+	}
+	return RESULT_SUCCESS;
+}
+
+#if CS_TEST_FRAMEWORK
+#	include <asterisk/test.h>
+#	include <sys/socket.h>
+
+#	define SESSION_TEST_ENQUEUE(_s, _y, _instance, _pinned) session_testEnqueue((_s), (_y), sizeof(((sccp_msg_t *)NULL)->data._y), (_instance), (_pinned))
+
+static sccp_servercontext_t session_testContext = { .type = SCCP_SERVERCONTEXT_TCP };
+
+/*!
+ * \brief Session for the tests: not registered and without a session thread. With fd -1 the lanes are never drained.
+ */
+static sccp_session_t * session_testCreate(int fd)
+{
+	sccp_socket_connection_t sc = { fd, NULL };
+	sccp_session_t * s = NULL;
+
+	session_testContext.transport = tcp_init();
+	if ((s = sccp_create_session(&session_testContext, &sc))) {
+		s->session_thread = AST_PTHREADT_NULL;
+		sccp_copy_string(s->designator, "test", sizeof(s->designator));
+	}
+	return s;
+}
+
+/*!
+ * \brief Queue a message with its first payload field (line / button instance) set to instance
+ * \return the queued message, owned by the session
+ */
+static sccp_msg_t * session_testEnqueue(sccp_session_t * s, sccp_mid_t msgid, size_t pkt_len, uint32_t instance, boolean_t pinned)
+{
+	sccp_msg_t * msg = sccp_build_packet(msgid, pkt_len);
+	uint32_t lel_instance = htolel(instance);
+
+	if (msg) {
+		if (pkt_len >= sizeof(lel_instance)) {
+			memcpy((uint8_t *)msg + SCCP_PACKET_HEADER, &lel_instance, sizeof(lel_instance));
+		}
+		session_enqueue(s, msg, (uint8_t *)msg, (ssize_t)(letohl(msg->header.length) + 8), msgid, NULL, pinned);
+	}
+	return msg;
+}
+
+/*!
+ * \brief Are exactly the expected messages queued in lane, in this order
+ */
+static boolean_t session_testLaneIs(sccp_session_t * s, session_lane_t lane, sccp_msg_t * const expected[], int count)
+{
+	session_outmsg_t * out = NULL;
+	boolean_t res = TRUE;
+	int idx = 0;
+
+	SCCP_LIST_LOCK(&s->lanes[lane].queue);
+	SCCP_LIST_TRAVERSE(&s->lanes[lane].queue, out, list) {
+		if (idx >= count || out->msg != expected[idx]) {
+			res = FALSE;
+		}
+		idx++;
+	}
+	SCCP_LIST_UNLOCK(&s->lanes[lane].queue);
+	return res && idx == count;
+}
+
+/*!
+ * \brief Take the next message from the lanes, the way the writer would, and free it
+ * \return the message that would have been written next (only to be compared against)
+ */
+static const sccp_msg_t * session_testDequeue(sccp_session_t * s, session_lane_t lastLane)
+{
+	session_outmsg_t * out = session_dequeue(s, lastLane);
+	const sccp_msg_t * msg = NULL;
+
+	if (out) {
+		msg = out->msg;
+		sccp_free(out->msg);
+		sccp_free(out);
+	}
+	return msg;
+}
+
+AST_TEST_DEFINE(sccp_session_lanes)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "lanes";
+			info->category = "/channels/chan_sccp/session/";
+			info->summary = "chan-sccp-b session send lanes";
+			info->description = "Checks the lane messages are queued in, coalescing of ui updates (repaint pair, prompt clears) and the order the lanes are written in";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	enum ast_test_result_state res = AST_TEST_PASS;
+	uint16_t highwater = GLOB(sendqueue_highwater);
+	sccp_session_t * s = NULL;
+	sccp_msg_t * line1 = NULL;
+	sccp_msg_t * line2 = NULL;
+	sccp_msg_t * shortLabel = NULL;
+	sccp_msg_t * fullLabel = NULL;
+	sccp_msg_t * shortLabel2 = NULL;
+	sccp_msg_t * fullLabel2 = NULL;
+	sccp_msg_t * prompt = NULL;
+	sccp_msg_t * clear = NULL;
+	sccp_msg_t * prompt2 = NULL;
+	sccp_msg_t * callState1 = NULL;
+	sccp_msg_t * callState2 = NULL;
+	sccp_msg_t * bulk = NULL;
+	struct timeval queued = { 0 };
+
+	pbx_test_status_update(test, "Lane classification\n");
+	pbx_test_validate(test, session_lane(CallStateMessage) == SESSION_LANE_CALLCONTROL);
+	pbx_test_validate(test, session_lane(DisplayPromptStatusMessage) == SESSION_LANE_CALLCONTROL);
+	pbx_test_validate(test, session_lane(LineStatMessage) == SESSION_LANE_UI);
+	pbx_test_validate(test, session_lane(FeatureStatDynamicMessage) == SESSION_LANE_UI);
+	pbx_test_validate(test, session_lane(DisplayNotifyMessage) == SESSION_LANE_UI && session_lane(ClearNotifyMessage) == SESSION_LANE_UI);
+	pbx_test_validate(test, session_lane(UserToDeviceDataVersion1Message) == SESSION_LANE_BULK);
+
+	s = session_testCreate(-1);
+	pbx_test_validate(test, s != NULL);
+	GLOB(sendqueue_highwater) = 0;
+
+	pbx_test_status_update(test, "A ui update replaces the queued one for the same button, keeping it's place but taking the new queued time\n");
+	line1 = SESSION_TEST_ENQUEUE(s, LineStatMessage, 1, FALSE);
+	line2 = SESSION_TEST_ENQUEUE(s, LineStatMessage, 2, FALSE);
+	queued = SCCP_LIST_FIRST(&s->lanes[SESSION_LANE_UI].queue)->queued;
+	usleep(1000);
+	line1 = SESSION_TEST_ENQUEUE(s, LineStatMessage, 1, FALSE);
+	pbx_test_validate_cleanup(test, session_testLaneIs(s, SESSION_LANE_UI, (sccp_msg_t * const[]) { line1, line2 }, 2), res, cleanup);
+	pbx_test_validate_cleanup(test, s->lanes[SESSION_LANE_UI].coalesced == 1, res, cleanup);
+	pbx_test_validate_cleanup(test, ast_tvcmp(SCCP_LIST_FIRST(&s->lanes[SESSION_LANE_UI].queue)->queued, queued) > 0, res, cleanup);
+
+	pbx_test_status_update(test, "The repaint pair (shortened label, full label) is never merged, later updates merge into the full label only\n");
+	shortLabel = SESSION_TEST_ENQUEUE(s, FeatureStatDynamicMessage, 3, TRUE);
+	fullLabel = SESSION_TEST_ENQUEUE(s, FeatureStatDynamicMessage, 3, FALSE);
+	pbx_test_validate_cleanup(test, session_testLaneIs(s, SESSION_LANE_UI, (sccp_msg_t * const[]) { line1, line2, shortLabel, fullLabel }, 4), res, cleanup);
+	fullLabel = SESSION_TEST_ENQUEUE(s, FeatureStatDynamicMessage, 3, FALSE);
+	pbx_test_validate_cleanup(test, session_testLaneIs(s, SESSION_LANE_UI, (sccp_msg_t * const[]) { line1, line2, shortLabel, fullLabel }, 4), res, cleanup);
+	shortLabel2 = SESSION_TEST_ENQUEUE(s, FeatureStatDynamicMessage, 3, TRUE);
+	fullLabel2 = SESSION_TEST_ENQUEUE(s, FeatureStatDynamicMessage, 3, FALSE);
+	pbx_test_validate_cleanup(test, session_testLaneIs(s, SESSION_LANE_UI, (sccp_msg_t * const[]) { line1, line2, shortLabel, fullLabel, shortLabel2, fullLabel2 }, 6), res, cleanup);
+	pbx_test_validate_cleanup(test, s->lanes[SESSION_LANE_UI].coalesced == 2, res, cleanup);
+
+	pbx_test_status_update(test, "A prompt is not merged in front of a clear queued after it\n");
+	while (session_testDequeue(s, SESSION_LANE_BULK)) {
+	}
+	prompt = SESSION_TEST_ENQUEUE(s, DisplayNotifyMessage, 5, FALSE);
+	clear = SESSION_TEST_ENQUEUE(s, ClearNotifyMessage, 0, FALSE);
+	prompt2 = SESSION_TEST_ENQUEUE(s, DisplayNotifyMessage, 5, FALSE);
+	pbx_test_validate_cleanup(test, session_testLaneIs(s, SESSION_LANE_UI, (sccp_msg_t * const[]) { prompt, clear, prompt2 }, 3), res, cleanup);
+	prompt2 = SESSION_TEST_ENQUEUE(s, DisplayNotifyMessage, 5, FALSE);
+	pbx_test_validate_cleanup(test, session_testLaneIs(s, SESSION_LANE_UI, (sccp_msg_t * const[]) { prompt, clear, prompt2 }, 3), res, cleanup);
+
+	pbx_test_status_update(test, "Call control is written first, each lane in the order it was queued in\n");
+	while (session_testDequeue(s, SESSION_LANE_BULK)) {
+	}
+	bulk = SESSION_TEST_ENQUEUE(s, UserToDeviceDataVersion1Message, 1, FALSE);
+	line1 = SESSION_TEST_ENQUEUE(s, LineStatMessage, 1, FALSE);
+	callState1 = SESSION_TEST_ENQUEUE(s, CallStateMessage, 1, FALSE);
+	line2 = SESSION_TEST_ENQUEUE(s, LineStatMessage, 2, FALSE);
+	callState2 = SESSION_TEST_ENQUEUE(s, CallStateMessage, 1, FALSE);
+	pbx_test_validate_cleanup(test, session_testDequeue(s, SESSION_LANE_CALLCONTROL) == callState1, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testDequeue(s, SESSION_LANE_CALLCONTROL) == callState2, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testDequeue(s, SESSION_LANE_CALLCONTROL) == NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testDequeue(s, SESSION_LANE_BULK) == line1, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testDequeue(s, SESSION_LANE_BULK) == line2, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testDequeue(s, SESSION_LANE_BULK) == bulk, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testDequeue(s, SESSION_LANE_BULK) == NULL, res, cleanup);
+
+cleanup:
+	GLOB(sendqueue_highwater) = highwater;
+	destroy_session(s);
+	return res;
+}
+
+/*!
+ * \brief Send call control until the socket stops accepting data (nobody reads the other end)
+ * \return TRUE when the session is blocked on a partially written message
+ */
+static boolean_t session_testFill(sccp_session_t * s)
+{
+	sccp_msg_t * msg = NULL;
+
+	for (int loop = 0; loop < 100000 && !s->writeBlockedSince && !s->session_stop; loop++) {
+		if (!(REQ(msg, CallStateMessage)) || session_send(s, msg, FALSE) < 0) {
+			return FALSE;
+		}
+	}
+	return s->writeBlockedSince && s->inflight && session_queueDepth(s) == 0;
+}
+
+/*!
+ * \brief Send a LineStatMessage, lineDirNumber carrying the state (round) it refreshes the button to
+ */
+static int session_testSendLineStat(sccp_session_t * s, uint32_t instance, int round)
+{
+	sccp_msg_t * msg = NULL;
+
+	if (!(REQ(msg, LineStatMessage))) {
+		return -1;
+	}
+	msg->data.LineStatMessage.lel_lineNumber = htolel(instance);
+	snprintf(msg->data.LineStatMessage.lineDirNumber, sizeof(msg->data.LineStatMessage.lineDirNumber), "%d", round);
+	return session_send(s, msg, FALSE);
+}
+
+/*!
+ * \brief Transport accepting a scripted number of bytes, to test partial, blocked and zero-byte writes
+ */
+static struct {
+	uint8_t written[1024];
+	size_t len;
+	size_t chunk;												/*!< Accepted per send, 0: nothing is written and no error reported */
+	size_t budget;												/*!< Accepted before the transport reports EAGAIN */
+} session_testSink;
+
+static int session_testSend(sccp_socket_connection_t * sc, void * buf, size_t buflen, int flags)
+{
+	size_t len = buflen < session_testSink.chunk ? buflen : session_testSink.chunk;
+
+	if (session_testSink.chunk && !session_testSink.budget) {
+		errno = EAGAIN;
+		return -1;
+	}
+	if (len > session_testSink.budget) {
+		len = session_testSink.budget;
+	}
+	if (len > sizeof(session_testSink.written) - session_testSink.len) {
+		len = sizeof(session_testSink.written) - session_testSink.len;
+	}
+	memcpy(session_testSink.written + session_testSink.len, buf, len);
+	session_testSink.len += len;
+	session_testSink.budget -= len;
+	return (int)len;
+}
+
+static int session_testShutdown(sccp_socket_connection_t * sc, int how)
+{
+	return 0;
+}
+
+static int session_testClose(sccp_socket_connection_t * sc)
+{
+	return close(sc->fd);
+}
+
+static const sccp_transport_t session_testTransport = {
+	.name     = "TEST",
+	.send     = session_testSend,
+	.shutdown = session_testShutdown,
+	.close    = session_testClose,
+};
+static sccp_servercontext_t session_testScriptedContext = { .type = SCCP_SERVERCONTEXT_TCP, .transport = &session_testTransport };
+
+AST_TEST_DEFINE(sccp_session_sendqueue)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "sendqueue";
+			info->category = "/channels/chan_sccp/session/";
+			info->summary = "chan-sccp-b session send queue bounds";
+			info->description = "Checks that ui updates to a device which does not read are coalesced and never dropped, the slow consumer and stall resets, "
+					    "and that partial, blocked and zero-byte writes continue from the right offset or stop the session";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	enum ast_test_result_state res = AST_TEST_PASS;
+	uint16_t highwater = GLOB(sendqueue_highwater);
+	uint16_t stalltimeout = GLOB(sendqueue_stalltimeout);
+	int fds[2] = { -1, -1 };
+	int sndbuf = 4096;
+	sccp_session_t * s = NULL;
+	sccp_session_t * stalled = NULL;
+	sccp_session_t * scripted = NULL;
+	session_outmsg_t * out = NULL;
+	sccp_msg_t * msg = NULL;
+	uint8_t expected[sizeof(session_testSink.written)];
+	size_t expectedLen = 0;
+	uint32_t instance = 0;
+	boolean_t latest = TRUE;
+	int round = 0;
+	int loop = 0;
+
+	GLOB(sendqueue_highwater) = 16;
+	GLOB(sendqueue_stalltimeout) = 60;
+
+	pbx_test_status_update(test, "Fill the socket buffer of a device which does not read\n");
+	pbx_test_validate_cleanup(test, socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, res, cleanup);
+	setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+	s = session_testCreate(fds[0]);
+	pbx_test_validate_cleanup(test, s != NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testFill(s), res, cleanup);
+	while (session_queueDepth(s) < GLOB(sendqueue_highwater) && (REQ(msg, CallStateMessage))) {
+		session_send(s, msg, FALSE);
+	}
+	pbx_test_validate_cleanup(test, session_queueDepth(s) == GLOB(sendqueue_highwater) && !s->session_stop, res, cleanup);
+
+	pbx_test_status_update(test, "Above the high-water mark ui updates are coalesced, none of them is dropped\n");
+	for (round = 0; round < 10; round++) {
+		for (instance = 1; instance <= 4; instance++) {
+			pbx_test_validate_cleanup(test, session_testSendLineStat(s, instance, round) > 0, res, cleanup);
+		}
+	}
+	instance = 0;
+	SCCP_LIST_LOCK(&s->lanes[SESSION_LANE_UI].queue);
+	SCCP_LIST_TRAVERSE(&s->lanes[SESSION_LANE_UI].queue, out, list) {
+		latest &= letohl(out->msg->data.LineStatMessage.lel_lineNumber) == ++instance && sccp_strequals(out->msg->data.LineStatMessage.lineDirNumber, "9");
+	}
+	SCCP_LIST_UNLOCK(&s->lanes[SESSION_LANE_UI].queue);
+	pbx_test_validate_cleanup(test, instance == 4 && latest, res, cleanup);
+	pbx_test_validate_cleanup(test, s->lanes[SESSION_LANE_UI].coalesced == 36 && s->lanes[SESSION_LANE_UI].overflow == 4 && !s->session_stop, res, cleanup);
+
+	pbx_test_status_update(test, "At twice the high-water mark the device is a slow consumer and the session is reset\n");
+	for (loop = 0; loop < GLOB(sendqueue_highwater) * 2 && !s->session_stop && (REQ(msg, CallStateMessage)); loop++) {
+		session_send(s, msg, FALSE);
+	}
+	pbx_test_validate_cleanup(test, s->session_stop && session_queueDepth(s) >= GLOB(sendqueue_highwater) * 2U, res, cleanup);
+	pbx_test_validate_cleanup(test, SCCP_LIST_GETSIZE(&s->lanes[SESSION_LANE_UI].queue) == 4, res, cleanup);
+	destroy_session(s);
+	s = NULL;
+	close(fds[1]);
+	fds[1] = -1;
+
+	pbx_test_status_update(test, "A device which stops reading is reset after sendqueue_stalltimeout seconds\n");
+	pbx_test_validate_cleanup(test, socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, res, cleanup);
+	setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+	stalled = session_testCreate(fds[0]);
+	pbx_test_validate_cleanup(test, stalled != NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testFill(stalled), res, cleanup);
+	pbx_test_validate_cleanup(test, !session_checkStalled(stalled) && !stalled->session_stop, res, cleanup);
+	GLOB(sendqueue_stalltimeout) = 1;
+	sleep(1);
+	pbx_test_validate_cleanup(test, session_checkStalled(stalled) && stalled->session_stop, res, cleanup);
+	destroy_session(stalled);
+	stalled = NULL;
+	close(fds[1]);
+	fds[1] = -1;
+
+	pbx_test_status_update(test, "Partial writes continue where they stopped, also after the socket blocked\n");
+	memset(&session_testSink, 0, sizeof(session_testSink));
+	session_testSink.chunk = 5;
+	session_testSink.budget = sizeof(session_testSink.written);
+	scripted = sccp_create_session(&session_testScriptedContext, &(sccp_socket_connection_t) { open("/dev/null", O_WRONLY), NULL });
+	pbx_test_validate_cleanup(test, scripted != NULL && scripted->sc.fd > 0, res, cleanup);
+	scripted->session_thread = AST_PTHREADT_NULL;
+	for (loop = 0; loop < 3; loop++) {
+		pbx_test_validate_cleanup(test, (REQ(msg, CallStateMessage)) != NULL, res, cleanup);
+		msg->data.CallStateMessage.lel_lineInstance = htolel(loop + 1);
+		memcpy(expected + expectedLen, msg, letohl(msg->header.length) + 8);
+		expectedLen += letohl(msg->header.length) + 8;
+		if (loop == 1) {
+			session_testSink.budget = 10;								/* blocks in the middle of the second message */
+		}
+		pbx_test_validate_cleanup(test, session_send(scripted, msg, FALSE) > 0, res, cleanup);
+	}
+	pbx_test_validate_cleanup(test, scripted->writeBlockedSince && scripted->inflight && scripted->inflightSent == 10 && session_queueDepth(scripted) == 1, res, cleanup);
+	session_testSink.budget = sizeof(session_testSink.written);
+	session_writable(scripted);
+	pbx_test_validate_cleanup(test, !scripted->writeBlockedSince && !scripted->inflight && session_queueDepth(scripted) == 0, res, cleanup);
+	pbx_test_validate_cleanup(test, session_testSink.len == expectedLen && memcmp(session_testSink.written, expected, expectedLen) == 0, res, cleanup);
+
+	pbx_test_status_update(test, "A write accepting nothing without reporting an error stops the session\n");
+	session_testSink.chunk = 0;
+	pbx_test_validate_cleanup(test, (REQ(msg, CallStateMessage)) != NULL, res, cleanup);
+	pbx_test_validate_cleanup(test, session_send(scripted, msg, FALSE) < 0, res, cleanup);
+	pbx_test_validate_cleanup(test, scripted->writeFailed && scripted->session_stop, res, cleanup);
+
+cleanup:
+	GLOB(sendqueue_highwater) = highwater;
+	GLOB(sendqueue_stalltimeout) = stalltimeout;
+	if (s) {
+		destroy_session(s);
+	}
+	if (stalled) {
+		destroy_session(stalled);
+	}
+	if (scripted) {
+		destroy_session(scripted);
+	}
+	if (fds[1] > -1) {
+		close(fds[1]);
+	}
+	return res;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_session_lanes);
+	AST_TEST_REGISTER(sccp_session_sendqueue);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_session_lanes);
+	AST_TEST_UNREGISTER(sccp_session_sendqueue);
+}
+#endif
+
 // kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;
@@ -39,6 +39,7 @@ uint16_t sccp_session_getPendingRequests(sccp_session_t * s);
 SCCP_API void SCCP_CALL sccp_session_sendmsg(constDevicePtr device, sccp_mid_t t);
 SCCP_API int SCCP_CALL sccp_session_send(constDevicePtr device, const sccp_msg_t * msg_in);
 SCCP_API int SCCP_CALL sccp_session_send2(constSessionPtr session, sccp_msg_t * msg);
+SCCP_API int SCCP_CALL sccp_session_sendPinned(constDevicePtr device, sccp_msg_t * msg);
 SCCP_API int SCCP_CALL sccp_session_retainDevice(constSessionPtr session, constDevicePtr device);
 SCCP_API void SCCP_CALL sccp_session_releaseDevice(constSessionPtr volatile session);
 SCCP_API sccp_session_t * SCCP_CALL sccp_session_reject(constSessionPtr session, char *message);
@@ -59,6 +60,9 @@ SCCP_API boolean_t SCCP_CALL sccp_session_check_crossdevice(constSessionPtr sess
 SCCP_API devicePtr SCCP_CALL sccp_session_getDevice(constSessionPtr session, boolean_t required);
 SCCP_API boolean_t SCCP_CALL sccp_session_isValid(constSessionPtr session);
 SCCP_API int SCCP_CALL sccp_cli_show_sessions(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[]);
+SCCP_API int SCCP_CALL sccp_cli_show_listeners(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[]);
+SCCP_API int SCCP_CALL sccp_cli_show_sendqueues(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[]);
+SCCP_API int SCCP_CALL sccp_cli_show_handshakes(int fd, sccp_cli_totals_t *totals, struct mansession *s, const struct message *m, int argc, char *argv[]);
 
 SCCP_API boolean_t SCCP_CALL sccp_session_bind_and_listen(sccp_servercontext_t * context, struct sockaddr_storage * bindaddr);
 SCCP_API void SCCP_CALL sccp_session_stop_accept_thread(sccp_servercontext_t * context);
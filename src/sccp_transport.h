@@ -35,6 +35,7 @@ struct sccp_transport {
 	int (* const bind)(sccp_socket_connection_t * sc, struct sockaddr * addr, socklen_t addrlen);
 	int (* const listen)(sccp_socket_connection_t * sc, int backlog);
 	sccp_socket_connection_t * (* const accept)(sccp_socket_connection_t * in_sc, struct sockaddr *, socklen_t * len, sccp_socket_connection_t * out_sc);
+	int (* const handshake)(sccp_socket_connection_t * sc, int timeout_ms);				/*!< optional, run by the session thread after accept. returns 0 on success (1 when a session was resumed), -1 on failure, -2 on timeout */
 	int (* const recv)(sccp_socket_connection_t * sc, void * buf, size_t buflen, int flags);
 	// int (*const recv_timeout)(int fd, void *buf, size_t buflen, int flags, int secs);
 	int (* const send)(sccp_socket_connection_t * sc, void * buf, size_t buflen, int flags);
@@ -16,8 +16,16 @@ SCCP_FILE_VERSION(__FILE__, "");
 #include "sccp_transport.h"
 
 #ifdef HAVE_LIBSSL
+#	include <fcntl.h>
+#	include <poll.h>
 #	include <openssl/err.h> /* for ERR_print_errors_fp */
 #	include <openssl/ssl.h> /* for SSL_CTX_free, SSL_get_error, ... */
+#	include <openssl/evp.h>
+#	include <openssl/hmac.h>
+#	include <openssl/rand.h> /* for RAND_bytes */
+#	if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#		include <openssl/core_names.h> /* for OSSL_MAC_PARAM_DIGEST */
+#	endif
 #	ifdef HAVE_CRYPTO
 #		include <openssl/crypto.h> /* for OPENSSL_free */
 #	endif
@@ -25,6 +33,7 @@ SCCP_FILE_VERSION(__FILE__, "");
 #	define REQUEST_RETRY_INTERVAL 5
 #	define REQUEST_RETRY_COUNT    2
 #	define DUPLICATE_INTERVAL     REQUEST_RETRY_INTERVAL * REQUEST_RETRY_COUNT
+#	define TLS_SEND_TIMEOUT       5000                                                  // max millisecs tls_send waits for the socket to become writable
 
 /* local variables */
 static SSL_CTX * sslctx = NULL;
@@ -67,12 +76,6 @@ static void DestroySSL()
 	EVP_cleanup();
 }
 
-static void ShutdownSSL(SSL * ssl)
-{
-	SSL_shutdown(ssl);
-	SSL_free(ssl);
-}
-
 static SSL_CTX * create_context()
 {
 	sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_1 "TLS Transport create context...\n");
@@ -85,10 +88,140 @@ static SSL_CTX * create_context()
 		return NULL;
 	}
 	SSL_CTX_set_options(ctx, SSL_OP_SINGLE_DH_USE | SSL_OP_NO_SSLv2);
+#	ifdef SSL_OP_NO_RENEGOTIATION
+	SSL_CTX_set_options(ctx, SSL_OP_NO_RENEGOTIATION);							// reads and writes happen on different threads, never let a write wait for a read
+#	endif
+#	ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+	SSL_CTX_set_options(ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);						// a phone dropping the connection is a normal close
+#	endif
+	SSL_CTX_set_read_ahead(ctx, 1);										// fetch as many records as are available per read syscall
 
 	return ctx;
 }
 
+/*!
+ * \brief Session ticket keys, [0] is used to issue new tickets, [1] is the previous key, still accepted (tickets get renewed)
+ */
+typedef struct {
+	unsigned char name[16];
+	unsigned char aes[32];
+	unsigned char hmac[32];
+	time_t created;
+} tls_ticket_key_t;
+
+static tls_ticket_key_t ticketKeys[2];
+AST_MUTEX_DEFINE_STATIC(ticketKeysLock);
+
+static boolean_t tls_ticket_key_generate(tls_ticket_key_t * key)
+{
+	if (RAND_bytes(key->name, sizeof(key->name)) <= 0 || RAND_bytes(key->aes, sizeof(key->aes)) <= 0 || RAND_bytes(key->hmac, sizeof(key->hmac)) <= 0) {
+		write_openssl_error_to_log();
+		return FALSE;
+	}
+	key->created = time(0);
+	return TRUE;
+}
+
+/*!
+ * \brief Select the ticket key to encrypt with (rotating it when it is due) or the key matching key_name to decrypt with
+ * \return encrypt: 1 or -1 on error, decrypt: 0 unknown key, 1 current key, 2 previous key (ticket should be renewed)
+ */
+static int tls_ticket_key_select(unsigned char key_name[16], int enc, tls_ticket_key_t * key)
+{
+	int res = 0;
+
+	pbx_mutex_lock(&ticketKeysLock);
+	if (enc) {
+		res = 1;
+		if (GLOB(tls_ticket_rotation) && time(0) - ticketKeys[0].created >= (time_t)GLOB(tls_ticket_rotation)) {
+			tls_ticket_key_t newKey;
+			if (tls_ticket_key_generate(&newKey)) {
+				ticketKeys[1] = ticketKeys[0];
+				ticketKeys[0] = newKey;
+				sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_3 "SCCP: TLS session ticket key rotated\n");
+			}
+		}
+		*key = ticketKeys[0];
+		memcpy(key_name, key->name, sizeof(key->name));
+	} else if (!memcmp(key_name, ticketKeys[0].name, sizeof(ticketKeys[0].name))) {
+		*key = ticketKeys[0];
+		res = 1;
+	} else if (ticketKeys[1].created && !memcmp(key_name, ticketKeys[1].name, sizeof(ticketKeys[1].name))) {
+		*key = ticketKeys[1];
+		res = 2;
+	}
+	pbx_mutex_unlock(&ticketKeysLock);
+	return res;
+}
+
+#	if OPENSSL_VERSION_NUMBER >= 0x30000000L
+static int tls_ticket_key_cb(SSL * ssl, unsigned char key_name[16], unsigned char iv[EVP_MAX_IV_LENGTH], EVP_CIPHER_CTX * ectx, EVP_MAC_CTX * hctx, int enc)
+#	else
+static int tls_ticket_key_cb(SSL * ssl, unsigned char key_name[16], unsigned char iv[EVP_MAX_IV_LENGTH], EVP_CIPHER_CTX * ectx, HMAC_CTX * hctx, int enc)
+#	endif
+{
+	tls_ticket_key_t key;
+	int res = tls_ticket_key_select(key_name, enc, &key);
+
+	if (res <= 0) {
+		return res;
+	}
+	if (enc) {
+		if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) <= 0 || !EVP_EncryptInit_ex(ectx, EVP_aes_256_cbc(), NULL, key.aes, iv)) {
+			return -1;
+		}
+	} else if (!EVP_DecryptInit_ex(ectx, EVP_aes_256_cbc(), NULL, key.aes, iv)) {
+		return -1;
+	}
+#	if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	OSSL_PARAM params[] = {
+		OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, (char *)"SHA256", 0),
+		OSSL_PARAM_construct_end(),
+	};
+	if (!EVP_MAC_init(hctx, key.hmac, sizeof(key.hmac), params)) {
+		return -1;
+	}
+#	else
+	if (!HMAC_Init_ex(hctx, key.hmac, sizeof(key.hmac), EVP_sha256(), NULL)) {
+		return -1;
+	}
+#	endif
+	return res;
+}
+
+/*!
+ * \brief Configure the server side session cache and stateless session tickets, so reconnecting phones can resume their session
+ */
+static void configure_session_resumption(SSL_CTX * ctx, uint32_t cacheSize, uint32_t timeout, boolean_t tickets)
+{
+	static const unsigned char sid_ctx[] = "chan_sccp";
+
+	SSL_CTX_set_session_id_context(ctx, sid_ctx, sizeof(sid_ctx) - 1);
+	SSL_CTX_set_timeout(ctx, timeout);
+	if (cacheSize) {
+		SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+		SSL_CTX_sess_set_cache_size(ctx, cacheSize);
+	} else {
+		SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+	}
+	if (tickets) {
+		SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+		pbx_mutex_lock(&ticketKeysLock);
+		if (!ticketKeys[0].created) {
+			tls_ticket_key_generate(&ticketKeys[0]);
+		}
+		pbx_mutex_unlock(&ticketKeysLock);
+#	if OPENSSL_VERSION_NUMBER >= 0x30000000L
+		SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, tls_ticket_key_cb);
+#	else
+		SSL_CTX_set_tlsext_ticket_key_cb(ctx, tls_ticket_key_cb);
+#	endif
+	} else {
+		SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+	}
+	sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_3 "TLS session cache:%u entries, timeout:%us, tickets:%s, ticket rotation:%us\n", cacheSize, timeout, tickets ? "yes" : "no", GLOB(tls_ticket_rotation));
+}
+
 static boolean_t configure_context(SSL_CTX * ctx)
 {
 	SSL_CTX_set_ecdh_auto(ctx, 1);
@@ -119,6 +252,7 @@ static boolean_t configure_context(SSL_CTX * ctx)
 			return FALSE;
 		}
 	}
+	configure_session_resumption(ctx, GLOB(tls_session_cache), GLOB(tls_session_timeout), GLOB(tls_session_tickets));
 
 	return TRUE;
 }
@@ -145,64 +279,198 @@ static int tls_listen(sccp_socket_connection_t * sc, int backlog)
 	return listen(sc->fd, backlog);
 }
 
+/*!
+ * \brief Accept the tcp connection only. The TLS handshake is left to tls_handshake, which runs on the session thread,
+ * so that a slow or malicious client cannot stall the accept thread and the ACL check happens before any crypto work.
+ */
 static sccp_socket_connection_t * tls_accept(sccp_socket_connection_t * in_sc, struct sockaddr * addr, socklen_t * addrlen, sccp_socket_connection_t * out_sc)
 {
-	unsigned long ssl_err;
-	int           newfd = 0;
-	SSL *         ssl   = NULL;
 	// sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_1 "TLS Transport accept...\n");
+	int newfd = accept(in_sc->fd, addr, addrlen);
+	out_sc->fd = newfd;
+	out_sc->ssl = NULL;
+	if (newfd < 0) {
+		pbx_log(LOG_ERROR, "Error accepting new socket %s on fd:%d\n", strerror(errno), in_sc->fd);
+		return NULL;
+	}
+	sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_1 "TLS Transport accept returning:%d...\n", newfd);
+	return out_sc;
+}
+
+/*!
+ * \brief Non-blocking TLS server handshake, driven by poll until it completes, fails or times out
+ * \param ctx SSL Context
+ * \param sc Socket Connection (the SSL structure is created here and attached to sc)
+ * \param timeout_ms Maximum time the complete handshake may take
+ * \return 0 on success, 1 on success using a resumed session, -1 on failure, -2 on timeout
+ */
+static int tls_server_handshake(SSL_CTX * ctx, sccp_socket_connection_t * sc, int timeout_ms)
+{
+	struct timeval start = pbx_tvnow();
+	int            res   = -1;
+	int            flags = 0;
+
+	if (!sc->ssl) {
+		if (!(sc->ssl = SSL_new(ctx))) {
+			pbx_log(LOG_ERROR, "Error creating new SSL structure\n");
+			write_openssl_error_to_log();
+			return -1;
+		}
+		SSL_set_fd(sc->ssl, sc->fd);
+		/* tls_send(MSG_DONTWAIT) returns EAGAIN on WANT_WRITE: report what did go out and let the session retry the rest of the same
+		 * (possibly moved) pending buffer later, once the socket is writable again */
+		SSL_set_mode(sc->ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+	}
+	if ((flags = fcntl(sc->fd, F_GETFL)) < 0 || fcntl(sc->fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+		pbx_log(LOG_ERROR, "Error switching fd:%d to non-blocking: %s\n", sc->fd, strerror(errno));
+		return -1;
+	}
 	do {
-		newfd = accept(in_sc->fd, addr, addrlen);
-		if (newfd < 0) {
-			pbx_log(LOG_ERROR, "Error accepting new socket %s on fd:%d\n", strerror(errno), in_sc->fd);
+		int ssl_res = SSL_accept(sc->ssl);
+		if (ssl_res == 1) {
+			res = SSL_session_reused(sc->ssl) ? 1 : 0;
 			break;
 		}
-
-		ssl = SSL_new(sslctx);
-		if (!ssl) {
-			pbx_log(LOG_ERROR, "Error creating new SSL structure\n");
+		struct pollfd fds[1] = { { 0 } };
+		fds[0].fd = sc->fd;
+		switch (SSL_get_error(sc->ssl, ssl_res)) {
+			case SSL_ERROR_WANT_READ:
+				fds[0].events = POLLIN;
+				break;
+			case SSL_ERROR_WANT_WRITE:
+				fds[0].events = POLLOUT;
+				break;
+			default:
+				pbx_log(LOG_NOTICE, "SSL handshake failed on fd:%d\n", sc->fd);
+				write_openssl_error_to_log();
+				fds[0].events = 0;
+				break;
+		}
+		if (!fds[0].events) {
 			break;
 		}
-
-		SSL_set_fd(ssl, newfd);
-		ssl_err = SSL_accept(ssl);
-		if (ssl_err <= 0) {
-			pbx_log(LOG_ERROR, "SSL Error occured: %lu '%s'.\n", ssl_err, ERR_reason_error_string(ssl_err));
+		int remaining = timeout_ms - (int)ast_tvdiff_ms(pbx_tvnow(), start);
+		int pollres   = remaining > 0 ? poll(fds, 1, remaining) : 0;
+		if (pollres == 0) {
+			res = -2;
 			break;
 		}
-		out_sc->fd  = newfd;
-		out_sc->ssl = ssl;
-		sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_1 "TLS Transport accept returning:%d...\n", newfd);
-		return out_sc;
-	} while (0);
-
-	// cleanup:
-	if (ssl) {
-		write_openssl_error_to_log();
-		ShutdownSSL(ssl);
-	}
-	if (newfd >= 0) {
-		close(newfd);
+		if (pollres < 0 && errno != EINTR && errno != EAGAIN) {
+			pbx_log(LOG_NOTICE, "SSL handshake poll failed on fd:%d: %s\n", sc->fd, strerror(errno));
+			break;
+		}
+	} while (1);
+	if (res < 0) {
+		fcntl(sc->fd, F_SETFL, flags);
 	}
-	return NULL;
+	return res;												// on success the socket stays non-blocking, see tls_recv/tls_send
 }
 
+static int tls_handshake(sccp_socket_connection_t * sc, int timeout_ms)
+{
+	return tls_server_handshake(sslctx, sc, timeout_ms);
+}
+
+/*!
+ * \brief Read everything that can be read without blocking, up to buflen
+ *
+ * Records that were already fetched (read ahead) and decrypted by openssl do not make the fd readable again, so instead of a
+ * single SSL_read, keep reading until openssl reports WANT_READ (or the buffer is full).
+ *
+ * \return number of bytes read, 0 when the connection was closed, -1 with errno set to EAGAIN when no complete record is available yet
+ */
 static int tls_recv(sccp_socket_connection_t * sc, void * buf, size_t buflen, int flags)
 {
 	// sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_1 "TLS Transport recv...\n");
-	return SSL_read(sc->ssl, buf, buflen);
+	int total = 0;
+
+	if (!sc->ssl) {
+		errno = ENOTCONN;
+		return -1;
+	}
+	while ((size_t)total < buflen) {
+		int res = SSL_read(sc->ssl, (char *)buf + total, buflen - total);
+		if (res > 0) {
+			total += res;
+			continue;
+		}
+		int err = SSL_get_error(sc->ssl, res);
+		if (total > 0) {
+			break;											// hand over what we have, a close/error resurfaces on the next call
+		}
+		switch (err) {
+			case SSL_ERROR_WANT_READ:
+			case SSL_ERROR_WANT_WRITE:
+				errno = EAGAIN;
+				return -1;
+			case SSL_ERROR_ZERO_RETURN:
+				return 0;
+			case SSL_ERROR_SYSCALL:
+				return (res == 0 || errno == 0) ? 0 : -1;					// eof without close_notify
+			default:
+				write_openssl_error_to_log();
+				errno = EPROTO;
+				return -1;
+		}
+	}
+	return total;
 }
 
+/*!
+ * \brief Write one buffer
+ *
+ * With MSG_DONTWAIT, WANT_WRITE/WANT_READ return -1 / EAGAIN immediately (like send() on a full socket). The caller has to retry with
+ * the same remaining data, the session thread does so once the socket is writable (POLLOUT). Without it, waits up to TLS_SEND_TIMEOUT.
+ * Partial writes are enabled, so the number of bytes written can be less than buflen.
+ */
 static int tls_send(sccp_socket_connection_t * sc, void * buf, size_t buflen, int flags)
 {
 	// sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_1 "TLS Transport send...\n");
-	return SSL_write(sc->ssl, buf, buflen);
+	int res = 0;
+
+	if (!sc->ssl) {
+		errno = ENOTCONN;
+		return -1;
+	}
+	while ((res = SSL_write(sc->ssl, buf, buflen)) <= 0) {
+		struct pollfd fds[1] = { { 0 } };
+		fds[0].fd = sc->fd;
+		switch (SSL_get_error(sc->ssl, res)) {
+			case SSL_ERROR_WANT_WRITE:
+				fds[0].events = POLLOUT;
+				break;
+			case SSL_ERROR_WANT_READ:
+				fds[0].events = POLLIN;
+				break;
+			case SSL_ERROR_SYSCALL:
+				return -1;
+			default:
+				write_openssl_error_to_log();
+				errno = EPROTO;
+				return -1;
+		}
+		if (flags & MSG_DONTWAIT) {
+			errno = EAGAIN;
+			return -1;
+		}
+		int pollres = poll(fds, 1, TLS_SEND_TIMEOUT);
+		if (pollres == 0) {
+			errno = ETIMEDOUT;
+			return -1;
+		}
+		if (pollres < 0 && errno != EINTR) {
+			return -1;
+		}
+	}
+	return res;
 }
 
 static int tls_shutdown(sccp_socket_connection_t * sc, int how)
 {
 	// sccp_log(DEBUGCAT_SOCKET)(VERBOSE_PREFIX_1 "TLS Transport shutdown...\n");
-	SSL_shutdown(sc->ssl);
+	if (sc->ssl && SSL_is_init_finished(sc->ssl)) {
+		SSL_shutdown(sc->ssl);
+	}
 	return shutdown(sc->fd, how);
 }
 
@@ -214,6 +482,9 @@ static int tls_close(sccp_socket_connection_t * sc)
 		res = close(sc->fd);
 	}
 	if (sc->ssl) {
+		if (SSL_is_init_finished(sc->ssl)) {
+			SSL_set_shutdown(sc->ssl, SSL_get_shutdown(sc->ssl) | SSL_SENT_SHUTDOWN);		// keep the session resumable when the phone just dropped the connection (fatal tls errors invalidate it anyway)
+		}
 		SSL_free(sc->ssl);
 	}
 	return res;
@@ -238,15 +509,393 @@ const sccp_transport_t tlstransport = {
 	.retryintervalmax         = 60,
 	.duplicateintervaldefault = DUPLICATE_INTERVAL,
 
-	.init     = tls_init,
-	.bind     = tls_bind,
-	.listen   = tls_listen,
-	.accept   = tls_accept,
-	.recv     = tls_recv,
-	.send     = tls_send,
-	.shutdown = tls_shutdown,
-	.close    = tls_close,
-	.destroy  = tls_destroy,
+	.init      = tls_init,
+	.bind      = tls_bind,
+	.listen    = tls_listen,
+	.accept    = tls_accept,
+	.handshake = tls_handshake,
+	.recv      = tls_recv,
+	.send      = tls_send,
+	.shutdown  = tls_shutdown,
+	.close     = tls_close,
+	.destroy   = tls_destroy,
 };
+#	if CS_TEST_FRAMEWORK
+#		include <asterisk/test.h>
+#		include <openssl/x509.h>
+#		include <sys/socket.h>
+
+#		define NUM_TLS_HANDSHAKES 20
+
+static SSL_CTX * tls_test_server_context(uint32_t cacheSize, boolean_t tickets)
+{
+	SSL_CTX * ctx = create_context();
+	EVP_PKEY * pkey = NULL;
+	EVP_PKEY_CTX * pctx = NULL;
+	X509 * x509 = NULL;
+
+	if (!ctx) {
+		return NULL;
+	}
+	do {
+		if (!(pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL)) || EVP_PKEY_keygen_init(pctx) <= 0 || EVP_PKEY_CTX_set_rsa_keygen_bits(pctx, 2048) <= 0 || EVP_PKEY_keygen(pctx, &pkey) <= 0) {
+			break;
+		}
+		if (!(x509 = X509_new())) {
+			break;
+		}
+		ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+		X509_gmtime_adj(X509_get_notBefore(x509), 0);
+		X509_gmtime_adj(X509_get_notAfter(x509), 3600);
+		X509_set_pubkey(x509, pkey);
+		X509_NAME_add_entry_by_txt(X509_get_subject_name(x509), "CN", MBSTRING_ASC, (const unsigned char *)"chan-sccp-test", -1, -1, 0);
+		X509_set_issuer_name(x509, X509_get_subject_name(x509));
+		if (!X509_sign(x509, pkey, EVP_sha256()) || SSL_CTX_use_certificate(ctx, x509) <= 0 || SSL_CTX_use_PrivateKey(ctx, pkey) <= 0) {
+			break;
+		}
+		SSL_CTX_set_ecdh_auto(ctx, 1);
+		configure_session_resumption(ctx, cacheSize, 300, tickets);
+		X509_free(x509);
+		EVP_PKEY_free(pkey);
+		EVP_PKEY_CTX_free(pctx);
+		return ctx;
+	} while (0);
+	write_openssl_error_to_log();
+	X509_free(x509);
+	EVP_PKEY_free(pkey);
+	EVP_PKEY_CTX_free(pctx);
+	SSL_CTX_free(ctx);
+	return NULL;
+}
+
+typedef struct {
+	SSL_CTX * ctx;
+	sccp_socket_connection_t sc;
+	int result;
+} tls_test_server_t;
+
+static void * tls_test_server_thread(void * data)
+{
+	tls_test_server_t * server = (tls_test_server_t *)data;
+	char c = 0;
+
+	server->result = tls_server_handshake(server->ctx, &server->sc, 5000);
+	if (server->result >= 0) {
+		struct pollfd fds[1] = { { 0 } };
+		fds[0].fd = server->sc.fd;
+		fds[0].events = POLLIN;
+		tls_send(&server->sc, "x", 1, 0);								/* lets the client pick up the session tickets */
+		while (poll(fds, 1, 5000) > 0 && tls_recv(&server->sc, &c, 1, 0) < 0 && errno == EAGAIN) {
+			/* wait for the client to close */
+		}
+	}
+	return NULL;
+}
+
+static void * tls_test_handshake_thread(void * data)
+{
+	tls_test_server_t * server = (tls_test_server_t *)data;
+
+	server->result = tls_server_handshake(server->ctx, &server->sc, 5000);
+	return NULL;
+}
+
+/*!
+ * \brief Connect a loopback client to the server context, optionally offering a session to resume
+ * \return handshake time in usec, or -1 on failure. *session is replaced by the session to use for the next connection.
+ */
+static int64_t tls_test_connect(SSL_CTX * serverCtx, SSL_CTX * clientCtx, SSL_SESSION ** session, boolean_t * reused)
+{
+	int fds[2] = { -1, -1 };
+	tls_test_server_t server = { serverCtx, { -1, NULL }, -1 };
+	pthread_t thread;
+	SSL * ssl = NULL;
+	int64_t res = -1;
+	char c = 0;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+		return -1;
+	}
+	server.sc.fd = fds[0];
+	if (pbx_pthread_create(&thread, NULL, tls_test_server_thread, &server)) {
+		close(fds[0]);
+		close(fds[1]);
+		return -1;
+	}
+	if ((ssl = SSL_new(clientCtx))) {
+		SSL_set_fd(ssl, fds[1]);
+		if (*session) {
+			SSL_set_session(ssl, *session);
+		}
+		struct timeval start = pbx_tvnow();
+		if (SSL_connect(ssl) == 1) {
+			res = ast_tvdiff_us(pbx_tvnow(), start);
+			*reused = SSL_session_reused(ssl) ? TRUE : FALSE;
+			SSL_read(ssl, &c, 1);
+			if (*session) {
+				SSL_SESSION_free(*session);
+			}
+			*session = SSL_get1_session(ssl);
+		}
+		SSL_shutdown(ssl);
+		SSL_free(ssl);
+	}
+	shutdown(fds[1], SHUT_RDWR);
+	pthread_join(thread, NULL);
+	if (server.result < 0 || (server.result == 1) != (res >= 0 && *reused)) {
+		res = -1;
+	}
+	tls_close(&server.sc);
+	close(fds[1]);
+	return res;
+}
+
+AST_TEST_DEFINE(sccp_transport_tls_resumption)
+{
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "resumption";
+			info->category = "/channels/chan_sccp/transport/tls/";
+			info->summary = "chan-sccp-b tls session resumption";
+			info->description = "Compares full handshakes against resumed ones, using the session cache and session tickets over a loopback connection";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	SSL_CTX * clientCtx = SSL_CTX_new(SSLv23_client_method());
+	pbx_test_validate(test, clientCtx != NULL);
+
+	int mode = 0;
+	for (mode = 0; mode < 2; mode++) {
+		boolean_t tickets = mode == 0 ? TRUE : FALSE;
+		SSL_CTX * serverCtx = tls_test_server_context(tickets ? 0 : 1024, tickets);
+		SSL_SESSION * session = NULL;
+		boolean_t reused = FALSE;
+		int64_t full = 0;
+		int64_t resumed = 0;
+		int64_t elapsed = 0;
+		int loop = 0;
+
+		pbx_test_validate(test, serverCtx != NULL);
+		pbx_test_status_update(test, "Resumption using %s\n", tickets ? "session tickets" : "the server session cache");
+		for (loop = 0; loop < NUM_TLS_HANDSHAKES; loop++) {
+			SSL_SESSION * fresh = NULL;
+			elapsed = tls_test_connect(serverCtx, clientCtx, &fresh, &reused);
+			pbx_test_validate(test, elapsed >= 0 && !reused);
+			full += elapsed;
+			if (session) {
+				SSL_SESSION_free(session);
+			}
+			session = fresh;
+		}
+		for (loop = 0; loop < NUM_TLS_HANDSHAKES; loop++) {
+			elapsed = tls_test_connect(serverCtx, clientCtx, &session, &reused);
+			pbx_test_validate(test, elapsed >= 0 && reused);
+			resumed += elapsed;
+		}
+		pbx_test_status_update(test, "%d full handshakes: %ld usec avg, %d resumed: %ld usec avg (%.1fx)\n", NUM_TLS_HANDSHAKES, (long)(full / NUM_TLS_HANDSHAKES), NUM_TLS_HANDSHAKES,
+				       (long)(resumed / NUM_TLS_HANDSHAKES), resumed ? (double)full / resumed : 0.0);
+		pbx_test_validate(test, resumed < full);
+		if (tickets && GLOB(tls_ticket_rotation)) {
+			pbx_test_status_update(test, "Tickets issued under the previous key are still accepted after rotation\n");
+			pbx_mutex_lock(&ticketKeysLock);
+			ticketKeys[0].created -= GLOB(tls_ticket_rotation);						/* next ticket issued rotates the key */
+			pbx_mutex_unlock(&ticketKeysLock);
+			SSL_SESSION * other = NULL;
+			pbx_test_validate(test, tls_test_connect(serverCtx, clientCtx, &other, &reused) >= 0 && !reused);
+			SSL_SESSION_free(other);
+			pbx_test_validate(test, tls_test_connect(serverCtx, clientCtx, &session, &reused) >= 0 && reused);
+		}
+		if (session) {
+			SSL_SESSION_free(session);
+		}
+		SSL_CTX_free(serverCtx);
+	}
+	SSL_CTX_free(clientCtx);
+	return AST_TEST_PASS;
+}
+
+/*!
+ * \brief Set up a connected loopback pair, the server side using the transport (non-blocking), the client side using plain (blocking) openssl
+ */
+static SSL * tls_test_pair(SSL_CTX * serverCtx, SSL_CTX * clientCtx, sccp_socket_connection_t * serverSc, int * clientFd)
+{
+	int fds[2] = { -1, -1 };
+	tls_test_server_t server = { serverCtx, { -1, NULL }, -1 };
+	pthread_t thread;
+	SSL * ssl = NULL;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+		return NULL;
+	}
+	server.sc.fd = fds[0];
+	if (pbx_pthread_create(&thread, NULL, tls_test_handshake_thread, &server)) {
+		close(fds[0]);
+		close(fds[1]);
+		return NULL;
+	}
+	if ((ssl = SSL_new(clientCtx))) {
+		SSL_set_fd(ssl, fds[1]);
+		if (SSL_connect(ssl) != 1) {
+			SSL_free(ssl);
+			ssl = NULL;
+		}
+	}
+	if (!ssl) {
+		shutdown(fds[1], SHUT_RDWR);
+	}
+	pthread_join(thread, NULL);
+	*serverSc = server.sc;
+	*clientFd = fds[1];
+	if (!ssl || server.result < 0) {
+		tls_close(serverSc);
+		close(fds[1]);
+		if (ssl) {
+			SSL_free(ssl);
+		}
+		return NULL;
+	}
+	return ssl;
+}
+
+typedef struct {
+	SSL * ssl;
+	size_t expected;
+	size_t received;
+} tls_test_reader_t;
+
+static void * tls_test_reader_thread(void * data)
+{
+	tls_test_reader_t * reader = (tls_test_reader_t *)data;
+	char buf[4096];
+	int res = 0;
+
+	usleep(20000);												/* let the writer run into a full socket first */
+	while (reader->received < reader->expected && (res = SSL_read(reader->ssl, buf, sizeof(buf))) > 0) {
+		reader->received += res;
+	}
+	return NULL;
+}
+
+AST_TEST_DEFINE(sccp_transport_tls_read)
+{
+#		define NUM_TLS_RECORDS    20
+#		define TLS_RECORD_SIZE    200
+#		define NUM_TLS_ROUNDTRIPS 1000
+#		define NUM_TLS_PUSHES     200
+#		define TLS_PUSH_SIZE      2000
+	switch (cmd) {
+		case TEST_INIT:
+			info->name = "read";
+			info->category = "/channels/chan_sccp/transport/tls/";
+			info->summary = "chan-sccp-b tls read loop";
+			info->description = "Checks that tls_recv drains all buffered records, that WANT_READ/WANT_WRITE are handled, and measures the round trip latency over a loopback connection";
+			return AST_TEST_NOT_RUN;
+		case TEST_EXECUTE:
+			break;
+	}
+	SSL_CTX * clientCtx = SSL_CTX_new(SSLv23_client_method());
+	SSL_CTX * serverCtx = tls_test_server_context(0, FALSE);
+	sccp_socket_connection_t sc = { -1, NULL };
+	int clientFd = -1;
+	SSL * ssl = NULL;
+	unsigned char buf[TLS_RECORD_SIZE * NUM_TLS_RECORDS * 2];
+	unsigned char record[TLS_PUSH_SIZE] = { 0 };
+	struct pollfd fds[1] = { { 0 } };
+	int loop = 0;
+	int res = 0;
+	int total = 0;
+
+	pbx_test_validate(test, clientCtx != NULL && serverCtx != NULL);
+	ssl = tls_test_pair(serverCtx, clientCtx, &sc, &clientFd);
+	pbx_test_validate(test, ssl != NULL);
+	fds[0].fd = sc.fd;
+	fds[0].events = POLLIN;
+
+	pbx_test_status_update(test, "Drain all buffered records in a single call\n");
+	for (loop = 0; loop < NUM_TLS_RECORDS; loop++) {
+		SSL_write(ssl, record, TLS_RECORD_SIZE);
+	}
+	pbx_test_validate(test, poll(fds, 1, 1000) == 1);
+	res = tls_recv(&sc, buf, sizeof(buf), 0);
+	pbx_test_validate(test, res == TLS_RECORD_SIZE * NUM_TLS_RECORDS);
+	res = tls_recv(&sc, buf, sizeof(buf), 0);
+	pbx_test_validate(test, res == -1 && errno == EAGAIN);
+
+	pbx_test_status_update(test, "With a small buffer, the remaining records are returned without waiting for the fd\n");
+	for (loop = 0; loop < NUM_TLS_RECORDS; loop++) {
+		SSL_write(ssl, record, TLS_RECORD_SIZE);
+	}
+	pbx_test_validate(test, poll(fds, 1, 1000) == 1);
+	for (total = 0, loop = 0; (res = tls_recv(&sc, buf, TLS_RECORD_SIZE * 5, 0)) > 0; loop++) {
+		total += res;
+		if (loop == 0) {
+			pbx_test_status_update(test, "fd readable after the first read: %s\n", poll(fds, 1, 0) == 1 ? "yes" : "no (data held by openssl)");
+		}
+	}
+	pbx_test_validate(test, total == TLS_RECORD_SIZE * NUM_TLS_RECORDS && loop == 4 && errno == EAGAIN);
+
+	pbx_test_status_update(test, "Round trip latency\n");
+	struct timeval start = pbx_tvnow();
+	for (loop = 0; loop < NUM_TLS_ROUNDTRIPS; loop++) {
+		SSL_write(ssl, record, 12);
+		pbx_test_validate(test, poll(fds, 1, 1000) == 1 && tls_recv(&sc, buf, sizeof(buf), 0) == 12);
+		pbx_test_validate(test, tls_send(&sc, buf, 12, 0) == 12 && SSL_read(ssl, buf, 12) == 12);
+	}
+	pbx_test_status_update(test, "%d round trips: %ld usec avg\n", NUM_TLS_ROUNDTRIPS, (long)(ast_tvdiff_us(pbx_tvnow(), start) / NUM_TLS_ROUNDTRIPS));
+
+	pbx_test_status_update(test, "Push more than the socket can buffer (MSG_DONTWAIT, WANT_WRITE -> EAGAIN, retry on POLLOUT)\n");
+	int sndbuf = 4096;
+	int wouldblock = 0;
+	int sent = 0;
+	setsockopt(sc.fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+	setsockopt(clientFd, SOL_SOCKET, SO_RCVBUF, &sndbuf, sizeof(sndbuf));
+	tls_test_reader_t reader = { ssl, NUM_TLS_PUSHES * TLS_PUSH_SIZE, 0 };
+	pthread_t thread;
+	pbx_test_validate(test, pbx_pthread_create(&thread, NULL, tls_test_reader_thread, &reader) == 0);
+	for (total = 0, loop = 0; loop < NUM_TLS_PUSHES;) {
+		res = tls_send(&sc, record + sent, TLS_PUSH_SIZE - sent, MSG_DONTWAIT);
+		if (res < 0) {
+			if (errno != EAGAIN) {
+				break;
+			}
+			/* same as the session thread: wait for POLLOUT, then retry the remaining part of the same buffer */
+			struct pollfd wfds[1] = { { .fd = sc.fd, .events = POLLOUT } };
+			wouldblock++;
+			if (poll(wfds, 1, 5000) <= 0) {
+				break;
+			}
+			continue;
+		}
+		total += res;
+		if ((sent += res) == TLS_PUSH_SIZE) {
+			sent = 0;
+			loop++;
+		}
+	}
+	pthread_join(thread, NULL);
+	pbx_test_status_update(test, "%d times EAGAIN\n", wouldblock);
+	pbx_test_validate(test, wouldblock > 0 && total == NUM_TLS_PUSHES * TLS_PUSH_SIZE && reader.received == reader.expected);
+
+	SSL_free(ssl);
+	close(clientFd);
+	tls_close(&sc);
+	SSL_CTX_free(serverCtx);
+	SSL_CTX_free(clientCtx);
+	return AST_TEST_PASS;
+}
+
+static void __attribute__((constructor)) sccp_register_tests(void)
+{
+	AST_TEST_REGISTER(sccp_transport_tls_resumption);
+	AST_TEST_REGISTER(sccp_transport_tls_read);
+}
+
+static void __attribute__((destructor)) sccp_unregister_tests(void)
+{
+	AST_TEST_UNREGISTER(sccp_transport_tls_resumption);
+	AST_TEST_UNREGISTER(sccp_transport_tls_read);
+}
+#	endif
 #endif /* HAVE_LIBSSL */
 // kate: indent-width 8; replace-tabs off; indent-mode cstyle; auto-insert-doxygen on; line-numbers on; tab-indents on; keep-extra-spaces off; auto-brackets off;